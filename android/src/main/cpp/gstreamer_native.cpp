@@ -9,8 +9,6 @@
 
 #include <glib.h>
 
-#include <thread>
-
 // The GStreamer Android SDK provides JNI helpers (libgstandroidmedia) that need the JavaVM
 // to be set before plugins like androidmedia can initialize/register correctly.
 // The SDK doesn't always ship public headers for these helpers; declare what we use.
@@ -47,10 +45,24 @@ GST_PLUGIN_STATIC_DECLARE(ndk);
 GST_PLUGIN_STATIC_DECLARE(opengl);
 }
 
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "kataglyphis_native_core/diagnostic_ring.h"
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_rewriter.h"
+#include "kataglyphis_native_core/pipeline_session.h"
+#include "kataglyphis_native_core/session_table.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
 
 namespace {
+namespace core = kataglyphis_native_inference::core;
+
 constexpr const char *kTag = "KataglyphisGStreamer";
 
 #ifdef GST_ANDROIDMEDIA_AVAILABLE
@@ -66,36 +78,30 @@ constexpr const char *kFlagAhc = "0";
 #endif
 
 // Track if the JNI VM has been set for GStreamer Android media plugins.
+// Written under g_init_mutex in init(), before the runtime thread starts.
+std::mutex g_init_mutex;
 bool g_jni_vm_set = false;
 
-struct GstContextState {
-    GstElement *pipeline = nullptr;
+// Everything a Flutter texture needs: its pipeline session (own lock, own
+// worker main loop) and the ANativeWindow of its SurfaceTexture.
+struct AndroidSession {
+    core::PipelineSession pipeline;
     ANativeWindow *window = nullptr;
-    bool initialized = false;
 
-    // Some Android camera sources rely on a running GLib main loop.
-    // We start one once per process and keep it running.
-    GMainContext *main_context = nullptr;
-    GMainLoop *main_loop = nullptr;
-    bool main_loop_started = false;
+    ~AndroidSession() {
+        pipeline.Close();
+        if (window) ANativeWindow_release(window);
+    }
 };
 
-std::mutex g_mutex;
-GstContextState g_state;
-std::string g_last_error;
+core::SessionTable<AndroidSession> g_sessions;
 
-void setLastError(const std::string &msg) {
-    g_last_error = msg;
-    __android_log_print(ANDROID_LOG_ERROR, kTag, "%s", msg.c_str());
-}
-
-void appendLastError(const std::string &msg) {
-    if (!g_last_error.empty()) g_last_error += "\n";
-    g_last_error += msg;
-    __android_log_print(ANDROID_LOG_ERROR, kTag, "%s", msg.c_str());
-}
+// Diagnostics that belong to no session (e.g. createSession failures),
+// reported for session id 0.
+core::DiagnosticRing g_diagnostics(32);
 
-void logError(const char *msg) {
+void setLastError(const char *msg) {
+    g_diagnostics.Record(core::DiagnosticSeverity::kError, "jni", 0, msg);
     __android_log_print(ANDROID_LOG_ERROR, kTag, "%s", msg);
 }
 
@@ -103,152 +109,9 @@ void logInfo(const char *msg) {
     __android_log_print(ANDROID_LOG_INFO, kTag, "%s", msg);
 }
 
-const char *stateToStr(GstState state) {
-    switch (state) {
-        case GST_STATE_VOID_PENDING: return "VOID_PENDING";
-        case GST_STATE_NULL: return "NULL";
-        case GST_STATE_READY: return "READY";
-        case GST_STATE_PAUSED: return "PAUSED";
-        case GST_STATE_PLAYING: return "PLAYING";
-        default: return "UNKNOWN";
-    }
-}
-
-void logBusMessages(GstBus *bus) {
-    if (!bus) return;
-    while (GstMessage *msg = gst_bus_pop_filtered(
-               bus, static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_WARNING))) {
-        switch (GST_MESSAGE_TYPE(msg)) {
-            case GST_MESSAGE_ERROR: {
-                GError *err = nullptr;
-                gchar *dbg = nullptr;
-                gst_message_parse_error(msg, &err, &dbg);
-                const std::string line = std::string("bus error: ") +
-                                         (err ? err->message : "unknown") +
-                                         " (" + (dbg ? dbg : "no debug") + ")";
-                appendLastError(line);
-                if (err) g_error_free(err);
-                if (dbg) g_free(dbg);
-                break;
-            }
-            case GST_MESSAGE_WARNING: {
-                GError *err = nullptr;
-                gchar *dbg = nullptr;
-                gst_message_parse_warning(msg, &err, &dbg);
-                const std::string line = std::string("bus warning: ") +
-                                         (err ? err->message : "unknown") +
-                                         " (" + (dbg ? dbg : "no debug") + ")";
-                appendLastError(line);
-                if (err) g_error_free(err);
-                if (dbg) g_free(dbg);
-                break;
-            }
-            default:
-                break;
-        }
-        gst_message_unref(msg);
-    }
-}
-
-void logBusMessagesWithWait(GstBus *bus, guint64 timeoutNanos) {
-    if (!bus) return;
-    const GstMessageType mask = static_cast<GstMessageType>(
-        GST_MESSAGE_ERROR | GST_MESSAGE_WARNING | GST_MESSAGE_INFO |
-        GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_STATE_CHANGED);
-
-    while (GstMessage *msg = gst_bus_timed_pop_filtered(bus, timeoutNanos, mask)) {
-        switch (GST_MESSAGE_TYPE(msg)) {
-            case GST_MESSAGE_ERROR: {
-                GError *err = nullptr;
-                gchar *dbg = nullptr;
-                gst_message_parse_error(msg, &err, &dbg);
-                const std::string line = std::string("bus error: ") +
-                                         (err ? err->message : "unknown") +
-                                         " (" + (dbg ? dbg : "no debug") + ")";
-                appendLastError(line);
-                if (err) g_error_free(err);
-                if (dbg) g_free(dbg);
-                break;
-            }
-            case GST_MESSAGE_WARNING: {
-                GError *err = nullptr;
-                gchar *dbg = nullptr;
-                gst_message_parse_warning(msg, &err, &dbg);
-                const std::string line = std::string("bus warning: ") +
-                                         (err ? err->message : "unknown") +
-                                         " (" + (dbg ? dbg : "no debug") + ")";
-                appendLastError(line);
-                if (err) g_error_free(err);
-                if (dbg) g_free(dbg);
-                break;
-            }
-            case GST_MESSAGE_INFO: {
-                GError *err = nullptr;
-                gchar *dbg = nullptr;
-                gst_message_parse_info(msg, &err, &dbg);
-                const std::string line = std::string("bus info: ") +
-                                         (err ? err->message : "unknown") +
-                                         " (" + (dbg ? dbg : "no debug") + ")";
-                __android_log_print(ANDROID_LOG_INFO, kTag, "%s", line.c_str());
-                if (err) g_error_free(err);
-                if (dbg) g_free(dbg);
-                break;
-            }
-            case GST_MESSAGE_ASYNC_DONE: {
-                __android_log_print(ANDROID_LOG_INFO, kTag, "bus async-done");
-                break;
-            }
-            case GST_MESSAGE_STATE_CHANGED: {
-                GstState oldState, newState, pending;
-                gst_message_parse_state_changed(msg, &oldState, &newState, &pending);
-                __android_log_print(ANDROID_LOG_INFO, kTag,
-                                    "bus state-changed: %s -> %s (pending %s)",
-                                    stateToStr(oldState), stateToStr(newState), stateToStr(pending));
-                break;
-            }
-            default:
-                break;
-        }
-        gst_message_unref(msg);
-    }
-}
-
-const char *stateChangeReturnToStr(GstStateChangeReturn ret) {
-    switch (ret) {
-        case GST_STATE_CHANGE_FAILURE: return "FAILURE";
-        case GST_STATE_CHANGE_SUCCESS: return "SUCCESS";
-        case GST_STATE_CHANGE_ASYNC: return "ASYNC";
-        case GST_STATE_CHANGE_NO_PREROLL: return "NO_PREROLL";
-        default: return "UNKNOWN";
-    }
-}
-
-void ensure_gst_init_unlocked() {
-    if (g_state.initialized) return;
-    int argc = 0;
-    char **argv = nullptr;
-    gst_init(&argc, &argv);
-
-    __android_log_print(ANDROID_LOG_INFO, kTag,
-                        "Compile flags: androidmedia=%s ahc=%s",
-                        kFlagAndroidMedia, kFlagAhc);
-
-    // Start a GLib main loop in the background. This is frequently required for Android
-    // camera sources (Camera1/Camera2) to post callbacks and state changes.
-    if (!g_state.main_loop_started) {
-        g_state.main_context = g_main_context_new();
-        g_state.main_loop = g_main_loop_new(g_state.main_context, FALSE);
-        GMainContext *ctx = g_state.main_context;
-        GMainLoop *loop = g_state.main_loop;
-        std::thread([ctx, loop]() {
-            g_main_context_push_thread_default(ctx);
-            g_main_loop_run(loop);
-            g_main_context_pop_thread_default(ctx);
-        }).detach();
-        g_state.main_loop_started = true;
-        logInfo("Started GLib main loop thread");
-    }
-
+// Runs once on the GstRuntime init thread, right after gst_init. Nothing is
+// logged here; `diagnose` reports availability and timings on demand.
+void register_static_plugins() {
 #ifdef GST_ANDROIDMEDIA_AVAILABLE
     // Initialize GStreamer Android JNI subsystem BEFORE registering androidmedia plugin.
     // This ensures gst_amc_jni_get_env() works during plugin registration and that
@@ -256,9 +119,8 @@ void ensure_gst_init_unlocked() {
     // NOTE: gst_amc_jni_set_java_vm() must have been called before this point (in init()).
     if (g_jni_vm_set) {
         gst_amc_jni_initialize();
-        __android_log_print(ANDROID_LOG_INFO, kTag, "gst_amc_jni_initialize called");
     } else {
-        __android_log_print(ANDROID_LOG_WARN, kTag, 
+        __android_log_print(ANDROID_LOG_WARN, kTag,
             "JavaVM not set - androidmedia plugin may not work. Call init() first!");
     }
 #endif
@@ -268,28 +130,10 @@ void ensure_gst_init_unlocked() {
     GST_PLUGIN_STATIC_REGISTER(app);           // app elements
     GST_PLUGIN_STATIC_REGISTER(videotestsrc);  // test patterns
 #ifdef GST_AUTODETECT_AVAILABLE
-    {
-        gst_plugin_autodetect_register();
-        GstPlugin *plugin = gst_registry_find_plugin(gst_registry_get(), "autodetect");
-        __android_log_print(ANDROID_LOG_INFO, kTag, "Static register autodetect: %s", plugin ? "ok" : "fail");
-        if (plugin) gst_object_unref(plugin);
-    }
+    gst_plugin_autodetect_register();
 #endif
 #ifdef GST_ANDROIDMEDIA_AVAILABLE
-    {
-        gst_plugin_androidmedia_register();
-        GstPlugin *plugin = gst_registry_find_plugin(gst_registry_get(), "androidmedia");
-        __android_log_print(ANDROID_LOG_INFO, kTag, "Static register androidmedia: %s", plugin ? "ok" : "fail");
-        if (plugin) gst_object_unref(plugin);
-        
-        // Check if camera elements are now available
-        GstElementFactory *ahcsrc_factory = gst_element_factory_find("ahcsrc");
-        GstElementFactory *ahc2src_factory = gst_element_factory_find("ahc2src");
-        __android_log_print(ANDROID_LOG_INFO, kTag, "Camera elements: ahcsrc=%s ahc2src=%s",
-                            ahcsrc_factory ? "yes" : "no", ahc2src_factory ? "yes" : "no");
-        if (ahcsrc_factory) gst_object_unref(ahcsrc_factory);
-        if (ahc2src_factory) gst_object_unref(ahc2src_factory);
-    }
+    gst_plugin_androidmedia_register();
 #endif
 #ifdef GST_VIDEOCONVERT_AVAILABLE
     // Video format conversion + scaling (combined plugin in many Android SDK builds).
@@ -300,39 +144,12 @@ void ensure_gst_init_unlocked() {
     GST_PLUGIN_STATIC_REGISTER(ndk);           // Android Camera2 NDK (alternate plugin name)
 #endif
     GST_PLUGIN_STATIC_REGISTER(opengl);        // glimagesink, etc
-    
-    // Log available elements for debugging
-    GstRegistry *registry = gst_registry_get();
-    GList *plugins = gst_registry_get_plugin_list(registry);
-    __android_log_print(ANDROID_LOG_INFO, kTag, "Registered %d GStreamer plugins", g_list_length(plugins));
-    
-    // Log plugin details for troubleshooting
-    for (GList *item = plugins; item != nullptr; item = item->next) {
-        GstPlugin *plugin = GST_PLUGIN(item->data);
-        const char *name = gst_plugin_get_name(plugin);
-        const char *version = gst_plugin_get_version(plugin);
-        __android_log_print(ANDROID_LOG_INFO, kTag, "  Plugin: %s (v%s)", name, version);
-    }
-    
-    g_list_free(plugins);
-    
-    g_state.initialized = true;
-    logInfo("GStreamer initialized");
-}
-
-bool has_element_factory(const char *name) {
-    if (!name) return false;
-    GstElementFactory *factory = gst_element_factory_find(name);
-    if (!factory) return false;
-    gst_object_unref(factory);
-    return true;
 }
 
-std::string diagnose_gstreamer_unlocked() {
-    std::string out;
-    out += "plugins:";
-
-    const char *pluginNames[] = {
+core::GstRuntimeOptions gst_runtime_options() {
+    core::GstRuntimeOptions options;
+    options.register_plugins = register_static_plugins;
+    options.probe_plugins = {
         "coreelements",
         "app",
         "videotestsrc",
@@ -343,17 +160,7 @@ std::string diagnose_gstreamer_unlocked() {
         "ahc",
         "ndk",
     };
-    for (const char *p : pluginNames) {
-        GstPlugin *plugin = gst_registry_find_plugin(gst_registry_get(), p);
-        out += "\n- ";
-        out += p;
-        out += ": ";
-        out += (plugin ? "yes" : "no");
-        if (plugin) gst_object_unref(plugin);
-    }
-
-    out += "\n\nelements:";
-    const char *elementNames[] = {
+    options.probe_elements = {
         "ahc2src",
         "ahcsrc",
         "androidvideosource",
@@ -366,59 +173,25 @@ std::string diagnose_gstreamer_unlocked() {
         "glcolorconvert",
         "appsink",
     };
-    for (const char *e : elementNames) {
-        out += "\n- ";
-        out += e;
-        out += ": ";
-        out += (has_element_factory(e) ? "yes" : "no");
-    }
-
-    return out;
-}
-
-bool ensure_first_element_exists_unlocked(const std::string &pipelineDesc) {
-    // We only inspect the first element name (up to first whitespace or '!'),
-    // which matches how the app builds pipelines.
-    std::string first = pipelineDesc;
-    const size_t bang = first.find('!');
-    if (bang != std::string::npos) first = first.substr(0, bang);
-
-    const size_t start = first.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) {
-        setLastError("Pipeline string has no elements");
-        return false;
-    }
-    first = first.substr(start);
-
-    const size_t end = first.find_last_not_of(" \t\n\r");
-    if (end != std::string::npos) first = first.substr(0, end + 1);
-
-    const size_t ws = first.find_first_of(" \t\n\r");
-    const std::string factoryName = (ws == std::string::npos) ? first : first.substr(0, ws);
-
-    GstElementFactory *factory = gst_element_factory_find(factoryName.c_str());
-    if (!factory) {
-        setLastError(std::string("Missing GStreamer element: ") + factoryName);
-        appendLastError("Diagnose:\n" + diagnose_gstreamer_unlocked());
-        return false;
-    }
-    gst_object_unref(factory);
-    return true;
+    return options;
 }
 
-void release_pipeline_unlocked() {
-    if (g_state.pipeline) {
-        gst_element_set_state(g_state.pipeline, GST_STATE_NULL);
-        gst_object_unref(g_state.pipeline);
-        g_state.pipeline = nullptr;
-    }
+// Kicks off the one-time initialization in the background (no-op once
+// started). Never blocks; callers that need GStreamer call WaitUntilReady()
+// without holding any lock.
+core::GstRuntime &gst_runtime() {
+    core::GstRuntime &runtime = core::GstRuntime::Get();
+    if (!runtime.ready()) runtime.StartAsync(gst_runtime_options());
+    return runtime;
 }
 
-void release_window_unlocked() {
-    if (g_state.window) {
-        ANativeWindow_release(g_state.window);
-        g_state.window = nullptr;
+std::string diagnose_gstreamer() {
+    std::string report = std::string("compile flags: androidmedia=") + kFlagAndroidMedia +
+                         " ahc=" + kFlagAhc + "\n\n" + gst_runtime().Diagnose();
+    if (std::shared_ptr<core::StreamingThreadPool> pool = core::StreamingThreadPool::Default()) {
+        report += "\n\n" + pool->Describe();
     }
+    return report;
 }
 
 bool bind_overlay(GstElement *pipeline, ANativeWindow *window) {
@@ -486,36 +259,6 @@ bool bind_overlay(GstElement *pipeline, ANativeWindow *window) {
     return false;
 }
 
-GstStateChangeReturn wait_for_state(GstElement *element, GstState target, GstClockTime timeout) {
-    GstStateChangeReturn ret = GST_STATE_CHANGE_ASYNC;
-    guint64 timeoutMs = timeout / 1000000;  // Convert nanoseconds to milliseconds
-    guint64 maxWait = 15000;  // 15 seconds maximum
-    if (timeoutMs > maxWait) timeoutMs = maxWait;
-    
-    // Use polling instead of blocking wait
-    guint64 startMs = g_get_monotonic_time() / 1000;
-    guint64 pollIntervalMs = 100;  // Poll every 100ms
-    
-    while (ret == GST_STATE_CHANGE_ASYNC) {
-        GstState current, pending;
-        ret = gst_element_get_state(element, &current, &pending, 0);  // Non-blocking query
-        
-        if (current == target) {
-            return GST_STATE_CHANGE_SUCCESS;
-        }
-        
-        guint64 elapsedMs = (g_get_monotonic_time() / 1000) - startMs;
-        if (elapsedMs >= timeoutMs) {
-            break;  // Timeout reached
-        }
-        
-        // Small sleep to avoid busy-waiting
-        g_usleep(pollIntervalMs * 1000);
-    }
-    
-    return ret;
-}
-
 GstElement *find_factory(GstElement *pipeline, const char *factoryName) {
     GstElement *found = nullptr;
     GstIterator *it = gst_bin_iterate_elements(GST_BIN(pipeline));
@@ -539,7 +282,7 @@ Java_com_example_kataglyphis_1native_1inference_GStreamerNative_init(
         JNIEnv *env,
         jclass /*clazz*/,
         jobject context) {
-    std::lock_guard<std::mutex> lock(g_mutex);
+    std::lock_guard<std::mutex> lock(g_init_mutex);
 
 #ifdef GST_ANDROIDMEDIA_AVAILABLE
     // Ensure GStreamer Android JNI helpers can attach threads and access Java APIs.
@@ -559,228 +302,304 @@ Java_com_example_kataglyphis_1native_1inference_GStreamerNative_init(
 #endif
 
     (void)context;
-    ensure_gst_init_unlocked();
+    // Returns immediately; plugin registration continues in the background.
+    gst_runtime();
 }
 
-extern "C" JNIEXPORT jboolean JNICALL
-Java_com_example_kataglyphis_1native_1inference_GStreamerNative_create(
+// Checks for a video sink and binds `window` to an overlay sink if there is
+// one. Runs on the session's worker thread before any state change.
+bool prepare_android_pipeline(GstElement *pipeline, ANativeWindow *window, std::string *error) {
+    // Check if we have either a video overlay sink (glimagesink) or an app sink (appsink)
+    // For Flutter textures with appsink, we don't need to bind a window overlay
+    GstElement *overlay = nullptr;
+    GstIterator *it = gst_bin_iterate_elements(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    bool hasVideoSink = false;
+
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        // Check for both overlay sinks (glimagesink) and app sinks
+        if (GST_IS_VIDEO_OVERLAY(element) || GST_IS_APP_SINK(element)) {
+            hasVideoSink = true;
+            if (overlay == nullptr && GST_IS_VIDEO_OVERLAY(element)) {
+                overlay = element;
+            }
+        }
+        g_value_reset(&item);
+    }
+    gst_iterator_free(it);
+
+    if (!hasVideoSink) {
+        *error = "No video sink (glimagesink or appsink) found in pipeline";
+        return false;
+    }
+
+    // Only bind overlay if we found a video overlay sink
+    if (overlay && window && !bind_overlay(pipeline, window)) {
+        *error = "Failed to bind video overlay";
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<AndroidSession> find_session(jlong sessionId) {
+    return g_sessions.Find(static_cast<int64_t>(sessionId));
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_createSession(
         JNIEnv *env,
         jclass /*clazz*/,
-        jobject surface) {
-    std::lock_guard<std::mutex> lock(g_mutex);
+        jobject surface,
+        jint /*width*/,
+        jint /*height*/) {
     if (!surface) {
         setLastError("Surface is null");
-        return JNI_FALSE;
+        return 0;
     }
 
-    g_state.window = ANativeWindow_fromSurface(env, surface);
-    if (!g_state.window) {
+    ANativeWindow *window = ANativeWindow_fromSurface(env, surface);
+    if (!window) {
         setLastError("Failed to acquire ANativeWindow");
-        return JNI_FALSE;
+        return 0;
     }
-    return JNI_TRUE;
+
+    auto session = std::make_shared<AndroidSession>();
+    session->window = window;
+    return static_cast<jlong>(g_sessions.Add(std::move(session)));
 }
 
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_example_kataglyphis_1native_1inference_GStreamerNative_getLastError(
         JNIEnv *env,
-        jclass /*clazz*/) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    return env->NewStringUTF(g_last_error.c_str());
+        jclass /*clazz*/,
+        jlong sessionId) {
+    if (std::shared_ptr<AndroidSession> session = find_session(sessionId)) {
+        return env->NewStringUTF(session->pipeline.last_error().c_str());
+    }
+    const std::vector<core::DiagnosticRecord> last = g_diagnostics.Recent(1);
+    return env->NewStringUTF(last.empty() ? "" : core::FormatDiagnostic(last.back()).c_str());
+}
+
+// The newest `maxRecords` diagnostics of a session (id 0: session-less
+// ones), oldest first, one formatted line each. Records are kept as fixed
+// structs and only formatted here, on request.
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_getDiagnostics(
+        JNIEnv *env,
+        jclass /*clazz*/,
+        jlong sessionId,
+        jint maxRecords) {
+    const size_t max_records = maxRecords > 0 ? static_cast<size_t>(maxRecords) : 0;
+    std::vector<core::DiagnosticRecord> records;
+    if (std::shared_ptr<AndroidSession> session = find_session(sessionId)) {
+        records = session->pipeline.diagnostics().Recent(max_records);
+    } else {
+        records = g_diagnostics.Recent(max_records);
+    }
+
+    jclass string_class = env->FindClass("java/lang/String");
+    jobjectArray lines =
+        env->NewObjectArray(static_cast<jsize>(records.size()), string_class, nullptr);
+    for (size_t i = 0; i < records.size(); ++i) {
+        jstring line = env->NewStringUTF(core::FormatDiagnostic(records[i]).c_str());
+        env->SetObjectArrayElement(lines, static_cast<jsize>(i), line);
+        env->DeleteLocalRef(line);
+    }
+    env->DeleteLocalRef(string_class);
+    return lines;
 }
 
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_example_kataglyphis_1native_1inference_GStreamerNative_diagnose(
         JNIEnv *env,
         jclass /*clazz*/) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    ensure_gst_init_unlocked();
-    const std::string report = diagnose_gstreamer_unlocked();
+    // The full report is only logged when asked for.
+    const std::string report = diagnose_gstreamer();
+    __android_log_print(ANDROID_LOG_INFO, kTag, "%s", report.c_str());
     return env->NewStringUTF(report.c_str());
 }
 
+// Runs the streaming threads of pipelines set from now on on named threads
+// pinned to `cpus` ("4-7"; empty: no pinning) with nice `nice` if `setNice`.
+// A null `cpus` and !setNice go back to GStreamer's default pool.
 extern "C" JNIEXPORT jboolean JNICALL
-Java_com_example_kataglyphis_1native_1inference_GStreamerNative_setPipeline(
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_configureStreamingThreads(
         JNIEnv *env,
         jclass /*clazz*/,
-        jstring pipelineStr) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    ensure_gst_init_unlocked();
-    g_last_error.clear();
-
-    if (!g_state.window) {
-        setLastError("Window not created before setPipeline");
-        return JNI_FALSE;
-    }
-
-    const char *cStr = env->GetStringUTFChars(pipelineStr, nullptr);
-    std::string pipelineDesc(cStr ? cStr : "");
-    if (cStr) env->ReleaseStringUTFChars(pipelineStr, cStr);
-
-    if (pipelineDesc.empty()) {
-        setLastError("Pipeline string is empty");
-        return JNI_FALSE;
-    }
-
-    // Fast-fail for missing source elements to avoid 20s ASYNC waits.
-    if (!ensure_first_element_exists_unlocked(pipelineDesc)) return JNI_FALSE;
-
-    release_pipeline_unlocked();
-
-    GError *err = nullptr;
-    GstElement *pipeline = gst_parse_launch(pipelineDesc.c_str(), &err);
-    if (!pipeline) {
-        setLastError("gst_parse_launch returned null");
-        if (err) {
-            __android_log_print(ANDROID_LOG_ERROR, kTag, "parse error: %s", err->message);
-            setLastError(std::string("parse error: ") + err->message);
-            g_error_free(err);
-        }
-        return JNI_FALSE;
-    }
-
-    // Check if we have either a video overlay sink (glimagesink) or an app sink (appsink)
-    // For Flutter textures with appsink, we don't need to bind a window overlay
-    GstElement *overlay = nullptr;
-    GstIterator *it = gst_bin_iterate_elements(GST_BIN(pipeline));
-    GValue item = G_VALUE_INIT;
-    bool hasVideoSink = false;
-    
-    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
-        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
-        // Check for both overlay sinks (glimagesink) and app sinks
-        if (GST_IS_VIDEO_OVERLAY(element) || GST_IS_APP_SINK(element)) {
-            hasVideoSink = true;
-            if (overlay == nullptr && GST_IS_VIDEO_OVERLAY(element)) {
-                overlay = element;
-            }
+        jstring cpus,
+        jint nice,
+        jboolean setNice) {
+    if (!cpus && !setNice) {
+        core::StreamingThreadPool::SetDefaultOptions(std::nullopt);
+        return JNI_TRUE;
+    }
+
+    core::StreamingThreadOptions options;
+    if (cpus) {
+        const char *cStr = env->GetStringUTFChars(cpus, nullptr);
+        std::string error;
+        const bool parsed = core::ParseCpuList(cStr ? cStr : "", &options.cpus, &error);
+        if (cStr) env->ReleaseStringUTFChars(cpus, cStr);
+        if (!parsed) {
+            setLastError(error.c_str());
+            return JNI_FALSE;
         }
-        g_value_reset(&item);
     }
-    gst_iterator_free(it);
-    
-    if (!hasVideoSink) {
-        setLastError("No video sink (glimagesink or appsink) found in pipeline");
-        gst_object_unref(pipeline);
-        return JNI_FALSE;
-    }
-    
-    // Only bind overlay if we found a video overlay sink
-    if (overlay && g_state.window) {
-        if (!bind_overlay(pipeline, g_state.window)) {
-            setLastError("Failed to bind video overlay");
-            gst_object_unref(pipeline);
+    if (setNice) {
+        if (nice < -20 || nice > 19) {
+            setLastError("nice must be -20..19");
             return JNI_FALSE;
         }
+        options.nice = static_cast<int>(nice);
     }
+    core::StreamingThreadPool::SetDefaultOptions(std::move(options));
+    return JNI_TRUE;
+}
 
-    // Force READY first to avoid sticky pending states on reuse
-    gst_element_set_state(pipeline, GST_STATE_READY);
-
-    GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PAUSED);
-    __android_log_print(ANDROID_LOG_INFO, kTag, "setPipeline set_state(PAUSED): %s",
-                        stateChangeReturnToStr(ret));
-    if (ret == GST_STATE_CHANGE_FAILURE) {
-        setLastError("Failed to preroll pipeline");
+// Adds leaky queues at stage boundaries and `converterThreads` n-threads to
+// converters (0: DefaultConverterThreads()). Returns the rewritten pipeline
+// followed by one line per change, or null if it does not validate (see
+// getLastError(0)).
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_rewritePipeline(
+        JNIEnv *env,
+        jclass /*clazz*/,
+        jstring pipelineStr,
+        jint converterThreads) {
+    const char *cStr = env->GetStringUTFChars(pipelineStr, nullptr);
+    std::string pipelineDesc(cStr ? cStr : "");
+    if (cStr) env->ReleaseStringUTFChars(pipelineStr, cStr);
 
-        // Capture detailed element errors (e.g. camera open failures) from the bus.
-        GstBus *bus = gst_element_get_bus(pipeline);
-        logBusMessagesWithWait(bus, 500000000);  // 500ms
-        if (bus) gst_object_unref(bus);
+    core::GstRuntime &runtime = gst_runtime();
+    core::PipelineRewriteOptions options;
+    options.converter_threads = converterThreads > 0
+                                        ? static_cast<uint32_t>(converterThreads)
+                                        : core::DefaultConverterThreads();
+    options.has_property = [&runtime](const std::string &factory,
+                                      const std::string &property) {
+        return runtime.HasElementProperty(factory, property);
+    };
+    const core::PipelineRewrite rewrite =
+            core::RewritePipeline(pipelineDesc, runtime.element_index(), options);
+    if (!rewrite.ok) {
+        setLastError(rewrite.error.c_str());
+        return nullptr;
+    }
+
+    jclass string_class = env->FindClass("java/lang/String");
+    jobjectArray lines = env->NewObjectArray(
+            static_cast<jsize>(rewrite.changes.size() + 1), string_class, nullptr);
+    jstring rewritten = env->NewStringUTF(rewrite.description.c_str());
+    env->SetObjectArrayElement(lines, 0, rewritten);
+    env->DeleteLocalRef(rewritten);
+    for (size_t i = 0; i < rewrite.changes.size(); ++i) {
+        g_diagnostics.Record(core::DiagnosticSeverity::kInfo, "rewriter", 0,
+                             rewrite.changes[i]);
+        jstring line = env->NewStringUTF(rewrite.changes[i].c_str());
+        env->SetObjectArrayElement(lines, static_cast<jsize>(i + 1), line);
+        env->DeleteLocalRef(line);
+    }
+    env->DeleteLocalRef(string_class);
+    return lines;
+}
 
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_setPipeline(
+        JNIEnv *env,
+        jclass /*clazz*/,
+        jlong sessionId,
+        jstring pipelineStr) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) {
+        setLastError("Unknown session; call createSession first");
         return JNI_FALSE;
     }
 
-    if (ret == GST_STATE_CHANGE_ASYNC) {
-        // Increased timeout to 20s for slower devices and caps negotiation
-        GstStateChangeReturn waitRet = wait_for_state(pipeline, GST_STATE_PAUSED, GST_SECOND * 20);
-        __android_log_print(ANDROID_LOG_INFO, kTag, "setPipeline wait_for_state(PAUSED): %s",
-                            stateChangeReturnToStr(waitRet));
-        ret = waitRet;
-        
-        if (ret == GST_STATE_CHANGE_ASYNC) {
-            setLastError("Pipeline still ASYNC after 20s - caps negotiation failed or source unavailable");
-
-            // Try to get more detailed error info from bus
-            GstBus *bus = gst_element_get_bus(pipeline);
-            logBusMessagesWithWait(bus, 100000000);  // 100ms
-            if (bus) gst_object_unref(bus);
-
-            appendLastError("Diagnose:\n" + diagnose_gstreamer_unlocked());
-        }
-    }
-
-    // Only accept SUCCESS or NO_PREROLL as valid results
-    if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
-        if (g_last_error.empty()) {
-            setLastError("Pipeline failed to reach PAUSED state");
-        } else {
-            appendLastError("Pipeline failed to reach PAUSED state");
-        }
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
-        return JNI_FALSE;
-    }
+    const char *cStr = env->GetStringUTFChars(pipelineStr, nullptr);
+    std::string pipelineDesc(cStr ? cStr : "");
+    if (cStr) env->ReleaseStringUTFChars(pipelineStr, cStr);
 
-    g_state.pipeline = pipeline;
-    return JNI_TRUE;
+    // Usually already done by the time the first pipeline is set.
+    gst_runtime().WaitUntilReady();
+
+    ANativeWindow *window = session->window;
+    const bool ok = session->pipeline.SetPipeline(
+        pipelineDesc,
+        [window](GstElement *pipeline, std::string *error) {
+            return prepare_android_pipeline(pipeline, window, error);
+        },
+        // Generous for slower devices and caps negotiation.
+        std::chrono::seconds(20));
+    if (!ok) {
+        __android_log_print(ANDROID_LOG_ERROR, kTag, "setPipeline(session %lld) failed: %s",
+                            static_cast<long long>(sessionId),
+                            session->pipeline.last_error().c_str());
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
 }
 
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_example_kataglyphis_1native_1inference_GStreamerNative_play(
         JNIEnv * /*env*/,
-        jclass /*clazz*/) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    if (!g_state.pipeline) return JNI_FALSE;
-    GstStateChangeReturn ret = gst_element_set_state(g_state.pipeline, GST_STATE_PLAYING);
-    __android_log_print(ANDROID_LOG_INFO, kTag, "play set_state(PLAYING): %s",
-                        stateChangeReturnToStr(ret));
-
-    if (ret == GST_STATE_CHANGE_ASYNC) {
-        GstStateChangeReturn waitRet = wait_for_state(g_state.pipeline, GST_STATE_PLAYING, GST_SECOND * 10);
-        __android_log_print(ANDROID_LOG_INFO, kTag, "play wait_for_state(PLAYING): %s",
-                            stateChangeReturnToStr(waitRet));
-        ret = waitRet;
-    }
+        jclass /*clazz*/,
+        jlong sessionId) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) return JNI_FALSE;
+    return session->pipeline.Play(std::chrono::seconds(10)) ? JNI_TRUE : JNI_FALSE;
+}
 
-    if (ret == GST_STATE_CHANGE_FAILURE) {
-        setLastError("Failed to set pipeline to PLAYING");
-        GstBus *bus = gst_element_get_bus(g_state.pipeline);
-        logBusMessagesWithWait(bus, 500000000);  // 500ms
-        if (bus) gst_object_unref(bus);
-    }
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_pause(
+        JNIEnv * /*env*/,
+        jclass /*clazz*/,
+        jlong sessionId) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) return JNI_FALSE;
+    return session->pipeline.Pause(std::chrono::seconds(10)) ? JNI_TRUE : JNI_FALSE;
+}
 
-    return ret != GST_STATE_CHANGE_FAILURE;
+// Frame-accurate; a paused pipeline prerolls the frame at the new position.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_seek(
+        JNIEnv * /*env*/,
+        jclass /*clazz*/,
+        jlong sessionId,
+        jlong positionNs) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) return JNI_FALSE;
+    return session->pipeline.Seek(positionNs, std::chrono::seconds(5)) ? JNI_TRUE : JNI_FALSE;
 }
 
+// Forward steps need a paused pipeline; backward steps seek.
 extern "C" JNIEXPORT jboolean JNICALL
-Java_com_example_kataglyphis_1native_1inference_GStreamerNative_pause(
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_stepFrame(
         JNIEnv * /*env*/,
-        jclass /*clazz*/) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    if (!g_state.pipeline) return JNI_FALSE;
-    GstStateChangeReturn ret = gst_element_set_state(g_state.pipeline, GST_STATE_PAUSED);
-    __android_log_print(ANDROID_LOG_INFO, kTag, "pause set_state(PAUSED): %s",
-                        stateChangeReturnToStr(ret));
-
-    if (ret == GST_STATE_CHANGE_ASYNC) {
-        GstStateChangeReturn waitRet = wait_for_state(g_state.pipeline, GST_STATE_PAUSED, GST_SECOND * 10);
-        __android_log_print(ANDROID_LOG_INFO, kTag, "pause wait_for_state(PAUSED): %s",
-                            stateChangeReturnToStr(waitRet));
-        ret = waitRet;
-    }
+        jclass /*clazz*/,
+        jlong sessionId,
+        jint frames) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) return JNI_FALSE;
+    return session->pipeline.StepFrames(frames, std::chrono::seconds(5)) ? JNI_TRUE : JNI_FALSE;
+}
 
-    return ret != GST_STATE_CHANGE_FAILURE;
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_kataglyphis_1native_1inference_GStreamerNative_getPosition(
+        JNIEnv * /*env*/,
+        jclass /*clazz*/,
+        jlong sessionId) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    return session ? session->pipeline.position_ns() : -1;
 }
 
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_example_kataglyphis_1native_1inference_GStreamerNative_stop(
         JNIEnv * /*env*/,
-        jclass /*clazz*/) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    release_pipeline_unlocked();
+        jclass /*clazz*/,
+        jlong sessionId) {
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) return JNI_FALSE;
+    session->pipeline.Stop();
     return JNI_TRUE;
 }
 
@@ -788,31 +607,37 @@ extern "C" JNIEXPORT jboolean JNICALL
 Java_com_example_kataglyphis_1native_1inference_GStreamerNative_setColor(
         JNIEnv * /*env*/,
         jclass /*clazz*/,
+        jlong sessionId,
         jint r,
         jint g,
         jint b) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    if (!g_state.pipeline) return JNI_FALSE;
-
-    GstElement *src = find_factory(g_state.pipeline, "videotestsrc");
-    if (!src) return JNI_FALSE;
+    std::shared_ptr<AndroidSession> session = find_session(sessionId);
+    if (!session) return JNI_FALSE;
 
     guint32 color = (0xFFu << 24) | ((static_cast<guint32>(r) & 0xFFu) << 16) |
                     ((static_cast<guint32>(g) & 0xFFu) << 8) |
                     (static_cast<guint32>(b) & 0xFFu);
-    g_object_set(src, "foreground-color", color, NULL);
-    gst_object_unref(src);
-    return JNI_TRUE;
+    bool found = false;
+    session->pipeline.WithPipeline([&](GstElement *pipeline) {
+        GstElement *src = find_factory(pipeline, "videotestsrc");
+        if (!src) return;
+        g_object_set(src, "foreground-color", color, NULL);
+        gst_object_unref(src);
+        found = true;
+    });
+    return found ? JNI_TRUE : JNI_FALSE;
 }
 
 extern "C" JNIEXPORT void JNICALL
 Java_com_example_kataglyphis_1native_1inference_GStreamerNative_dispose(
         JNIEnv * /*env*/,
-        jclass /*clazz*/) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    release_pipeline_unlocked();
-    release_window_unlocked();
-    g_state.initialized = true; // keep gst initialized to avoid re-init issues
+        jclass /*clazz*/,
+        jlong sessionId) {
+    // Stops the pipeline, joins the session's worker loop and releases the
+    // window once the last in-flight call on it returns. GStreamer itself
+    // stays initialized to avoid re-init issues.
+    std::shared_ptr<AndroidSession> session = g_sessions.Remove(static_cast<int64_t>(sessionId));
+    if (session) session->pipeline.Close();
 }
 
 } // namespace
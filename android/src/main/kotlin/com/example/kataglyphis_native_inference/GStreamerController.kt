@@ -4,14 +4,34 @@ import android.content.Context
 import android.util.Log
 import android.view.Surface
 import io.flutter.view.TextureRegistry
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
 
 internal class GStreamerController(
     private val context: Context,
     private val textureRegistry: TextureRegistry,
 ) {
 
-    private var textureEntry: TextureRegistry.SurfaceTextureEntry? = null
-    private var surface: Surface? = null
+    /**
+     * One Flutter texture and its native pipeline session. Commands for a session
+     * run in order on its own thread, so a slow camera open in one session never
+     * delays play/pause/stop in another.
+     */
+    private class Session(
+        val entry: TextureRegistry.SurfaceTextureEntry,
+        val surface: Surface,
+        val nativeId: Long,
+    ) {
+        val executor: ExecutorService = Executors.newSingleThreadExecutor { runnable ->
+            Thread(runnable, "kataglyphis-gst-session-${entry.id()}")
+        }
+    }
+
+    private val sessions = ConcurrentHashMap<Long, Session>()
+    @Volatile
+    private var lastTextureId: Long? = null
+    @Volatile
     private var nativeInitialized = false
 
     companion object {
@@ -20,61 +40,151 @@ internal class GStreamerController(
 
     fun createTexture(width: Int, height: Int): Long {
         ensureNativeReady()
-        releaseSurface()
 
         val entry = textureRegistry.createSurfaceTexture()
         entry.surfaceTexture().setDefaultBufferSize(width, height)
         val targetSurface = Surface(entry.surfaceTexture())
 
-        val created = GStreamerNative.create(targetSurface, width, height)
-        if (!created) {
+        val nativeId = GStreamerNative.createSession(targetSurface, width, height)
+        if (nativeId == 0L) {
             entry.release()
             targetSurface.release()
-            throw IllegalStateException("Native GStreamer create() returned false")
+            throw IllegalStateException(
+                "Native GStreamer createSession() failed: ${GStreamerNative.getLastError(0L)}",
+            )
         }
 
-        textureEntry = entry
-        surface = targetSurface
+        sessions[entry.id()] = Session(entry, targetSurface, nativeId)
+        lastTextureId = entry.id()
         return entry.id()
     }
 
-    fun setPipeline(pipeline: String) {
+    /**
+     * Runs [block] with the native session id of [textureId] (or the most
+     * recently created texture) on that session's thread and reports its value
+     * or failure through [callback] on the thread the executor runs on.
+     */
+    fun <T> submit(textureId: Long?, block: (Long) -> T, callback: (T?, Throwable?) -> Unit) {
+        val session = findSession(textureId)
+        if (session == null) {
+            callback(null, IllegalStateException("No texture session for id ${textureId ?: "<latest>"}"))
+            return
+        }
+        session.executor.execute {
+            val outcome = runCatching { block(session.nativeId) }
+            callback(outcome.getOrNull(), outcome.exceptionOrNull())
+        }
+    }
+
+    /**
+     * Sets [pipeline] on a session. With [autoThreads] it is first rewritten to
+     * add queues at stage boundaries and converter threads; the rewritten
+     * pipeline and the list of changes are returned.
+     */
+    fun setPipeline(nativeId: Long, pipeline: String, autoThreads: Boolean = false): Map<String, Any>? {
         ensureNativeReady()
-        val success = GStreamerNative.setPipeline(pipeline)
-        if (!success) throw IllegalStateException("setPipeline failed")
+        var effective = pipeline
+        var report: Map<String, Any>? = null
+        if (autoThreads) {
+            val rewrite = GStreamerNative.rewritePipeline(pipeline, 0)
+                ?: throw IllegalArgumentException(GStreamerNative.getLastError(0L))
+            effective = rewrite[0]
+            report = mapOf("pipeline" to effective, "changes" to rewrite.drop(1))
+        }
+        if (!GStreamerNative.setPipeline(nativeId, effective)) {
+            throw IllegalStateException(
+                listOf("setPipeline failed", GStreamerNative.getLastError(nativeId))
+                    .filter { it.isNotBlank() }
+                    .joinToString("\n"),
+            )
+        }
+        return report
     }
 
-    fun play() {
+    fun play(nativeId: Long) {
         ensureNativeReady()
-        if (!GStreamerNative.play()) throw IllegalStateException("play failed")
+        if (!GStreamerNative.play(nativeId)) {
+            throw IllegalStateException("play failed: ${GStreamerNative.getLastError(nativeId)}")
+        }
+    }
+
+    fun pause(nativeId: Long) {
+        ensureNativeReady()
+        if (!GStreamerNative.pause(nativeId)) throw IllegalStateException("pause failed")
+    }
+
+    /** Seeks to [positionNs] and returns the position now shown (-1 if unknown). */
+    fun seek(nativeId: Long, positionNs: Long): Long {
+        ensureNativeReady()
+        if (!GStreamerNative.seek(nativeId, positionNs)) {
+            throw IllegalStateException("seek failed: ${GStreamerNative.getLastError(nativeId)}")
+        }
+        return GStreamerNative.getPosition(nativeId)
     }
 
-    fun pause() {
+    /** Steps [frames] frames (negative: backward) and returns the position now shown. */
+    fun stepFrame(nativeId: Long, frames: Int): Long {
         ensureNativeReady()
-        if (!GStreamerNative.pause()) throw IllegalStateException("pause failed")
+        if (!GStreamerNative.stepFrame(nativeId, frames)) {
+            throw IllegalStateException("stepFrame failed: ${GStreamerNative.getLastError(nativeId)}")
+        }
+        return GStreamerNative.getPosition(nativeId)
     }
 
-    fun stop() {
+    fun stop(nativeId: Long) {
         if (!nativeInitialized) return
-        if (!GStreamerNative.stop()) throw IllegalStateException("stop failed")
+        if (!GStreamerNative.stop(nativeId)) throw IllegalStateException("stop failed")
     }
 
-    fun setColor(r: Int, g: Int, b: Int) {
+    fun setColor(nativeId: Long, r: Int, g: Int, b: Int) {
         ensureNativeReady()
-        if (!GStreamerNative.setColor(r, g, b)) throw IllegalStateException("setColor failed")
+        if (!GStreamerNative.setColor(nativeId, r, g, b)) throw IllegalStateException("setColor failed")
     }
 
-    fun dispose() {
-        runCatching {
-            if (nativeInitialized) {
-                GStreamerNative.stop()
-                GStreamerNative.dispose()
-            }
+    /**
+     * Recent diagnostics of [textureId] (or the latest texture). Falls back to
+     * the session-less ones, e.g. why creating a texture failed.
+     */
+    fun diagnostics(textureId: Long?, maxRecords: Int): List<String> {
+        ensureNativeReady()
+        val nativeId = findSession(textureId)?.nativeId ?: 0L
+        return GStreamerNative.getDiagnostics(nativeId, maxRecords).toList()
+    }
+
+    /**
+     * Pins the streaming threads of pipelines set from now on to [cpus] ("4-7")
+     * and/or gives them [nice]. Both null restores GStreamer's default threads.
+     */
+    fun configureStreamingThreads(cpus: String?, nice: Int?) {
+        ensureNativeReady()
+        if (!GStreamerNative.configureStreamingThreads(cpus, nice ?: 0, nice != null)) {
+            throw IllegalArgumentException(GStreamerNative.getLastError(0L))
         }
+    }
+
+    /** Stops and releases one texture session; unknown ids are ignored. */
+    fun disposeTexture(textureId: Long) {
+        val session = sessions.remove(textureId) ?: return
+        if (lastTextureId == textureId) lastTextureId = null
+        releaseSession(session)
+    }
+
+    fun dispose() {
+        sessions.keys.toList().forEach { disposeTexture(it) }
+        lastTextureId = null
         nativeInitialized = false
-        releaseSurface()
     }
 
+    /**
+     * Loads the native library and starts GStreamer initialization. Called on a
+     * background thread when the plugin attaches so the first `create`/`setPipeline`
+     * does not pay for it on the platform thread.
+     */
+    fun warmUp() {
+        ensureNativeReady()
+    }
+
+    @Synchronized
     private fun ensureNativeReady() {
         if (nativeInitialized) return
         GStreamerNative.ensureLoaded()
@@ -94,11 +204,21 @@ internal class GStreamerController(
         nativeInitialized = true
     }
 
-    private fun releaseSurface() {
-        surface?.release()
-        surface = null
-        textureEntry?.release()
-        textureEntry = null
+    private fun findSession(textureId: Long?): Session? {
+        val id = textureId ?: lastTextureId ?: return null
+        return sessions[id]
+    }
+
+    private fun releaseSession(session: Session) {
+        // Queued behind any pending command of this session; dispose() in native
+        // also interrupts a pipeline that is still prerolling.
+        session.executor.execute {
+            runCatching { GStreamerNative.dispose(session.nativeId) }
+                .onFailure { Log.w(TAG, "dispose failed", it) }
+            session.surface.release()
+            session.entry.release()
+        }
+        session.executor.shutdown()
     }
 }
 
@@ -111,13 +231,23 @@ internal object GStreamerNative {
     }
 
     external fun init(context: Context)
-    external fun create(surface: Surface, width: Int, height: Int): Boolean
-    external fun setPipeline(pipeline: String): Boolean
-    external fun getLastError(): String
+    /** Returns the native session id, or 0 on failure (see getLastError(0)). */
+    external fun createSession(surface: Surface, width: Int, height: Int): Long
+    external fun setPipeline(sessionId: Long, pipeline: String): Boolean
+    /** Rewritten pipeline followed by its changes, or null (see getLastError(0)). */
+    external fun rewritePipeline(pipeline: String, converterThreads: Int): Array<String>?
+    external fun getLastError(sessionId: Long): String
+    /** Newest [maxRecords] diagnostics of a session (0: session-less ones), oldest first. */
+    external fun getDiagnostics(sessionId: Long, maxRecords: Int): Array<String>
     external fun diagnose(): String
-    external fun play(): Boolean
-    external fun pause(): Boolean
-    external fun stop(): Boolean
-    external fun setColor(r: Int, g: Int, b: Int): Boolean
-    external fun dispose()
+    external fun configureStreamingThreads(cpus: String?, nice: Int, setNice: Boolean): Boolean
+    external fun play(sessionId: Long): Boolean
+    external fun pause(sessionId: Long): Boolean
+    external fun stop(sessionId: Long): Boolean
+    external fun seek(sessionId: Long, positionNs: Long): Boolean
+    external fun stepFrame(sessionId: Long, frames: Int): Boolean
+    /** Stream position in nanoseconds, -1 if unknown. */
+    external fun getPosition(sessionId: Long): Long
+    external fun setColor(sessionId: Long, r: Int, g: Int, b: Int): Boolean
+    external fun dispose(sessionId: Long)
 }
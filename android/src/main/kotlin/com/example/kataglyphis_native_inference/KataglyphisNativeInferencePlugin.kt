@@ -1,5 +1,7 @@
 package com.example.kataglyphis_native_inference
 
+import android.os.Handler
+import android.os.Looper
 import android.util.Log
 import io.flutter.embedding.engine.plugins.FlutterPlugin
 import io.flutter.plugin.common.MethodCall
@@ -15,13 +17,19 @@ class KataglyphisNativeInferencePlugin :
     private var channel: MethodChannel? = null
     private var pluginBinding: FlutterPlugin.FlutterPluginBinding? = null
     private var gstreamerController: GStreamerController? = null
+    private val mainHandler = Handler(Looper.getMainLooper())
 
     override fun onAttachedToEngine(flutterPluginBinding: FlutterPlugin.FlutterPluginBinding) {
         pluginBinding = flutterPluginBinding
-        gstreamerController = GStreamerController(
+        val controller = GStreamerController(
             context = flutterPluginBinding.applicationContext,
             textureRegistry = flutterPluginBinding.textureRegistry,
         )
+        gstreamerController = controller
+        Thread({
+            runCatching { controller.warmUp() }
+                .onFailure { Log.w("KataglyphisGStreamer", "GStreamer warm-up failed", it) }
+        }, "kataglyphis-gst-init").start()
 
         channel = MethodChannel(flutterPluginBinding.binaryMessenger, "kataglyphis_native_inference")
         channel?.setMethodCallHandler(this)
@@ -36,10 +44,15 @@ class KataglyphisNativeInferencePlugin :
             "create" -> handleCreate(call, result)
             "setPipeline" -> handleSetPipeline(call, result)
             "diagnose" -> handleDiagnose(result)
-            "play" -> handleNoArgCommand(result) { controller -> controller.play() }
-            "pause" -> handleNoArgCommand(result) { controller -> controller.pause() }
-            "stop" -> handleNoArgCommand(result) { controller -> controller.stop() }
+            "getDiagnostics" -> handleGetDiagnostics(call, result)
+            "configureStreamingThreads" -> handleConfigureStreamingThreads(call, result)
+            "play" -> handleSessionCommand(textureIdOf(call.arguments), result) { c, id -> c.play(id) }
+            "pause" -> handleSessionCommand(textureIdOf(call.arguments), result) { c, id -> c.pause(id) }
+            "stop" -> handleSessionCommand(textureIdOf(call.arguments), result) { c, id -> c.stop(id) }
+            "seek" -> handleSeek(call, result)
+            "stepFrame" -> handleStepFrame(call, result)
             "setColor" -> handleSetColor(call, result)
+            "disposeTexture" -> handleDisposeTexture(call, result)
             else -> result.notImplemented()
         }
     }
@@ -78,32 +91,57 @@ class KataglyphisNativeInferencePlugin :
     }
 
     private fun handleSetPipeline(call: MethodCall, result: Result) {
-        val pipeline = call.arguments as? String
+        // Either the bare pipeline string (latest texture) or
+        // {"pipeline": String, "textureId": Int, "autoThreads": Boolean}.
+        val args = call.arguments
+        val pipeline = when (args) {
+            is String -> args
+            is Map<*, *> -> args["pipeline"] as? String
+            else -> null
+        }
         if (pipeline.isNullOrBlank()) {
             result.error("bad_args", "Pipeline string must not be empty", null)
             return
         }
 
-        val controller = gstreamerController ?: run {
-            result.error("no_controller", "Plugin binding is unavailable", null)
+        val autoThreads = (args as? Map<*, *>)?.get("autoThreads") == true
+        handleSessionCall(textureIdOf(args), result) { controller, nativeId ->
+            runCatching { controller.setPipeline(nativeId, pipeline, autoThreads) }
+                .onFailure { Log.e("KataglyphisGStreamer", "setPipeline failed for: $pipeline", it) }
+                .getOrThrow()
+        }
+    }
+
+    private fun handleSeek(call: MethodCall, result: Result) {
+        // {"positionNs": Int, "textureId": Int?}; replies {"positionNs": Int}.
+        val args = call.arguments as? Map<*, *>
+        val positionNs = (args?.get("positionNs") as? Number)?.toLong()
+        if (positionNs == null) {
+            result.error("bad_args", "Expected {positionNs: int}", null)
             return
         }
+        handleSessionCall(textureIdOf(args), result) { controller, nativeId ->
+            mapOf("positionNs" to controller.seek(nativeId, positionNs))
+        }
+    }
 
-        runCatching { controller.setPipeline(pipeline) }
-            .onSuccess { result.success(null) }
-            .onFailure { throwable ->
-                Log.e("KataglyphisGStreamer", "setPipeline failed for: $pipeline", throwable)
-
-                val nativeDetails = runCatching { GStreamerNative.getLastError() }.getOrNull()
-                val details = listOfNotNull(throwable.message, nativeDetails)
-                    .joinToString("\n")
-                    .ifBlank { "setPipeline failed" }
-                result.error(
-                    "command_failed",
-                    details,
-                    null,
-                )
-            }
+    private fun handleStepFrame(call: MethodCall, result: Result) {
+        // {"frames": Int (default 1), "textureId": Int?}; replies {"positionNs": Int}.
+        val args = call.arguments as? Map<*, *>
+        val frames = (args?.get("frames") as? Number)?.toInt() ?: 1
+        handleSessionCall(textureIdOf(args), result) { controller, nativeId ->
+            mapOf("positionNs" to controller.stepFrame(nativeId, frames))
+        }
+    }
+
+    private fun handleDisposeTexture(call: MethodCall, result: Result) {
+        val textureId = textureIdOf(call.arguments)
+        if (textureId == null) {
+            result.error("bad_args", "Expected a textureId", null)
+            return
+        }
+        gstreamerController?.disposeTexture(textureId)
+        result.success(null)
     }
 
     private fun handleDiagnose(result: Result) {
@@ -117,7 +155,42 @@ class KataglyphisNativeInferencePlugin :
         }
     }
 
+    private fun handleGetDiagnostics(call: MethodCall, result: Result) {
+        // Optional {"textureId": Int, "maxRecords": Int}.
+        val args = call.arguments as? Map<*, *>
+        val maxRecords = (args?.get("maxRecords") as? Number)?.toInt() ?: 32
+        val controller = gstreamerController ?: run {
+            result.error("no_controller", "Plugin binding is unavailable", null)
+            return
+        }
+
+        runCatching { controller.diagnostics(textureIdOf(args), maxRecords) }
+            .onSuccess { result.success(it) }
+            .onFailure { throwable ->
+                Log.e("KataglyphisGStreamer", "getDiagnostics failed", throwable)
+                result.error("command_failed", throwable.message, null)
+            }
+    }
+
+    private fun handleConfigureStreamingThreads(call: MethodCall, result: Result) {
+        // {"cpus": "4-7", "nice": 5}; omit both to restore the defaults.
+        val args = call.arguments as? Map<*, *>
+        val cpus = args?.get("cpus") as? String
+        val nice = (args?.get("nice") as? Number)?.toInt()
+        val controller = gstreamerController ?: run {
+            result.error("no_controller", "Plugin binding is unavailable", null)
+            return
+        }
+
+        runCatching { controller.configureStreamingThreads(cpus, nice) }
+            .onSuccess { result.success(null) }
+            .onFailure { throwable ->
+                result.error("bad_args", throwable.message, null)
+            }
+    }
+
     private fun handleSetColor(call: MethodCall, result: Result) {
+        // [r, g, b] or [r, g, b, textureId].
         val args = call.arguments as? List<*>
         val r = args?.getOrNull(0) as? Number
         val g = args?.getOrNull(1) as? Number
@@ -127,22 +200,54 @@ class KataglyphisNativeInferencePlugin :
             return
         }
 
-        handleNoArgCommand(result) { controller ->
-            controller.setColor(r.toInt(), g.toInt(), b.toInt())
+        val textureId = (args.getOrNull(3) as? Number)?.toLong()
+        handleSessionCommand(textureId, result) { controller, nativeId ->
+            controller.setColor(nativeId, r.toInt(), g.toInt(), b.toInt())
         }
     }
 
-    private inline fun handleNoArgCommand(result: Result, crossinline block: (GStreamerController) -> Unit) {
+    /** `textureId` from an int argument or a map entry; null means the latest texture. */
+    private fun textureIdOf(args: Any?): Long? = when (args) {
+        is Number -> args.toLong()
+        is Map<*, *> -> (args["textureId"] as? Number)?.toLong()
+        else -> null
+    }
+
+    /**
+     * Runs [block] on the session thread of [textureId] and replies on the main
+     * thread, so the platform thread never waits for a pipeline state change.
+     */
+    private fun handleSessionCommand(
+        textureId: Long?,
+        result: Result,
+        block: (GStreamerController, Long) -> Unit,
+    ) {
+        handleSessionCall(textureId, result) { controller, nativeId ->
+            block(controller, nativeId)
+            null
+        }
+    }
+
+    /** Like [handleSessionCommand], replying with the value [block] returns. */
+    private fun handleSessionCall(
+        textureId: Long?,
+        result: Result,
+        block: (GStreamerController, Long) -> Any?,
+    ) {
         val controller = gstreamerController ?: run {
             result.error("no_controller", "Plugin binding is unavailable", null)
             return
         }
 
-        runCatching { block(controller) }
-            .onSuccess { result.success(null) }
-            .onFailure { throwable ->
-                Log.e("KataglyphisGStreamer", "Command failed", throwable)
-                result.error("command_failed", throwable.message, null)
+        controller.submit(textureId, { nativeId -> block(controller, nativeId) }) { value, throwable ->
+            mainHandler.post {
+                if (throwable == null) {
+                    result.success(value)
+                } else {
+                    Log.e("KataglyphisGStreamer", "Command failed", throwable)
+                    result.error("command_failed", throwable.message, null)
+                }
             }
+        }
     }
 }
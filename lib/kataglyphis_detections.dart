@@ -0,0 +1,172 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+
+// Reader for the packed detection format of
+// src/include/kataglyphis_native_core/detection_packet.h. Keep both sides
+// in sync.
+const int _magic = 0x5444474B; // "KGDT"
+const int _version = 2;
+const int _minHeaderBytes = 48;
+const int _columns = 7;
+const int _flagPredicted = 1;
+
+// Version 1 packets have no flags and no track_id column.
+int _columnsOf(int version) => version == 1 ? 6 : _columns;
+
+/// The detections of one frame, read in place from the native packet.
+///
+/// Nothing is unpacked up front: the accessors read straight from the
+/// message bytes, so decoding a batch allocates only this wrapper. Boxes
+/// are in pixels of a [frameWidth] x [frameHeight] frame.
+class DetectionBatch {
+  DetectionBatch._(this._data, this._arrays, this.count, this._version);
+
+  /// Wraps a packet, or returns null if [data] is not a complete packet
+  /// of a known version.
+  static DetectionBatch? decode(ByteData data) {
+    if (data.lengthInBytes < _minHeaderBytes ||
+        data.getUint32(0, Endian.little) != _magic) {
+      return null;
+    }
+    final version = data.getUint16(4, Endian.little);
+    if (version != 1 && version != _version) {
+      return null;
+    }
+    final headerBytes = data.getUint16(6, Endian.little);
+    final count = data.getUint32(8, Endian.little);
+    if (headerBytes < _minHeaderBytes ||
+        data.lengthInBytes < headerBytes + _columnsOf(version) * 4 * count) {
+      return null;
+    }
+    return DetectionBatch._(data, headerBytes, count, version);
+  }
+
+  final ByteData _data;
+  final int _arrays;
+  final int _version;
+
+  /// Number of detections.
+  final int count;
+
+  /// Generation of the frame the boxes belong to; matches
+  /// [MappedFrame.generation] and [FrameStats.latestGeneration].
+  int get frameGeneration => _data.getUint64(16, Endian.little);
+
+  /// Producer timestamp of the frame, -1 if unknown.
+  int get timestampNs => _data.getInt64(24, Endian.little);
+  int get frameWidth => _data.getUint32(32, Endian.little);
+  int get frameHeight => _data.getUint32(36, Endian.little);
+
+  /// True if the boxes were extrapolated by the native tracker rather than
+  /// measured on this frame.
+  bool get isPredicted =>
+      _version != 1 && (_data.getUint32(12, Endian.little) & _flagPredicted) != 0;
+
+  double left(int i) => _float(0, i);
+  double top(int i) => _float(1, i);
+  double width(int i) => _float(2, i);
+  double height(int i) => _float(3, i);
+  double score(int i) => _float(4, i);
+
+  /// Class index of the detector, -1 if unknown.
+  int classId(int i) => _data.getInt32(_offset(5, i), Endian.little);
+
+  /// Id of the track following this object across frames, -1 while the
+  /// tracker is off.
+  int trackId(int i) =>
+      _version == 1 ? -1 : _data.getInt32(_offset(6, i), Endian.little);
+
+  double _float(int column, int i) =>
+      _data.getFloat32(_offset(column, i), Endian.little);
+
+  int _offset(int column, int i) {
+    RangeError.checkValidIndex(i, this, 'i', count);
+    return _arrays + (column * count + i) * 4;
+  }
+}
+
+/// One box for [encodeDetections], in frame pixels.
+class DetectionBox {
+  const DetectionBox({
+    required this.left,
+    required this.top,
+    required this.width,
+    required this.height,
+    this.score = 0,
+    this.classId = -1,
+  });
+
+  final double left;
+  final double top;
+  final double width;
+  final double height;
+  final double score;
+  final int classId;
+}
+
+/// Packs [boxes] found on the frame [frameGeneration] into the native
+/// packet format, e.g. for [KataglyphisFfi.submitDetections].
+Uint8List encodeDetections(
+  List<DetectionBox> boxes, {
+  required int frameGeneration,
+  int timestampNs = -1,
+  int frameWidth = 0,
+  int frameHeight = 0,
+}) {
+  final count = boxes.length;
+  final data = ByteData(_minHeaderBytes + _columns * 4 * count);
+  data.setUint32(0, _magic, Endian.little);
+  data.setUint16(4, _version, Endian.little);
+  data.setUint16(6, _minHeaderBytes, Endian.little);
+  data.setUint32(8, count, Endian.little);
+  data.setUint64(16, frameGeneration, Endian.little);
+  data.setInt64(24, timestampNs, Endian.little);
+  data.setUint32(32, frameWidth, Endian.little);
+  data.setUint32(36, frameHeight, Endian.little);
+  for (var i = 0; i < count; ++i) {
+    final box = boxes[i];
+    int offset(int column) => _minHeaderBytes + (column * count + i) * 4;
+    data.setFloat32(offset(0), box.left, Endian.little);
+    data.setFloat32(offset(1), box.top, Endian.little);
+    data.setFloat32(offset(2), box.width, Endian.little);
+    data.setFloat32(offset(3), box.height, Endian.little);
+    data.setFloat32(offset(4), box.score, Endian.little);
+    data.setInt32(offset(5), box.classId, Endian.little);
+    data.setInt32(offset(6), -1, Endian.little);
+  }
+  return data.buffer.asUint8List();
+}
+
+/// Detections of the texture's pipeline, one batch per frame that carried
+/// region-of-interest metadata (plus an empty batch when they stop).
+///
+/// Arrives on a binary message channel, so the platform side sends its
+/// packet bytes without any codec work; under load only the newest batch
+/// is delivered.
+class KataglyphisDetections {
+  KataglyphisDetections._();
+
+  static const BasicMessageChannel<ByteData?> _channel =
+      BasicMessageChannel<ByteData?>(
+          'kataglyphis_native_inference/detections', BinaryCodec());
+
+  static StreamController<DetectionBatch>? _controller;
+
+  /// Broadcast stream of decoded batches. Listening installs the channel
+  /// handler; it is removed again when the last listener cancels.
+  static Stream<DetectionBatch> get stream {
+    _controller ??= StreamController<DetectionBatch>.broadcast(
+      onListen: () => _channel.setMessageHandler(_onMessage),
+      onCancel: () => _channel.setMessageHandler(null),
+    );
+    return _controller!.stream;
+  }
+
+  static Future<ByteData?> _onMessage(ByteData? message) async {
+    final batch = message == null ? null : DetectionBatch.decode(message);
+    if (batch != null) _controller?.add(batch);
+    return null;
+  }
+}
@@ -0,0 +1,91 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+
+// Reader for the window format of
+// src/include/kataglyphis_native_core/stats_aggregator.h. Keep both sides
+// in sync.
+const int _magic = 0x5453474B; // "KGST"
+const int _version = 1;
+const int _bytes = 104;
+
+/// Distribution of one duration metric within a window.
+class DurationSummary {
+  DurationSummary._(ByteData data, int offset)
+      : count = data.getUint32(offset, Endian.little),
+        p50Ms = data.getFloat32(offset + 4, Endian.little),
+        p95Ms = data.getFloat32(offset + 8, Endian.little),
+        p99Ms = data.getFloat32(offset + 12, Endian.little),
+        maxMs = data.getFloat32(offset + 16, Endian.little);
+
+  /// Samples in the window; percentiles cover the newest few thousand.
+  final int count;
+  final double p50Ms;
+  final double p95Ms;
+  final double p99Ms;
+  final double maxMs;
+}
+
+/// Aggregated metrics of one texture over one window.
+class StatsWindow {
+  StatsWindow._(ByteData data)
+      : endNs = data.getInt64(8, Endian.little),
+        durationNs = data.getInt64(16, Endian.little),
+        frames = data.getUint32(24, Endian.little),
+        dropped = data.getUint32(28, Endian.little),
+        fps = data.getFloat32(32, Endian.little),
+        latency = DurationSummary._(data, 40),
+        copy = DurationSummary._(data, 60),
+        inference = DurationSummary._(data, 80);
+
+  /// Parses one window message, or returns null for anything else.
+  static StatsWindow? decode(ByteData data) {
+    if (data.lengthInBytes < _bytes ||
+        data.getUint32(0, Endian.little) != _magic ||
+        data.getUint16(4, Endian.little) != _version) {
+      return null;
+    }
+    return StatsWindow._(data);
+  }
+
+  /// Monotonic native clock at the end of the window.
+  final int endNs;
+  final int durationNs;
+
+  /// Frames that arrived from the pipeline.
+  final int frames;
+
+  /// Frames replaced before Flutter presented them.
+  final int dropped;
+  final double fps;
+
+  /// Frame arrival to presentation.
+  final DurationSummary latency;
+
+  /// Pixel copies for presentation; zero-copy frames have none.
+  final DurationSummary copy;
+
+  /// As reported through `KataglyphisFfi.reportInferenceTime`.
+  final DurationSummary inference;
+}
+
+/// Live texture metrics, summarized natively and pushed once per window.
+class KataglyphisStats {
+  KataglyphisStats._();
+
+  static const EventChannel _channel =
+      EventChannel('kataglyphis_native_inference/stats');
+
+  /// One [StatsWindow] every [window]. Nothing is measured while there is
+  /// no listener. The texture must exist before listening.
+  static Stream<StatsWindow> windows(
+      {Duration window = const Duration(seconds: 1)}) {
+    return _channel
+        .receiveBroadcastStream({'windowMs': window.inMilliseconds})
+        .map((event) => StatsWindow.decode(ByteData.sublistView(
+            event as Uint8List)))
+        .where((window) => window != null)
+        .cast<StatsWindow>();
+  }
+}
@@ -2,6 +2,10 @@ import 'dart:async';
 import 'package:flutter/services.dart';
 import 'kataglyphis_native_inference_platform_interface.dart';
 
+export 'kataglyphis_detections.dart';
+export 'kataglyphis_frame_stats.dart';
+export 'kataglyphis_native_inference_ffi.dart';
+
 class KataglyphisNativeInference {
   Future<String?> getPlatformVersion() {
     return KataglyphisNativeInferencePlatform.instance.getPlatformVersion();
@@ -0,0 +1,412 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+// Mirrors of the C ABI in src/include/kataglyphis_native_core/ffi_api.h.
+// Only append fields, together with the native side.
+
+final class _KntFrameStats extends Struct {
+  @Uint64()
+  external int framesPushed;
+  @Uint64()
+  external int framesPresented;
+  @Uint64()
+  external int framesDropped;
+  @Uint64()
+  external int latestGeneration;
+  @Uint64()
+  external int presentedGeneration;
+  @Double()
+  external double consumerFps;
+  @Uint32()
+  external int framePending;
+  @Uint32()
+  external int reserved;
+}
+
+final class _KntFrameView extends Struct {
+  external Pointer<Uint8> data;
+  @Uint64()
+  external int size;
+  @Uint64()
+  external int generation;
+  @Int64()
+  external int timestampNs;
+  @Uint32()
+  external int width;
+  @Uint32()
+  external int height;
+  @Uint32()
+  external int stride;
+  @Uint32()
+  external int reserved;
+  external Pointer<Void> handle;
+}
+
+final class _KntInferenceStats extends Struct {
+  @Uint64()
+  external int framesOffered;
+  @Uint64()
+  external int framesGated;
+  @Uint64()
+  external int framesReplaced;
+  @Uint64()
+  external int framesTaken;
+  @Float()
+  external double lastMeanDiff;
+  @Float()
+  external double lastChangedFraction;
+  @Uint64()
+  external int framesThrottled;
+  @Float()
+  external double effectiveFps;
+  @Float()
+  external double inferenceMs;
+  @Float()
+  external double latencyMs;
+  @Float()
+  external double admittedFps;
+}
+
+typedef _VersionNative = Int32 Function();
+typedef _Version = int Function();
+typedef _StatsNative = Int32 Function(Int64, Pointer<_KntFrameStats>);
+typedef _Stats = int Function(int, Pointer<_KntFrameStats>);
+typedef _AcquireNative = Int32 Function(Int64, Pointer<_KntFrameView>);
+typedef _Acquire = int Function(int, Pointer<_KntFrameView>);
+typedef _ReleaseNative = Void Function(Pointer<Void>);
+typedef _Release = void Function(Pointer<Void>);
+typedef _ResultNative = Int64 Function(
+    Int64, Pointer<Uint8>, Uint64, Pointer<Uint64>, Pointer<Uint64>);
+typedef _Result = int Function(
+    int, Pointer<Uint8>, int, Pointer<Uint64>, Pointer<Uint64>);
+typedef _InferenceStatsNative = Int32 Function(
+    Int64, Pointer<_KntInferenceStats>);
+typedef _InferenceStats = int Function(int, Pointer<_KntInferenceStats>);
+typedef _ReportNative = Int32 Function(Int64, Int64);
+typedef _Report = int Function(int, int);
+typedef _MapLevelNative = Int32 Function(
+    Pointer<Void>, Uint32, Pointer<_KntFrameView>);
+typedef _MapLevel = int Function(Pointer<Void>, int, Pointer<_KntFrameView>);
+typedef _SubmitNative = Int32 Function(Int64, Pointer<Uint8>, Uint64);
+typedef _Submit = int Function(int, Pointer<Uint8>, int);
+
+/// Presentation counters of one texture.
+class FrameStats {
+  const FrameStats({
+    required this.framesPushed,
+    required this.framesPresented,
+    required this.framesDropped,
+    required this.latestGeneration,
+    required this.presentedGeneration,
+    required this.consumerFps,
+    required this.framePending,
+  });
+
+  final int framesPushed;
+  final int framesPresented;
+  final int framesDropped;
+  final int latestGeneration;
+  final int presentedGeneration;
+  final double consumerFps;
+  final bool framePending;
+}
+
+/// What happened to the frames offered to inference
+/// ([KataglyphisFfi.acquireInferenceFrame]).
+class InferenceStats {
+  const InferenceStats({
+    required this.framesOffered,
+    required this.framesGated,
+    required this.framesReplaced,
+    required this.framesTaken,
+    required this.lastMeanDiff,
+    required this.lastChangedFraction,
+    required this.framesThrottled,
+    required this.effectiveFps,
+    required this.inferenceMs,
+    required this.latencyMs,
+    required this.admittedFps,
+  });
+
+  final int framesOffered;
+
+  /// Held back by the motion gate (`configureMotionGate`).
+  final int framesGated;
+
+  /// Let through, but replaced before they were taken.
+  final int framesReplaced;
+  final int framesTaken;
+
+  /// Motion of the last offered frame against the last one let through:
+  /// mean luma difference (0-255) and fraction of changed cells.
+  final double lastMeanDiff;
+  final double lastChangedFraction;
+
+  /// Skipped by the rate control (`configureInferenceRate`). Together with
+  /// [framesGated] and [framesReplaced], the frames inference never saw.
+  final int framesThrottled;
+
+  /// Smoothed over [KataglyphisFfi.reportInferenceTime]: completed
+  /// inferences per second, time per inference, and age of the analyzed
+  /// frame when its result was reported.
+  final double effectiveFps;
+  final double inferenceMs;
+  final double latencyMs;
+
+  /// Rate the rate control currently lets frames through at, 0 while off.
+  final double admittedFps;
+}
+
+/// The latest frame of a texture, mapped in place (tightly packed or
+/// strided RGBA8). The pixels stay valid until [release]; a finalizer
+/// releases forgotten frames, but holding one keeps a producer buffer
+/// checked out, so release promptly.
+class MappedFrame implements Finalizable {
+  MappedFrame._(
+    this._ffi,
+    this._handle,
+    this.data,
+    this.size,
+    this.generation,
+    this.timestampNs,
+    this.width,
+    this.height,
+    this.stride,
+  ) {
+    _ffi._frameFinalizer.attach(this, _handle, detach: this);
+  }
+
+  final KataglyphisFfi _ffi;
+  Pointer<Void> _handle;
+
+  final Pointer<Uint8> data;
+  final int size;
+  final int generation;
+
+  /// Producer timestamp, -1 if unknown.
+  final int timestampNs;
+  final int width;
+  final int height;
+  final int stride;
+
+  /// A view of the pixels; must not be used after [release].
+  Uint8List get bytes => data.asTypedList(size);
+
+  bool get isReleased => _handle == nullptr;
+
+  /// Pyramid level [level] of this frame (1/2^level of the size), built by
+  /// the producer after `configurePyramid`; null where there is none.
+  /// Release it independently of this frame.
+  MappedFrame? mapLevel(int level) {
+    if (_handle == nullptr) {
+      throw StateError('Frame already released');
+    }
+    if (_ffi._mapLevel(_handle, level, _ffi._viewOut) != 0) return null;
+    return _ffi._mapView();
+  }
+
+  void release() {
+    if (_handle == nullptr) return;
+    _ffi._frameFinalizer.detach(this);
+    _ffi._release(_handle);
+    _handle = nullptr;
+  }
+}
+
+/// The latest inference result of a texture as published by the native
+/// producer, with the generation of the frame it belongs to.
+class InferenceResult {
+  const InferenceResult(this.bytes, this.frameGeneration, this.version);
+
+  final Uint8List bytes;
+  final int frameGeneration;
+
+  /// Increases with every published result.
+  final int version;
+}
+
+/// Direct `dart:ffi` access to the plugin library for hot paths: plain
+/// function calls on the calling isolate, no codec and no thread hop.
+/// Control stays on the method channel.
+class KataglyphisFfi {
+  KataglyphisFfi._(DynamicLibrary library)
+      : _stats = library.lookupFunction<_StatsNative, _Stats>(
+            'knt_get_frame_stats'),
+        _acquire = library.lookupFunction<_AcquireNative, _Acquire>(
+            'knt_acquire_frame'),
+        _acquireInference = library.lookupFunction<_AcquireNative, _Acquire>(
+            'knt_acquire_inference_frame'),
+        _inferenceStats =
+            library.lookupFunction<_InferenceStatsNative, _InferenceStats>(
+                'knt_get_inference_stats'),
+        _release = library.lookupFunction<_ReleaseNative, _Release>(
+            'knt_release_frame'),
+        _mapLevel = library.lookupFunction<_MapLevelNative, _MapLevel>(
+            'knt_map_frame_level'),
+        _copyResult = library.lookupFunction<_ResultNative, _Result>(
+            'knt_copy_latest_result'),
+        _reportInference = library.lookupFunction<_ReportNative, _Report>(
+            'knt_report_inference_time'),
+        _submitDetections = library.lookupFunction<_SubmitNative, _Submit>(
+            'knt_submit_detections'),
+        _frameFinalizer = NativeFinalizer(
+            library.lookup<NativeFunction<_ReleaseNative>>('knt_release_frame')
+                .cast());
+
+  static const int _apiVersion = 6;
+  static KataglyphisFfi? _instance;
+  static bool _opened = false;
+
+  /// The binding, or null where the plugin library does not export the
+  /// expected ABI version.
+  static KataglyphisFfi? get instance {
+    if (_opened) return _instance;
+    _opened = true;
+    try {
+      final library = _openLibrary();
+      final version =
+          library.lookupFunction<_VersionNative, _Version>('knt_ffi_api_version');
+      if (version() == _apiVersion) {
+        _instance = KataglyphisFfi._(library);
+      }
+    } on Object {
+      _instance = null;
+    }
+    return _instance;
+  }
+
+  static DynamicLibrary _openLibrary() {
+    if (Platform.isLinux) {
+      return DynamicLibrary.open('libkataglyphis_native_inference_plugin.so');
+    }
+    if (Platform.isWindows) {
+      return DynamicLibrary.open('kataglyphis_native_inference_plugin.dll');
+    }
+    if (Platform.isAndroid) {
+      return DynamicLibrary.open('libkataglyphis_native_inference.so');
+    }
+    throw UnsupportedError('No native plugin library on this platform');
+  }
+
+  final _Stats _stats;
+  final _Acquire _acquire;
+  final _Acquire _acquireInference;
+  final _InferenceStats _inferenceStats;
+  final _Release _release;
+  final _MapLevel _mapLevel;
+  final _Result _copyResult;
+  final _Report _reportInference;
+  final _Submit _submitDetections;
+  final NativeFinalizer _frameFinalizer;
+
+  // Reused for every call; the binding lives as long as the isolate.
+  final Pointer<_KntFrameStats> _statsOut = calloc<_KntFrameStats>();
+  final Pointer<_KntFrameView> _viewOut = calloc<_KntFrameView>();
+  final Pointer<_KntInferenceStats> _inferenceStatsOut =
+      calloc<_KntInferenceStats>();
+  final Pointer<Uint64> _generationOut = calloc<Uint64>();
+  final Pointer<Uint64> _versionOut = calloc<Uint64>();
+  Pointer<Uint8> _resultBuffer = nullptr;
+  int _resultCapacity = 0;
+  Pointer<Uint8> _packetBuffer = nullptr;
+  int _packetCapacity = 0;
+
+  /// Null for unknown textures.
+  FrameStats? frameStats(int textureId) {
+    if (_stats(textureId, _statsOut) != 0) return null;
+    final stats = _statsOut.ref;
+    return FrameStats(
+      framesPushed: stats.framesPushed,
+      framesPresented: stats.framesPresented,
+      framesDropped: stats.framesDropped,
+      latestGeneration: stats.latestGeneration,
+      presentedGeneration: stats.presentedGeneration,
+      consumerFps: stats.consumerFps,
+      framePending: stats.framePending != 0,
+    );
+  }
+
+  /// Maps the latest frame without copying it; null if there is none yet.
+  MappedFrame? acquireFrame(int textureId) {
+    if (_acquire(textureId, _viewOut) != 0) return null;
+    return _mapView();
+  }
+
+  /// The next frame to run inference on, or null if no new frame passed
+  /// the motion gate since the last call. Each frame is returned once.
+  MappedFrame? acquireInferenceFrame(int textureId) {
+    if (_acquireInference(textureId, _viewOut) != 0) return null;
+    return _mapView();
+  }
+
+  /// Null for unknown textures and platforms without an inference feed.
+  InferenceStats? inferenceStats(int textureId) {
+    if (_inferenceStats(textureId, _inferenceStatsOut) != 0) return null;
+    final stats = _inferenceStatsOut.ref;
+    return InferenceStats(
+      framesOffered: stats.framesOffered,
+      framesGated: stats.framesGated,
+      framesReplaced: stats.framesReplaced,
+      framesTaken: stats.framesTaken,
+      lastMeanDiff: stats.lastMeanDiff,
+      lastChangedFraction: stats.lastChangedFraction,
+      framesThrottled: stats.framesThrottled,
+      effectiveFps: stats.effectiveFps,
+      inferenceMs: stats.inferenceMs,
+      latencyMs: stats.latencyMs,
+      admittedFps: stats.admittedFps,
+    );
+  }
+
+  MappedFrame _mapView() {
+    final view = _viewOut.ref;
+    return MappedFrame._(this, view.handle, view.data, view.size,
+        view.generation, view.timestampNs, view.width, view.height,
+        view.stride);
+  }
+
+  /// The latest result, or null if there is none or it is not newer than
+  /// [sinceVersion].
+  InferenceResult? latestResult(int textureId, {int sinceVersion = 0}) {
+    for (;;) {
+      final size = _copyResult(textureId, _resultBuffer, _resultCapacity,
+          _generationOut, _versionOut);
+      if (size < 0 || _versionOut.value <= sinceVersion) return null;
+      if (size <= _resultCapacity) {
+        return InferenceResult(
+          Uint8List.fromList(_resultBuffer.asTypedList(size)),
+          _generationOut.value,
+          _versionOut.value,
+        );
+      }
+      // Grown result; retry with room for it.
+      if (_resultBuffer != nullptr) calloc.free(_resultBuffer);
+      _resultCapacity = size * 2;
+      _resultBuffer = calloc<Uint8>(_resultCapacity);
+    }
+  }
+
+  /// Feeds the inference-time percentiles of `KataglyphisStats.windows`
+  /// and the rate control of [acquireInferenceFrame]. Report once per
+  /// analyzed frame, when its result is done; cheap enough for every frame.
+  void reportInferenceTime(int textureId, Duration duration) {
+    _reportInference(textureId, duration.inMicroseconds * 1000);
+  }
+
+  /// Publishes the detections of an inference run, packed with
+  /// `encodeDetections` for the analyzed frame. With `configureTracker`
+  /// enabled they become the tracker's next keyframe. False for malformed
+  /// packets and unknown textures.
+  bool submitDetections(int textureId, Uint8List packet) {
+    if (packet.length > _packetCapacity) {
+      if (_packetBuffer != nullptr) calloc.free(_packetBuffer);
+      _packetCapacity = packet.length * 2;
+      _packetBuffer = calloc<Uint8>(_packetCapacity);
+    }
+    _packetBuffer.asTypedList(packet.length).setAll(0, packet);
+    return _submitDetections(textureId, _packetBuffer, packet.length) == 0;
+  }
+}
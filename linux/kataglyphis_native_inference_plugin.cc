@@ -6,17 +6,32 @@ import kataglyphis.c_api;
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "kataglyphis_native_core/batch_processor.h"
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_rewriter.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+#include "kataglyphis_native_core/trace_recorder.h"
 #include "kataglyphis_native_inference_plugin_private.h"
 
 #define KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), kataglyphis_native_inference_plugin_get_type(), \
                               KataglyphisNativeInferencePlugin))
 
+struct BatchJob;
+
 struct _KataglyphisNativeInferencePlugin {
   GObject parent_instance;
   char** dart_entrypoint_arguments;
@@ -24,6 +39,12 @@ struct _KataglyphisNativeInferencePlugin {
   /* Channel to receive general method calls from Flutter. */
   FlMethodChannel* channel;
 
+  /* Binary channel streaming detection packets to Dart (see detection_packet.h). */
+  FlBasicMessageChannel* results_channel;
+
+  /* Event channel streaming one binary statistics window per period. */
+  FlEventChannel* stats_channel;
+
   /* Channel to receive texture requests from Flutter (optional, only when a view is present). */
   FlMethodChannel* texture_channel;
 
@@ -32,6 +53,9 @@ struct _KataglyphisNativeInferencePlugin {
 
   /* The FlView associated with the registrar (may be NULL). */
   FlView* view;
+
+  /* Offline batch run started by processFiles (may be NULL). */
+  BatchJob* batch;
 };
 
 G_DEFINE_TYPE(KataglyphisNativeInferencePlugin, kataglyphis_native_inference_plugin, g_object_get_type())
@@ -75,21 +99,58 @@ FlMethodResponse* get_platform_version(void);
 
 static FlMethodResponse* handle_set_pipeline(KataglyphisNativeInferencePlugin* self,
                                              FlMethodCall* method_call) {
+  kataglyphis_native_inference::core::ScopedTrace trace("handle_set_pipeline");
   if (!self->texture) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new(
         "Error", "No texture created. Call 'create' first.", nullptr));
   }
 
+  // Either the pipeline string, or {pipeline, autoThreads} to let the
+  // rewriter add queues and converter threads first.
   FlValue* args = fl_method_call_get_args(method_call);
-  if (!is_fl_type(args, FL_VALUE_TYPE_STRING)) {
+  FlValue* pipeline_val = args;
+  bool auto_threads = false;
+  if (is_fl_type(args, FL_VALUE_TYPE_MAP)) {
+    pipeline_val = fl_value_lookup_string(args, "pipeline");
+    FlValue* auto_val = fl_value_lookup_string(args, "autoThreads");
+    auto_threads = is_fl_type(auto_val, FL_VALUE_TYPE_BOOL) &&
+                   fl_value_get_bool(auto_val);
+  }
+  if (!is_fl_type(pipeline_val, FL_VALUE_TYPE_STRING)) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new(
         "Invalid args", "Expected pipeline string", nullptr));
   }
 
-  const gchar* pipeline_desc = fl_value_get_string(args);
+  std::string pipeline_desc = fl_value_get_string(pipeline_val);
+  g_autoptr(FlValue) result = nullptr;
+  if (auto_threads) {
+    namespace core = kataglyphis_native_inference::core;
+    core::GstRuntime& runtime = core::GstRuntime::Get();
+    core::PipelineRewriteOptions options;
+    options.converter_threads = core::DefaultConverterThreads();
+    options.has_property = [&runtime](const std::string& factory,
+                                      const std::string& property) {
+      return runtime.HasElementProperty(factory, property);
+    };
+    core::PipelineRewrite rewrite = core::RewritePipeline(
+        pipeline_desc, runtime.element_index(), options);
+    if (!rewrite.ok) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "Pipeline Error", rewrite.error.c_str(), nullptr));
+    }
+    pipeline_desc = std::move(rewrite.description);
+    result = fl_value_new_map();
+    fl_value_set_string_take(result, "pipeline",
+                             fl_value_new_string(pipeline_desc.c_str()));
+    FlValue* changes = fl_value_new_list();
+    for (const std::string& change : rewrite.changes) {
+      fl_value_append_take(changes, fl_value_new_string(change.c_str()));
+    }
+    fl_value_set_string_take(result, "changes", changes);
+  }
+
   GError* error = nullptr;
-  
-  if (!my_texture_set_pipeline(self->texture, pipeline_desc, &error)) {
+  if (!my_texture_set_pipeline(self->texture, pipeline_desc.c_str(), &error)) {
     g_autofree gchar* error_msg = g_strdup_printf(
         "Failed to set pipeline: %s", error ? error->message : "Unknown error");
     if (error) g_error_free(error);
@@ -97,7 +158,13 @@ static FlMethodResponse* handle_set_pipeline(KataglyphisNativeInferencePlugin* s
         "Pipeline Error", error_msg, nullptr));
   }
 
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* scrub_error_response(const char* code, GError* error) {
+  g_autofree gchar* error_msg = g_strdup(error ? error->message : "Unknown error");
+  if (error) g_error_free(error);
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(code, error_msg, nullptr));
 }
 
 static FlMethodResponse* handle_play(KataglyphisNativeInferencePlugin* self,
@@ -107,7 +174,11 @@ static FlMethodResponse* handle_play(KataglyphisNativeInferencePlugin* self,
         "Error", "No texture created", nullptr));
   }
 
-  my_texture_play(self->texture);
+  // Fails while a file is open for scrubbing.
+  GError* error = nullptr;
+  if (!my_texture_play(self->texture, &error)) {
+    return scrub_error_response("Play Error", error);
+  }
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
@@ -118,7 +189,11 @@ static FlMethodResponse* handle_pause(KataglyphisNativeInferencePlugin* self,
         "Error", "No texture created", nullptr));
   }
 
-  my_texture_pause(self->texture);
+  // Fails while a file is open for scrubbing.
+  GError* error = nullptr;
+  if (!my_texture_pause(self->texture, &error)) {
+    return scrub_error_response("Pause Error", error);
+  }
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
@@ -133,6 +208,159 @@ static FlMethodResponse* handle_stop(KataglyphisNativeInferencePlugin* self,
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+// Returns {positionNs} of the frame now shown.
+static FlMethodResponse* shown_position_response(gint64 shown_ns) {
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "positionNs", fl_value_new_int(shown_ns));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// {input, budgetMb?}: decodes a file for frame-accurate scrubbing instead
+// of running the texture's pipeline.
+static FlMethodResponse* handle_open_scrub(KataglyphisNativeInferencePlugin* self,
+                                           FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  if (!is_fl_type(args, FL_VALUE_TYPE_MAP)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {input: path or URI, budgetMb?: int}", nullptr));
+  }
+  FlValue* input_val = fl_value_lookup_string(args, "input");
+  if (!is_fl_type(input_val, FL_VALUE_TYPE_STRING)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {input: path or URI, budgetMb?: int}", nullptr));
+  }
+  FlValue* budget_val = fl_value_lookup_string(args, "budgetMb");
+  guint64 budget_bytes = 0;  // default budget
+  if (is_fl_type(budget_val, FL_VALUE_TYPE_INT) && fl_value_get_int(budget_val) > 0) {
+    budget_bytes = static_cast<guint64>(fl_value_get_int(budget_val)) << 20;
+  }
+
+  GError* error = nullptr;
+  if (!my_texture_open_scrub(self->texture, fl_value_get_string(input_val),
+                             budget_bytes, &error)) {
+    return scrub_error_response("Scrub Error", error);
+  }
+  return shown_position_response(0);
+}
+
+static FlMethodResponse* handle_close_scrub(KataglyphisNativeInferencePlugin* self,
+                                            FlMethodCall* /*method_call*/) {
+  if (self->texture) my_texture_close_scrub(self->texture);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {positionNs}: frame-accurate seek of the scrubbed file, or of the
+// pipeline if none is open.
+static FlMethodResponse* handle_seek(KataglyphisNativeInferencePlugin* self,
+                                     FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* position_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                              ? fl_value_lookup_string(args, "positionNs")
+                              : nullptr;
+  if (!is_fl_type(position_val, FL_VALUE_TYPE_INT)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {positionNs: int}", nullptr));
+  }
+
+  GError* error = nullptr;
+  gint64 shown_ns = -1;
+  if (!my_texture_seek(self->texture, fl_value_get_int(position_val), &shown_ns, &error)) {
+    return scrub_error_response("Seek Error", error);
+  }
+  return shown_position_response(shown_ns);
+}
+
+// {frames}: steps forward (> 0) or backward (< 0) by whole frames.
+static FlMethodResponse* handle_step_frame(KataglyphisNativeInferencePlugin* self,
+                                           FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* frames_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                            ? fl_value_lookup_string(args, "frames")
+                            : nullptr;
+  const gint64 frames = is_fl_type(frames_val, FL_VALUE_TYPE_INT) ? fl_value_get_int(frames_val) : 1;
+  if (frames < std::numeric_limits<gint>::min() ||
+      frames > std::numeric_limits<gint>::max()) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "frames out of range", nullptr));
+  }
+
+  GError* error = nullptr;
+  gint64 shown_ns = -1;
+  if (!my_texture_step_frame(self->texture, static_cast<gint>(frames), &shown_ns, &error)) {
+    return scrub_error_response("Seek Error", error);
+  }
+  return shown_position_response(shown_ns);
+}
+
+// Main thread: forwards the newest detection packet as-is; FlBinaryCodec
+// sends the bytes without re-encoding.
+static void on_results_ready(GBytes* packet, gpointer user_data) {
+  KataglyphisNativeInferencePlugin* self =
+      KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(user_data);
+  if (!self->results_channel) {
+    return;
+  }
+  g_autoptr(FlValue) message = fl_value_new_uint8_list_from_bytes(packet);
+  fl_basic_message_channel_send(self->results_channel, message, nullptr,
+                                nullptr, nullptr);
+}
+
+// Main thread, once per window while Dart listens.
+static void on_stats_window(GBytes* window, gpointer user_data) {
+  KataglyphisNativeInferencePlugin* self =
+      KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(user_data);
+  g_autoptr(FlValue) event = fl_value_new_uint8_list_from_bytes(window);
+  fl_event_channel_send(self->stats_channel, event, nullptr, nullptr);
+}
+
+static constexpr gint64 kDefaultStatsWindowMs = 1000;
+static constexpr gint64 kMinStatsWindowMs = 50;
+
+// {windowMs?}: starts measuring; nothing is measured without a listener.
+static FlMethodErrorResponse* on_stats_listen(FlEventChannel* /*channel*/,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  KataglyphisNativeInferencePlugin* self =
+      KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(user_data);
+  if (!self->texture) {
+    return fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr);
+  }
+  FlValue* window_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                            ? fl_value_lookup_string(args, "windowMs")
+                            : nullptr;
+  gint64 window_ms = is_fl_type(window_val, FL_VALUE_TYPE_INT)
+                         ? fl_value_get_int(window_val)
+                         : kDefaultStatsWindowMs;
+  window_ms = std::max(window_ms, kMinStatsWindowMs);
+  my_texture_set_stats_listener(self->texture, clamp_to_u32(window_ms),
+                                on_stats_window, self);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* on_stats_cancel(FlEventChannel* /*channel*/,
+                                              FlValue* /*args*/,
+                                              gpointer user_data) {
+  KataglyphisNativeInferencePlugin* self =
+      KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(user_data);
+  if (self->texture) {
+    my_texture_set_stats_listener(self->texture, 0, nullptr, nullptr);
+  }
+  return nullptr;
+}
+
 // Handle request to create the texture.
 static FlMethodResponse* handle_create(KataglyphisNativeInferencePlugin* self,
                                        FlMethodCall* method_call) {
@@ -176,6 +404,8 @@ static FlMethodResponse* handle_create(KataglyphisNativeInferencePlugin* self,
     return FL_METHOD_RESPONSE(fl_method_error_response_new(
         "Error", "Failed to register texture", nullptr));
   }
+  my_texture_register_ffi(self->texture);
+  my_texture_set_results_listener(self->texture, on_results_ready, self);
 
   // Return the texture ID to Flutter so it can use this texture.
   g_autoptr(FlValue) id = fl_value_new_int(fl_texture_get_id(self->texture));
@@ -219,6 +449,798 @@ static FlMethodResponse* handle_set_color(KataglyphisNativeInferencePlugin* self
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+// One processFiles run. Results go to `output` as JSON lines, or to Dart
+// as "batchResults" calls of up to kBatchResultChunk entries; a final
+// "batchFinished" call reports the outcome.
+struct BatchJob {
+  std::unique_ptr<kataglyphis_native_inference::core::BatchProcessor> processor;
+  std::thread thread;
+  std::atomic<bool> finished{false};
+};
+
+static constexpr size_t kBatchResultChunk = 256;
+
+struct ChannelCall {
+  FlMethodChannel* channel;
+  gchar* method;
+  FlValue* args;
+};
+
+static gboolean invoke_channel_call_on_main(gpointer user_data) {
+  auto* call = static_cast<ChannelCall*>(user_data);
+  fl_method_channel_invoke_method(call->channel, call->method, call->args,
+                                  nullptr, nullptr, nullptr);
+  g_object_unref(call->channel);
+  g_free(call->method);
+  fl_value_unref(call->args);
+  delete call;
+  return G_SOURCE_REMOVE;
+}
+
+// Calls `method` on Dart from any thread. Takes ownership of `args`.
+static void invoke_on_main(FlMethodChannel* channel, const char* method,
+                           FlValue* args) {
+  g_main_context_invoke(
+      nullptr, invoke_channel_call_on_main,
+      new ChannelCall{FL_METHOD_CHANNEL(g_object_ref(channel)),
+                      g_strdup(method), args});
+}
+
+static FlValue* batch_result_to_fl(
+    const kataglyphis_native_inference::core::BatchResult& result) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "file",
+                           fl_value_new_int(static_cast<int64_t>(result.file_index)));
+  fl_value_set_string_take(map, "segment",
+                           fl_value_new_int(static_cast<int64_t>(result.segment_index)));
+  fl_value_set_string_take(map, "frame",
+                           fl_value_new_int(static_cast<int64_t>(result.frame_index)));
+  fl_value_set_string_take(map, "ptsNs", fl_value_new_int(result.timestamp_ns));
+  fl_value_set_string_take(map, "width", fl_value_new_int(result.width));
+  fl_value_set_string_take(map, "height", fl_value_new_int(result.height));
+  if (!result.payload.empty()) {
+    fl_value_set_string_take(map, "result",
+                             fl_value_new_string(result.payload.c_str()));
+  }
+  return map;
+}
+
+static FlValue* batch_progress_to_fl(
+    const kataglyphis_native_inference::core::BatchProgress& progress) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "segmentsDone",
+                           fl_value_new_int(static_cast<int64_t>(progress.segments_done)));
+  fl_value_set_string_take(map, "segmentsTotal",
+                           fl_value_new_int(static_cast<int64_t>(progress.segments_total)));
+  fl_value_set_string_take(map, "frames",
+                           fl_value_new_int(static_cast<int64_t>(progress.frames)));
+  fl_value_set_string_take(map, "seconds", fl_value_new_float(progress.elapsed_s));
+  fl_value_set_string_take(map, "fps",
+                           fl_value_new_float(progress.frames_per_second));
+  return map;
+}
+
+static void stop_batch(KataglyphisNativeInferencePlugin* self) {
+  if (!self->batch) return;
+  self->batch->processor->Cancel();
+  if (self->batch->thread.joinable()) self->batch->thread.join();
+  delete self->batch;
+  self->batch = nullptr;
+}
+
+// {files: [String], output?: String, workers?: int, width?: int,
+// height?: int}. Starts decoding every frame of `files` at full speed in
+// the background and returns immediately.
+static FlMethodResponse* handle_process_files(KataglyphisNativeInferencePlugin* self,
+                                              FlMethodCall* method_call) {
+  namespace core = kataglyphis_native_inference::core;
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* files_val =
+      is_fl_type(args, FL_VALUE_TYPE_MAP) ? fl_value_lookup_string(args, "files") : nullptr;
+  if (!is_fl_type(files_val, FL_VALUE_TYPE_LIST) || fl_value_get_length(files_val) == 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {files: [String], ...}", nullptr));
+  }
+  std::vector<std::string> files;
+  for (size_t i = 0; i < fl_value_get_length(files_val); ++i) {
+    FlValue* file = fl_value_get_list_value(files_val, i);
+    if (!is_fl_type(file, FL_VALUE_TYPE_STRING)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "Invalid args", "files must be strings", nullptr));
+    }
+    files.emplace_back(fl_value_get_string(file));
+  }
+
+  core::BatchOptions options;
+  options.task_pool = core::StreamingThreadPool::Default();
+  FlValue* workers_val = fl_value_lookup_string(args, "workers");
+  if (is_fl_type(workers_val, FL_VALUE_TYPE_INT)) {
+    options.workers = clamp_to_u32(fl_value_get_int(workers_val));
+  }
+  FlValue* width_val = fl_value_lookup_string(args, "width");
+  FlValue* height_val = fl_value_lookup_string(args, "height");
+  if (is_fl_type(width_val, FL_VALUE_TYPE_INT) && is_fl_type(height_val, FL_VALUE_TYPE_INT)) {
+    options.width = clamp_to_u32(fl_value_get_int(width_val));
+    options.height = clamp_to_u32(fl_value_get_int(height_val));
+  }
+  FlValue* output_val = fl_value_lookup_string(args, "output");
+  std::string output =
+      is_fl_type(output_val, FL_VALUE_TYPE_STRING) ? fl_value_get_string(output_val) : "";
+
+  if (!self->channel) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "Plugin channel is not registered", nullptr));
+  }
+  if (self->batch && !self->batch->finished.load()) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Busy", "A batch is already running; call cancelBatch first", nullptr));
+  }
+  stop_batch(self);
+
+  auto writer = std::make_shared<core::BatchResultWriter>();
+  std::string error;
+  if (!output.empty() && !writer->Open(output, files, &error)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Batch Error", error.c_str(), nullptr));
+  }
+
+  self->batch = new BatchJob();
+  self->batch->processor = std::make_unique<core::BatchProcessor>(options);
+  BatchJob* job = self->batch;
+  FlMethodChannel* channel = FL_METHOD_CHANNEL(g_object_ref(self->channel));
+  job->thread = std::thread([job, channel, writer, files = std::move(files),
+                             output = std::move(output)]() {
+    FlValue* pending = fl_value_new_list();
+    const auto flush = [&]() {
+      if (fl_value_get_length(pending) == 0) return;
+      invoke_on_main(channel, "batchResults", pending);
+      pending = fl_value_new_list();
+    };
+
+    std::string run_error;
+    // KataglyphisCppInference has no per-frame entry point yet, so results
+    // carry the decoded frame's position and size only.
+    const bool ok = job->processor->Run(
+        files, nullptr,
+        [&](const core::BatchResult& result) {
+          if (!output.empty()) {
+            writer->Write(result);
+            return;
+          }
+          fl_value_append_take(pending, batch_result_to_fl(result));
+          if (fl_value_get_length(pending) >= kBatchResultChunk) flush();
+        },
+        &run_error);
+    flush();
+    fl_value_unref(pending);
+    std::string close_error;
+    const bool closed = output.empty() || writer->Close(&close_error);
+
+    FlValue* summary = batch_progress_to_fl(job->processor->progress());
+    fl_value_set_string_take(summary, "ok", fl_value_new_bool(ok && closed));
+    const std::string& message = !ok ? run_error : close_error;
+    if (!message.empty()) {
+      fl_value_set_string_take(summary, "error", fl_value_new_string(message.c_str()));
+    }
+    if (!output.empty()) {
+      fl_value_set_string_take(summary, "output", fl_value_new_string(output.c_str()));
+    }
+    invoke_on_main(channel, "batchFinished", summary);
+    g_object_unref(channel);
+    job->finished.store(true);
+  });
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* handle_batch_progress(KataglyphisNativeInferencePlugin* self,
+                                               FlMethodCall* /*method_call*/) {
+  if (!self->batch) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  g_autoptr(FlValue) result = batch_progress_to_fl(self->batch->processor->progress());
+  fl_value_set_string_take(result, "running",
+                           fl_value_new_bool(!self->batch->finished.load()));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* handle_cancel_batch(KataglyphisNativeInferencePlugin* self,
+                                             FlMethodCall* /*method_call*/) {
+  // "batchFinished" still follows, with ok=false.
+  if (self->batch) self->batch->processor->Cancel();
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {seconds, maxMb?, encoded?, encoder?}: keeps the last `seconds` of the
+// texture's pipeline in memory for dumpHistory; seconds <= 0 turns it off.
+static FlMethodResponse* handle_configure_history(
+    KataglyphisNativeInferencePlugin* self, FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* seconds_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                             ? fl_value_lookup_string(args, "seconds")
+                             : nullptr;
+  gdouble seconds = 0;
+  if (is_fl_type(seconds_val, FL_VALUE_TYPE_FLOAT)) {
+    seconds = fl_value_get_float(seconds_val);
+  } else if (is_fl_type(seconds_val, FL_VALUE_TYPE_INT)) {
+    seconds = static_cast<gdouble>(fl_value_get_int(seconds_val));
+  } else {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args",
+        "Expected {seconds: num, maxMb?: int, encoded?: bool, encoder?: string}",
+        nullptr));
+  }
+  FlValue* max_mb_val = fl_value_lookup_string(args, "maxMb");
+  guint64 max_bytes = 0;  // default cap
+  if (is_fl_type(max_mb_val, FL_VALUE_TYPE_INT) && fl_value_get_int(max_mb_val) > 0) {
+    max_bytes = static_cast<guint64>(fl_value_get_int(max_mb_val)) << 20;
+  }
+  FlValue* encoded_val = fl_value_lookup_string(args, "encoded");
+  FlValue* encoder_val = fl_value_lookup_string(args, "encoder");
+
+  // Encoded mode splices its branch in at the next setPipeline.
+  my_texture_configure_history(
+      self->texture, seconds, max_bytes,
+      is_fl_type(encoded_val, FL_VALUE_TYPE_BOOL) && fl_value_get_bool(encoded_val),
+      is_fl_type(encoder_val, FL_VALUE_TYPE_STRING) ? fl_value_get_string(encoder_val)
+                                                    : nullptr);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Runs on the history writer thread; takes the channel reference.
+static void on_history_dumped(gboolean ok, const gchar* path, const gchar* error,
+                              guint64 frames, gint64 span_ns, gpointer user_data) {
+  FlMethodChannel* channel = FL_METHOD_CHANNEL(user_data);
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "path", fl_value_new_string(path));
+  fl_value_set_string_take(result, "ok", fl_value_new_bool(ok));
+  if (!ok) {
+    fl_value_set_string_take(result, "error", fl_value_new_string(error));
+  }
+  fl_value_set_string_take(result, "frames",
+                           fl_value_new_int(static_cast<int64_t>(frames)));
+  fl_value_set_string_take(result, "spanNs", fl_value_new_int(span_ns));
+  invoke_on_main(channel, "historyDumped", result);
+  g_object_unref(channel);
+}
+
+// {path, seconds?}: writes the recorded history to `path` in the
+// background; "historyDumped" reports the outcome.
+static FlMethodResponse* handle_dump_history(KataglyphisNativeInferencePlugin* self,
+                                             FlMethodCall* method_call) {
+  if (!self->texture || !self->channel) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* path_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                          ? fl_value_lookup_string(args, "path")
+                          : nullptr;
+  if (!is_fl_type(path_val, FL_VALUE_TYPE_STRING)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {path: string, seconds?: num}", nullptr));
+  }
+  FlValue* seconds_val = fl_value_lookup_string(args, "seconds");
+  gdouble seconds = 0;  // everything recorded
+  if (is_fl_type(seconds_val, FL_VALUE_TYPE_FLOAT)) {
+    seconds = fl_value_get_float(seconds_val);
+  } else if (is_fl_type(seconds_val, FL_VALUE_TYPE_INT)) {
+    seconds = static_cast<gdouble>(fl_value_get_int(seconds_val));
+  }
+
+  GError* error = nullptr;
+  gpointer channel = g_object_ref(self->channel);
+  if (!my_texture_dump_history(self->texture, fl_value_get_string(path_val),
+                               seconds, on_history_dumped, channel, &error)) {
+    g_object_unref(channel);
+    g_autofree gchar* message =
+        g_strdup(error ? error->message : "Unknown error");
+    if (error) g_error_free(error);
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("History Error", message, nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {slots?: 4, maxWidth?: 1920, maxHeight?: 1080}: exports every new frame
+// into a shared-memory ring that sidecars map from `path`; slots: 0 stops.
+static FlMethodResponse* handle_export_frames(KataglyphisNativeInferencePlugin* self,
+                                              FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  const bool is_map = is_fl_type(args, FL_VALUE_TYPE_MAP);
+  const auto int_arg = [args, is_map](const char* key, gint64 fallback) {
+    FlValue* value = is_map ? fl_value_lookup_string(args, key) : nullptr;
+    return is_fl_type(value, FL_VALUE_TYPE_INT) ? fl_value_get_int(value) : fallback;
+  };
+  const gint64 slots = int_arg("slots", 4);
+  const gint64 max_width = int_arg("maxWidth", 1920);
+  const gint64 max_height = int_arg("maxHeight", 1080);
+  if (slots < 0 || slots > 64 || max_width <= 0 || max_height <= 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {slots?: 0..64, maxWidth?: int, maxHeight?: int}",
+        nullptr));
+  }
+  const guint64 slot_bytes = static_cast<guint64>(max_width) *
+                             static_cast<guint64>(max_height) * 4;
+
+  GError* error = nullptr;
+  gint fd = -1;
+  if (!my_texture_export_frames(self->texture, static_cast<guint>(slots),
+                                slot_bytes, &fd, &error)) {
+    g_autofree gchar* message = g_strdup(error ? error->message : "Unknown error");
+    if (error) g_error_free(error);
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("Export Error", message, nullptr));
+  }
+  if (fd < 0) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  g_autoptr(FlValue) result = fl_value_new_map();
+  g_autofree gchar* path = g_strdup_printf("/proc/%d/fd/%d", getpid(), fd);
+  fl_value_set_string_take(result, "path", fl_value_new_string(path));
+  fl_value_set_string_take(result, "slots", fl_value_new_int(slots));
+  fl_value_set_string_take(result, "slotBytes",
+                           fl_value_new_int(static_cast<int64_t>(slot_bytes)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// {eventsPerThread?}: starts a new trace session of the frame path.
+static FlMethodResponse* handle_start_trace(
+    KataglyphisNativeInferencePlugin* /*self*/, FlMethodCall* method_call) {
+  namespace core = kataglyphis_native_inference::core;
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* events_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                            ? fl_value_lookup_string(args, "eventsPerThread")
+                            : nullptr;
+  const size_t events = is_fl_type(events_val, FL_VALUE_TYPE_INT)
+                            ? clamp_to_u32(fl_value_get_int(events_val))
+                            : core::TraceRecorder::kDefaultEventsPerThread;
+  core::TraceRecorder::Get().Start(events);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {path?}: stops tracing and writes the session as Chrome trace JSON,
+// by default into the temp directory. Returns {path, events, dropped,
+// threads}.
+static FlMethodResponse* handle_stop_trace(
+    KataglyphisNativeInferencePlugin* /*self*/, FlMethodCall* method_call) {
+  namespace core = kataglyphis_native_inference::core;
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* path_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                          ? fl_value_lookup_string(args, "path")
+                          : nullptr;
+  g_autofree gchar* path =
+      is_fl_type(path_val, FL_VALUE_TYPE_STRING)
+          ? g_strdup(fl_value_get_string(path_val))
+          : g_strdup_printf("%s/kataglyphis_trace_%d.json", g_get_tmp_dir(),
+                            getpid());
+
+  core::TraceRecorder::Get().Stop();
+  core::TraceStats stats;
+  std::string error;
+  if (!core::TraceRecorder::Get().WriteChromeTrace(path, &stats, &error)) {
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("Trace Error", error.c_str(), nullptr));
+  }
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "path", fl_value_new_string(path));
+  fl_value_set_string_take(result, "events",
+                           fl_value_new_int(static_cast<int64_t>(stats.events)));
+  fl_value_set_string_take(result, "dropped",
+                           fl_value_new_int(static_cast<int64_t>(stats.dropped)));
+  fl_value_set_string_take(result, "threads",
+                           fl_value_new_int(static_cast<int64_t>(stats.threads)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+struct PendingResponse {
+  FlMethodCall* call;
+  FlMethodResponse* response;
+};
+
+static gboolean respond_on_main(gpointer user_data) {
+  auto* pending = static_cast<PendingResponse*>(user_data);
+  fl_method_call_respond(pending->call, pending->response, nullptr);
+  g_object_unref(pending->response);
+  g_object_unref(pending->call);
+  delete pending;
+  return G_SOURCE_REMOVE;
+}
+
+// Runs on a snapshot worker; answers the FlMethodCall passed as user data.
+static void on_snapshot_done(gboolean ok, const gchar* error, const gchar* format,
+                             const guint8* bytes, gsize size, const gchar* path,
+                             guint32 width, guint32 height, gint64 timestamp_ns,
+                             gpointer user_data) {
+  FlMethodResponse* response = nullptr;
+  if (ok) {
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "format", fl_value_new_string(format));
+    fl_value_set_string_take(result, "width", fl_value_new_int(width));
+    fl_value_set_string_take(result, "height", fl_value_new_int(height));
+    fl_value_set_string_take(result, "ptsNs", fl_value_new_int(timestamp_ns));
+    if (path && *path) {
+      fl_value_set_string_take(result, "path", fl_value_new_string(path));
+    } else {
+      fl_value_set_string_take(result, "bytes", fl_value_new_uint8_list(bytes, size));
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(
+        fl_method_error_response_new("Snapshot Error", error, nullptr));
+  }
+  g_main_context_invoke(nullptr, respond_on_main,
+                        new PendingResponse{FL_METHOD_CALL(user_data), response});
+}
+
+// {format?: png|jpeg|raw, quality?, path?, maxSide?}: answered once the
+// current frame is encoded, with {format, width, height, ptsNs} plus `bytes`
+// or `path`. maxSide > 0 encodes a pyramid level as a thumbnail.
+// Responds itself, possibly later, instead of returning a response.
+static void handle_snapshot(KataglyphisNativeInferencePlugin* self,
+                            FlMethodCall* method_call) {
+  if (!self->texture) {
+    fl_method_call_respond_error(method_call, "Error",
+                                 "No texture created. Call 'create' first.",
+                                 nullptr, nullptr);
+    return;
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  const bool is_map = is_fl_type(args, FL_VALUE_TYPE_MAP);
+  FlValue* format_val = is_map ? fl_value_lookup_string(args, "format") : nullptr;
+  FlValue* quality_val = is_map ? fl_value_lookup_string(args, "quality") : nullptr;
+  FlValue* path_val = is_map ? fl_value_lookup_string(args, "path") : nullptr;
+  FlValue* max_side_val = is_map ? fl_value_lookup_string(args, "maxSide") : nullptr;
+
+  GError* error = nullptr;
+  if (!my_texture_snapshot(
+          self->texture,
+          is_fl_type(format_val, FL_VALUE_TYPE_STRING) ? fl_value_get_string(format_val)
+                                                       : nullptr,
+          is_fl_type(quality_val, FL_VALUE_TYPE_INT)
+              ? static_cast<gint>(fl_value_get_int(quality_val))
+              : 0,
+          is_fl_type(path_val, FL_VALUE_TYPE_STRING) ? fl_value_get_string(path_val)
+                                                     : nullptr,
+          is_fl_type(max_side_val, FL_VALUE_TYPE_INT)
+              ? clamp_to_u32(fl_value_get_int(max_side_val))
+              : 0U,
+          on_snapshot_done, g_object_ref(method_call), &error)) {
+    fl_method_call_respond_error(method_call, "Snapshot Error",
+                                 error ? error->message : "Unknown error",
+                                 nullptr, nullptr);
+    if (error) g_error_free(error);
+    // The callback never runs, so drop its reference here.
+    g_object_unref(method_call);
+  }
+}
+
+// Runs on the main thread; answers the FlMethodCall passed as user data.
+static void on_profile_done(FlValue* result, const gchar* error,
+                            gpointer user_data) {
+  FlMethodCall* method_call = FL_METHOD_CALL(user_data);
+  if (result) {
+    fl_method_call_respond_success(method_call, result, nullptr);
+  } else {
+    fl_method_call_respond_error(method_call, "Profile Error", error, nullptr,
+                                 nullptr);
+  }
+  g_object_unref(method_call);
+}
+
+// {durationMs?}: probes every element of the current pipeline for that long
+// (default 3000) and answers with {table, elements: [{name, factory,
+// buffers, rateHz, processing*Ms, queueFill*}]}. Responds itself, later.
+static void handle_profile_pipeline(KataglyphisNativeInferencePlugin* self,
+                                    FlMethodCall* method_call) {
+  if (!self->texture) {
+    fl_method_call_respond_error(method_call, "Error",
+                                 "No texture created. Call 'create' first.",
+                                 nullptr, nullptr);
+    return;
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* duration_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                              ? fl_value_lookup_string(args, "durationMs")
+                              : nullptr;
+  const guint duration_ms = is_fl_type(duration_val, FL_VALUE_TYPE_INT)
+                                ? clamp_to_u32(fl_value_get_int(duration_val))
+                                : 3000;
+
+  GError* error = nullptr;
+  if (!my_texture_profile_pipeline(self->texture, duration_ms, on_profile_done,
+                                   g_object_ref(method_call), &error)) {
+    fl_method_call_respond_error(method_call, "Profile Error",
+                                 error ? error->message : "Unknown error",
+                                 nullptr, nullptr);
+    if (error) g_error_free(error);
+    g_object_unref(method_call);
+  }
+}
+
+// Number argument that Dart may send as int or double.
+static bool number_arg(FlValue* value, gdouble* out) {
+  if (is_fl_type(value, FL_VALUE_TYPE_FLOAT)) {
+    *out = fl_value_get_float(value);
+    return true;
+  }
+  if (is_fl_type(value, FL_VALUE_TYPE_INT)) {
+    *out = static_cast<gdouble>(fl_value_get_int(value));
+    return true;
+  }
+  return false;
+}
+
+// [left, top, width, height] as a float list or a list of numbers.
+static bool rect_arg(FlValue* value, gdouble rect[4]) {
+  if (is_fl_type(value, FL_VALUE_TYPE_FLOAT_LIST) &&
+      fl_value_get_length(value) == 4) {
+    std::copy_n(fl_value_get_float_list(value), 4, rect);
+    return true;
+  }
+  if (!is_fl_type(value, FL_VALUE_TYPE_LIST) ||
+      fl_value_get_length(value) != 4) {
+    return false;
+  }
+  for (size_t k = 0; k < 4; ++k) {
+    if (!number_arg(fl_value_get_list_value(value, k), &rect[k])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// {enabled?: true, cellSize?: 8, meanThreshold?: 3.0, cellThreshold?: 24,
+//  changedFraction?: 0.005, keepAliveMs?: 5000,
+//  regions?: [[left, top, width, height], ...]}: only frames that changed
+// enough reach knt_acquire_inference_frame. Regions are normalized to 0..1.
+static FlMethodResponse* handle_configure_motion_gate(
+    KataglyphisNativeInferencePlugin* self, FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  const bool is_map = is_fl_type(args, FL_VALUE_TYPE_MAP);
+  const auto lookup = [args, is_map](const char* key) {
+    return is_map ? fl_value_lookup_string(args, key) : nullptr;
+  };
+  const auto number = [&lookup](const char* key, gdouble fallback) {
+    gdouble value = fallback;
+    number_arg(lookup(key), &value);
+    return value;
+  };
+  FlValue* enabled_val = lookup("enabled");
+  const bool enabled =
+      !is_fl_type(enabled_val, FL_VALUE_TYPE_BOOL) || fl_value_get_bool(enabled_val);
+  const gdouble cell_size = number("cellSize", 8);
+  const gdouble mean_threshold = number("meanThreshold", 3.0);
+  const gdouble cell_threshold = number("cellThreshold", 24);
+  const gdouble changed_fraction = number("changedFraction", 0.005);
+  const gdouble keep_alive_ms = number("keepAliveMs", 5000);
+  if (cell_size < 1 || cell_size > 256 || mean_threshold < 0 ||
+      cell_threshold < 0 || cell_threshold > 255 || changed_fraction < 0 ||
+      keep_alive_ms < 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args",
+        "Expected cellSize 1..256, cellThreshold 0..255 and non-negative "
+        "thresholds",
+        nullptr));
+  }
+
+  std::vector<gdouble> regions;
+  FlValue* regions_val = lookup("regions");
+  if (is_fl_type(regions_val, FL_VALUE_TYPE_LIST)) {
+    for (size_t i = 0; i < fl_value_get_length(regions_val); ++i) {
+      gdouble rect[4];
+      if (!rect_arg(fl_value_get_list_value(regions_val, i), rect)) {
+        return FL_METHOD_RESPONSE(fl_method_error_response_new(
+            "Invalid args", "Each region must be [left, top, width, height]",
+            nullptr));
+      }
+      regions.insert(regions.end(), rect, rect + 4);
+    }
+  }
+
+  my_texture_configure_motion_gate(
+      self->texture, enabled, static_cast<guint>(cell_size), mean_threshold,
+      static_cast<guint>(cell_threshold), changed_fraction,
+      static_cast<guint>(std::min<gdouble>(keep_alive_ms, G_MAXUINT)),
+      regions.data(), regions.size() / 4);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {enabled?: true, maxFps?: 0, targetLatencyMs?: 0}: lets frames reach
+// knt_acquire_inference_frame only as fast as reported inferences finish,
+// capped at maxFps (0: no cap), and slower while results come back older
+// than targetLatencyMs (0: no target).
+static FlMethodResponse* handle_configure_inference_rate(
+    KataglyphisNativeInferencePlugin* self, FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  const bool is_map = is_fl_type(args, FL_VALUE_TYPE_MAP);
+  const auto lookup = [args, is_map](const char* key) {
+    return is_map ? fl_value_lookup_string(args, key) : nullptr;
+  };
+  FlValue* enabled_val = lookup("enabled");
+  const bool enabled =
+      !is_fl_type(enabled_val, FL_VALUE_TYPE_BOOL) || fl_value_get_bool(enabled_val);
+  gdouble max_fps = 0;
+  gdouble target_latency_ms = 0;
+  number_arg(lookup("maxFps"), &max_fps);
+  number_arg(lookup("targetLatencyMs"), &target_latency_ms);
+  if (max_fps < 0 || target_latency_ms < 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected non-negative maxFps and targetLatencyMs",
+        nullptr));
+  }
+
+  my_texture_configure_inference_rate(
+      self->texture, enabled, max_fps,
+      static_cast<guint>(std::min<gdouble>(target_latency_ms, G_MAXUINT)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {levels: 3}: builds that many halved levels of every frame once, for the
+// motion gate, knt_map_frame_level and snapshot thumbnails. 0 turns it off.
+static FlMethodResponse* handle_configure_pyramid(
+    KataglyphisNativeInferencePlugin* self, FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* levels_val = is_fl_type(args, FL_VALUE_TYPE_MAP)
+                            ? fl_value_lookup_string(args, "levels")
+                            : nullptr;
+  if (!is_fl_type(levels_val, FL_VALUE_TYPE_INT) ||
+      fl_value_get_int(levels_val) < 0 || fl_value_get_int(levels_val) > 8) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args", "Expected {levels: 0..8}", nullptr));
+  }
+  my_texture_configure_pyramid(self->texture,
+                               static_cast<guint>(fl_value_get_int(levels_val)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {width, height, background?: 0x000000ff,
+//  tiles: [{source, rect: [left, top, width, height], fit?: true}, ...]}:
+// composites the appsinks named by `source` into one width x height surface
+// that the texture shows instead of `sink`. Rects are normalized to 0..1;
+// background is RGBA. Sources are picked up by the next setPipeline; an
+// empty tile list turns the mosaic off.
+static FlMethodResponse* handle_configure_mosaic(
+    KataglyphisNativeInferencePlugin* self, FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  const bool is_map = is_fl_type(args, FL_VALUE_TYPE_MAP);
+  const auto lookup = [args, is_map](const char* key) {
+    return is_map ? fl_value_lookup_string(args, key) : nullptr;
+  };
+  FlValue* width_val = lookup("width");
+  FlValue* height_val = lookup("height");
+  FlValue* background_val = lookup("background");
+  FlValue* tiles_val = lookup("tiles");
+  const auto invalid = [] {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args",
+        "Expected {width: 1..8192, height: 1..8192, background?: int, "
+        "tiles: [{source: String, rect: [left, top, width, height], "
+        "fit?: bool}]}",
+        nullptr));
+  };
+  if (!is_fl_type(width_val, FL_VALUE_TYPE_INT) ||
+      !is_fl_type(height_val, FL_VALUE_TYPE_INT) ||
+      !is_fl_type(tiles_val, FL_VALUE_TYPE_LIST) ||
+      (background_val && !is_fl_type(background_val, FL_VALUE_TYPE_INT))) {
+    return invalid();
+  }
+  const gint64 width = fl_value_get_int(width_val);
+  const gint64 height = fl_value_get_int(height_val);
+  if (width < 1 || width > 8192 || height < 1 || height > 8192) {
+    return invalid();
+  }
+  const guint32 background =
+      background_val ? clamp_to_u32(fl_value_get_int(background_val))
+                     : 0x000000ffU;
+
+  const size_t count = fl_value_get_length(tiles_val);
+  std::vector<const gchar*> sources;
+  std::vector<gdouble> rects;
+  std::vector<gboolean> fits;
+  for (size_t i = 0; i < count; ++i) {
+    FlValue* tile = fl_value_get_list_value(tiles_val, i);
+    if (!is_fl_type(tile, FL_VALUE_TYPE_MAP)) {
+      return invalid();
+    }
+    FlValue* source_val = fl_value_lookup_string(tile, "source");
+    FlValue* fit_val = fl_value_lookup_string(tile, "fit");
+    gdouble rect[4];
+    if (!is_fl_type(source_val, FL_VALUE_TYPE_STRING) ||
+        !rect_arg(fl_value_lookup_string(tile, "rect"), rect) ||
+        (fit_val && !is_fl_type(fit_val, FL_VALUE_TYPE_BOOL))) {
+      return invalid();
+    }
+    // Strings stay owned by `args` until the call returns.
+    sources.push_back(fl_value_get_string(source_val));
+    rects.insert(rects.end(), rect, rect + 4);
+    fits.push_back(!fit_val || fl_value_get_bool(fit_val));
+  }
+
+  my_texture_configure_mosaic(self->texture, static_cast<guint>(width),
+                              static_cast<guint>(height), background,
+                              sources.data(), rects.data(), fits.data(),
+                              count);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// {enabled?: true, iouThreshold?: 0.3, maxMisses?: 2, maxCoastMs?: 1000}:
+// carries boxes from inference keyframes across the frames in between and
+// assigns track ids. Reconfiguring drops the current tracks.
+static FlMethodResponse* handle_configure_tracker(
+    KataglyphisNativeInferencePlugin* self, FlMethodCall* method_call) {
+  if (!self->texture) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Error", "No texture created. Call 'create' first.", nullptr));
+  }
+  FlValue* args = fl_method_call_get_args(method_call);
+  const bool is_map = is_fl_type(args, FL_VALUE_TYPE_MAP);
+  const auto lookup = [args, is_map](const char* key) {
+    return is_map ? fl_value_lookup_string(args, key) : nullptr;
+  };
+  const auto number = [&lookup](const char* key, gdouble fallback) {
+    gdouble value = fallback;
+    number_arg(lookup(key), &value);
+    return value;
+  };
+  FlValue* enabled_val = lookup("enabled");
+  const bool enabled =
+      !is_fl_type(enabled_val, FL_VALUE_TYPE_BOOL) || fl_value_get_bool(enabled_val);
+  const gdouble iou_threshold = number("iouThreshold", 0.3);
+  const gdouble max_misses = number("maxMisses", 2);
+  const gdouble max_coast_ms = number("maxCoastMs", 1000);
+  if (iou_threshold < 0 || iou_threshold > 1 || max_misses < 0 ||
+      max_coast_ms < 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "Invalid args",
+        "Expected iouThreshold 0..1 and non-negative maxMisses/maxCoastMs",
+        nullptr));
+  }
+
+  my_texture_configure_tracker(
+      self->texture, enabled, iou_threshold,
+      static_cast<guint>(std::min<gdouble>(max_misses, G_MAXUINT)),
+      static_cast<guint>(std::min<gdouble>(max_coast_ms, G_MAXUINT)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Availability of the probed plugins/elements, init phase timings and the
+// full plugin registry. Only computed when asked for.
+static FlMethodResponse* handle_diagnose(
+    KataglyphisNativeInferencePlugin* /*self*/, FlMethodCall* /*method_call*/) {
+  std::string report =
+      kataglyphis_native_inference::core::GstRuntime::Get().Diagnose();
+  if (const auto pool =
+          kataglyphis_native_inference::core::StreamingThreadPool::Default()) {
+    report += "\n\n" + pool->Describe();
+  }
+  g_autoptr(FlValue) result = fl_value_new_string(report.c_str());
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
 static FlMethodResponse* handle_get_platform_version(
     KataglyphisNativeInferencePlugin* /*self*/, FlMethodCall* /*method_call*/) {
   return get_platform_version();
@@ -260,7 +1282,7 @@ static void kataglyphis_native_inference_plugin_handle_method_call(
 
   const gchar* method = fl_method_call_get_name(method_call);
 
-  static constexpr std::array<std::pair<const char*, MethodHandler>, 7> kHandlers = {{
+  static constexpr std::array<std::pair<const char*, MethodHandler>, 25> kHandlers = {{
       {"getPlatformVersion", handle_get_platform_version},
       {"add", handle_add},
       {"create", handle_create},
@@ -268,10 +1290,35 @@ static void kataglyphis_native_inference_plugin_handle_method_call(
       {"setPipeline", handle_set_pipeline},
       {"play", handle_play},
       {"pause", handle_pause},
+      {"diagnose", handle_diagnose},
+      {"processFiles", handle_process_files},
+      {"batchProgress", handle_batch_progress},
+      {"cancelBatch", handle_cancel_batch},
+      {"openScrub", handle_open_scrub},
+      {"closeScrub", handle_close_scrub},
+      {"seek", handle_seek},
+      {"stepFrame", handle_step_frame},
+      {"configureHistory", handle_configure_history},
+      {"dumpHistory", handle_dump_history},
+      {"exportFrames", handle_export_frames},
+      {"startTrace", handle_start_trace},
+      {"stopTrace", handle_stop_trace},
+      {"configureMotionGate", handle_configure_motion_gate},
+      {"configureInferenceRate", handle_configure_inference_rate},
+      {"configureTracker", handle_configure_tracker},
+      {"configurePyramid", handle_configure_pyramid},
+      {"configureMosaic", handle_configure_mosaic},
   }};
 
   if (g_str_equal(method, "stop")) {
     response = handle_stop(self, method_call);
+  } else if (g_str_equal(method, "snapshot")) {
+    // Answered asynchronously.
+    handle_snapshot(self, method_call);
+    return;
+  } else if (g_str_equal(method, "profilePipeline")) {
+    handle_profile_pipeline(self, method_call);
+    return;
   } else {
     for (const auto& handler : kHandlers) {
       if (std::strcmp(method, handler.first) == 0) {
@@ -301,10 +1348,18 @@ FlMethodResponse* get_platform_version() {
 static void kataglyphis_native_inference_plugin_dispose(GObject *object) {
   KataglyphisNativeInferencePlugin* self = KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(object);
 
+  stop_batch(self);
   g_clear_pointer(&self->dart_entrypoint_arguments, g_strfreev);
   g_clear_object(&self->channel);
   g_clear_object(&self->texture_channel);
+  if (self->texture) {
+    // Pending deliveries keep the texture alive past this plugin.
+    my_texture_set_results_listener(self->texture, nullptr, nullptr);
+    my_texture_set_stats_listener(self->texture, 0, nullptr, nullptr);
+  }
   g_clear_object(&self->texture);
+  g_clear_object(&self->results_channel);
+  g_clear_object(&self->stats_channel);
   if (self->view) {
     g_clear_object(&self->view);
   }
@@ -321,9 +1376,12 @@ static void kataglyphis_native_inference_plugin_init(
     KataglyphisNativeInferencePlugin *self) {
   self->dart_entrypoint_arguments = nullptr;
   self->channel = nullptr;
+  self->results_channel = nullptr;
+  self->stats_channel = nullptr;
   self->texture_channel = nullptr;
   self->texture = nullptr;
   self->view = nullptr;
+  self->batch = nullptr;
 }
 
 static void method_call_cb(FlMethodChannel* /*channel*/, FlMethodCall* method_call,
@@ -333,6 +1391,28 @@ static void method_call_cb(FlMethodChannel* /*channel*/, FlMethodCall* method_ca
 }
 
 void kataglyphis_native_inference_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  // gst_init and the registry scan run in the background so neither plugin
+  // registration nor the first texture creation blocks the main thread.
+  kataglyphis_native_inference::core::GstRuntimeOptions gst_options;
+  gst_options.probe_plugins = {"coreelements", "app", "videotestsrc",
+                               "videoconvertscale", "v4l2", "libcamera"};
+  gst_options.probe_elements = {"v4l2src", "libcamerasrc", "videotestsrc",
+                                "videoconvert", "videoscale", "appsink"};
+  kataglyphis_native_inference::core::GstRuntime::Get().StartAsync(
+      std::move(gst_options));
+
+  // Kiosk deployments keep media threads off the UI/raster cores via
+  // KATAGLYPHIS_GST_CPUS / KATAGLYPHIS_GST_NICE.
+  kataglyphis_native_inference::core::StreamingThreadOptions stream_options;
+  std::string stream_error;
+  if (kataglyphis_native_inference::core::StreamingThreadPool::
+          OptionsFromEnvironment(&stream_options, &stream_error)) {
+    kataglyphis_native_inference::core::StreamingThreadPool::SetDefaultOptions(
+        std::move(stream_options));
+  } else if (!stream_error.empty()) {
+    g_warning("Ignoring streaming thread settings: %s", stream_error.c_str());
+  }
+
   KataglyphisNativeInferencePlugin* plugin = KATAGLYPHIS_NATIVE_INFERENCE_PLUGIN(
       g_object_new(kataglyphis_native_inference_plugin_get_type(), nullptr));
 
@@ -350,6 +1430,20 @@ void kataglyphis_native_inference_plugin_register_with_registrar(FlPluginRegistr
   fl_method_channel_set_method_call_handler(channel, method_call_cb,
                                             g_object_ref(plugin),
                                             g_object_unref);
+  /* Kept for calls into Dart (batch results). */
+  plugin->channel = FL_METHOD_CHANNEL(g_object_ref(channel));
+
+  g_autoptr(FlBinaryCodec) binary_codec = fl_binary_codec_new();
+  plugin->results_channel = fl_basic_message_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "kataglyphis_native_inference/detections",
+      FL_MESSAGE_CODEC(binary_codec));
+
+  plugin->stats_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "kataglyphis_native_inference/stats", FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->stats_channel, on_stats_listen,
+                                       on_stats_cancel, plugin, nullptr);
 
   g_object_unref(plugin);
 }
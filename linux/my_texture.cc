@@ -3,16 +3,111 @@ module;
 #include <flutter_linux/flutter_linux.h>
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
-#include <gst/video/video.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <string.h>
+#include <vector>
+
+#include "kataglyphis_native_core/detection_packet.h"
+#include "kataglyphis_native_core/ffi_api.h"
+#include "kataglyphis_native_core/frame_exchange.h"
+#include "kataglyphis_native_core/frame_pool.h"
+#include "kataglyphis_native_core/frame_pyramid.h"
+#include "kataglyphis_native_core/frame_scrubber.h"
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/history_recorder.h"
+#include "kataglyphis_native_core/inference_feed.h"
+#include "kataglyphis_native_core/mosaic_compositor.h"
+#include "kataglyphis_native_core/object_tracker.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+#include "kataglyphis_native_core/pipeline_profiler.h"
+#include "kataglyphis_native_core/result_slot.h"
+#include "kataglyphis_native_core/pipeline_validator.h"
+#include "kataglyphis_native_core/pixel_convert.h"
+#include "kataglyphis_native_core/roi_detections.h"
+#include "kataglyphis_native_core/sample_frame.h"
+#include "kataglyphis_native_core/shared_frame_ring.h"
+#include "kataglyphis_native_core/snapshot_service.h"
+#include "kataglyphis_native_core/stats_aggregator.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+#include "kataglyphis_native_core/trace_recorder.h"
 
 module kataglyphis.my_texture;
 
+namespace core = kataglyphis_native_inference::core;
+
 typedef struct _MyTexture MyTexture;
 typedef struct _MyTextureClass MyTextureClass;
 
+// Weiterer appsink der Pipeline, dessen Frames eine Mosaik-Kachel füllen.
+struct MyTextureMosaicSink {
+  MyTexture* self;
+  // Name des appsink, unter dem die Kachel ihre Quelle findet.
+  std::string source;
+  GstElement* appsink;
+};
+
+struct MyTextureFrames {
+  core::FrameExchange exchange;
+  // Letztes Inferenz-Ergebnis für den FFI-Schnellpfad.
+  core::ResultSlot results;
+  // Boxen im zuletzt veröffentlichten Ergebnis; nur der Streaming-Thread.
+  size_t last_result_count = 0;
+  // Gesetzt, solange eine Zustellung an den Main-Thread aussteht, damit
+  // sich bei hoher Framerate keine Aufrufe in der Hauptschleife stauen.
+  std::atomic<bool> results_dispatch_pending{false};
+  // Zuletzt an den Listener gegebene Version; nur der Main-Thread.
+  uint64_t delivered_result_version = 0;
+  // Messfenster für set_stats_listener; gemessen wird nur, solange
+  // stats_enabled gesetzt ist.
+  core::StatsAggregator stats;
+  std::atomic<bool> stats_enabled{false};
+  // Frames für knt_acquire_inference_frame, optional mit Bewegungsfilter.
+  core::InferenceFeed inference;
+  // Stufenzahl der Bildpyramide je Frame (configure_pyramid), 0: keine.
+  // Die Stufen kommen aus einem eigenen Pool.
+  std::atomic<uint32_t> pyramid_levels{0};
+  std::shared_ptr<core::FramePool> pyramid_pool = core::FramePool::Create(12);
+  // Trägt Boxen zwischen Inferenz-Keyframes (ROI-Metas oder
+  // knt_submit_detections) weiter; aus, bis configureTracker es einschaltet.
+  core::ObjectTracker tracker{core::ObjectTrackerOptions(), false};
+  // Mosaik aus allen appsinks außer `sink` (configure_mosaic); aktiv zeigt
+  // die Textur dessen Fläche statt des Hauptstroms.
+  core::MosaicCompositor mosaic;
+  // Wie results_dispatch_pending: ein Frame-Aufruf für alle Quellen, bis
+  // copy_pixels das Mosaik zusammensetzt.
+  std::atomic<bool> mosaic_frame_pending{false};
+  // Nur der Main-Thread; die Adressen sind user_data der Callbacks.
+  std::vector<std::unique_ptr<MyTextureMosaicSink>> mosaic_sinks;
+  // Sonden von profile_pipeline; muss vor der Pipeline sterben.
+  std::unique_ptr<core::PipelineProfiler> profiler;
+  // Frame whose pixels were handed to Flutter in place. Released on the next
+  // copy_pixels call, once Flutter has uploaded it.
+  core::FrameRef presented;
+  // Offene Datei für seek/stepFrame ohne Pipeline (openScrub), sonst null.
+  std::unique_ptr<core::FrameScrubber> scrubber;
+  // Vorlauf-Aufzeichnung (configureHistory), sonst null. Der Mutex schützt
+  // nur den Zeiger; der Streaming-Thread kopiert ihn und zeichnet ohne Lock
+  // auf.
+  std::mutex history_mutex;
+  std::shared_ptr<core::HistoryRecorder> history;
+  // Recorder, dessen Encoder-Zweig in der aktuellen Pipeline hängt; lebt
+  // mindestens so lange wie deren Streaming-Threads.
+  std::shared_ptr<core::HistoryRecorder> attached_history;
+  // Frame-Export für Sidecar-Prozesse (exportFrames), sonst null; gleiche
+  // Regel wie bei history.
+  std::mutex export_mutex;
+  std::shared_ptr<core::SharedFrameRingWriter> frame_export;
+  // Beim ersten snapshot angelegt; zuletzt deklariert, damit der Destruktor
+  // die Warteschlange abarbeitet, solange alles andere noch lebt.
+  std::unique_ptr<core::SnapshotService> snapshots;
+};
+
 struct _MyTextureClass {
   FlPixelBufferTextureClass parent_class;
 };
@@ -33,8 +128,22 @@ struct _MyTexture {
   // GStreamer components
   GstElement* pipeline;
   GstElement* appsink;
-  GstSample* last_sample;
-  GMutex sample_mutex;
+
+  // Frame handoff between the appsink streaming thread and copy_pixels.
+  MyTextureFrames* frames;
+  // Id unter der die Textur im FFI-Register steht, sonst -1.
+  int64_t ffi_texture_id;
+  // Empfänger der Ergebnis-Pakete (set_results_listener), sonst null.
+  MyTextureResultsReady results_listener;
+  gpointer results_listener_data;
+  // Timer, der die Messfenster schließt, sonst 0.
+  guint stats_timer;
+  MyTextureStatsReady stats_listener;
+  gpointer stats_listener_data;
+  // Laufendes profile_pipeline: Timer und Empfänger des Ergebnisses.
+  guint profile_timer;
+  MyTextureProfiled profile_done;
+  gpointer profile_done_data;
   
   // Callback for texture updates
   FlTextureRegistrar* texture_registrar;
@@ -48,8 +157,16 @@ G_DEFINE_TYPE(MyTexture, my_texture, fl_pixel_buffer_texture_get_type())
 
 // Forward declarations
 static GstFlowReturn on_new_sample(GstAppSink* appsink, gpointer user_data);
+static GstFlowReturn on_new_preroll(GstAppSink* appsink, gpointer user_data);
+static GstFlowReturn publish_sample(MyTexture* self, GstSample* sample,
+                                    bool record);
+static void finish_profile(MyTexture* self, const gchar* error_message);
+
+// Wie lange seek/stepFrame auf das Preroll einer pausierten Pipeline warten.
+static constexpr std::chrono::seconds kSeekTimeout(5);
 
 static gboolean mark_texture_frame_available_on_main(gpointer user_data) {
+  core::ScopedTrace trace("mark_texture_frame_available_on_main");
   MyTexture* self = MY_TEXTURE(user_data);
   if (self->texture_registrar) {
     fl_texture_registrar_mark_texture_frame_available(self->texture_registrar,
@@ -60,6 +177,7 @@ static gboolean mark_texture_frame_available_on_main(gpointer user_data) {
 }
 
 static void request_texture_frame_available(MyTexture* self, const char* source) {
+  core::ScopedTrace trace("request_texture_frame_available");
   if (!self->texture_registrar) {
     if (!self->logged_no_registrar) {
       g_warning("[my_texture] no texture registrar yet; skip frame update from %s",
@@ -73,18 +191,73 @@ static void request_texture_frame_available(MyTexture* self, const char* source)
                         g_object_ref(self));
 }
 
-static void force_alpha_opaque(uint8_t* buffer, uint32_t width, uint32_t height) {
-  const uint64_t pixel_count = static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
-  for (uint64_t index = 0; index < pixel_count; ++index) {
-    buffer[index * 4U + 3U] = 255U;
+static void release_result_bytes(gpointer data) {
+  delete static_cast<core::ResultBytes*>(data);
+}
+
+static gboolean deliver_results_on_main(gpointer user_data) {
+  MyTexture* self = MY_TEXTURE(user_data);
+  self->frames->results_dispatch_pending.store(false);
+  // Version vor dem Paket lesen: ein dazwischen veröffentlichtes Paket
+  // kommt so höchstens doppelt, nie gar nicht an.
+  const uint64_t version = self->frames->results.version();
+  if (self->results_listener &&
+      version != self->frames->delivered_result_version) {
+    core::ResultBytes bytes = self->frames->results.Latest(nullptr);
+    if (bytes) {
+      self->frames->delivered_result_version = version;
+      // Das GBytes teilt sich den Puffer mit dem ResultSlot, ohne Kopie.
+      auto* owner = new core::ResultBytes(bytes);
+      GBytes* packet = g_bytes_new_with_free_func(
+          bytes->data(), bytes->size(), release_result_bytes, owner);
+      self->results_listener(packet, self->results_listener_data);
+      g_bytes_unref(packet);
+    }
+  }
+  g_object_unref(self);
+  return G_SOURCE_REMOVE;
+}
+
+// Streaming thread: publishes the boxes of `frame` for FFI readers and the
+// results listener.
+static void publish_results(MyTexture* self, core::DetectionSet* detections,
+                            const core::Frame& frame) {
+  detections->frame_generation = frame.generation();
+  detections->timestamp_ns = frame.timestamp_ns();
+  detections->frame_width = frame.width();
+  detections->frame_height = frame.height();
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  core::EncodeDetections(*detections, bytes.get());
+  self->frames->results.Publish(frame.generation(), std::move(bytes));
+  self->frames->last_result_count = detections->detections.size();
+
+  if (!self->frames->results_dispatch_pending.exchange(true)) {
+    g_main_context_invoke(nullptr, deliver_results_on_main,
+                          g_object_ref(self));
   }
 }
 
+// Wraps `sample` as a core frame without copying. Takes ownership.
+static std::shared_ptr<core::Frame> wrap_sample(MyTexture* self,
+                                                GstSample* sample) {
+  // No usable caps: treat the payload as tightly packed texture-sized RGBA.
+  return core::WrapVideoSample(sample, self->width, self->height);
+}
+
+static void detach_mosaic_sinks(MyTexture* self) {
+  for (const std::unique_ptr<MyTextureMosaicSink>& sink :
+       self->frames->mosaic_sinks) {
+    GstAppSinkCallbacks callbacks = {};
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink->appsink), &callbacks,
+                               nullptr, nullptr);
+    gst_object_unref(sink->appsink);
+  }
+  self->frames->mosaic_sinks.clear();
+}
+
 static void my_texture_dispose(GObject* object) {
   MyTexture* self = MY_TEXTURE(object);
 
-  g_mutex_lock(&self->sample_mutex);
-
   if (self->appsink) {
     GstAppSinkCallbacks callbacks = {};
     gst_app_sink_set_callbacks(GST_APP_SINK(self->appsink), &callbacks, nullptr,
@@ -93,19 +266,30 @@ static void my_texture_dispose(GObject* object) {
     self->appsink = nullptr;
   }
 
+  if (self->frames) {
+    detach_mosaic_sinks(self);
+    finish_profile(self, "Textur wurde freigegeben");
+  }
   if (self->pipeline) {
     gst_element_set_state(self->pipeline, GST_STATE_NULL);
     gst_object_unref(self->pipeline);
     self->pipeline = nullptr;
   }
 
-  if (self->last_sample) {
-    gst_sample_unref(self->last_sample);
-    self->last_sample = nullptr;
+  if (self->stats_timer) {
+    g_source_remove(self->stats_timer);
+    self->stats_timer = 0;
+  }
+
+  // Wartet auf FFI-Aufrufe, die die Frames gerade benutzen.
+  if (self->ffi_texture_id >= 0) {
+    core::UnregisterFfiTexture(self->ffi_texture_id);
+    self->ffi_texture_id = -1;
   }
 
-  g_mutex_unlock(&self->sample_mutex);
-  g_mutex_clear(&self->sample_mutex);
+  // Streaming threads are stopped, so nothing publishes anymore.
+  delete self->frames;
+  self->frames = nullptr;
 
   if (self->buffer) {
     free(self->buffer);
@@ -121,95 +305,70 @@ static gboolean my_texture_copy_pixels(FlPixelBufferTexture* texture,
                                        GError** error) {
   (void)error;
   MyTexture* self = MY_TEXTURE(texture);
-  
-  const size_t buffer_size =
-      static_cast<size_t>(self->width) * static_cast<size_t>(self->height) * 4U;
-
-  g_mutex_lock(&self->sample_mutex);
-  GstSample* sample = self->last_sample ? gst_sample_ref(self->last_sample) : nullptr;
-  g_mutex_unlock(&self->sample_mutex);
-
-  if (sample) {
-    GstBuffer* buffer = gst_sample_get_buffer(sample);
-    GstCaps* caps = gst_sample_get_caps(sample);
-    GstMapInfo map;
-
-    if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-      GstVideoInfo info;
-      if (caps && gst_video_info_from_caps(&info, caps)) {
-        const gint src_width_signed = GST_VIDEO_INFO_WIDTH(&info);
-        const gint src_height_signed = GST_VIDEO_INFO_HEIGHT(&info);
-        const uint32_t src_width =
-          static_cast<uint32_t>(std::max(src_width_signed, 0));
-        const uint32_t src_height =
-          static_cast<uint32_t>(std::max(src_height_signed, 0));
-        const int src_stride = GST_VIDEO_INFO_PLANE_STRIDE(&info, 0);
-        const size_t row_bytes =
-            std::min(static_cast<size_t>(self->width), static_cast<size_t>(src_width)) * 4U;
-        const uint32_t copy_rows = std::min(self->height, src_height);
-
-        memset(self->buffer, 0, buffer_size);
-        if (src_stride > 0 && row_bytes > 0U) {
-          for (uint32_t row = 0; row < copy_rows; ++row) {
-            const size_t src_offset = static_cast<size_t>(row) * static_cast<size_t>(src_stride);
-            const size_t dst_offset = static_cast<size_t>(row) * static_cast<size_t>(self->width) * 4U;
-            if (src_offset + row_bytes <= static_cast<size_t>(map.size) &&
-                dst_offset + row_bytes <= buffer_size) {
-              memcpy(self->buffer + dst_offset, map.data + src_offset, row_bytes);
-            }
-          }
-        }
-
-        force_alpha_opaque(self->buffer, self->width, self->height);
-
-        if (!self->logged_first_sample) {
-          const gchar* format_name =
-              gst_video_format_to_string(GST_VIDEO_INFO_FORMAT(&info));
-          g_message("[my_texture] first sample: src=%ux%u stride=%d format=%s dst=%ux%u",
-                    src_width, src_height, src_stride,
-                    format_name ? format_name : "unknown", self->width, self->height);
-          self->logged_first_sample = TRUE;
-        }
-      } else {
-        const size_t copy_size = std::min(buffer_size, static_cast<size_t>(map.size));
-        memcpy(self->buffer, map.data, copy_size);
-        if (copy_size < buffer_size) {
-          memset(self->buffer + copy_size, 0, buffer_size - copy_size);
-        }
-
-        force_alpha_opaque(self->buffer, self->width, self->height);
-
-        if (!self->logged_first_sample) {
-          g_message("[my_texture] first sample (fallback copy): bytes=%zu dst=%ux%u",
-                    static_cast<size_t>(map.size), self->width, self->height);
-          self->logged_first_sample = TRUE;
-        }
-      }
-      gst_buffer_unmap(buffer, &map);
-    }
+  core::ScopedTrace trace("my_texture_copy_pixels", "generation");
+
+  // Flutter has uploaded whatever we returned last time.
+  self->frames->presented.reset();
 
-    gst_sample_unref(sample);
+  if (self->frames->mosaic.active()) {
+    // Sources arriving from here on schedule the next frame.
+    self->frames->mosaic_frame_pending.store(false);
+    const size_t drawn = self->frames->mosaic.Compose();
+    trace.set_arg(static_cast<int64_t>(drawn));
+    *out_buffer = self->frames->mosaic.surface();
+    *width = self->frames->mosaic.surface_width();
+    *height = self->frames->mosaic.surface_height();
+    return TRUE;
   }
-  
+
   *out_buffer = self->buffer;
   *width = self->width;
   *height = self->height;
+
+  core::FrameRef frame = self->frames->exchange.AcquireLatest();
+  if (!frame) {
+    return TRUE;
+  }
+  trace.set_arg(static_cast<int64_t>(frame->generation()));
+  const bool measure = self->frames->stats_enabled.load(std::memory_order_relaxed);
+  if (measure) {
+    self->frames->stats.RecordPresented(frame->generation(),
+                                        core::StatsAggregator::NowNs());
+  }
+
+  if (frame->opaque() && frame->is_tightly_packed() &&
+      frame->width() == self->width && frame->height() == self->height) {
+    // Exact layout and alpha known to be 0xff: present in place. Frames
+    // that may carry alpha are copied below, which forces it opaque, so
+    // the result never depends on which branch ran.
+    self->frames->presented = frame;
+    *out_buffer = frame->data();
+  } else {
+    const int64_t copy_start_ns = measure ? core::StatsAggregator::NowNs() : 0;
+    core::CopyRgbaFrame(frame->data(), frame->size(), frame->stride(),
+                        frame->width(), frame->height(), self->buffer,
+                        self->width, self->height, true);
+    if (measure) {
+      self->frames->stats.RecordCopy(core::StatsAggregator::NowNs() -
+                                     copy_start_ns);
+    }
+  }
+
+  if (!self->logged_first_sample) {
+    g_message("[my_texture] first sample: src=%ux%u stride=%u dst=%ux%u%s",
+              frame->width(), frame->height(), frame->stride(), self->width,
+              self->height,
+              *out_buffer == self->buffer ? "" : " (zero-copy)");
+    self->logged_first_sample = TRUE;
+  }
   return TRUE;
 }
 
 void my_texture_set_color(FlTexture* texture, uint8_t r, uint8_t g, uint8_t b) {
   MyTexture* self = MY_TEXTURE(texture);
   g_return_if_fail(MY_IS_TEXTURE(self));
-  if (!self->buffer) return;
 
-  const uint32_t pixels = self->width * self->height;
-  for (uint32_t i = 0; i < pixels; ++i) {
-    uint8_t* p = self->buffer + i * 4;
-    p[0] = r;
-    p[1] = g;
-    p[2] = b;
-    p[3] = 255;
-  }
+  self->frames->exchange.PublishFill(self->width, self->height, r, g, b);
 
   if (self->texture_registrar) {
     request_texture_frame_available(self, "set_color");
@@ -224,13 +383,21 @@ static void my_texture_class_init(MyTextureClass* klass) {
 static void my_texture_init(MyTexture* self) {
   self->pipeline = nullptr;
   self->appsink = nullptr;
-  self->last_sample = nullptr;
+  self->frames = new MyTextureFrames();
+  self->ffi_texture_id = -1;
+  self->results_listener = nullptr;
+  self->results_listener_data = nullptr;
+  self->stats_timer = 0;
+  self->stats_listener = nullptr;
+  self->stats_listener_data = nullptr;
+  self->profile_timer = 0;
+  self->profile_done = nullptr;
+  self->profile_done_data = nullptr;
   self->buffer = nullptr;
   self->texture_registrar = nullptr;
   self->frame_counter = 0U;
   self->logged_no_registrar = FALSE;
   self->logged_first_sample = FALSE;
-  g_mutex_init(&self->sample_mutex);
 }
 
 FlTexture* my_texture_new(uint32_t width, uint32_t height, uint8_t r, uint8_t g, uint8_t b) {
@@ -240,32 +407,121 @@ FlTexture* my_texture_new(uint32_t width, uint32_t height, uint8_t r, uint8_t g,
   self->buffer = static_cast<uint8_t*>(malloc(width * height * 4));
   memset(self->buffer, 0, width * height * 4);
 
-  gst_init(nullptr, nullptr);
-
   my_texture_set_color(FL_TEXTURE(self), r, g, b);
   return FL_TEXTURE(self);
 }
 
 // Callback wenn ein neues Frame verfügbar ist
 static GstFlowReturn on_new_sample(GstAppSink* appsink, gpointer user_data) {
-  MyTexture* self = MY_TEXTURE(user_data);
-  
   GstSample* sample = gst_app_sink_pull_sample(appsink);
   if (!sample) {
     return GST_FLOW_ERROR;
   }
-  
-  g_mutex_lock(&self->sample_mutex);
+  return publish_sample(MY_TEXTURE(user_data), sample, true);
+}
 
-  // Altes Sample freigeben
-  if (self->last_sample) {
-    gst_sample_unref(self->last_sample);
+// Pausiert (nach seek/stepFrame) kommt das Frame nur als Preroll an.
+static GstFlowReturn on_new_preroll(GstAppSink* appsink, gpointer user_data) {
+  GstSample* sample = gst_app_sink_pull_preroll(appsink);
+  if (!sample) {
+    return GST_FLOW_ERROR;
+  }
+  // Dasselbe Frame folgt beim Abspielen als Sample; nur einmal aufzeichnen.
+  return publish_sample(MY_TEXTURE(user_data), sample, false);
+}
+
+// Frame eines Mosaik-appsink: nur ablegen, copy_pixels skaliert es.
+static GstFlowReturn on_mosaic_sample(GstAppSink* appsink,
+                                      gpointer user_data) {
+  MyTextureMosaicSink* sink = static_cast<MyTextureMosaicSink*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(appsink);
+  if (!sample) {
+    return GST_FLOW_ERROR;
+  }
+  core::ScopedTrace trace("on_mosaic_sample");
+  MyTexture* self = sink->self;
+  std::shared_ptr<core::Frame> frame = wrap_sample(self, sample);
+  if (frame && self->frames->mosaic.Submit(sink->source, std::move(frame)) &&
+      !self->frames->mosaic_frame_pending.exchange(true)) {
+    request_texture_frame_available(self, "mosaic");
+  }
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn publish_sample(MyTexture* self, GstSample* sample,
+                                    bool record) {
+  core::ScopedTrace trace(record ? "on_new_sample" : "on_new_preroll",
+                          "generation");
+  // Ohne ROI-Metas wird nur einmal ein leeres Paket gesendet, damit alte
+  // Boxen verschwinden; Pipelines ohne Inferenz kostet das nichts.
+  core::DetectionSet detections;
+  const bool measured =
+      core::CollectRoiDetections(gst_sample_get_buffer(sample),
+                                 &detections) > 0;
+
+  std::shared_ptr<core::Frame> frame = wrap_sample(self, sample);
+  if (!frame) {
+    return GST_FLOW_OK;
+  }
+  // Einmal pro Frame vor Publish; danach ist das Frame unveränderlich.
+  const uint32_t pyramid_levels =
+      self->frames->pyramid_levels.load(std::memory_order_relaxed);
+  if (pyramid_levels > 0) {
+    frame->set_pyramid(core::FramePyramid::Build(
+        *frame, pyramid_levels, self->frames->pyramid_pool.get()));
   }
-  
-  self->last_sample = sample;
-  self->frame_counter += 1U;
 
-  g_mutex_unlock(&self->sample_mutex);
+  if (record) {
+    std::shared_ptr<core::HistoryRecorder> history;
+    {
+      std::lock_guard<std::mutex> lock(self->frames->history_mutex);
+      history = self->frames->history;
+    }
+    // Kopiert nur im Raw-Modus; der Sample-Puffer gehört der Pipeline.
+    if (history) history->PushRaw(*frame);
+
+    std::shared_ptr<core::SharedFrameRingWriter> frame_export;
+    {
+      std::lock_guard<std::mutex> lock(self->frames->export_mutex);
+      frame_export = self->frames->frame_export;
+    }
+    if (frame_export) frame_export->Write(*frame);
+  }
+
+  // Ersetzt das vorherige Frame; es wird freigegeben, sobald Flutter es
+  // nicht mehr liest.
+  const bool measure = self->frames->stats_enabled.load(std::memory_order_relaxed);
+  const std::shared_ptr<core::Frame> published = frame;
+  self->frames->exchange.Publish(std::move(frame));
+  // Nach Publish, das die Generation vergibt.
+  trace.set_arg(static_cast<int64_t>(published->generation()));
+  // Mit Tracker bekommen Keyframes Track-IDs, alle anderen Frames die
+  // fortgeschriebenen Boxen. Ein Frame ohne ROI-Metas ist von einem
+  // übersprungenen nicht zu unterscheiden und zählt daher nicht als
+  // Keyframe: Verliert der Detektor sein letztes Objekt, endet dessen Track
+  // erst nach max_coast_ns, max_misses greift nur auf Keyframes mit Boxen.
+  if (self->frames->tracker.enabled()) {
+    const int64_t time_ns = published->timestamp_ns() >= 0
+                                ? published->timestamp_ns()
+                                : core::StatsAggregator::NowNs();
+    if (measured) {
+      self->frames->tracker.Update(&detections, time_ns);
+    } else {
+      self->frames->tracker.Predict(time_ns, &detections);
+    }
+  }
+  if (!detections.detections.empty() ||
+      self->frames->last_result_count > 0) {
+    publish_results(self, &detections, *published);
+  }
+  // Mit Bewegungsfilter liest das nur jede cell_size-te Zeile; ohne ist es
+  // ein Zeigertausch.
+  self->frames->inference.Offer(published, core::StatsAggregator::NowNs());
+  if (measure) {
+    self->frames->stats.RecordArrival(published->generation(),
+                                      core::StatsAggregator::NowNs());
+  }
+  self->frame_counter += 1U;
   
   // Flutter benachrichtigen, dass ein neues Frame verfügbar ist
   request_texture_frame_available(self, "appsink");
@@ -280,11 +536,10 @@ static GstFlowReturn on_new_sample(GstAppSink* appsink, gpointer user_data) {
 gboolean my_texture_set_pipeline(FlTexture* texture, const gchar* pipeline_description, GError** error) {
   MyTexture* self = MY_TEXTURE(texture);
   g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+  core::ScopedTrace trace("my_texture_set_pipeline");
 
   g_message("[my_texture] set_pipeline called: %s", pipeline_description ? pipeline_description : "<null>");
 
-  g_mutex_lock(&self->sample_mutex);
-
   if (self->appsink) {
     GstAppSinkCallbacks callbacks = {};
     gst_app_sink_set_callbacks(GST_APP_SINK(self->appsink), &callbacks, nullptr,
@@ -292,20 +547,37 @@ gboolean my_texture_set_pipeline(FlTexture* texture, const gchar* pipeline_descr
     gst_object_unref(self->appsink);
     self->appsink = nullptr;
   }
+  detach_mosaic_sinks(self);
   
   // Alte Pipeline aufräumen
+  finish_profile(self, "Pipeline wurde ersetzt");
   if (self->pipeline) {
     gst_element_set_state(self->pipeline, GST_STATE_NULL);
     gst_object_unref(self->pipeline);
     self->pipeline = nullptr;
   }
 
-  if (self->last_sample) {
-    gst_sample_unref(self->last_sample);
-    self->last_sample = nullptr;
-  }
+  self->frames->exchange.Reset();
+  self->frames->inference.Reset();
+  self->frames->tracker.Reset();
+  self->frames->mosaic.ClearSources();
+  self->frames->scrubber.reset();
+  self->frames->attached_history.reset();
 
-  g_mutex_unlock(&self->sample_mutex);
+  // Normalerweise schon beim Plugin-Start im Hintergrund erledigt.
+  core::GstRuntime& runtime = core::GstRuntime::Get();
+  runtime.WaitUntilReady();
+
+  // Ganze Beschreibung gegen den Factory-Index prüfen, bevor gst_parse_launch
+  // und ein langes Preroll anlaufen.
+  const core::PipelineValidation validation = core::ValidatePipeline(
+      pipeline_description ? pipeline_description : "",
+      runtime.element_index());
+  if (!validation.ok) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s",
+                validation.error.c_str());
+    return FALSE;
+  }
   
   // Neue Pipeline erstellen
   self->pipeline = gst_parse_launch(pipeline_description, error);
@@ -322,14 +594,51 @@ gboolean my_texture_set_pipeline(FlTexture* texture, const gchar* pipeline_descr
     self->pipeline = nullptr;
     return FALSE;
   }
+
+  // Streaming-Threads optional in den konfigurierten Pool verschieben
+  // (KATAGLYPHIS_GST_CPUS / KATAGLYPHIS_GST_NICE).
+  if (std::shared_ptr<core::StreamingThreadPool> pool =
+          core::StreamingThreadPool::Default()) {
+    pool->Attach(self->pipeline);
+  }
   
   // AppSink finden
   self->appsink = gst_bin_get_by_name(GST_BIN(self->pipeline), "sink");
-  if (!self->appsink || !GST_IS_APP_SINK(self->appsink)) {
-    if (self->appsink) {
-      gst_object_unref(self->appsink);
-      self->appsink = nullptr;
+  if (self->appsink && !GST_IS_APP_SINK(self->appsink)) {
+    gst_object_unref(self->appsink);
+    self->appsink = nullptr;
+  }
+
+  // RGBx zuerst: ohne Alpha in der Quelle wählt videoconvert es, und die
+  // Frames gelten als deckend (zero-copy in copy_pixels).
+  GstCaps* caps =
+      gst_caps_from_string("video/x-raw, format=(string){ RGBx, RGBA }");
+  // Alle übrigen appsinks speisen das Mosaik, benannt nach ihrem Element.
+  if (self->frames->mosaic.active()) {
+    GstIterator* it = gst_bin_iterate_recurse(GST_BIN(self->pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+      GstElement* element = GST_ELEMENT(g_value_get_object(&item));
+      if (GST_IS_APP_SINK(element) && element != self->appsink) {
+        gchar* name = gst_element_get_name(element);
+        auto sink = std::make_unique<MyTextureMosaicSink>();
+        sink->self = self;
+        sink->source = name;
+        sink->appsink = GST_ELEMENT(gst_object_ref(element));
+        g_free(name);
+        g_object_set(sink->appsink, "caps", caps, "emit-signals", TRUE,
+                     "sync", FALSE, "max-buffers", 1, "drop", TRUE, nullptr);
+        self->frames->mosaic_sinks.push_back(std::move(sink));
+      }
+      g_value_reset(&item);
     }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+  }
+
+  // Ohne Mosaik-Quellen bleibt `sink` Pflicht.
+  if (!self->appsink && self->frames->mosaic_sinks.empty()) {
+    gst_caps_unref(caps);
     if (error) {
       g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
                   "Pipeline muss ein appsink Element mit name='sink' enthalten");
@@ -338,10 +647,20 @@ gboolean my_texture_set_pipeline(FlTexture* texture, const gchar* pipeline_descr
     self->pipeline = nullptr;
     return FALSE;
   }
-  
+
+  for (const std::unique_ptr<MyTextureMosaicSink>& sink :
+       self->frames->mosaic_sinks) {
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = on_mosaic_sample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink->appsink), &callbacks,
+                               sink.get(), nullptr);
+  }
+  if (!self->appsink) {
+    gst_caps_unref(caps);
+    return TRUE;
+  }
+
   // AppSink konfigurieren
-  GstCaps* caps = gst_caps_new_simple("video/x-raw",
-                                      "format", G_TYPE_STRING, "RGBA", nullptr);
   g_object_set(self->appsink,
                "caps", caps,
                "emit-signals", TRUE,
@@ -351,43 +670,327 @@ gboolean my_texture_set_pipeline(FlTexture* texture, const gchar* pipeline_descr
                nullptr);
   gst_caps_unref(caps);
   
+  // Encoder-Zweig für die Vorlauf-Aufzeichnung vor den appsink hängen.
+  std::shared_ptr<core::HistoryRecorder> history;
+  {
+    std::lock_guard<std::mutex> lock(self->frames->history_mutex);
+    history = self->frames->history;
+  }
+  if (history) {
+    std::string message;
+    if (!history->Attach(self->pipeline, self->appsink, &message)) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+      detach_mosaic_sinks(self);
+      gst_object_unref(self->appsink);
+      self->appsink = nullptr;
+      gst_object_unref(self->pipeline);
+      self->pipeline = nullptr;
+      return FALSE;
+    }
+    if (history->options().encoded) {
+      self->frames->attached_history = history;
+    }
+  }
+
   // Callback registrieren
   GstAppSinkCallbacks callbacks = {};
   callbacks.new_sample = on_new_sample;
+  callbacks.new_preroll = on_new_preroll;
   gst_app_sink_set_callbacks(GST_APP_SINK(self->appsink), &callbacks, self, nullptr);
   
   return TRUE;
 }
 
-void my_texture_play(FlTexture* texture) {
+// Solange gescrubbt wird, gehört die Exchange dem Scrubber; die geparkte
+// Pipeline darf nicht dazwischen veröffentlichen.
+static gboolean reject_while_scrubbing(MyTexture* self, GError** error) {
+  if (!self->frames->scrubber) {
+    return FALSE;
+  }
+  g_set_error(error, G_IO_ERROR, G_IO_ERROR_BUSY,
+              "Scrubbing aktiv; zuerst closeScrub aufrufen");
+  return TRUE;
+}
+
+gboolean my_texture_play(FlTexture* texture, GError** error) {
   MyTexture* self = MY_TEXTURE(texture);
-  g_return_if_fail(MY_IS_TEXTURE(self));
-  
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+  core::ScopedTrace trace("my_texture_play");
+
+  if (reject_while_scrubbing(self, error)) {
+    return FALSE;
+  }
   if (self->pipeline) {
     const GstStateChangeReturn result =
         gst_element_set_state(self->pipeline, GST_STATE_PLAYING);
     g_message("[my_texture] set PLAYING result=%d", static_cast<int>(result));
   }
+  return TRUE;
 }
 
-void my_texture_pause(FlTexture* texture) {
+gboolean my_texture_pause(FlTexture* texture, GError** error) {
   MyTexture* self = MY_TEXTURE(texture);
-  g_return_if_fail(MY_IS_TEXTURE(self));
-  
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+  core::ScopedTrace trace("my_texture_pause");
+
+  if (reject_while_scrubbing(self, error)) {
+    return FALSE;
+  }
   if (self->pipeline) {
     gst_element_set_state(self->pipeline, GST_STATE_PAUSED);
   }
+  return TRUE;
 }
 
 void my_texture_stop(FlTexture* texture) {
   MyTexture* self = MY_TEXTURE(texture);
   g_return_if_fail(MY_IS_TEXTURE(self));
+  core::ScopedTrace trace("my_texture_stop");
   
   if (self->pipeline) {
     gst_element_set_state(self->pipeline, GST_STATE_NULL);
   }
 }
 
+// Zeigt ein Frame aus dem Scrub-Cache an. Die Exchange vergibt eigene
+// Generationen, daher wird das gecachte Frame nur umhüllt, nicht kopiert.
+static void publish_cached_frame(MyTexture* self, const core::FrameRef& frame) {
+  std::shared_ptr<core::Frame> wrapped = core::Frame::Wrap(
+      frame->data(), frame->width(), frame->height(), frame->stride(),
+      frame->size(), frame);
+  wrapped->set_opaque(frame->opaque());
+  self->frames->exchange.Publish(std::move(wrapped));
+  request_texture_frame_available(self, "scrub");
+}
+
+gboolean my_texture_open_scrub(FlTexture* texture, const gchar* input, guint64 budget_bytes, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  core::FrameScrubberOptions options;
+  if (budget_bytes > 0) {
+    options.budget_bytes = static_cast<size_t>(budget_bytes);
+  }
+  options.width = self->width;
+  options.height = self->height;
+  options.task_pool = core::StreamingThreadPool::Default();
+  auto scrubber = std::make_unique<core::FrameScrubber>(options);
+  std::string message;
+  if (!scrubber->Open(input ? input : "", &message)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+    return FALSE;
+  }
+  // Erst jetzt die Pipeline parken; schlägt Open fehl, läuft sie weiter.
+  // Sie bleibt gesetzt, damit close_scrub zu ihr zurückkehren kann.
+  if (self->pipeline) {
+    gst_element_set_state(self->pipeline, GST_STATE_NULL);
+  }
+  self->frames->scrubber = std::move(scrubber);
+
+  // Erstes Frame sofort zeigen.
+  gint64 shown = 0;
+  return my_texture_seek(texture, 0, &shown, error);
+}
+
+void my_texture_close_scrub(FlTexture* texture) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+  if (!self->frames->scrubber) {
+    return;
+  }
+  self->frames->scrubber.reset();
+  // Zurück zur geparkten Pipeline, pausiert: ihr Preroll-Frame ersetzt das
+  // letzte Scrub-Frame, play setzt sie fort. Ohne Pipeline bleibt dieses
+  // stehen.
+  if (self->pipeline) {
+    gst_element_set_state(self->pipeline, GST_STATE_PAUSED);
+  }
+}
+
+gboolean my_texture_seek(FlTexture* texture, gint64 position_ns, gint64* shown_ns, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  std::string message;
+  if (self->frames->scrubber) {
+    core::FrameRef frame = self->frames->scrubber->Seek(position_ns, &message);
+    if (!frame) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+      return FALSE;
+    }
+    publish_cached_frame(self, frame);
+    *shown_ns = frame->timestamp_ns();
+    return TRUE;
+  }
+  if (!self->pipeline) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Keine Pipeline gesetzt");
+    return FALSE;
+  }
+  // Das neue Frame kommt über new_preroll bzw. new_sample.
+  if (!core::SeekToFrame(self->pipeline, position_ns, kSeekTimeout, &message)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+    return FALSE;
+  }
+  *shown_ns = core::QueryPositionNs(self->pipeline);
+  return TRUE;
+}
+
+gboolean my_texture_step_frame(FlTexture* texture, gint frames, gint64* shown_ns, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  std::string message;
+  if (self->frames->scrubber) {
+    core::FrameRef frame = self->frames->scrubber->Step(frames, &message);
+    if (!frame) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+      return FALSE;
+    }
+    publish_cached_frame(self, frame);
+    *shown_ns = frame->timestamp_ns();
+    return TRUE;
+  }
+  if (!self->pipeline) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Keine Pipeline gesetzt");
+    return FALSE;
+  }
+  if (!core::StepFrames(self->pipeline, frames, kSeekTimeout, &message)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+    return FALSE;
+  }
+  *shown_ns = core::QueryPositionNs(self->pipeline);
+  return TRUE;
+}
+
+gboolean my_texture_snapshot(FlTexture* texture, const gchar* format, gint quality, const gchar* path, guint max_side, MyTextureSnapshotDone done, gpointer user_data, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  core::SnapshotRequest request;
+  if (format && !core::ParseImageFormat(format, &request.format)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Unbekanntes Format '%s' (png, jpeg, raw)", format);
+    return FALSE;
+  }
+  if (quality > 0) {
+    request.jpeg_quality = quality;
+  }
+  if (path) {
+    request.path = path;
+  }
+  request.max_side = max_side;
+  if (!self->frames->snapshots) {
+    self->frames->snapshots = std::make_unique<core::SnapshotService>();
+  }
+
+  // Nur eine Referenz auf das aktuelle Frame (GstSample bzw. Pool-Slot);
+  // zählt nicht als präsentiert.
+  std::string message;
+  const bool queued = self->frames->snapshots->Submit(
+      self->frames->exchange.PeekLatest(), std::move(request),
+      [done, user_data](core::SnapshotResult result) {
+        done(result.ok, result.error.c_str(),
+             core::ImageFormatName(result.format), result.bytes.data(),
+             result.bytes.size(), result.path.c_str(), result.width,
+             result.height, result.timestamp_ns, user_data);
+      },
+      &message);
+  if (!queued) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+    return FALSE;
+  }
+  return TRUE;
+}
+
+gboolean my_texture_export_frames(FlTexture* texture, guint slots, guint64 slot_bytes, gint* fd, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  std::shared_ptr<core::SharedFrameRingWriter> frame_export;
+  if (slots > 0) {
+    std::string message;
+    frame_export = core::SharedFrameRingWriter::Create(
+        "kataglyphis-frames", slots, static_cast<size_t>(slot_bytes), &message);
+    if (!frame_export) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+      return FALSE;
+    }
+  }
+  if (fd) {
+    *fd = frame_export ? frame_export->fd() : -1;
+  }
+  // Ein Streaming-Thread, der gerade in den alten Ring schreibt, hält ihn
+  // bis zum Ende des Frames selbst fest.
+  std::lock_guard<std::mutex> lock(self->frames->export_mutex);
+  self->frames->frame_export = std::move(frame_export);
+  return TRUE;
+}
+
+void my_texture_configure_history(FlTexture* texture, gdouble seconds, guint64 max_bytes, gboolean encoded, const gchar* encoder) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  std::shared_ptr<core::HistoryRecorder> history;
+  if (seconds > 0) {
+    core::HistoryRecorderOptions options;
+    options.history.window_ns = static_cast<int64_t>(seconds * 1e9);
+    if (max_bytes > 0) {
+      options.history.max_bytes = static_cast<size_t>(max_bytes);
+    }
+    options.encoded = encoded;
+    if (encoder && *encoder) {
+      options.encoder = encoder;
+    }
+    history = std::make_shared<core::HistoryRecorder>(options);
+  }
+  // Ein laufender Dump hält seine eigene Referenz nicht; der alte Recorder
+  // wartet im Destruktor auf ihn.
+  std::lock_guard<std::mutex> lock(self->frames->history_mutex);
+  self->frames->history = std::move(history);
+}
+
+gboolean my_texture_dump_history(FlTexture* texture, const gchar* path, gdouble seconds, MyTextureHistoryDumped done, gpointer user_data, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  std::shared_ptr<core::HistoryRecorder> history;
+  {
+    std::lock_guard<std::mutex> lock(self->frames->history_mutex);
+    history = self->frames->history;
+  }
+  if (!history) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Keine Aufzeichnung konfiguriert (configureHistory)");
+    return FALSE;
+  }
+  std::string message;
+  const bool started = history->Dump(
+      path ? path : "", seconds > 0 ? static_cast<int64_t>(seconds * 1e9) : 0,
+      [done, user_data](const core::HistoryDumpResult& result) {
+        done(result.ok, result.path.c_str(), result.error.c_str(),
+             result.frames, result.span_ns, user_data);
+      },
+      &message);
+  if (!started) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message.c_str());
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void my_texture_register_ffi(FlTexture* texture) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  self->ffi_texture_id = fl_texture_get_id(texture);
+  core::RegisterFfiTexture(self->ffi_texture_id,
+                           core::FfiTexture{&self->frames->exchange,
+                                            &self->frames->results,
+                                            &self->frames->stats,
+                                            &self->frames->inference,
+                                            &self->frames->tracker});
+}
+
 // Hilfsfunktion um den TextureRegistrar zu setzen
 void my_texture_set_texture_registrar(FlTexture* texture, FlTextureRegistrar* registrar) {
   MyTexture* self = MY_TEXTURE(texture);
@@ -395,4 +998,237 @@ void my_texture_set_texture_registrar(FlTexture* texture, FlTextureRegistrar* re
   self->texture_registrar = registrar;
   self->logged_no_registrar = FALSE;
   g_message("[my_texture] texture registrar assigned");
-}
\ No newline at end of file
+}
+
+void my_texture_set_results_listener(FlTexture* texture,
+                                     MyTextureResultsReady listener,
+                                     gpointer user_data) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+  self->results_listener = listener;
+  self->results_listener_data = user_data;
+  // Ein neuer Listener bekommt das aktuelle Ergebnis beim nächsten Paket.
+  self->frames->delivered_result_version = 0;
+}
+
+static gboolean emit_stats_window(gpointer user_data) {
+  MyTexture* self = MY_TEXTURE(user_data);
+  const core::StatsWindow window = self->frames->stats.Collect(
+      core::StatsAggregator::NowNs(),
+      self->frames->exchange.GetStats().frames_dropped);
+  std::vector<uint8_t> bytes;
+  core::EncodeStatsWindow(window, &bytes);
+  GBytes* packet = g_bytes_new(bytes.data(), bytes.size());
+  self->stats_listener(packet, self->stats_listener_data);
+  g_bytes_unref(packet);
+  return G_SOURCE_CONTINUE;
+}
+
+void my_texture_set_stats_listener(FlTexture* texture, guint window_ms,
+                                   MyTextureStatsReady listener,
+                                   gpointer user_data) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  if (self->stats_timer) {
+    g_source_remove(self->stats_timer);
+    self->stats_timer = 0;
+  }
+  self->stats_listener = window_ms > 0 ? listener : nullptr;
+  self->stats_listener_data = user_data;
+  if (!self->stats_listener) {
+    self->frames->stats_enabled.store(false);
+    return;
+  }
+  self->frames->stats.Start(core::StatsAggregator::NowNs(),
+                            self->frames->exchange.GetStats().frames_dropped);
+  self->frames->stats_enabled.store(true);
+  // Der Timer hält keine Referenz; dispose entfernt ihn.
+  self->stats_timer = g_timeout_add(window_ms, emit_stats_window, self);
+}
+
+static void finish_profile(MyTexture* self, const gchar* error_message) {
+  if (self->profile_timer) {
+    g_source_remove(self->profile_timer);
+    self->profile_timer = 0;
+  }
+  std::unique_ptr<core::PipelineProfiler> profiler =
+      std::move(self->frames->profiler);
+  MyTextureProfiled done = self->profile_done;
+  self->profile_done = nullptr;
+  if (!done) {
+    return;
+  }
+  if (error_message || !profiler) {
+    done(nullptr, error_message ? error_message : "Kein Profiling aktiv",
+         self->profile_done_data);
+    return;
+  }
+  const std::vector<core::ElementProfile> profiles = profiler->Snapshot();
+  // Sonden entfernen, bevor der Empfänger etwas Langsames tut.
+  profiler.reset();
+
+  g_autoptr(FlValue) elements = fl_value_new_list();
+  for (const core::ElementProfile& profile : profiles) {
+    FlValue* element = fl_value_new_map();
+    fl_value_set_string_take(element, "name",
+                             fl_value_new_string(profile.name.c_str()));
+    fl_value_set_string_take(element, "factory",
+                             fl_value_new_string(profile.factory.c_str()));
+    fl_value_set_string_take(element, "buffers",
+                             fl_value_new_int(static_cast<int64_t>(profile.buffers)));
+    fl_value_set_string_take(element, "rateHz", fl_value_new_float(profile.rate_hz));
+    fl_value_set_string_take(
+        element, "processingSamples",
+        fl_value_new_int(static_cast<int64_t>(profile.processing_samples)));
+    fl_value_set_string_take(element, "processingMeanMs",
+                             fl_value_new_float(profile.processing_mean_ms));
+    fl_value_set_string_take(element, "processingP50Ms",
+                             fl_value_new_float(profile.processing_p50_ms));
+    fl_value_set_string_take(element, "processingP95Ms",
+                             fl_value_new_float(profile.processing_p95_ms));
+    fl_value_set_string_take(element, "processingMaxMs",
+                             fl_value_new_float(profile.processing_max_ms));
+    if (profile.is_queue) {
+      fl_value_set_string_take(element, "queueFillMean",
+                               fl_value_new_float(profile.queue_fill_mean));
+      fl_value_set_string_take(element, "queueFillMax",
+                               fl_value_new_int(profile.queue_fill_max));
+      fl_value_set_string_take(element, "queueCapacity",
+                               fl_value_new_int(profile.queue_capacity));
+    }
+    fl_value_append_take(elements, element);
+  }
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "table",
+      fl_value_new_string(core::FormatProfileTable(profiles).c_str()));
+  fl_value_set_string(result, "elements", elements);
+  done(result, nullptr, self->profile_done_data);
+}
+
+static gboolean on_profile_timeout(gpointer user_data) {
+  MyTexture* self = MY_TEXTURE(user_data);
+  self->profile_timer = 0;
+  finish_profile(self, nullptr);
+  return G_SOURCE_REMOVE;
+}
+
+gboolean my_texture_profile_pipeline(FlTexture* texture, guint duration_ms,
+                                     MyTextureProfiled done,
+                                     gpointer user_data, GError** error) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_val_if_fail(MY_IS_TEXTURE(self), FALSE);
+
+  if (!self->pipeline) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Keine Pipeline gesetzt");
+    return FALSE;
+  }
+  if (self->profile_done) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_BUSY, "Profiling läuft bereits");
+    return FALSE;
+  }
+  self->frames->profiler =
+      std::make_unique<core::PipelineProfiler>(self->pipeline);
+  self->profile_done = done;
+  self->profile_done_data = user_data;
+  // Wie beim Statistik-Timer ohne Referenz; dispose beendet das Profiling.
+  self->profile_timer =
+      g_timeout_add(std::max<guint>(duration_ms, 1), on_profile_timeout, self);
+  return TRUE;
+}
+
+void my_texture_configure_motion_gate(FlTexture* texture, gboolean enabled,
+                                      guint cell_size, gdouble mean_threshold,
+                                      guint cell_threshold,
+                                      gdouble changed_fraction,
+                                      guint keep_alive_ms,
+                                      const gdouble* regions,
+                                      gsize region_count) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  if (!enabled) {
+    self->frames->inference.SetMotionGate(nullptr);
+    return;
+  }
+  core::MotionGateOptions options;
+  options.cell_size = cell_size;
+  options.mean_threshold = static_cast<float>(mean_threshold);
+  options.cell_threshold = static_cast<uint8_t>(std::min<guint>(cell_threshold, 255));
+  options.changed_fraction = static_cast<float>(changed_fraction);
+  options.keep_alive_ns = static_cast<int64_t>(keep_alive_ms) * 1000000;
+  for (gsize i = 0; i < region_count; ++i) {
+    const gdouble* r = regions + i * 4;
+    options.regions.push_back(core::MotionRegion{
+        static_cast<float>(r[0]), static_cast<float>(r[1]),
+        static_cast<float>(r[2]), static_cast<float>(r[3])});
+  }
+  // Der neue Filter beginnt mit einem Referenzframe von vorn.
+  self->frames->inference.SetMotionGate(
+      std::make_shared<core::MotionGate>(std::move(options)));
+}
+
+void my_texture_configure_tracker(FlTexture* texture, gboolean enabled,
+                                  gdouble iou_threshold, guint max_misses,
+                                  guint max_coast_ms) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  core::ObjectTrackerOptions options;
+  options.iou_threshold = static_cast<float>(iou_threshold);
+  options.max_misses = max_misses;
+  options.max_coast_ns = static_cast<int64_t>(max_coast_ms) * 1000000;
+  // Verwirft bestehende Tracks; die IDs beginnen nicht von vorn.
+  self->frames->tracker.Configure(enabled, options);
+}
+
+void my_texture_configure_inference_rate(FlTexture* texture, gboolean enabled,
+                                         gdouble max_fps,
+                                         guint target_latency_ms) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  core::InferenceRateOptions options;
+  options.max_fps = static_cast<float>(max_fps);
+  options.target_latency_ns = static_cast<int64_t>(target_latency_ms) * 1000000;
+  self->frames->inference.ConfigureRate(enabled, options);
+}
+
+void my_texture_configure_pyramid(FlTexture* texture, guint levels) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  // Greift ab dem nächsten Frame.
+  self->frames->pyramid_levels.store(levels, std::memory_order_relaxed);
+}
+
+void my_texture_configure_mosaic(FlTexture* texture, guint width,
+                                 guint height, guint32 background_rgba,
+                                 const gchar* const* sources,
+                                 const gdouble* rects, const gboolean* fits,
+                                 gsize count) {
+  MyTexture* self = MY_TEXTURE(texture);
+  g_return_if_fail(MY_IS_TEXTURE(self));
+
+  core::MosaicLayout layout;
+  layout.width = width;
+  layout.height = height;
+  for (int i = 0; i < 4; ++i) {
+    layout.background[i] =
+        static_cast<uint8_t>(background_rgba >> (24 - 8 * i));
+  }
+  for (gsize i = 0; i < count; ++i) {
+    core::MosaicTile tile;
+    tile.source = sources[i];
+    tile.left = static_cast<float>(rects[4 * i]);
+    tile.top = static_cast<float>(rects[4 * i + 1]);
+    tile.width = static_cast<float>(rects[4 * i + 2]);
+    tile.height = static_cast<float>(rects[4 * i + 3]);
+    tile.fit = fits[i];
+    layout.tiles.push_back(std::move(tile));
+  }
+  // Kacheln wirken sofort; neue Quellen erst mit der nächsten Pipeline.
+  self->frames->mosaic.SetLayout(std::move(layout));
+  request_texture_frame_available(self, "mosaic");
+}
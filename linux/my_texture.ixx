@@ -12,8 +12,99 @@ export void my_texture_set_color(FlTexture* texture, uint8_t r, uint8_t g, uint8
 
 export void my_texture_set_texture_registrar(FlTexture* texture, FlTextureRegistrar* registrar);
 
+// Meldet die Textur nach der Registrierung beim FFI-Schnellpfad an
+// (knt_acquire_frame & Co.); dispose meldet sie wieder ab.
+export void my_texture_register_ffi(FlTexture* texture);
+
 export gboolean my_texture_set_pipeline(FlTexture* texture, const gchar* pipeline_description, GError** error);
 
-export void my_texture_play(FlTexture* texture);
-export void my_texture_pause(FlTexture* texture);
-export void my_texture_stop(FlTexture* texture);
\ No newline at end of file
+// Schlagen fehl, solange gescrubbt wird.
+export gboolean my_texture_play(FlTexture* texture, GError** error);
+export gboolean my_texture_pause(FlTexture* texture, GError** error);
+export void my_texture_stop(FlTexture* texture);
+
+// Frame-genaues Scrubbing einer Datei mit Cache. Erst wenn die Datei offen
+// ist, wird die Pipeline gestoppt und geparkt; play/pause sind bis
+// close_scrub gesperrt. close_scrub kehrt pausiert zu ihr zurück (ohne
+// Pipeline bleibt das letzte Scrub-Frame stehen); set_pipeline beendet das
+// Scrubbing ebenfalls.
+export gboolean my_texture_open_scrub(FlTexture* texture, const gchar* input, guint64 budget_bytes, GError** error);
+export void my_texture_close_scrub(FlTexture* texture);
+export gboolean my_texture_seek(FlTexture* texture, gint64 position_ns, gint64* shown_ns, GError** error);
+export gboolean my_texture_step_frame(FlTexture* texture, gint frames, gint64* shown_ns, GError** error);
+
+// Vorlauf-Aufzeichnung: die letzten Sekunden pro Textur im Speicher halten.
+// `encoded` wirkt ab dem nächsten set_pipeline; seconds <= 0 schaltet ab.
+export void my_texture_configure_history(FlTexture* texture, gdouble seconds, guint64 max_bytes, gboolean encoded, const gchar* encoder);
+
+// Aufruf auf dem Schreib-Thread, wenn die Datei fertig ist.
+export using MyTextureHistoryDumped = void (*)(gboolean ok, const gchar* path, const gchar* error, guint64 frames, gint64 span_ns, gpointer user_data);
+export gboolean my_texture_dump_history(FlTexture* texture, const gchar* path, gdouble seconds, MyTextureHistoryDumped done, gpointer user_data, GError** error);
+
+// Schnappschuss des aktuellen Frames ohne Kopie; Kodierung ("png", "jpeg",
+// "raw") und Schreiben laufen im Worker-Pool. `bytes` ist leer, wenn nach
+// `path` geschrieben wurde. Mit `max_side` > 0 wird als Vorschaubild die
+// größte passende Pyramidenstufe kodiert (configure_pyramid). Aufruf auf dem
+// Worker-Thread.
+export using MyTextureSnapshotDone = void (*)(gboolean ok, const gchar* error, const gchar* format, const guint8* bytes, gsize size, const gchar* path, guint32 width, guint32 height, gint64 timestamp_ns, gpointer user_data);
+export gboolean my_texture_snapshot(FlTexture* texture, const gchar* format, gint quality, const gchar* path, guint max_side, MyTextureSnapshotDone done, gpointer user_data, GError** error);
+
+// Kopiert jedes neue Frame in einen memfd-Ring für Sidecar-Prozesse
+// (/proc/<pid>/fd/<fd>). slots == 0 schaltet den Export ab. Frames über
+// `slot_bytes` werden ausgelassen.
+export gboolean my_texture_export_frames(FlTexture* texture, guint slots, guint64 slot_bytes, gint* fd, GError** error);
+
+// Boxen der Inferenz-Elemente (ROI-Metas) als gepacktes Binärpaket, siehe
+// detection_packet.h. Der Listener läuft auf dem Main-Thread und bekommt
+// pro Durchlauf der Hauptschleife nur das neueste Paket; null schaltet ab.
+export using MyTextureResultsReady = void (*)(GBytes* packet, gpointer user_data);
+export void my_texture_set_results_listener(FlTexture* texture, MyTextureResultsReady listener, gpointer user_data);
+
+// Fasst alle `window_ms` Millisekunden Framerate, Latenz, Drops, Kopier- und
+// Inferenzzeit zusammen (stats_aggregator.h) und übergibt das Binärpaket
+// auf dem Main-Thread an den Listener. Ohne Listener wird nichts gemessen;
+// null oder window_ms == 0 schaltet ab.
+export using MyTextureStatsReady = void (*)(GBytes* window, gpointer user_data);
+export void my_texture_set_stats_listener(FlTexture* texture, guint window_ms, MyTextureStatsReady listener, gpointer user_data);
+
+// Bewegungsfilter vor knt_acquire_inference_frame (motion_gate.h): Frames
+// einer unveränderten Szene erreichen die Inferenz nicht, höchstens alle
+// `keep_alive_ms` eines (0: nie). `regions` sind region_count normierte
+// Rechtecke {left, top, width, height}; keine heißt ganzes Bild.
+export void my_texture_configure_motion_gate(FlTexture* texture, gboolean enabled, guint cell_size, gdouble mean_threshold, guint cell_threshold, gdouble changed_fraction, guint keep_alive_ms, const gdouble* regions, gsize region_count);
+
+// Ratenregelung vor knt_acquire_inference_frame: lässt Frames höchstens so
+// schnell durch, wie die Inferenz sie laut knt_report_inference_time
+// abarbeitet (und nie öfter als `max_fps`, 0: unbegrenzt). Mit
+// `target_latency_ms` > 0 wird zusätzlich gedrosselt, solange Ergebnisse
+// älter als das Ziel sind.
+export void my_texture_configure_inference_rate(FlTexture* texture, gboolean enabled, gdouble max_fps, guint target_latency_ms);
+
+// Bildpyramide (frame_pyramid.h): baut je Frame `levels` halbierte Stufen
+// (1/2, 1/4, ...) aus dem Pool, die Bewegungsfilter, knt_map_frame_level
+// und Vorschaubilder lesen, statt selbst das volle Bild zu skalieren.
+// 0 schaltet sie ab.
+export void my_texture_configure_pyramid(FlTexture* texture, guint levels);
+
+// Mosaik (mosaic_compositor.h): setzt die Frames mehrerer appsinks der
+// Pipeline zu einer `width` x `height` großen Fläche zusammen, die die
+// Textur statt `sink` zeigt. Kachel i zeigt den appsink `sources[i]` im
+// normierten Rechteck rects[4i..4i+3] (links, oben, Breite, Höhe), mit
+// `fits[i]` im Seitenverhältnis der Quelle. Neue Quellen greifen ab dem
+// nächsten set_pipeline; `count` 0 schaltet das Mosaik ab.
+export void my_texture_configure_mosaic(FlTexture* texture, guint width, guint height, guint32 background_rgba, const gchar* const* sources, const gdouble* rects, const gboolean* fits, gsize count);
+
+// Objekt-Tracker (object_tracker.h): führt die Boxen von Inferenz-Keyframes
+// über die Frames dazwischen fort und vergibt Track-IDs. Tracks ohne
+// Treffer fallen nach `max_misses` Keyframes bzw. `max_coast_ms` weg.
+// Keyframes aus ROI-Metas sind nur Frames mit mindestens einer Box; sieht
+// der Detektor gar nichts mehr, beendet allein `max_coast_ms` die Tracks.
+export void my_texture_configure_tracker(FlTexture* texture, gboolean enabled, gdouble iou_threshold, guint max_misses, guint max_coast_ms);
+
+// Misst Verarbeitungszeit, Pufferrate und Queue-Füllstand jedes Elements
+// der aktuellen Pipeline für `duration_ms` Millisekunden (pipeline_profiler.h)
+// und übergibt dann {table, elements} auf dem Main-Thread. Bei Fehlern
+// (Pipeline ersetzt, Textur freigegeben) ist `result` null. Nur ein Lauf
+// gleichzeitig.
+export using MyTextureProfiled = void (*)(FlValue* result, const gchar* error, gpointer user_data);
+export gboolean my_texture_profile_pipeline(FlTexture* texture, guint duration_ms, MyTextureProfiled done, gpointer user_data, GError** error);
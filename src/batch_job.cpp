@@ -0,0 +1,133 @@
+#include "kataglyphis_native_core/batch_job.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+void AppendJsonString(std::string* out, const std::string& text) {
+  *out += '"';
+  for (const char c : text) {
+    switch (c) {
+      case '"':
+        *out += "\\\"";
+        break;
+      case '\\':
+        *out += "\\\\";
+        break;
+      case '\n':
+        *out += "\\n";
+        break;
+      case '\r':
+        *out += "\\r";
+        break;
+      case '\t':
+        *out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                        static_cast<unsigned>(static_cast<unsigned char>(c)));
+          *out += escaped;
+        } else {
+          *out += c;
+        }
+    }
+  }
+  *out += '"';
+}
+
+}  // namespace
+
+std::vector<BatchSegment> PlanBatchSegments(
+    const std::vector<int64_t>& durations_ns, uint32_t max_segments_per_file,
+    int64_t min_segment_ns) {
+  std::vector<BatchSegment> segments;
+  for (size_t file = 0; file < durations_ns.size(); ++file) {
+    const int64_t duration = durations_ns[file];
+    int64_t count = 1;
+    if (duration > 0 && min_segment_ns > 0) {
+      count = std::clamp<int64_t>(duration / min_segment_ns, 1,
+                                  std::max<uint32_t>(max_segments_per_file, 1));
+    }
+    for (int64_t i = 0; i < count; ++i) {
+      BatchSegment segment;
+      segment.file_index = file;
+      segment.index = static_cast<size_t>(i);
+      segment.start_ns = duration * i / count;
+      segment.end_ns = i + 1 == count ? -1 : duration * (i + 1) / count;
+      segments.push_back(segment);
+    }
+  }
+  return segments;
+}
+
+std::string FormatBatchResultJson(const BatchResult& result,
+                                  const std::string& file) {
+  std::string line = "{\"file\":";
+  AppendJsonString(&line, file);
+  line += ",\"segment\":" + std::to_string(result.segment_index) +
+          ",\"frame\":" + std::to_string(result.frame_index) +
+          ",\"pts_ns\":" + std::to_string(result.timestamp_ns) +
+          ",\"width\":" + std::to_string(result.width) +
+          ",\"height\":" + std::to_string(result.height);
+  if (!result.payload.empty()) {
+    line += ",\"result\":" + result.payload;
+  }
+  line += '}';
+  return line;
+}
+
+BatchResultWriter::~BatchResultWriter() { Close(nullptr); }
+
+bool BatchResultWriter::Open(const std::string& path,
+                             std::vector<std::string> files,
+                             std::string* error) {
+  Close(nullptr);
+  file_ = std::fopen(path.c_str(), "w");
+  if (!file_) {
+    if (error) {
+      *error = "Cannot open '" + path + "': " + std::strerror(errno);
+    }
+    return false;
+  }
+  // Results are small and frequent.
+  std::setvbuf(file_, nullptr, _IOFBF, 1 << 16);
+  files_ = std::move(files);
+  written_ = 0;
+  failed_ = false;
+  return true;
+}
+
+void BatchResultWriter::Write(const BatchResult& result) {
+  if (!file_) return;
+  static const std::string kUnknown;
+  const std::string& name =
+      result.file_index < files_.size() ? files_[result.file_index] : kUnknown;
+  std::string line = FormatBatchResultJson(result, name);
+  line += '\n';
+  if (std::fwrite(line.data(), 1, line.size(), file_) != line.size()) {
+    failed_ = true;
+    return;
+  }
+  ++written_;
+}
+
+bool BatchResultWriter::Close(std::string* error) {
+  if (!file_) return !failed_;
+  const bool closed = std::fclose(file_) == 0;
+  file_ = nullptr;
+  if ((failed_ || !closed) && error) {
+    *error = "Writing batch results failed";
+  }
+  return !failed_ && closed;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
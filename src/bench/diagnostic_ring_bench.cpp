@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+
+#include "kataglyphis_native_core/diagnostic_ring.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace {
+
+// An error storm: every streaming thread reporting into one ring.
+void BM_DiagnosticRecord(benchmark::State& state) {
+  static DiagnosticRing ring(256);
+  for (auto _ : state) {
+    ring.Record(DiagnosticSeverity::kError, "v4l2src0", 1,
+                "Could not read from resource.",
+                "gstv4l2bufferpool.c(1220): poll error 1: Success (0)");
+  }
+}
+BENCHMARK(BM_DiagnosticRecord)->Threads(1)->Threads(4);
+
+void BM_DiagnosticRecent(benchmark::State& state) {
+  DiagnosticRing ring(256);
+  for (int i = 0; i < 256; ++i) {
+    ring.Record(DiagnosticSeverity::kWarning, "queue0", i, "overrun");
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ring.Recent(32));
+  }
+}
+BENCHMARK(BM_DiagnosticRecent);
+
+}  // namespace
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "kataglyphis_native_core/frame_exchange.h"
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace {
+
+void BM_PushCopyAcquire(benchmark::State& state) {
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4, 0x42);
+  FrameExchange exchange;
+  for (auto _ : state) {
+    exchange.PushCopy(frame.data(), width, height);
+    benchmark::DoNotOptimize(exchange.AcquireLatest());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_PushCopyAcquire)->Args({640, 480})->Args({1920, 1080});
+
+void BM_PushLentAcquire(benchmark::State& state) {
+  std::vector<uint8_t> frame(1920 * 1080 * 4, 0x42);
+  FrameExchange exchange;
+  const auto release = [](void*) {};
+  for (auto _ : state) {
+    exchange.PushLent(frame.data(), 1920, 1080, release, nullptr);
+    benchmark::DoNotOptimize(exchange.AcquireLatest());
+  }
+}
+BENCHMARK(BM_PushLentAcquire);
+
+void BM_CopyRgbaFrameStrided(benchmark::State& state) {
+  constexpr uint32_t kWidth = 1920;
+  constexpr uint32_t kHeight = 1080;
+  constexpr size_t kStride = kWidth * 4 + 64;
+  std::vector<uint8_t> src(kStride * kHeight, 0x42);
+  std::vector<uint8_t> dst(static_cast<size_t>(kWidth) * kHeight * 4);
+  for (auto _ : state) {
+    CopyRgbaFrame(src.data(), src.size(), kStride, kWidth, kHeight,
+                  dst.data(), kWidth, kHeight, state.range(0) != 0);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(dst.size()));
+}
+BENCHMARK(BM_CopyRgbaFrameStrided)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+#include "kataglyphis_native_core/frame_pool.h"
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace {
+
+// Three levels (1/2, 1/4, 1/8) of a 1080p frame from a warm pool.
+void BM_FramePyramidBuild(benchmark::State& state) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 1920, 1080);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(),
+            0x42);
+  auto pool = FramePool::Create(8);
+  const uint32_t levels = static_cast<uint32_t>(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FramePyramid::Build(*frame, levels, pool.get()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame->size()));
+}
+BENCHMARK(BM_FramePyramidBuild)->Arg(1)->Arg(3);
+
+}  // namespace
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/mosaic_compositor.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace {
+
+// A 4x4 wall of 1080p feeds on a 1080p surface; every feed has a new frame
+// each composition, the worst case.
+void BM_MosaicComposeAllTiles(benchmark::State& state) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 1920, 1080);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(),
+            0x42);
+  MosaicLayout layout;
+  layout.width = 1920;
+  layout.height = 1080;
+  for (int i = 0; i < 16; ++i) {
+    layout.tiles.push_back(MosaicTile{"cam" + std::to_string(i),
+                                      (i % 4) * 0.25f, (i / 4) * 0.25f, 0.25f,
+                                      0.25f, true});
+  }
+  MosaicCompositor mosaic;
+  mosaic.SetLayout(layout);
+  for (auto _ : state) {
+    for (const MosaicTile& tile : layout.tiles) {
+      mosaic.Submit(tile.source, frame);
+    }
+    benchmark::DoNotOptimize(mosaic.Compose());
+  }
+}
+BENCHMARK(BM_MosaicComposeAllTiles);
+
+void BM_ScaleRgbaBilinear(benchmark::State& state) {
+  std::vector<uint8_t> src(960 * 540 * 4, 0x42);
+  std::vector<uint8_t> dst(640 * 360 * 4);
+  std::vector<uint8_t> row;
+  for (auto _ : state) {
+    ScaleRgbaBilinear(src.data(), 960 * 4, 960, 540, dst.data(), 640 * 4, 640,
+                      360, &row);
+    benchmark::DoNotOptimize(dst.data());
+  }
+}
+BENCHMARK(BM_ScaleRgbaBilinear);
+
+}  // namespace
+}  // namespace core
+}  // namespace kataglyphis_native_inference
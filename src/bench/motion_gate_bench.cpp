@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kataglyphis_native_core/motion_gate.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace {
+
+// Full gate decision on a static 1080p scene: luma grid plus masked SAD.
+void BM_MotionGateEvaluate(benchmark::State& state) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 1920, 1080);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(),
+            0x42);
+  MotionGateOptions options;
+  options.cell_size = static_cast<uint32_t>(state.range(0));
+  options.keep_alive_ns = 0;
+  MotionGate gate(options);
+  int64_t now = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gate.Evaluate(*frame, ++now));
+  }
+}
+BENCHMARK(BM_MotionGateEvaluate)->Arg(4)->Arg(8)->Arg(16);
+
+void BM_MaskedAbsDiff(benchmark::State& state) {
+  const size_t count = static_cast<size_t>(state.range(0));
+  std::vector<uint8_t> a(count, 10);
+  std::vector<uint8_t> b(count, 30);
+  std::vector<uint8_t> mask(count, 0xFF);
+  uint64_t sum = 0;
+  uint64_t changed = 0;
+  for (auto _ : state) {
+    MaskedAbsDiff(a.data(), b.data(), mask.data(), count, 16, &sum, &changed);
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(changed);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(count));
+}
+BENCHMARK(BM_MaskedAbsDiff)->Arg(240 * 135)->Arg(1 << 20);
+
+}  // namespace
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/pipeline_validator.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace {
+
+// Roughly the size of a real registry.
+ElementFactoryIndex LargeIndex() {
+  std::vector<std::string> names = {"v4l2src", "queue", "tee",
+                                    "videoconvert", "videoscale", "appsink"};
+  for (int i = 0; i < 1500; ++i) {
+    names.push_back("element" + std::to_string(i));
+  }
+  return ElementFactoryIndex(std::move(names));
+}
+
+void BM_ValidatePipeline(benchmark::State& state) {
+  const ElementFactoryIndex index = LargeIndex();
+  const std::string description =
+      "v4l2src device=/dev/video0 ! video/x-raw,width=1280,height=720 ! "
+      "tee name=t t. ! queue leaky=downstream max-size-buffers=2 ! "
+      "videoconvert ! videoscale ! video/x-raw,format=RGBA ! "
+      "appsink name=sink sync=false t. ! queue ! appsink name=history";
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ValidatePipeline(description, index));
+  }
+}
+BENCHMARK(BM_ValidatePipeline);
+
+}  // namespace
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,132 @@
+#include "kataglyphis_native_core/detection_packet.h"
+
+#include <cstring>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Explicit byte order, so the packet reads the same on any host.
+void PutU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void PutU64(uint8_t* out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void PutF32(uint8_t* out, float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  PutU32(out, bits);
+}
+
+uint16_t GetU16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* in) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) value = (value << 8) | in[i];
+  return value;
+}
+
+uint64_t GetU64(const uint8_t* in) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) value = (value << 8) | in[i];
+  return value;
+}
+
+float GetF32(const uint8_t* in) {
+  const uint32_t bits = GetU32(in);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+size_t DetectionPacketSize(size_t count) {
+  return kDetectionPacketHeaderBytes + kDetectionPacketArrays * 4 * count;
+}
+
+void EncodeDetections(const DetectionSet& set, std::vector<uint8_t>* out) {
+  const size_t count = set.detections.size();
+  out->assign(DetectionPacketSize(count), 0);
+  uint8_t* header = out->data();
+  PutU32(header, kDetectionPacketMagic);
+  PutU16(header + 4, kDetectionPacketVersion);
+  PutU16(header + 6, static_cast<uint16_t>(kDetectionPacketHeaderBytes));
+  PutU32(header + 8, static_cast<uint32_t>(count));
+  PutU32(header + 12, set.flags);
+  PutU64(header + 16, set.frame_generation);
+  PutU64(header + 24, static_cast<uint64_t>(set.timestamp_ns));
+  PutU32(header + 32, set.frame_width);
+  PutU32(header + 36, set.frame_height);
+
+  // Struct of arrays: column k of detection i sits at array k, index i.
+  uint8_t* arrays = header + kDetectionPacketHeaderBytes;
+  const size_t column = 4 * count;
+  for (size_t i = 0; i < count; ++i) {
+    const Detection& detection = set.detections[i];
+    uint8_t* cell = arrays + 4 * i;
+    PutF32(cell, detection.left);
+    PutF32(cell + column, detection.top);
+    PutF32(cell + 2 * column, detection.width);
+    PutF32(cell + 3 * column, detection.height);
+    PutF32(cell + 4 * column, detection.score);
+    PutU32(cell + 5 * column, static_cast<uint32_t>(detection.class_id));
+    PutU32(cell + 6 * column, static_cast<uint32_t>(detection.track_id));
+  }
+}
+
+bool DecodeDetections(const uint8_t* data, size_t size, DetectionSet* set) {
+  if (!data || size < kDetectionPacketHeaderBytes ||
+      GetU32(data) != kDetectionPacketMagic) {
+    return false;
+  }
+  const uint16_t version = GetU16(data + 4);
+  if (version != 1 && version != kDetectionPacketVersion) {
+    return false;
+  }
+  const size_t arrays_count = version == 1 ? 6 : kDetectionPacketArrays;
+  const size_t header_bytes = GetU16(data + 6);
+  const size_t count = GetU32(data + 8);
+  if (header_bytes < kDetectionPacketHeaderBytes || header_bytes % 4 != 0 ||
+      size < header_bytes ||
+      (size - header_bytes) / (arrays_count * 4) < count) {
+    return false;
+  }
+  set->flags = version == 1 ? 0 : GetU32(data + 12);
+  set->frame_generation = GetU64(data + 16);
+  set->timestamp_ns = static_cast<int64_t>(GetU64(data + 24));
+  set->frame_width = GetU32(data + 32);
+  set->frame_height = GetU32(data + 36);
+  set->detections.resize(count);
+
+  const uint8_t* arrays = data + header_bytes;
+  const size_t column = 4 * count;
+  for (size_t i = 0; i < count; ++i) {
+    Detection& detection = set->detections[i];
+    const uint8_t* cell = arrays + 4 * i;
+    detection.left = GetF32(cell);
+    detection.top = GetF32(cell + column);
+    detection.width = GetF32(cell + 2 * column);
+    detection.height = GetF32(cell + 3 * column);
+    detection.score = GetF32(cell + 4 * column);
+    detection.class_id = static_cast<int32_t>(GetU32(cell + 5 * column));
+    detection.track_id =
+        version == 1 ? -1
+                     : static_cast<int32_t>(GetU32(cell + 6 * column));
+  }
+  return true;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
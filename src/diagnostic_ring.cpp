@@ -0,0 +1,129 @@
+#include "kataglyphis_native_core/diagnostic_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 2;
+  while (result < value) result <<= 1;
+  return result;
+}
+
+// Copies `text` into `dest` starting at `offset`, truncating so the result
+// stays NUL-terminated. Returns the new length.
+size_t AppendTruncated(char* dest, size_t dest_size, size_t offset,
+                       std::string_view text) {
+  const size_t count = std::min(text.size(), dest_size - 1 - offset);
+  std::memcpy(dest + offset, text.data(), count);
+  dest[offset + count] = '\0';
+  return offset + count;
+}
+
+}  // namespace
+
+DiagnosticRing::DiagnosticRing(size_t capacity)
+    : slots_(RoundUpToPowerOfTwo(capacity)), mask_(slots_.size() - 1) {}
+
+void DiagnosticRing::Record(DiagnosticSeverity severity,
+                            std::string_view source, int32_t code,
+                            std::string_view message,
+                            std::string_view detail) {
+  const uint64_t sequence = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[sequence & mask_];
+  const uint64_t writing = 2 * sequence + 1;
+
+  uint64_t state = slot.state.load(std::memory_order_relaxed);
+  do {
+    // Odd: another writer is mid-copy. Newer: a later lap already won.
+    if ((state & 1) != 0 || state > writing) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  } while (!slot.state.compare_exchange_weak(state, writing,
+                                             std::memory_order_relaxed));
+  // Orders the odd state before the payload writes for readers.
+  std::atomic_thread_fence(std::memory_order_release);
+
+  DiagnosticRecord& record = slot.record;
+  record.sequence = sequence;
+  record.timestamp_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  record.severity = severity;
+  record.code = code;
+  AppendTruncated(record.source, sizeof(record.source), 0, source);
+  size_t length =
+      AppendTruncated(record.message, sizeof(record.message), 0, message);
+  if (!detail.empty()) {
+    length = AppendTruncated(record.message, sizeof(record.message), length,
+                             "; ");
+    AppendTruncated(record.message, sizeof(record.message), length, detail);
+  }
+
+  slot.state.store(writing + 1, std::memory_order_release);
+}
+
+std::vector<DiagnosticRecord> DiagnosticRing::Recent(size_t max_records,
+                                                     uint64_t since) const {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t first = head > slots_.size() ? head - slots_.size() : 0;
+  first = std::max(first, since);
+  if (head > first && head - first > max_records) first = head - max_records;
+
+  std::vector<DiagnosticRecord> records;
+  if (head <= first) return records;
+  records.reserve(static_cast<size_t>(head - first));
+  for (uint64_t sequence = first; sequence < head; ++sequence) {
+    const Slot& slot = slots_[sequence & mask_];
+    const uint64_t done = 2 * sequence + 2;
+    if (slot.state.load(std::memory_order_acquire) != done) continue;
+    DiagnosticRecord copy = slot.record;
+    // Orders the payload reads before the re-check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.state.load(std::memory_order_relaxed) != done) continue;
+    records.push_back(copy);
+  }
+  return records;
+}
+
+const char* SeverityToString(DiagnosticSeverity severity) {
+  switch (severity) {
+    case DiagnosticSeverity::kInfo: return "info";
+    case DiagnosticSeverity::kWarning: return "warning";
+    case DiagnosticSeverity::kError: return "error";
+  }
+  return "unknown";
+}
+
+std::string FormatDiagnostic(const DiagnosticRecord& record) {
+  std::string line = SeverityToString(record.severity);
+  line += ' ';
+  if (record.source[0] != '\0') {
+    line += record.source;
+    line += ": ";
+  }
+  line += record.message;
+  if (record.code != 0) {
+    line += " (code " + std::to_string(record.code) + ")";
+  }
+  return line;
+}
+
+std::string FormatDiagnostics(const std::vector<DiagnosticRecord>& records) {
+  std::string text;
+  for (const DiagnosticRecord& record : records) {
+    if (!text.empty()) text += '\n';
+    text += FormatDiagnostic(record);
+  }
+  return text;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,232 @@
+#include "kataglyphis_native_core/ffi_api.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+std::mutex g_ffi_textures_mutex;
+std::unordered_map<int64_t, FfiTexture>& FfiTextures() {
+  static std::unordered_map<int64_t, FfiTexture> textures;
+  return textures;
+}
+
+// Resolves the texture and runs `fn` on it while the registry lock keeps
+// it alive. Returns -2 for unknown ids, otherwise `fn`'s result.
+template <typename Fn>
+auto WithFfiTexture(int64_t texture_id, Fn&& fn) -> decltype(fn(FfiTexture{})) {
+  std::lock_guard<std::mutex> lock(g_ffi_textures_mutex);
+  auto it = FfiTextures().find(texture_id);
+  if (it == FfiTextures().end()) {
+    return -2;
+  }
+  return fn(it->second);
+}
+
+// Hands the frame's reference to the view.
+void MapFrame(FrameRef frame, KntFrameView* view) {
+  *view = KntFrameView{};
+  view->data = frame->data();
+  view->size = frame->size();
+  view->generation = frame->generation();
+  view->timestamp_ns = frame->timestamp_ns();
+  view->width = frame->width();
+  view->height = frame->height();
+  view->stride = frame->stride();
+  // The reference outlives the registry lock; the texture may go away
+  // meanwhile, the frame's storage does not.
+  view->handle = new FrameRef(std::move(frame));
+}
+
+}  // namespace
+
+void RegisterFfiTexture(int64_t texture_id, FfiTexture texture) {
+  std::lock_guard<std::mutex> lock(g_ffi_textures_mutex);
+  FfiTextures()[texture_id] = texture;
+}
+
+void UnregisterFfiTexture(int64_t texture_id) {
+  std::lock_guard<std::mutex> lock(g_ffi_textures_mutex);
+  FfiTextures().erase(texture_id);
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+namespace core = kataglyphis_native_inference::core;
+
+int32_t knt_ffi_api_version(void) { return 6; }
+
+int32_t knt_get_frame_stats(int64_t texture_id, KntFrameStats* stats) {
+  if (!stats) {
+    return -1;
+  }
+  return core::WithFfiTexture(texture_id, [stats](core::FfiTexture texture) {
+    const core::FrameStats frame_stats = texture.exchange->GetStats();
+    *stats = KntFrameStats{};
+    stats->frames_pushed = frame_stats.frames_pushed;
+    stats->frames_presented = frame_stats.frames_presented;
+    stats->frames_dropped = frame_stats.frames_dropped;
+    stats->latest_generation = frame_stats.latest_generation;
+    stats->presented_generation = frame_stats.presented_generation;
+    stats->consumer_fps = frame_stats.consumer_fps;
+    stats->frame_pending = frame_stats.frame_pending ? 1U : 0U;
+    return 0;
+  });
+}
+
+int32_t knt_acquire_frame(int64_t texture_id, KntFrameView* view) {
+  if (!view) {
+    return -1;
+  }
+  return core::WithFfiTexture(texture_id, [view](core::FfiTexture texture) {
+    core::FrameRef frame = texture.exchange->PeekLatest();
+    if (!frame) {
+      return -3;
+    }
+    core::MapFrame(std::move(frame), view);
+    return 0;
+  });
+}
+
+int32_t knt_acquire_inference_frame(int64_t texture_id, KntFrameView* view) {
+  if (!view) {
+    return -1;
+  }
+  return core::WithFfiTexture(texture_id, [view](core::FfiTexture texture) {
+    core::FrameRef frame =
+        texture.inference ? texture.inference->Take() : nullptr;
+    if (!frame) {
+      return -3;
+    }
+    core::MapFrame(std::move(frame), view);
+    return 0;
+  });
+}
+
+int32_t knt_get_inference_stats(int64_t texture_id, KntInferenceStats* stats) {
+  if (!stats) {
+    return -1;
+  }
+  return core::WithFfiTexture(texture_id, [stats](core::FfiTexture texture) {
+    if (!texture.inference) {
+      return -3;
+    }
+    const core::InferenceFeedStats feed = texture.inference->GetStats();
+    *stats = KntInferenceStats{};
+    stats->frames_offered = feed.offered;
+    stats->frames_gated = feed.gated;
+    stats->frames_replaced = feed.replaced;
+    stats->frames_taken = feed.taken;
+    stats->last_mean_diff = feed.last_mean_diff;
+    stats->last_changed_fraction = feed.last_changed_fraction;
+    stats->frames_throttled = feed.throttled;
+    stats->effective_fps = feed.effective_fps;
+    stats->inference_ms = feed.inference_ms;
+    stats->latency_ms = feed.latency_ms;
+    stats->admitted_fps = feed.admitted_fps;
+    return 0;
+  });
+}
+
+void knt_release_frame(void* handle) {
+  delete static_cast<core::FrameRef*>(handle);
+}
+
+int32_t knt_map_frame_level(void* handle, uint32_t level,
+                            KntFrameView* view) {
+  if (!handle || !view) {
+    return -1;
+  }
+  const core::FrameRef& frame = *static_cast<core::FrameRef*>(handle);
+  core::FrameRef mapped =
+      frame->pyramid() ? frame->pyramid()->level(level) : nullptr;
+  if (!mapped) {
+    return -3;
+  }
+  core::MapFrame(std::move(mapped), view);
+  // Levels are never published themselves.
+  view->generation = frame->generation();
+  return 0;
+}
+
+int64_t knt_copy_latest_result(int64_t texture_id, uint8_t* buffer,
+                               uint64_t capacity, uint64_t* frame_generation,
+                               uint64_t* version) {
+  if (!buffer && capacity > 0) {
+    return -1;
+  }
+  return core::WithFfiTexture(
+      texture_id, [&](core::FfiTexture texture) -> int64_t {
+        if (!texture.results) {
+          return -3;
+        }
+        // Read before the bytes, so a racing Publish() shows up as a newer
+        // version next time rather than being missed.
+        if (version) {
+          *version = texture.results->version();
+        }
+        core::ResultBytes bytes = texture.results->Latest(frame_generation);
+        if (!bytes) {
+          return -3;
+        }
+        if (bytes->size() <= capacity && !bytes->empty()) {
+          std::memcpy(buffer, bytes->data(), bytes->size());
+        }
+        return static_cast<int64_t>(bytes->size());
+      });
+}
+
+int32_t knt_submit_detections(int64_t texture_id, const uint8_t* packet,
+                              uint64_t size) {
+  core::DetectionSet detections;
+  // Decoded before taking the registry lock.
+  if (!core::DecodeDetections(packet, static_cast<size_t>(size),
+                              &detections)) {
+    return -1;
+  }
+  return core::WithFfiTexture(
+      texture_id, [&detections](core::FfiTexture texture) {
+        if (!texture.results) {
+          return -3;
+        }
+        if (texture.tracker) {
+          const int64_t time_ns =
+              detections.timestamp_ns >= 0
+                  ? detections.timestamp_ns
+                  : core::StatsAggregator::NowNs();
+          texture.tracker->Update(&detections, time_ns);
+        }
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        core::EncodeDetections(detections, bytes.get());
+        texture.results->Publish(detections.frame_generation,
+                                 std::move(bytes));
+        return 0;
+      });
+}
+
+int32_t knt_report_inference_time(int64_t texture_id, int64_t duration_ns) {
+  if (duration_ns < 0) {
+    return -1;
+  }
+  return core::WithFfiTexture(
+      texture_id, [duration_ns](core::FfiTexture texture) {
+        if (!texture.stats && !texture.inference) {
+          return -3;
+        }
+        if (texture.stats) texture.stats->RecordInference(duration_ns);
+        if (texture.inference) {
+          texture.inference->ReportInference(duration_ns,
+                                             core::StatsAggregator::NowNs());
+        }
+        return 0;
+      });
+}
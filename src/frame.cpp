@@ -0,0 +1,66 @@
+#include "kataglyphis_native_core/frame.h"
+
+#include <utility>
+
+#include "kataglyphis_native_core/frame_pool.h"
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+Frame::Frame(const uint8_t* data, uint8_t* writable, uint32_t width,
+             uint32_t height, uint32_t stride, size_t size,
+             std::shared_ptr<const void> owner)
+    : data_(data),
+      writable_(writable),
+      width_(width),
+      height_(height),
+      stride_(stride),
+      size_(size),
+      owner_(std::move(owner)) {}
+
+// static
+std::shared_ptr<Frame> Frame::Allocate(FramePool* pool, uint32_t width,
+                                       uint32_t height) {
+  const uint32_t stride = width * static_cast<uint32_t>(kRgbaBytesPerPixel);
+  const size_t size = static_cast<size_t>(stride) * height;
+  std::shared_ptr<uint8_t> storage;
+  if (pool) {
+    storage = pool->Acquire(size);
+  } else {
+    storage = std::shared_ptr<uint8_t>(new uint8_t[size],
+                                       std::default_delete<uint8_t[]>());
+  }
+  uint8_t* data = storage.get();
+  return std::shared_ptr<Frame>(
+      new Frame(data, data, width, height, stride, size, std::move(storage)));
+}
+
+// static
+std::shared_ptr<Frame> Frame::Wrap(const uint8_t* data, uint32_t width,
+                                   uint32_t height, uint32_t stride,
+                                   size_t size,
+                                   std::shared_ptr<const void> owner) {
+  return std::shared_ptr<Frame>(
+      new Frame(data, nullptr, width, height, stride, size, std::move(owner)));
+}
+
+// static
+std::shared_ptr<Frame> Frame::Lend(const uint8_t* data, uint32_t width,
+                                   uint32_t height, uint32_t stride,
+                                   ReleaseCallback release,
+                                   void* release_context) {
+  // The control block only exists to run `release` once the last frame
+  // reference is gone; the pointer itself is never dereferenced.
+  std::shared_ptr<const void> owner(
+      release_context, [release](const void* context) {
+        if (release) {
+          release(const_cast<void*>(context));
+        }
+      });
+  return Wrap(data, width, height, stride, static_cast<size_t>(stride) * height,
+              std::move(owner));
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
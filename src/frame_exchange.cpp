@@ -0,0 +1,176 @@
+#include "kataglyphis_native_core/frame_exchange.h"
+
+#include <cstring>
+#include <utility>
+
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// The slot-free callbacks this thread is inside, innermost first. A
+// callback that replaces its own exchange's callback must not wait for
+// itself, but still waits for other threads.
+struct RunningSlotFree {
+  const FrameExchange* exchange;
+  const RunningSlotFree* outer;
+};
+thread_local const RunningSlotFree* running_slot_free = nullptr;
+
+int RunningOnThisThread(const FrameExchange* exchange) {
+  int count = 0;
+  for (const RunningSlotFree* it = running_slot_free; it; it = it->outer) {
+    if (it->exchange == exchange) ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+FrameExchange::FrameExchange(std::shared_ptr<FramePool> pool)
+    : pool_(pool ? std::move(pool) : FramePool::Create()) {}
+
+bool FrameExchange::PushCopy(const uint8_t* rgba, uint32_t width,
+                             uint32_t height, bool* previous_consumed) {
+  if (!rgba || width == 0 || height == 0) {
+    return false;
+  }
+  std::shared_ptr<Frame> frame = Frame::Allocate(pool_.get(), width, height);
+  std::memcpy(frame->mutable_data(), rgba, frame->size());
+  Publish(std::move(frame), previous_consumed);
+  return true;
+}
+
+bool FrameExchange::PushLent(const uint8_t* rgba, uint32_t width,
+                             uint32_t height, Frame::ReleaseCallback release,
+                             void* release_context, bool* previous_consumed) {
+  if (!rgba || width == 0 || height == 0) {
+    return false;
+  }
+  Publish(Frame::Lend(rgba, width, height,
+                      width * static_cast<uint32_t>(kRgbaBytesPerPixel),
+                      release, release_context),
+          previous_consumed);
+  return true;
+}
+
+void FrameExchange::Publish(std::shared_ptr<Frame> frame,
+                            bool* previous_consumed) {
+  FrameRef displaced;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PublishLocked(std::move(frame), true, previous_consumed, &displaced);
+  }
+  // `displaced` may be the last reference to a lent buffer; its release
+  // callback must run outside the lock in case it pushes again.
+}
+
+void FrameExchange::PublishFill(uint32_t width, uint32_t height, uint8_t r,
+                                uint8_t g, uint8_t b) {
+  if (width == 0 || height == 0) {
+    return;
+  }
+  std::shared_ptr<Frame> frame = Frame::Allocate(pool_.get(), width, height);
+  FillRgba(frame->mutable_data(), static_cast<size_t>(width) * height, r, g,
+           b);
+  frame->set_opaque(true);
+  FrameRef displaced;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PublishLocked(std::move(frame), false, nullptr, &displaced);
+  }
+}
+
+void FrameExchange::PublishLocked(std::shared_ptr<Frame> frame, bool tracked,
+                                  bool* previous_consumed,
+                                  FrameRef* displaced) {
+  frame->generation_ = ++next_generation_;
+  if (previous_consumed) {
+    *previous_consumed = !stats_.frame_pending;
+  }
+  if (tracked) {
+    if (stats_.frame_pending) {
+      ++stats_.frames_dropped;
+    }
+    ++stats_.frames_pushed;
+  }
+  // Untracked frames still need presenting, but never count as drops.
+  stats_.frame_pending = tracked;
+  stats_.latest_generation = frame->generation_;
+  *displaced = std::move(latest_);
+  latest_ = std::move(frame);
+}
+
+void FrameExchange::Reset() {
+  FrameRef displaced;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    displaced = std::move(latest_);
+    stats_.frame_pending = false;
+  }
+}
+
+bool FrameExchange::HasPendingFrame() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_.frame_pending;
+}
+
+void FrameExchange::SetSlotFreeCallback(std::function<void()> callback) {
+  const int own = RunningOnThisThread(this);
+  std::function<void()> previous;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    previous = std::move(slot_free_callback_);
+    slot_free_callback_ = std::move(callback);
+    slot_free_done_.wait(lock,
+                         [this, own] { return slot_free_running_ == own; });
+  }
+  // Destroyed outside the lock; its captures may be anything.
+}
+
+FrameRef FrameExchange::AcquireLatest() {
+  FrameRef frame;
+  std::function<void()> slot_free_callback;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame = latest_;
+    if (frame && stats_.presented_generation != frame->generation()) {
+      const bool was_pending = stats_.frame_pending;
+      stats_.presented_generation = frame->generation();
+      stats_.frame_pending = false;
+      if (was_pending) {
+        ++stats_.frames_presented;
+        consumer_rate_.Tick();
+        slot_free_callback = slot_free_callback_;
+        if (slot_free_callback) ++slot_free_running_;
+      }
+    }
+  }
+  if (slot_free_callback) {
+    const RunningSlotFree running{this, running_slot_free};
+    running_slot_free = &running;
+    slot_free_callback();
+    running_slot_free = running.outer;
+    slot_free_callback = nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--slot_free_running_ == 0) slot_free_done_.notify_all();
+  }
+  return frame;
+}
+
+FrameRef FrameExchange::PeekLatest() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latest_;
+}
+
+FrameStats FrameExchange::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FrameStats stats = stats_;
+  stats.consumer_fps = consumer_rate_.rate_hz();
+  return stats;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
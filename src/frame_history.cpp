@@ -0,0 +1,94 @@
+#include "kataglyphis_native_core/frame_history.h"
+
+#include <utility>
+
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Buffers of trimmed frames kept for the next copies; the ring turns over
+// about one frame per push.
+constexpr size_t kFreeBuffers = 8;
+
+}  // namespace
+
+FrameHistory::FrameHistory(FrameHistoryOptions options)
+    : options_(options), pool_(FramePool::Create(kFreeBuffers)) {}
+
+void FrameHistory::Push(HistoryFrame frame) {
+  if (frame.timestamp_ns < 0) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!frames_.empty() && frame.timestamp_ns < frames_.back().timestamp_ns) {
+    evicted_ += frames_.size();
+    frames_.clear();
+    bytes_ = 0;
+  }
+  bytes_ += frame.bytes();
+  frames_.push_back(std::move(frame));
+  ++pushed_;
+  TrimLocked();
+}
+
+std::shared_ptr<Frame> FrameHistory::CopyFrame(const Frame& frame) {
+  std::shared_ptr<Frame> copy =
+      Frame::Allocate(pool_.get(), frame.width(), frame.height());
+  CopyRgbaFrame(frame.data(), frame.size(), frame.stride(), frame.width(),
+                frame.height(), copy->mutable_data(), copy->width(),
+                copy->height(), false);
+  copy->set_timestamp_ns(frame.timestamp_ns());
+  return copy;
+}
+
+std::vector<HistoryFrame> FrameHistory::Snapshot(int64_t window_ns) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t first = 0;
+  if (window_ns > 0 && !frames_.empty()) {
+    const int64_t since = frames_.back().timestamp_ns - window_ns;
+    while (first + 1 < frames_.size() && frames_[first].timestamp_ns < since) {
+      ++first;
+    }
+    while (first > 0 && !frames_[first].keyframe) --first;
+  }
+  return std::vector<HistoryFrame>(frames_.begin() + first, frames_.end());
+}
+
+void FrameHistory::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  frames_.clear();
+  bytes_ = 0;
+}
+
+FrameHistoryStats FrameHistory::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FrameHistoryStats stats;
+  stats.frames = frames_.size();
+  stats.bytes = bytes_;
+  if (!frames_.empty()) {
+    stats.span_ns = frames_.back().timestamp_ns - frames_.front().timestamp_ns;
+  }
+  stats.pushed = pushed_;
+  stats.evicted = evicted_;
+  return stats;
+}
+
+void FrameHistory::TrimLocked() {
+  const int64_t newest = frames_.back().timestamp_ns;
+  const auto pop = [this] {
+    bytes_ -= frames_.front().bytes();
+    frames_.pop_front();
+    ++evicted_;
+  };
+  while (!frames_.empty() &&
+         (bytes_ > options_.max_bytes ||
+          newest - frames_.front().timestamp_ns > options_.window_ns)) {
+    pop();
+  }
+  // Delta frames whose keyframe is gone cannot be decoded anymore.
+  while (!frames_.empty() && !frames_.front().keyframe) pop();
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,75 @@
+#include "kataglyphis_native_core/frame_pool.h"
+
+#include <algorithm>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// static
+std::shared_ptr<FramePool> FramePool::Create(size_t max_free_buffers) {
+  return std::shared_ptr<FramePool>(new FramePool(max_free_buffers));
+}
+
+FramePool::FramePool(size_t max_free_buffers)
+    : max_free_buffers_(max_free_buffers) {}
+
+std::shared_ptr<uint8_t> FramePool::Acquire(size_t size) {
+  std::unique_ptr<uint8_t[]> data;
+  size_t capacity = size;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Frame sizes only change on resolution switches, so an exact-size
+    // match is the common case; a slightly larger buffer is fine too.
+    auto it = std::find_if(free_.begin(), free_.end(),
+                           [size](const FreeBuffer& buffer) {
+                             return buffer.size >= size &&
+                                    buffer.size <= size + size / 4;
+                           });
+    if (it != free_.end()) {
+      capacity = it->size;
+      data = std::move(it->data);
+      free_.erase(it);
+    } else {
+      ++allocations_;
+    }
+  }
+  if (!data) {
+    data.reset(new uint8_t[capacity]);
+  }
+
+  std::weak_ptr<FramePool> weak_pool = weak_from_this();
+  return std::shared_ptr<uint8_t>(
+      data.release(), [weak_pool, capacity](uint8_t* buffer) {
+        if (auto pool = weak_pool.lock()) {
+          pool->Recycle(capacity, buffer);
+        } else {
+          delete[] buffer;
+        }
+      });
+}
+
+void FramePool::Recycle(size_t size, uint8_t* data) {
+  std::unique_ptr<uint8_t[]> buffer(data);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (max_free_buffers_ == 0) {
+    return;
+  }
+  if (free_.size() >= max_free_buffers_) {
+    // Oldest entries are most likely from a previous resolution.
+    free_.erase(free_.begin());
+  }
+  free_.push_back(FreeBuffer{size, std::move(buffer)});
+}
+
+size_t FramePool::free_buffers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return free_.size();
+}
+
+uint64_t FramePool::allocations() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocations_;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
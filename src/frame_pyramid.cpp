@@ -0,0 +1,148 @@
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KATAGLYPHIS_PYRAMID_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KATAGLYPHIS_PYRAMID_NEON 1
+#endif
+
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+#if defined(KATAGLYPHIS_PYRAMID_SSE2)
+// Two output pixels from four input pixels of each row, as 16-bit sums.
+__m128i SumPairs(__m128i top, __m128i bottom) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero),
+                                   _mm_unpacklo_epi8(bottom, zero));
+  const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero),
+                                   _mm_unpackhi_epi8(bottom, zero));
+  // Each half holds two neighbouring pixels; fold them together.
+  return _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)),
+                            _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+}
+#endif
+
+}  // namespace
+
+void Downsample2x(const uint8_t* src, size_t src_stride, uint32_t width,
+                  uint32_t height, uint8_t* dst, size_t dst_stride) {
+  const uint32_t out_width = width / 2;
+  const uint32_t out_height = height / 2;
+  for (uint32_t y = 0; y < out_height; ++y) {
+    const uint8_t* top = src + static_cast<size_t>(2 * y) * src_stride;
+    const uint8_t* bottom = top + src_stride;
+    uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+    uint32_t x = 0;
+#if defined(KATAGLYPHIS_PYRAMID_SSE2)
+    const __m128i rounding = _mm_set1_epi16(2);
+    for (; x + 4 <= out_width; x += 4) {
+      const size_t offset = static_cast<size_t>(x) * 2 * kRgbaBytesPerPixel;
+      const __m128i* t = reinterpret_cast<const __m128i*>(top + offset);
+      const __m128i* b = reinterpret_cast<const __m128i*>(bottom + offset);
+      const __m128i first =
+          SumPairs(_mm_loadu_si128(t), _mm_loadu_si128(b));
+      const __m128i second =
+          SumPairs(_mm_loadu_si128(t + 1), _mm_loadu_si128(b + 1));
+      const __m128i packed = _mm_packus_epi16(
+          _mm_srli_epi16(_mm_add_epi16(first, rounding), 2),
+          _mm_srli_epi16(_mm_add_epi16(second, rounding), 2));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + x * kRgbaBytesPerPixel), packed);
+    }
+#elif defined(KATAGLYPHIS_PYRAMID_NEON)
+    for (; x + 4 <= out_width; x += 4) {
+      const size_t offset = static_cast<size_t>(x) * 2 * kRgbaBytesPerPixel;
+      // De-interleaves even and odd pixels.
+      const uint32x4x2_t t =
+          vld2q_u32(reinterpret_cast<const uint32_t*>(top + offset));
+      const uint32x4x2_t b =
+          vld2q_u32(reinterpret_cast<const uint32_t*>(bottom + offset));
+      const uint8x16_t te = vreinterpretq_u8_u32(t.val[0]);
+      const uint8x16_t to = vreinterpretq_u8_u32(t.val[1]);
+      const uint8x16_t be = vreinterpretq_u8_u32(b.val[0]);
+      const uint8x16_t bo = vreinterpretq_u8_u32(b.val[1]);
+      uint16x8_t lo = vaddl_u8(vget_low_u8(te), vget_low_u8(to));
+      lo = vaddw_u8(vaddw_u8(lo, vget_low_u8(be)), vget_low_u8(bo));
+      uint16x8_t hi = vaddl_u8(vget_high_u8(te), vget_high_u8(to));
+      hi = vaddw_u8(vaddw_u8(hi, vget_high_u8(be)), vget_high_u8(bo));
+      vst1q_u8(out + x * kRgbaBytesPerPixel,
+               vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+#endif
+    for (; x < out_width; ++x) {
+      const size_t offset = static_cast<size_t>(x) * 2 * kRgbaBytesPerPixel;
+      for (size_t c = 0; c < kRgbaBytesPerPixel; ++c) {
+        const unsigned sum = top[offset + c] +
+                             top[offset + kRgbaBytesPerPixel + c] +
+                             bottom[offset + c] +
+                             bottom[offset + kRgbaBytesPerPixel + c];
+        out[x * kRgbaBytesPerPixel + c] = static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+}
+
+// static
+std::shared_ptr<const FramePyramid> FramePyramid::Build(const Frame& frame,
+                                                        uint32_t levels,
+                                                        FramePool* pool) {
+  const size_t row_bytes =
+      static_cast<size_t>(frame.width()) * kRgbaBytesPerPixel;
+  if (!frame.data() || frame.height() == 0 || frame.stride() < row_bytes ||
+      frame.size() <
+          static_cast<size_t>(frame.stride()) * (frame.height() - 1) +
+              row_bytes) {
+    return nullptr;
+  }
+
+  std::shared_ptr<FramePyramid> pyramid(new FramePyramid());
+  const uint8_t* src = frame.data();
+  size_t src_stride = frame.stride();
+  uint32_t width = frame.width();
+  uint32_t height = frame.height();
+  for (uint32_t i = 0; i < levels && width >= 2 && height >= 2; ++i) {
+    std::shared_ptr<Frame> level =
+        Frame::Allocate(pool, width / 2, height / 2);
+    Downsample2x(src, src_stride, width, height, level->mutable_data(),
+                 level->stride());
+    level->set_timestamp_ns(frame.timestamp_ns());
+    src = level->data();
+    src_stride = level->stride();
+    width = level->width();
+    height = level->height();
+    pyramid->levels_.push_back(std::move(level));
+  }
+  if (pyramid->levels_.empty()) {
+    return nullptr;
+  }
+  return pyramid;
+}
+
+FrameRef FramePyramid::level(uint32_t index) const {
+  if (index == 0 || index > levels_.size()) {
+    return nullptr;
+  }
+  return levels_[index - 1];
+}
+
+FrameRef FramePyramid::FitWithin(uint32_t max_side) const {
+  for (const FrameRef& level : levels_) {
+    if (std::max(level->width(), level->height()) <= max_side) {
+      return level;
+    }
+  }
+  return levels_.back();
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
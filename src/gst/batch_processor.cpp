@@ -0,0 +1,298 @@
+#include "kataglyphis_native_core/batch_processor.h"
+
+#include <gst/app/gstappsink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+#include "kataglyphis_native_core/sample_frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// How often a segment waiting for frames checks for errors and Cancel().
+constexpr GstClockTime kPullTimeout = 100 * GST_MSECOND;
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+// Runs task(0..count-1) on up to `workers` threads, the calling thread
+// included. A task returning false stops its thread from taking more.
+template <typename Task>
+void RunOnWorkers(size_t count, uint32_t workers, const Task& task) {
+  std::atomic<size_t> next{0};
+  const auto loop = [&] {
+    for (size_t i = next++; i < count; i = next++) {
+      if (!task(i)) return;
+    }
+  };
+  const size_t threads = std::min<size_t>(std::max<uint32_t>(workers, 1), count);
+  std::vector<std::thread> helpers;
+  for (size_t i = 1; i < threads; ++i) helpers.emplace_back(loop);
+  loop();
+  for (std::thread& helper : helpers) helper.join();
+}
+
+}  // namespace
+
+BatchProcessor::BatchProcessor(BatchOptions options)
+    : options_(std::move(options)),
+      diagnostics_(std::make_shared<DiagnosticRing>(128)) {}
+
+std::string BatchProcessor::SegmentDescription() const {
+  // Only the video stream is exposed; audio is never decoded.
+  std::string caps = "video/x-raw,format=RGBA";
+  if (options_.width > 0 && options_.height > 0) {
+    caps += ",width=" + std::to_string(options_.width) +
+            ",height=" + std::to_string(options_.height);
+  }
+  return "uridecodebin name=src expose-all-streams=false "
+         "caps=\"video/x-raw(ANY)\" ! videoconvert ! videoscale ! " +
+         caps +
+         " ! appsink name=sink sync=false drop=false "
+         "enable-last-sample=false max-buffers=" +
+         std::to_string(std::max<uint32_t>(options_.max_buffers, 1));
+}
+
+bool BatchProcessor::ProbeDuration(const std::string& uri,
+                                   int64_t* duration_ns, std::string* error) {
+  PipelineController controller;
+  controller.set_task_pool(options_.task_pool);
+  if (!controller.Load(SegmentDescription(), error)) return false;
+  GstElement* src =
+      gst_bin_get_by_name(GST_BIN(controller.pipeline()), "src");
+  g_object_set(src, "uri", uri.c_str(), nullptr);
+  gst_object_unref(src);
+
+  const GstStateChangeReturn ret =
+      controller.SetState(GST_STATE_PAUSED, kPrerollTimeout);
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+    const std::string bus_error = controller.LastBusError();
+    *error = "Cannot open " + uri + ": " +
+             (bus_error.empty() ? StateChangeReturnToString(ret) : bus_error);
+    return false;
+  }
+  gint64 duration = -1;
+  if (!gst_element_query_duration(controller.pipeline(), GST_FORMAT_TIME,
+                                  &duration)) {
+    duration = -1;
+  }
+  *duration_ns = duration;
+  controller.Release();
+  return true;
+}
+
+bool BatchProcessor::RunSegment(const std::string& uri,
+                                const BatchSegment& segment,
+                                const BatchInference& inference,
+                                const BatchResultCallback& on_result,
+                                std::string* error) {
+  PipelineController controller;
+  controller.set_task_pool(options_.task_pool);
+  if (!controller.Load(SegmentDescription(), error)) return false;
+  GstElement* pipeline = controller.pipeline();
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+  g_object_set(src, "uri", uri.c_str(), nullptr);
+  gst_object_unref(src);
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+
+  const std::string where = uri + " segment " + std::to_string(segment.index);
+  const auto fail = [&](const std::string& what) {
+    const std::string bus_error = controller.LastBusError();
+    *error = what + " (" + where + ")" +
+             (bus_error.empty() ? "" : ": " + bus_error);
+    gst_object_unref(sink);
+    controller.Release();
+    return false;
+  };
+
+  GstStateChangeReturn ret =
+      controller.SetState(GST_STATE_PAUSED, kPrerollTimeout);
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+    return fail(std::string("Preroll failed: ") +
+                StateChangeReturnToString(ret));
+  }
+  if (segment.start_ns > 0 || segment.end_ns >= 0) {
+    // ACCURATE decodes from the preceding keyframe but only outputs from
+    // `start_ns`; the stop position ends the segment with EOS.
+    const bool bounded = segment.end_ns >= 0;
+    if (!gst_element_seek(
+            pipeline, 1.0, GST_FORMAT_TIME,
+            static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH |
+                                      GST_SEEK_FLAG_ACCURATE),
+            GST_SEEK_TYPE_SET, static_cast<gint64>(segment.start_ns),
+            bounded ? GST_SEEK_TYPE_SET : GST_SEEK_TYPE_NONE,
+            bounded ? static_cast<gint64>(segment.end_ns)
+                    : static_cast<gint64>(GST_CLOCK_TIME_NONE))) {
+      return fail("Seek failed");
+    }
+  }
+  ret = controller.SetState(GST_STATE_PLAYING, kPrerollTimeout);
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+    return fail(std::string("Start failed: ") +
+                StateChangeReturnToString(ret));
+  }
+
+  uint64_t frame_index = 0;
+  while (!ShouldStop()) {
+    GstSample* sample =
+        gst_app_sink_try_pull_sample(GST_APP_SINK(sink), kPullTimeout);
+    if (!sample) {
+      if (gst_app_sink_is_eos(GST_APP_SINK(sink))) break;
+      if (!controller.LastBusError().empty()) return fail("Decoding failed");
+      continue;
+    }
+
+    int64_t stream_time = -1;
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    const GstSegment* sample_segment = gst_sample_get_segment(sample);
+    if (buffer && sample_segment && GST_BUFFER_PTS_IS_VALID(buffer)) {
+      const guint64 position = gst_segment_to_stream_time(
+          sample_segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+      if (position != GST_CLOCK_TIME_NONE) {
+        stream_time = static_cast<int64_t>(position);
+      }
+    }
+    // Clipping should already keep frames inside the segment; neighbours
+    // must never both report the same boundary frame.
+    if (stream_time >= 0 &&
+        (stream_time < segment.start_ns ||
+         (segment.end_ns >= 0 && stream_time >= segment.end_ns))) {
+      gst_sample_unref(sample);
+      continue;
+    }
+    std::shared_ptr<Frame> frame =
+        WrapVideoSample(sample, options_.width, options_.height);
+    if (!frame) continue;
+
+    BatchFrame batch_frame;
+    batch_frame.segment = &segment;
+    batch_frame.frame_index = frame_index;
+    batch_frame.stream_time_ns = stream_time;
+    batch_frame.frame = frame;
+
+    BatchResult result;
+    result.file_index = segment.file_index;
+    result.segment_index = segment.index;
+    result.frame_index = frame_index;
+    result.timestamp_ns = stream_time;
+    result.width = frame->width();
+    result.height = frame->height();
+    if (inference) result.payload = inference(batch_frame);
+    if (on_result) {
+      std::lock_guard<std::mutex> lock(results_mutex_);
+      on_result(result);
+    }
+    ++frame_index;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  gst_object_unref(sink);
+  controller.Release();
+  return true;
+}
+
+bool BatchProcessor::Run(const std::vector<std::string>& inputs,
+                         const BatchInference& inference,
+                         const BatchResultCallback& on_result,
+                         std::string* error) {
+  GstRuntime::Get().WaitUntilReady();
+  failed_.store(false);
+  files_.store(inputs.size());
+  segments_total_.store(0);
+  segments_done_.store(0);
+  frames_.store(0);
+  start_ns_.store(NowNs());
+
+  std::vector<std::string> uris(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::string uri_error;
+    if (!InputToUri(inputs[i], &uris[i], &uri_error)) {
+      if (error) *error = uri_error;
+      return false;
+    }
+  }
+
+  const uint32_t workers =
+      options_.workers > 0
+          ? options_.workers
+          : std::max(1U, std::thread::hardware_concurrency());
+  std::mutex error_mutex;
+  std::string first_error;
+  const auto record_failure = [&](const std::string& message) {
+    diagnostics_->Record(DiagnosticSeverity::kError, "batch", 0, message);
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (first_error.empty()) first_error = message;
+    failed_.store(true);
+  };
+
+  std::vector<int64_t> durations(uris.size(), -1);
+  RunOnWorkers(uris.size(), workers, [&](size_t i) {
+    if (ShouldStop()) return false;
+    std::string probe_error;
+    if (!ProbeDuration(uris[i], &durations[i], &probe_error)) {
+      record_failure(probe_error);
+      return false;
+    }
+    return true;
+  });
+
+  const std::vector<BatchSegment> segments =
+      ShouldStop() ? std::vector<BatchSegment>()
+                   : PlanBatchSegments(durations, workers,
+                                       options_.min_segment_ns);
+  segments_total_.store(segments.size());
+  RunOnWorkers(segments.size(), workers, [&](size_t i) {
+    if (ShouldStop()) return false;
+    const BatchSegment& segment = segments[i];
+    std::string segment_error;
+    if (!RunSegment(uris[segment.file_index], segment, inference, on_result,
+                    &segment_error)) {
+      record_failure(segment_error);
+      return false;
+    }
+    if (!ShouldStop()) segments_done_.fetch_add(1);
+    return true;
+  });
+
+  if (failed_.load()) {
+    if (error) *error = first_error;
+    return false;
+  }
+  if (cancelled()) {
+    if (error) *error = "Cancelled";
+    return false;
+  }
+  return true;
+}
+
+BatchProgress BatchProcessor::progress() const {
+  BatchProgress progress;
+  progress.files = files_.load(std::memory_order_relaxed);
+  progress.segments_total = segments_total_.load(std::memory_order_relaxed);
+  progress.segments_done = segments_done_.load(std::memory_order_relaxed);
+  progress.frames = frames_.load(std::memory_order_relaxed);
+  const int64_t start = start_ns_.load(std::memory_order_relaxed);
+  if (start != 0) {
+    progress.elapsed_s = static_cast<double>(NowNs() - start) / 1e9;
+  }
+  if (progress.elapsed_s > 0.0) {
+    progress.frames_per_second =
+        static_cast<double>(progress.frames) / progress.elapsed_s;
+  }
+  return progress;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
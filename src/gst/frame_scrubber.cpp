@@ -0,0 +1,408 @@
+#include "kataglyphis_native_core/frame_scrubber.h"
+
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+#include "kataglyphis_native_core/pixel_convert.h"
+#include "kataglyphis_native_core/sample_frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// How often a decode waiting for frames checks for errors and preemption.
+constexpr GstClockTime kPullTimeout = 100 * GST_MSECOND;
+// Longest a Seek()/Step() miss waits for its frame.
+constexpr std::chrono::seconds kDemandTimeout(10);
+// Assumed when neither the caps nor the buffers carry a frame duration.
+constexpr int64_t kFallbackFrameNs = 1000000000 / 30;
+
+// Frame duration from the framerate negotiated on `sink`, or -1.
+int64_t NegotiatedFrameDuration(GstElement* sink) {
+  GstPad* pad = gst_element_get_static_pad(sink, "sink");
+  GstCaps* caps = pad ? gst_pad_get_current_caps(pad) : nullptr;
+  int64_t duration = -1;
+  gint num = 0;
+  gint den = 0;
+  if (caps && gst_caps_get_size(caps) > 0 &&
+      gst_structure_get_fraction(gst_caps_get_structure(caps, 0), "framerate",
+                                 &num, &den) &&
+      num > 0 && den > 0) {
+    duration = static_cast<int64_t>(
+        gst_util_uint64_scale_int(GST_SECOND, den, num));
+  }
+  if (caps) gst_caps_unref(caps);
+  if (pad) gst_object_unref(pad);
+  return duration;
+}
+
+}  // namespace
+
+struct FrameScrubber::Decoder {
+  explicit Decoder(std::shared_ptr<DiagnosticRing> diagnostics)
+      : controller(std::move(diagnostics)) {}
+  ~Decoder() {
+    if (sink) gst_object_unref(sink);
+    controller.Release();
+  }
+
+  PipelineController controller;
+  GstElement* sink = nullptr;
+  bool playing = false;
+};
+
+FrameScrubber::FrameScrubber(FrameScrubberOptions options)
+    : options_(std::move(options)),
+      diagnostics_(std::make_shared<DiagnosticRing>(64)),
+      cache_(options_.budget_bytes) {}
+
+FrameScrubber::~FrameScrubber() { Close(); }
+
+bool FrameScrubber::Open(const std::string& input, std::string* error) {
+  if (decoder_) {
+    *error = "A file is already open";
+    return false;
+  }
+  GstRuntime::Get().WaitUntilReady();
+  std::string uri;
+  if (!InputToUri(input, &uri, error)) return false;
+
+  std::string caps = "video/x-raw,format=RGBA";
+  if (options_.width > 0 && options_.height > 0) {
+    caps += ",width=" + std::to_string(options_.width) +
+            ",height=" + std::to_string(options_.height);
+  }
+  auto decoder = std::make_unique<Decoder>(diagnostics_);
+  decoder->controller.set_task_pool(options_.task_pool);
+  if (!decoder->controller.Load(
+          "uridecodebin name=src expose-all-streams=false "
+          "caps=\"video/x-raw(ANY)\" ! videoconvert ! videoscale ! " +
+              caps +
+              " ! appsink name=sink sync=false drop=false "
+              "enable-last-sample=false max-buffers=2",
+          error)) {
+    return false;
+  }
+  GstElement* pipeline = decoder->controller.pipeline();
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+  g_object_set(src, "uri", uri.c_str(), nullptr);
+  gst_object_unref(src);
+  decoder->sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+
+  const GstStateChangeReturn ret =
+      decoder->controller.SetState(GST_STATE_PAUSED, kPrerollTimeout);
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+    const std::string bus_error = decoder->controller.LastBusError();
+    *error = "Cannot open " + uri + ": " +
+             (bus_error.empty() ? StateChangeReturnToString(ret) : bus_error);
+    return false;
+  }
+
+  gint64 duration = -1;
+  GstQuery* seeking = gst_query_new_seeking(GST_FORMAT_TIME);
+  gboolean seekable = FALSE;
+  if (gst_element_query(pipeline, seeking)) {
+    gst_query_parse_seeking(seeking, nullptr, &seekable, nullptr, nullptr);
+  }
+  gst_query_unref(seeking);
+  if (!seekable ||
+      !gst_element_query_duration(pipeline, GST_FORMAT_TIME, &duration) ||
+      duration <= 0) {
+    *error = uri + " is not seekable or has no known duration";
+    return false;
+  }
+
+  int64_t frame_ns = NegotiatedFrameDuration(decoder->sink);
+  if (frame_ns <= 0) {
+    GstSample* preroll = gst_app_sink_try_pull_preroll(
+        GST_APP_SINK(decoder->sink), kPullTimeout);
+    GstBuffer* buffer = preroll ? gst_sample_get_buffer(preroll) : nullptr;
+    if (buffer && GST_BUFFER_DURATION_IS_VALID(buffer)) {
+      frame_ns = static_cast<int64_t>(GST_BUFFER_DURATION(buffer));
+    }
+    if (preroll) gst_sample_unref(preroll);
+  }
+  if (frame_ns <= 0) {
+    diagnostics_->Record(DiagnosticSeverity::kWarning, "scrubber", 0,
+                         "Unknown framerate; assuming 30 fps");
+    frame_ns = kFallbackFrameNs;
+  }
+
+  duration_ns_ = duration;
+  frame_ns_ = frame_ns;
+  position_ns_.store(0);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    demand_pending_ = false;
+    direction_ = 1;
+    served_generation_ = generation_.load();
+    demand_error_.clear();
+  }
+  cache_.Clear();
+  cache_.SetPlayhead(0, 1);
+  decoder_ = std::move(decoder);
+  worker_ = std::thread([this] { WorkerLoop(); });
+  return true;
+}
+
+void FrameScrubber::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    ++generation_;
+  }
+  changed_.notify_all();
+  if (worker_.joinable()) worker_.join();
+  decoder_.reset();
+  cache_.Clear();
+}
+
+FrameRef FrameScrubber::Seek(int64_t position_ns, std::string* error) {
+  if (!decoder_) {
+    *error = "No file is open";
+    return nullptr;
+  }
+  // The last frame starts up to one frame before the end.
+  position_ns = std::max<int64_t>(
+      0, std::min(position_ns, duration_ns_ - frame_ns_ / 2));
+  const int64_t previous = position_ns_.load();
+  int direction = position_ns > previous ? 1 : -1;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (position_ns == previous) direction = direction_;
+  if (direction != direction_) {
+    // Prefetch running the other way is no longer useful.
+    direction_ = direction;
+    ++generation_;
+  }
+  cache_.SetPlayhead(position_ns, direction);
+  FrameRef frame = cache_.Lookup(position_ns);
+  if (!frame) {
+    demand_pending_ = true;
+    demand_ns_ = position_ns;
+    const uint64_t generation = ++generation_;
+    changed_.notify_all();
+    changed_.wait_for(lock, kDemandTimeout, [&] {
+      frame = cache_.Step(position_ns, 0);
+      return frame || stopping_ || served_generation_ >= generation;
+    });
+    if (!frame) {
+      if (stopping_) {
+        *error = "Closed";
+      } else if (served_generation_ < generation) {
+        *error = "Timed out decoding the frame at " +
+                 std::to_string(position_ns) + " ns";
+      } else if (!demand_error_.empty()) {
+        *error = demand_error_;
+      } else {
+        *error = "No frame at " + std::to_string(position_ns) + " ns";
+      }
+      return nullptr;
+    }
+  }
+  position_ns_.store(frame->timestamp_ns());
+  lock.unlock();
+  // A hit may have moved the prefetch window.
+  changed_.notify_all();
+  return frame;
+}
+
+FrameRef FrameScrubber::Step(int frames, std::string* error) {
+  if (!decoder_) {
+    *error = "No file is open";
+    return nullptr;
+  }
+  const int64_t position = position_ns_.load();
+  if (frames != 0) {
+    FrameRef frame = cache_.Step(position, frames);
+    if (frame) {
+      const int direction = frames > 0 ? 1 : -1;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (direction != direction_) {
+          direction_ = direction;
+          ++generation_;
+        }
+        cache_.SetPlayhead(frame->timestamp_ns(), direction);
+        position_ns_.store(frame->timestamp_ns());
+      }
+      changed_.notify_all();
+      return frame;
+    }
+  }
+  // Half a frame in, so rounded timestamps cannot land on the neighbour.
+  return Seek(position + frames * frame_ns_ + frame_ns_ / 2, error);
+}
+
+void FrameScrubber::DemandRange(int64_t position_ns, int direction,
+                                int64_t* begin_ns, int64_t* end_ns) const {
+  if (direction >= 0) {
+    *begin_ns = position_ns;
+    *end_ns = position_ns + options_.chunk_ns;
+  } else {
+    *begin_ns = std::max<int64_t>(0, position_ns - options_.chunk_ns);
+    *end_ns = position_ns + frame_ns_;
+  }
+}
+
+void FrameScrubber::WorkerLoop() {
+  // Gap edge a prefetch left unfilled (frames past the budget, or a range
+  // without frames), and the playhead it was tried from. Not decoded again
+  // until the user moves.
+  int64_t stalled_edge = -1;
+  int64_t stalled_playhead = -1;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (demand_pending_) {
+      demand_pending_ = false;
+      const uint64_t generation = generation_.load();
+      int64_t begin = 0;
+      int64_t end = 0;
+      DemandRange(demand_ns_, direction_, &begin, &end);
+      lock.unlock();
+      std::string error;
+      const bool ok = DecodeRange(begin, end, generation, &error);
+      lock.lock();
+      served_generation_ = std::max(served_generation_, generation);
+      demand_error_ = ok ? "" : error;
+      changed_.notify_all();
+      continue;
+    }
+
+    const int64_t playhead = position_ns_.load();
+    const int direction = direction_;
+    // The tail past the last frame's start is never a gap worth decoding.
+    const int64_t last = duration_ns_ - frame_ns_ / 2;
+    const int64_t window_begin =
+        direction > 0 ? playhead
+                      : std::max<int64_t>(0, playhead - options_.prefetch_ns);
+    const int64_t window_end =
+        direction > 0 ? std::min(last, playhead + options_.prefetch_ns)
+                      : playhead;
+    int64_t gap_begin = 0;
+    int64_t gap_end = 0;
+    if (options_.prefetch_ns <= 0 || window_end <= window_begin ||
+        !cache_.FindGap(window_begin, window_end, direction, &gap_begin,
+                        &gap_end)) {
+      changed_.wait(lock);
+      continue;
+    }
+    const int64_t edge = direction > 0 ? gap_begin : gap_end;
+    if (edge == stalled_edge && playhead == stalled_playhead) {
+      changed_.wait(lock);
+      continue;
+    }
+    // Fill the gap one chunk at a time, nearest the playhead first.
+    if (direction > 0) {
+      gap_end = std::min(gap_end, gap_begin + options_.chunk_ns);
+    } else {
+      gap_begin = std::max(gap_begin, gap_end - options_.chunk_ns);
+    }
+    const uint64_t generation = generation_.load();
+    lock.unlock();
+    std::string error;
+    if (!DecodeRange(gap_begin, gap_end, generation, &error)) {
+      diagnostics_->Record(DiagnosticSeverity::kWarning, "scrubber", 0,
+                           "Prefetch failed: " + error);
+    }
+    lock.lock();
+    int64_t after_begin = 0;
+    int64_t after_end = 0;
+    if (generation == generation_.load() &&
+        cache_.FindGap(window_begin, window_end, direction, &after_begin,
+                       &after_end) &&
+        (direction > 0 ? after_begin : after_end) == edge) {
+      stalled_edge = edge;
+      stalled_playhead = playhead;
+    }
+  }
+}
+
+bool FrameScrubber::DecodeRange(int64_t begin_ns, int64_t end_ns,
+                                uint64_t generation, std::string* error) {
+  Decoder& decoder = *decoder_;
+  GstElement* pipeline = decoder.controller.pipeline();
+  // ACCURATE decodes from the preceding keyframe but only outputs from
+  // `begin_ns`; the stop position ends the range with EOS.
+  if (!gst_element_seek(
+          pipeline, 1.0, GST_FORMAT_TIME,
+          static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH |
+                                    GST_SEEK_FLAG_ACCURATE),
+          GST_SEEK_TYPE_SET, static_cast<gint64>(begin_ns), GST_SEEK_TYPE_SET,
+          static_cast<gint64>(end_ns))) {
+    *error = "Seek to " + std::to_string(begin_ns) + " ns failed";
+    return false;
+  }
+  if (!decoder.playing) {
+    const GstStateChangeReturn ret =
+        decoder.controller.SetState(GST_STATE_PLAYING, kPrerollTimeout);
+    if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+      *error = std::string("Start failed: ") + StateChangeReturnToString(ret);
+      return false;
+    }
+    decoder.playing = true;
+  }
+
+  GstAppSink* sink = GST_APP_SINK(decoder.sink);
+  // A newer demand flushes the pipeline with its own seek, so abandoning
+  // this range mid-stream is safe.
+  while (generation_.load() == generation) {
+    GstSample* sample = gst_app_sink_try_pull_sample(sink, kPullTimeout);
+    if (!sample) {
+      if (gst_app_sink_is_eos(sink)) return true;
+      const std::string bus_error = decoder.controller.LastBusError();
+      if (!bus_error.empty()) {
+        *error = "Decoding failed: " + bus_error;
+        return false;
+      }
+      continue;
+    }
+
+    int64_t stream_time = -1;
+    int64_t duration = frame_ns_;
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    const GstSegment* segment = gst_sample_get_segment(sample);
+    if (buffer && segment && GST_BUFFER_PTS_IS_VALID(buffer)) {
+      const guint64 position = gst_segment_to_stream_time(
+          segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+      if (position != GST_CLOCK_TIME_NONE) {
+        stream_time = static_cast<int64_t>(position);
+      }
+    }
+    if (buffer && GST_BUFFER_DURATION_IS_VALID(buffer)) {
+      duration = static_cast<int64_t>(GST_BUFFER_DURATION(buffer));
+    }
+    std::shared_ptr<Frame> decoded =
+        WrapVideoSample(sample, options_.width, options_.height);
+    if (!decoded || stream_time < 0) continue;
+
+    // Decoder buffer pools may be bounded, so cached frames must not pin
+    // them; copy out of the sample.
+    std::shared_ptr<Frame> frame =
+        Frame::Allocate(nullptr, decoded->width(), decoded->height());
+    CopyRgbaFrame(decoded->data(), decoded->size(), decoded->stride(),
+                  decoded->width(), decoded->height(), frame->mutable_data(),
+                  frame->width(), frame->height(), false);
+    frame->set_timestamp_ns(stream_time);
+    cache_.Insert(std::move(frame), duration);
+    {
+      // Pairs with the predicate check in Seek() so the wakeup is not lost.
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+    changed_.notify_all();
+  }
+  return true;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,240 @@
+#include "kataglyphis_native_core/gst_runtime.h"
+
+#include <gst/gst.h>
+
+#include <cstdio>
+#include <thread>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsBetween(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+bool LookupPlugin(const std::string& name) {
+  GstPlugin* plugin = gst_registry_find_plugin(gst_registry_get(), name.c_str());
+  if (!plugin) return false;
+  gst_object_unref(plugin);
+  return true;
+}
+
+bool LookupElementProperty(const std::string& factory_name,
+                           const std::string& property) {
+  GstElementFactory* factory = gst_element_factory_find(factory_name.c_str());
+  if (!factory) return false;
+  GstPluginFeature* loaded =
+      gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+  gst_object_unref(factory);
+  if (!loaded) return false;
+  bool found = false;
+  const GType type =
+      gst_element_factory_get_element_type(GST_ELEMENT_FACTORY(loaded));
+  if (type != G_TYPE_INVALID) {
+    gpointer klass = g_type_class_ref(type);
+    found = g_object_class_find_property(G_OBJECT_CLASS(klass),
+                                         property.c_str()) != nullptr;
+    g_type_class_unref(klass);
+  }
+  gst_object_unref(loaded);
+  return found;
+}
+
+ElementFactoryIndex BuildElementIndex() {
+  GList* features = gst_registry_get_feature_list(gst_registry_get(),
+                                                  GST_TYPE_ELEMENT_FACTORY);
+  std::vector<std::string> names;
+  names.reserve(g_list_length(features));
+  for (GList* item = features; item != nullptr; item = item->next) {
+    names.emplace_back(
+        gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(item->data)));
+  }
+  gst_plugin_feature_list_free(features);
+  return ElementFactoryIndex(std::move(names));
+}
+
+void AppendMs(std::string* out, const char* label, double ms) {
+  char line[64];
+  std::snprintf(line, sizeof(line), "\n- %s: %.2f ms", label, ms);
+  *out += line;
+}
+
+}  // namespace
+
+// static
+GstRuntime& GstRuntime::Get() {
+  // Leaked on purpose: the init thread may still run during static
+  // destruction.
+  static GstRuntime* runtime = new GstRuntime();
+  return *runtime;
+}
+
+GstRuntime::~GstRuntime() {
+  // The init thread uses `this` until it has set ready_.
+  std::unique_lock<std::mutex> lock(mutex_);
+  ready_changed_.wait(lock, [this] { return !started_ || ready_; });
+}
+
+void GstRuntime::StartAsync(GstRuntimeOptions options) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) return;
+    started_ = true;
+    start_time_ = Clock::now();
+  }
+  std::thread([this, options = std::move(options)]() mutable {
+    Run(std::move(options));
+  }).detach();
+}
+
+void GstRuntime::WaitUntilReady() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!started_) {
+    started_ = true;
+    start_time_ = Clock::now();
+    lock.unlock();
+    Run(GstRuntimeOptions());
+    return;
+  }
+  ready_changed_.wait(lock, [this] { return ready_; });
+}
+
+bool GstRuntime::ready() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ready_;
+}
+
+void GstRuntime::Run(GstRuntimeOptions options) {
+  const Clock::time_point run_start = Clock::now();
+
+  gst_init(nullptr, nullptr);
+  const Clock::time_point init_done = Clock::now();
+
+  if (options.register_plugins) {
+    options.register_plugins();
+  }
+  const Clock::time_point register_done = Clock::now();
+
+  ElementFactoryIndex index = BuildElementIndex();
+  const Clock::time_point index_done = Clock::now();
+
+  std::map<std::string, bool> plugins;
+  for (const std::string& name : options.probe_plugins) {
+    plugins[name] = LookupPlugin(name);
+  }
+  const Clock::time_point probe_done = Clock::now();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  timings_.thread_start_ms = MsBetween(start_time_, run_start);
+  timings_.gst_init_ms = MsBetween(run_start, init_done);
+  timings_.plugin_register_ms = MsBetween(init_done, register_done);
+  timings_.index_ms = MsBetween(register_done, index_done);
+  timings_.probe_ms = MsBetween(index_done, probe_done);
+  timings_.total_ms = MsBetween(start_time_, probe_done);
+  probe_plugins_ = std::move(options.probe_plugins);
+  probe_elements_ = std::move(options.probe_elements);
+  plugins_.insert(plugins.begin(), plugins.end());
+  element_index_ = std::move(index);
+  ready_ = true;
+  ready_changed_.notify_all();
+}
+
+bool GstRuntime::HasPlugin(const std::string& name) {
+  WaitUntilReady();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = plugins_.find(name);
+    if (it != plugins_.end()) return it->second;
+  }
+  const bool found = LookupPlugin(name);
+  std::lock_guard<std::mutex> lock(mutex_);
+  plugins_[name] = found;
+  return found;
+}
+
+bool GstRuntime::HasElement(const std::string& name) {
+  return element_index().Contains(name);
+}
+
+bool GstRuntime::HasElementProperty(const std::string& factory,
+                                    const std::string& property) {
+  if (!HasElement(factory)) return false;
+  const std::string key = factory + "." + property;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = element_properties_.find(key);
+    if (it != element_properties_.end()) return it->second;
+  }
+  const bool found = LookupElementProperty(factory, property);
+  std::lock_guard<std::mutex> lock(mutex_);
+  element_properties_[key] = found;
+  return found;
+}
+
+const ElementFactoryIndex& GstRuntime::element_index() {
+  WaitUntilReady();
+  return element_index_;
+}
+
+GstRuntimeTimings GstRuntime::timings() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timings_;
+}
+
+std::string GstRuntime::Diagnose() {
+  WaitUntilReady();
+
+  std::vector<std::string> probe_plugins;
+  std::vector<std::string> probe_elements;
+  GstRuntimeTimings timings;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    probe_plugins = probe_plugins_;
+    probe_elements = probe_elements_;
+    timings = timings_;
+  }
+
+  std::string out;
+  out += "plugins:";
+  for (const std::string& name : probe_plugins) {
+    out += "\n- " + name + ": " + (HasPlugin(name) ? "yes" : "no");
+  }
+
+  out += "\n\nelements (" + std::to_string(element_index().size()) +
+         " factories indexed):";
+  for (const std::string& name : probe_elements) {
+    out += "\n- " + name + ": " + (HasElement(name) ? "yes" : "no");
+  }
+
+  out += "\n\ninit timings:";
+  AppendMs(&out, "thread start", timings.thread_start_ms);
+  AppendMs(&out, "gst_init", timings.gst_init_ms);
+  AppendMs(&out, "plugin registration", timings.plugin_register_ms);
+  AppendMs(&out, "element index", timings.index_ms);
+  AppendMs(&out, "availability probe", timings.probe_ms);
+  AppendMs(&out, "total", timings.total_ms);
+
+  GList* registered = gst_registry_get_plugin_list(gst_registry_get());
+  out += "\n\nregistered plugins (" +
+         std::to_string(g_list_length(registered)) + "):";
+  for (GList* item = registered; item != nullptr; item = item->next) {
+    GstPlugin* plugin = GST_PLUGIN(item->data);
+    const char* version = gst_plugin_get_version(plugin);
+    out += "\n- ";
+    out += gst_plugin_get_name(plugin);
+    out += " (v";
+    out += version ? version : "?";
+    out += ")";
+  }
+  gst_plugin_list_free(registered);
+
+  return out;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
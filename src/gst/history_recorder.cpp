@@ -0,0 +1,243 @@
+#include "kataglyphis_native_core/history_recorder.h"
+
+#include <gst/app/gstappsrc.h>
+
+#include <chrono>
+#include <utility>
+
+#include "kataglyphis_native_core/pipeline_controller.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Muxing a few hundred megabytes to local storage; a stuck filesystem
+// fails the dump instead of pinning the writer thread forever.
+constexpr std::chrono::seconds kWriteTimeout(120);
+
+// Keeps the frame or encoded bytes alive for as long as a GstBuffer
+// wrapping them is.
+template <typename Owner>
+GstBuffer* WrapReadOnly(const uint8_t* data, size_t size, Owner owner) {
+  auto* holder = new Owner(std::move(owner));
+  return gst_buffer_new_wrapped_full(
+      GST_MEMORY_FLAG_READONLY, const_cast<uint8_t*>(data), size, 0, size,
+      holder,
+      [](gpointer user_data) { delete static_cast<Owner*>(user_data); });
+}
+
+}  // namespace
+
+HistoryRecorder::HistoryRecorder(HistoryRecorderOptions options)
+    : options_(std::move(options)), history_(options_.history) {}
+
+HistoryRecorder::~HistoryRecorder() {
+  if (writer_.joinable()) writer_.join();
+  if (last_caps_) gst_caps_unref(last_caps_);
+}
+
+bool HistoryRecorder::Attach(GstElement* pipeline, GstElement* sink,
+                             std::string* error) {
+  if (!options_.encoded) return true;
+
+  GstPad* sink_pad = gst_element_get_static_pad(sink, "sink");
+  GstPad* upstream = sink_pad ? gst_pad_get_peer(sink_pad) : nullptr;
+  if (!upstream) {
+    if (sink_pad) gst_object_unref(sink_pad);
+    *error = "The display sink is not linked";
+    return false;
+  }
+
+  // The queue in front of the encoder leaks, so a slow encoder loses
+  // history frames instead of stalling the display.
+  GError* gerror = nullptr;
+  GstElement* branch = gst_parse_bin_from_description(
+      ("queue leaky=downstream max-size-buffers=8 max-size-time=0 "
+       "max-size-bytes=0 ! videoconvert ! " +
+       options_.encoder +
+       " ! appsink name=history sync=false async=false "
+       "enable-last-sample=false max-buffers=8")
+          .c_str(),
+      TRUE, &gerror);
+  if (!branch) {
+    *error = std::string("Invalid history encoder: ") +
+             (gerror ? gerror->message : "unknown");
+    g_clear_error(&gerror);
+    gst_object_unref(upstream);
+    gst_object_unref(sink_pad);
+    return false;
+  }
+  GstElement* tee = gst_element_factory_make("tee", nullptr);
+  GstElement* display_queue = gst_element_factory_make("queue", nullptr);
+  g_object_set(display_queue, "max-size-buffers", 1, "leaky", 2, nullptr);
+
+  gst_pad_unlink(upstream, sink_pad);
+  gst_bin_add_many(GST_BIN(pipeline), tee, display_queue, branch, nullptr);
+  GstPad* tee_sink = gst_element_get_static_pad(tee, "sink");
+  const bool linked =
+      gst_pad_link(upstream, tee_sink) == GST_PAD_LINK_OK &&
+      gst_element_link_many(tee, display_queue, sink, nullptr) &&
+      gst_element_link(tee, branch);
+  gst_object_unref(tee_sink);
+  gst_object_unref(upstream);
+  gst_object_unref(sink_pad);
+  if (!linked) {
+    *error = "Could not insert the history branch";
+    return false;
+  }
+
+  GstElement* history_sink = gst_bin_get_by_name(GST_BIN(branch), "history");
+  GstAppSinkCallbacks callbacks = {};
+  callbacks.new_sample = &HistoryRecorder::OnEncodedSample;
+  gst_app_sink_set_callbacks(GST_APP_SINK(history_sink), &callbacks, this,
+                             nullptr);
+  gst_object_unref(history_sink);
+  return true;
+}
+
+// static
+GstFlowReturn HistoryRecorder::OnEncodedSample(GstAppSink* sink,
+                                               gpointer user_data) {
+  auto* self = static_cast<HistoryRecorder*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (!sample) return GST_FLOW_ERROR;
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  GstMapInfo map;
+  if (buffer && GST_BUFFER_PTS_IS_VALID(buffer) &&
+      gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    HistoryFrame frame;
+    frame.timestamp_ns = static_cast<int64_t>(GST_BUFFER_PTS(buffer));
+    frame.keyframe =
+        !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    frame.encoded = std::make_shared<const std::vector<uint8_t>>(
+        map.data, map.data + map.size);
+    gst_buffer_unmap(buffer, &map);
+
+    GstCaps* caps = gst_sample_get_caps(sample);
+    if (caps && caps != self->last_caps_) {
+      gchar* caps_string = gst_caps_to_string(caps);
+      {
+        std::lock_guard<std::mutex> lock(self->caps_mutex_);
+        self->caps_ = caps_string;
+      }
+      g_free(caps_string);
+      gst_caps_replace(&self->last_caps_, caps);
+    }
+    self->history_.Push(std::move(frame));
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+void HistoryRecorder::PushRaw(const Frame& frame) {
+  if (options_.encoded || frame.timestamp_ns() < 0) return;
+  HistoryFrame recorded;
+  recorded.timestamp_ns = frame.timestamp_ns();
+  recorded.frame = history_.CopyFrame(frame);
+  history_.Push(std::move(recorded));
+}
+
+bool HistoryRecorder::Dump(const std::string& path, int64_t window_ns,
+                           DumpCallback done, std::string* error) {
+  if (dumping_.exchange(true)) {
+    *error = "A dump is already being written";
+    return false;
+  }
+  std::vector<HistoryFrame> frames = history_.Snapshot(window_ns);
+  if (frames.empty()) {
+    dumping_.store(false);
+    *error = "Nothing recorded yet";
+    return false;
+  }
+  std::string caps;
+  if (options_.encoded) {
+    std::lock_guard<std::mutex> lock(caps_mutex_);
+    caps = caps_;
+  } else {
+    const Frame& first = *frames.front().frame;
+    caps = "video/x-raw,format=RGBA,width=" + std::to_string(first.width()) +
+           ",height=" + std::to_string(first.height()) + ",framerate=0/1";
+  }
+
+  // The previous writer has finished (dumping_ was false).
+  if (writer_.joinable()) writer_.join();
+  writer_ = std::thread(
+      [this, path, frames = std::move(frames), caps, done = std::move(done)] {
+        const HistoryDumpResult result = WriteFile(path, frames, caps);
+        dumping_.store(false);
+        if (done) done(result);
+      });
+  return true;
+}
+
+HistoryDumpResult HistoryRecorder::WriteFile(
+    const std::string& path, const std::vector<HistoryFrame>& frames,
+    const std::string& caps) {
+  HistoryDumpResult result;
+  result.path = path;
+
+  // Raw frames are compressed on the way out; encoded streams only need
+  // parsing into the form the muxer takes.
+  std::string chain = "videoconvert ! jpegenc ! ";
+  if (options_.encoded) {
+    chain.clear();
+    if (caps.rfind("video/x-h264", 0) == 0) chain = "h264parse ! ";
+    if (caps.rfind("video/x-h265", 0) == 0) chain = "h265parse ! ";
+  }
+  PipelineController controller;
+  if (!controller.Load("appsrc name=src format=time block=true ! " + chain +
+                           "matroskamux ! filesink location=\"" + path +
+                           "\"",
+                       &result.error)) {
+    return result;
+  }
+  GstElement* pipeline = controller.pipeline();
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+  GstCaps* src_caps = gst_caps_from_string(caps.c_str());
+  g_object_set(src, "caps", src_caps, nullptr);
+  if (src_caps) gst_caps_unref(src_caps);
+
+  // appsrc only prerolls once data arrives, so do not wait for PLAYING.
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  const int64_t base = frames.front().timestamp_ns;
+  GstFlowReturn flow = GST_FLOW_OK;
+  for (size_t i = 0; i < frames.size() && flow == GST_FLOW_OK; ++i) {
+    const HistoryFrame& frame = frames[i];
+    GstBuffer* buffer =
+        frame.frame ? WrapReadOnly(frame.frame->data(), frame.frame->size(),
+                                   frame.frame)
+                    : WrapReadOnly(frame.encoded->data(),
+                                   frame.encoded->size(), frame.encoded);
+    GST_BUFFER_PTS(buffer) =
+        static_cast<GstClockTime>(frame.timestamp_ns - base);
+    if (i + 1 < frames.size()) {
+      GST_BUFFER_DURATION(buffer) = static_cast<GstClockTime>(
+          frames[i + 1].timestamp_ns - frame.timestamp_ns);
+    }
+    if (!frame.keyframe) {
+      GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    }
+    flow = gst_app_src_push_buffer(GST_APP_SRC(src), buffer);
+  }
+  gst_app_src_end_of_stream(GST_APP_SRC(src));
+  gst_object_unref(src);
+
+  // The controller's bus handler consumes the EOS, so wait through it.
+  std::string wait_error;
+  const bool eos = controller.WaitForEos(kWriteTimeout, &wait_error);
+  if (eos && flow == GST_FLOW_OK) {
+    result.ok = true;
+    result.frames = frames.size();
+    result.span_ns = frames.back().timestamp_ns - base;
+  } else {
+    result.error = std::string("Writing ") + path + " failed: " +
+                   (eos ? gst_flow_get_name(flow) : wait_error);
+  }
+  controller.Release();
+  return result;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
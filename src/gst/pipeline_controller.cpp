@@ -0,0 +1,439 @@
+#include "kataglyphis_native_core/pipeline_controller.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Waits for the preroll a flushing seek or step started. Playing
+// pipelines do not block; their next frame simply comes from the new
+// position.
+bool WaitForPreroll(GstElement* pipeline, std::chrono::milliseconds timeout) {
+  const GstClockTime wait =
+      static_cast<GstClockTime>(timeout.count()) * GST_MSECOND;
+  return gst_element_get_state(pipeline, nullptr, nullptr, wait) ==
+         GST_STATE_CHANGE_SUCCESS;
+}
+
+// Duration of one frame at the framerate negotiated on the first sink that
+// has one, or -1.
+int64_t SinkFrameDuration(GstElement* pipeline) {
+  int64_t duration = -1;
+  GstIterator* sinks = gst_bin_iterate_sinks(GST_BIN(pipeline));
+  GValue item = G_VALUE_INIT;
+  while (duration < 0 &&
+         gst_iterator_next(sinks, &item) == GST_ITERATOR_OK) {
+    GstElement* sink = GST_ELEMENT(g_value_get_object(&item));
+    GstPad* pad = gst_element_get_static_pad(sink, "sink");
+    GstCaps* caps = pad ? gst_pad_get_current_caps(pad) : nullptr;
+    gint num = 0;
+    gint den = 0;
+    if (caps && gst_caps_get_size(caps) > 0 &&
+        gst_structure_get_fraction(gst_caps_get_structure(caps, 0),
+                                   "framerate", &num, &den) &&
+        num > 0 && den > 0) {
+      duration = static_cast<int64_t>(
+          gst_util_uint64_scale_int(GST_SECOND, den, num));
+    }
+    if (caps) gst_caps_unref(caps);
+    if (pad) gst_object_unref(pad);
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(sinks);
+  return duration;
+}
+
+}  // namespace
+
+PipelineController::PipelineController(
+    std::shared_ptr<DiagnosticRing> diagnostics)
+    : diagnostics_(diagnostics ? std::move(diagnostics)
+                               : std::make_shared<DiagnosticRing>(64)) {}
+
+PipelineController::~PipelineController() { Release(); }
+
+bool PipelineController::Load(const std::string& description,
+                              std::string* error) {
+  Release();
+  GstRuntime::Get().WaitUntilReady();
+
+  GError* parse_error = nullptr;
+  GstElement* element = gst_parse_launch(description.c_str(), &parse_error);
+  if (!element) {
+    if (error) {
+      *error = std::string("parse error: ") +
+               (parse_error ? parse_error->message : "unknown");
+    }
+    if (parse_error) g_error_free(parse_error);
+    return false;
+  }
+  if (parse_error) {
+    // Recoverable parse warnings (e.g. unknown properties); keep going.
+    diagnostics_->Record(DiagnosticSeverity::kWarning, "parse",
+                         parse_error->code, parse_error->message);
+    g_error_free(parse_error);
+  }
+  if (g_object_is_floating(element)) {
+    gst_object_ref_sink(element);
+  }
+  if (!GST_IS_PIPELINE(element)) {
+    if (error) {
+      *error = "Pipeline description must describe a bin/pipeline";
+    }
+    gst_object_unref(element);
+    return false;
+  }
+
+  Adopt(element);
+  // Adopt took its own reference.
+  gst_object_unref(element);
+  return true;
+}
+
+void PipelineController::Adopt(GstElement* pipeline) {
+  Release();
+  if (!pipeline) return;
+  if (g_object_is_floating(pipeline)) {
+    gst_object_ref_sink(pipeline);
+    pipeline_ = pipeline;
+  } else {
+    pipeline_ = GST_ELEMENT(gst_object_ref(pipeline));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_state_ = GST_STATE_NULL;
+    pending_state_ = GST_STATE_VOID_PENDING;
+    errors_at_adopt_ = error_count_;
+    eos_ = false;
+  }
+  AttachBus();
+}
+
+void PipelineController::Release() {
+  if (!pipeline_) return;
+  // NULL first: joins the streaming threads so nothing posts to the bus
+  // while the sync handler is being removed.
+  gst_element_set_state(pipeline_, GST_STATE_NULL);
+  DetachBus();
+  gst_object_unref(pipeline_);
+  pipeline_ = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  current_state_ = GST_STATE_NULL;
+  pending_state_ = GST_STATE_VOID_PENDING;
+  eos_ = false;
+  state_changed_.notify_all();
+}
+
+void PipelineController::AttachBus() {
+  bus_ = gst_element_get_bus(pipeline_);
+  if (bus_) {
+    gst_bus_set_sync_handler(bus_, &PipelineController::OnBusMessage, this,
+                             nullptr);
+  }
+}
+
+void PipelineController::DetachBus() {
+  if (!bus_) return;
+  gst_bus_set_sync_handler(bus_, nullptr, nullptr, nullptr);
+  gst_object_unref(bus_);
+  bus_ = nullptr;
+}
+
+GstStateChangeReturn PipelineController::SetState(
+    GstState target, std::chrono::milliseconds timeout) {
+  if (!pipeline_) return GST_STATE_CHANGE_FAILURE;
+
+  uint64_t errors_before = 0;
+  uint64_t changes_before = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    errors_before = error_count_;
+    changes_before = state_change_count_;
+  }
+  const GstStateChangeReturn ret = gst_element_set_state(pipeline_, target);
+  if (ret != GST_STATE_CHANGE_ASYNC) {
+    return ret;
+  }
+
+  // Wake on the first settled state after our request (the target, or
+  // whatever a concurrent request moved the pipeline to) or on an error.
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  bool errored = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    state_changed_.wait_until(lock, deadline, [&] {
+      return error_count_ != errors_before ||
+             (state_change_count_ != changes_before &&
+              pending_state_ == GST_STATE_VOID_PENDING);
+    });
+    errored = error_count_ != errors_before;
+  }
+  if (errored) {
+    return GST_STATE_CHANGE_FAILURE;
+  }
+
+  // The element is the authority; the bus only told us when to look. A
+  // short grace period covers STATE_CHANGED racing the final commit.
+  const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      deadline - std::chrono::steady_clock::now());
+  const GstClockTime grace =
+      remaining.count() > 0
+          ? std::min<GstClockTime>(static_cast<GstClockTime>(remaining.count()),
+                                   10 * GST_MSECOND)
+          : 0;
+  GstState current = GST_STATE_VOID_PENDING;
+  GstState pending = GST_STATE_VOID_PENDING;
+  const GstStateChangeReturn final_ret =
+      gst_element_get_state(pipeline_, &current, &pending, grace);
+  if (final_ret == GST_STATE_CHANGE_FAILURE) {
+    return GST_STATE_CHANGE_FAILURE;
+  }
+  if (final_ret == GST_STATE_CHANGE_ASYNC) {
+    return GST_STATE_CHANGE_ASYNC;
+  }
+  if (current != target) {
+    // Settled somewhere else: another thread changed the state meanwhile.
+    return GST_STATE_CHANGE_FAILURE;
+  }
+  return final_ret;
+}
+
+GstStateChangeReturn PipelineController::WaitForState(
+    GstState target, std::chrono::milliseconds timeout) {
+  if (!pipeline_) return GST_STATE_CHANGE_FAILURE;
+  GstState current = GST_STATE_VOID_PENDING;
+  GstState pending = GST_STATE_VOID_PENDING;
+  if (gst_element_get_state(pipeline_, &current, &pending, 0) !=
+          GST_STATE_CHANGE_ASYNC &&
+      current == target) {
+    return GST_STATE_CHANGE_SUCCESS;
+  }
+  // Re-requesting the same target is a no-op for GStreamer but gives us
+  // the same event-driven wait.
+  return SetState(target, timeout);
+}
+
+bool PipelineController::WaitForEos(std::chrono::milliseconds timeout,
+                                    std::string* error) {
+  if (!pipeline_) {
+    if (error) *error = "No pipeline loaded";
+    return false;
+  }
+  bool eos = false;
+  bool errored = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    state_changed_.wait_for(lock, timeout, [&] {
+      return eos_ || error_count_ != errors_at_adopt_;
+    });
+    eos = eos_;
+    errored = error_count_ != errors_at_adopt_;
+  }
+  if (errored) {
+    if (error) {
+      *error = LastBusError();
+      if (error->empty()) *error = "bus error";
+    }
+    return false;
+  }
+  if (!eos) {
+    if (error) *error = "Timed out waiting for end of stream";
+    return false;
+  }
+  return true;
+}
+
+std::string PipelineController::LastBusError() const {
+  const std::vector<DiagnosticRecord> records = diagnostics_->Recent(16);
+  for (auto it = records.rbegin(); it != records.rend(); ++it) {
+    if (it->severity == DiagnosticSeverity::kError) {
+      return FormatDiagnostic(*it);
+    }
+  }
+  return "";
+}
+
+// static
+GstBusSyncReply PipelineController::OnBusMessage(GstBus* /*bus*/,
+                                                 GstMessage* message,
+                                                 gpointer user_data) {
+  static_cast<PipelineController*>(user_data)->HandleBusMessage(message);
+  // Everything a caller needs from the bus (state, errors, EOS) is tracked
+  // by the handler, so dropping keeps the async queue from growing; this
+  // is why callers must wait through the controller instead of popping.
+  return GST_BUS_DROP;
+}
+
+void PipelineController::HandleBusMessage(GstMessage* message) {
+  switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_ERROR:
+    case GST_MESSAGE_WARNING: {
+      const bool is_error = GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR;
+      // Read the fields in place; gst_message_parse_error() would copy the
+      // GError and debug string on the streaming thread.
+      const GstStructure* details = gst_message_get_structure(message);
+      const GValue* error_value =
+          details ? gst_structure_get_value(details, "gerror") : nullptr;
+      const GError* err =
+          error_value ? static_cast<const GError*>(g_value_get_boxed(error_value))
+                      : nullptr;
+      const gchar* debug =
+          details ? gst_structure_get_string(details, "debug") : nullptr;
+      diagnostics_->Record(
+          is_error ? DiagnosticSeverity::kError : DiagnosticSeverity::kWarning,
+          GST_MESSAGE_SRC(message) && GST_MESSAGE_SRC_NAME(message)
+              ? GST_MESSAGE_SRC_NAME(message)
+              : "bus",
+          err ? err->code : 0, err && err->message ? err->message : "unknown",
+          debug ? debug : "");
+
+      if (is_error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++error_count_;
+        state_changed_.notify_all();
+      }
+      break;
+    }
+    case GST_MESSAGE_STATE_CHANGED: {
+      if (GST_MESSAGE_SRC(message) != GST_OBJECT(pipeline_)) break;
+      GstState old_state = GST_STATE_VOID_PENDING;
+      GstState new_state = GST_STATE_VOID_PENDING;
+      GstState pending = GST_STATE_VOID_PENDING;
+      gst_message_parse_state_changed(message, &old_state, &new_state,
+                                      &pending);
+      std::lock_guard<std::mutex> lock(mutex_);
+      current_state_ = new_state;
+      pending_state_ = pending;
+      ++state_change_count_;
+      state_changed_.notify_all();
+      break;
+    }
+    case GST_MESSAGE_STREAM_STATUS:
+      if (task_pool_) task_pool_->HandleStreamStatus(message);
+      break;
+    case GST_MESSAGE_ASYNC_DONE: {
+      std::lock_guard<std::mutex> lock(mutex_);
+      state_changed_.notify_all();
+      break;
+    }
+    case GST_MESSAGE_EOS: {
+      std::lock_guard<std::mutex> lock(mutex_);
+      eos_ = true;
+      state_changed_.notify_all();
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+bool InputToUri(const std::string& input, std::string* uri,
+                std::string* error) {
+  if (gst_uri_is_valid(input.c_str())) {
+    *uri = input;
+    return true;
+  }
+  GError* gerror = nullptr;
+  gchar* converted = gst_filename_to_uri(input.c_str(), &gerror);
+  if (!converted) {
+    *error = "Invalid input '" + input +
+             "': " + (gerror ? gerror->message : "not a path or URI");
+    g_clear_error(&gerror);
+    return false;
+  }
+  *uri = converted;
+  g_free(converted);
+  return true;
+}
+
+const char* StateToString(GstState state) {
+  switch (state) {
+    case GST_STATE_VOID_PENDING: return "VOID_PENDING";
+    case GST_STATE_NULL: return "NULL";
+    case GST_STATE_READY: return "READY";
+    case GST_STATE_PAUSED: return "PAUSED";
+    case GST_STATE_PLAYING: return "PLAYING";
+    default: return "UNKNOWN";
+  }
+}
+
+const char* StateChangeReturnToString(GstStateChangeReturn ret) {
+  switch (ret) {
+    case GST_STATE_CHANGE_FAILURE: return "FAILURE";
+    case GST_STATE_CHANGE_SUCCESS: return "SUCCESS";
+    case GST_STATE_CHANGE_ASYNC: return "ASYNC";
+    case GST_STATE_CHANGE_NO_PREROLL: return "NO_PREROLL";
+    default: return "UNKNOWN";
+  }
+}
+
+bool SeekToFrame(GstElement* pipeline, int64_t position_ns,
+                 std::chrono::milliseconds timeout, std::string* error) {
+  if (position_ns < 0) {
+    *error = "Negative seek position";
+    return false;
+  }
+  if (!gst_element_seek_simple(
+          pipeline, GST_FORMAT_TIME,
+          static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH |
+                                    GST_SEEK_FLAG_ACCURATE),
+          position_ns)) {
+    *error = "Seek to " + std::to_string(position_ns) +
+             " ns failed; the source may not be seekable";
+    return false;
+  }
+  if (!WaitForPreroll(pipeline, timeout)) {
+    *error = "Pipeline did not preroll after seeking";
+    return false;
+  }
+  return true;
+}
+
+bool StepFrames(GstElement* pipeline, int frames,
+                std::chrono::milliseconds timeout, std::string* error) {
+  if (frames == 0) return true;
+  if (frames < 0) {
+    const int64_t frame_ns = SinkFrameDuration(pipeline);
+    const int64_t position = QueryPositionNs(pipeline);
+    if (frame_ns <= 0 || position < 0) {
+      *error = "Cannot step backward without a known framerate and position";
+      return false;
+    }
+    // Half a frame into the target so rounding cannot land on its
+    // predecessor.
+    const int64_t target = position + frames * frame_ns + frame_ns / 2;
+    return SeekToFrame(pipeline, std::max<int64_t>(target, 0), timeout,
+                       error);
+  }
+  if (!gst_element_send_event(
+          pipeline, gst_event_new_step(GST_FORMAT_BUFFERS,
+                                       static_cast<guint64>(frames), 1.0,
+                                       TRUE, FALSE))) {
+    *error = "Frame step failed; pause the pipeline first";
+    return false;
+  }
+  if (!WaitForPreroll(pipeline, timeout)) {
+    *error = "Pipeline did not preroll after stepping";
+    return false;
+  }
+  return true;
+}
+
+int64_t QueryPositionNs(GstElement* pipeline) {
+  gint64 position = -1;
+  if (!gst_element_query_position(pipeline, GST_FORMAT_TIME, &position)) {
+    return -1;
+  }
+  return position;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
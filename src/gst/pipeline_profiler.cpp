@@ -0,0 +1,307 @@
+#include "kataglyphis_native_core/pipeline_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Processing-time samples kept per element; the newest win.
+constexpr size_t kMaxSamples = 1024;
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double ToMs(double ns) { return ns / 1e6; }
+
+guint BufferCount(GstPadProbeInfo* info) {
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    return gst_buffer_list_length(GST_PAD_PROBE_INFO_BUFFER_LIST(info));
+  }
+  return 1;
+}
+
+bool IsQueue(const std::string& factory) {
+  return factory == "queue" || factory == "queue2";
+}
+
+// Sink-pad entry times of the elements currently processing a buffer on
+// this thread. A chain of synchronous elements nests, so this stays short.
+std::vector<std::pair<const void*, int64_t>>& ThreadEntries() {
+  thread_local std::vector<std::pair<const void*, int64_t>> entries;
+  return entries;
+}
+
+// Children of `bin` in data-flow order, sources first; bins are descended
+// into instead of probed, so ghost pads do not count twice.
+void CollectElements(GstBin* bin, std::vector<GstElement*>* out) {
+  std::vector<GstElement*> sorted;
+  GstIterator* it = gst_bin_iterate_sorted(bin);
+  GValue item = G_VALUE_INIT;
+  bool done = false;
+  while (!done) {
+    switch (gst_iterator_next(it, &item)) {
+      case GST_ITERATOR_OK:
+        sorted.push_back(GST_ELEMENT(g_value_dup_object(&item)));
+        g_value_reset(&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        for (GstElement* element : sorted) gst_object_unref(element);
+        sorted.clear();
+        gst_iterator_resync(it);
+        break;
+      default:
+        done = true;
+        break;
+    }
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+
+  // The iterator yields sinks first.
+  for (auto element = sorted.rbegin(); element != sorted.rend(); ++element) {
+    if (GST_IS_BIN(*element)) {
+      CollectElements(GST_BIN(*element), out);
+      gst_object_unref(*element);
+    } else {
+      out->push_back(*element);
+    }
+  }
+}
+
+}  // namespace
+
+struct PipelineProfiler::ElementState {
+  GstElement* element = nullptr;  // owned reference
+  std::string name;
+  std::string factory;
+  bool is_queue = false;
+  bool has_src_pads = false;
+  uint32_t queue_capacity = 0;
+
+  mutable std::mutex mutex;
+  uint64_t buffers = 0;
+  uint64_t processing_samples = 0;
+  double processing_sum_ns = 0.0;
+  std::vector<int64_t> processing_ns;
+  double fill_sum = 0.0;
+  uint64_t fill_samples = 0;
+  uint32_t fill_max = 0;
+
+  static GstPadProbeReturn OnSinkBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                        gpointer user_data);
+  static GstPadProbeReturn OnSrcBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                       gpointer user_data);
+};
+
+// static
+GstPadProbeReturn PipelineProfiler::ElementState::OnSinkBuffer(
+    GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data) {
+  auto* state = static_cast<ElementState*>(user_data);
+  const int64_t now = NowNs();
+  auto& entries = ThreadEntries();
+  auto entry = std::find_if(entries.begin(), entries.end(),
+                            [state](const auto& e) { return e.first == state; });
+  if (entry != entries.end()) {
+    entry->second = now;
+  } else {
+    entries.emplace_back(state, now);
+  }
+
+  guint level = 0;
+  if (state->is_queue) {
+    // Read before the queue's chain function takes its own lock.
+    g_object_get(state->element, "current-level-buffers", &level, nullptr);
+  }
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (!state->has_src_pads) state->buffers += BufferCount(info);
+  if (state->is_queue) {
+    state->fill_sum += level;
+    ++state->fill_samples;
+    state->fill_max = std::max<uint32_t>(state->fill_max, level);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+// static
+GstPadProbeReturn PipelineProfiler::ElementState::OnSrcBuffer(
+    GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data) {
+  auto* state = static_cast<ElementState*>(user_data);
+  const int64_t now = NowNs();
+  int64_t processing = -1;
+  auto& entries = ThreadEntries();
+  auto entry = std::find_if(entries.begin(), entries.end(),
+                            [state](const auto& e) { return e.first == state; });
+  if (entry != entries.end()) {
+    // Only the first push per input counts; later ones (e.g. a demuxer
+    // splitting one buffer) would include the pushes before them.
+    processing = now - entry->second;
+    *entry = entries.back();
+    entries.pop_back();
+  }
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->buffers += BufferCount(info);
+  if (processing >= 0) {
+    if (state->processing_ns.size() < kMaxSamples) {
+      state->processing_ns.push_back(processing);
+    } else {
+      state->processing_ns[state->processing_samples % kMaxSamples] =
+          processing;
+    }
+    ++state->processing_samples;
+    state->processing_sum_ns += static_cast<double>(processing);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+PipelineProfiler::PipelineProfiler(GstElement* pipeline) {
+  start_ns_ = NowNs();
+  if (!pipeline) return;
+  std::vector<GstElement*> elements;
+  if (GST_IS_BIN(pipeline)) {
+    CollectElements(GST_BIN(pipeline), &elements);
+  } else {
+    elements.push_back(GST_ELEMENT(gst_object_ref(pipeline)));
+  }
+  for (GstElement* element : elements) AttachElement(element);
+}
+
+PipelineProfiler::~PipelineProfiler() {
+  for (const Probe& probe : probes_) {
+    gst_pad_remove_probe(probe.pad, probe.id);
+    gst_object_unref(probe.pad);
+  }
+  // Probe callbacks that already started finish before
+  // gst_pad_remove_probe returns, so the states are unused now.
+  for (const auto& state : elements_) gst_object_unref(state->element);
+}
+
+void PipelineProfiler::AttachElement(GstElement* element) {
+  auto state = std::make_unique<ElementState>();
+  state->element = element;  // takes the reference from CollectElements
+  gchar* name = gst_element_get_name(element);
+  state->name = name ? name : "";
+  g_free(name);
+  GstElementFactory* factory = gst_element_get_factory(element);
+  state->factory =
+      factory ? GST_OBJECT_NAME(factory) : G_OBJECT_TYPE_NAME(element);
+  state->is_queue = IsQueue(state->factory);
+  // Known before any probe can fire: sinks count on their sink pads.
+  GST_OBJECT_LOCK(element);
+  state->has_src_pads = element->numsrcpads > 0;
+  GST_OBJECT_UNLOCK(element);
+  if (state->is_queue) {
+    guint capacity = 0;
+    g_object_get(element, "max-size-buffers", &capacity, nullptr);
+    state->queue_capacity = capacity;
+  }
+
+  constexpr auto kBufferProbes = static_cast<GstPadProbeType>(
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST);
+  GstIterator* it = gst_element_iterate_pads(element);
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+    auto* pad = GST_PAD(g_value_dup_object(&item));
+    g_value_reset(&item);
+    const bool is_src = GST_PAD_DIRECTION(pad) == GST_PAD_SRC;
+    const gulong id = gst_pad_add_probe(
+        pad, kBufferProbes,
+        is_src ? &ElementState::OnSrcBuffer : &ElementState::OnSinkBuffer,
+        state.get(), nullptr);
+    if (id != 0) {
+      probes_.push_back(Probe{pad, id});
+    } else {
+      gst_object_unref(pad);
+    }
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+  elements_.push_back(std::move(state));
+}
+
+std::vector<ElementProfile> PipelineProfiler::Snapshot() const {
+  const double seconds =
+      static_cast<double>(std::max<int64_t>(NowNs() - start_ns_, 1)) / 1e9;
+  std::vector<ElementProfile> profiles;
+  profiles.reserve(elements_.size());
+  std::vector<int64_t> sorted;
+  for (const auto& state : elements_) {
+    ElementProfile profile;
+    profile.name = state->name;
+    profile.factory = state->factory;
+    profile.is_queue = state->is_queue;
+    profile.queue_capacity = state->queue_capacity;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      profile.buffers = state->buffers;
+      profile.processing_samples = state->processing_samples;
+      if (state->processing_samples > 0) {
+        profile.processing_mean_ms =
+            ToMs(state->processing_sum_ns /
+                 static_cast<double>(state->processing_samples));
+      }
+      sorted = state->processing_ns;
+      if (state->fill_samples > 0) {
+        profile.queue_fill_mean =
+            state->fill_sum / static_cast<double>(state->fill_samples);
+      }
+      profile.queue_fill_max = state->fill_max;
+    }
+    profile.rate_hz = static_cast<double>(profile.buffers) / seconds;
+    if (!sorted.empty()) {
+      std::sort(sorted.begin(), sorted.end());
+      profile.processing_p50_ms =
+          ToMs(static_cast<double>(sorted[(sorted.size() - 1) / 2]));
+      profile.processing_p95_ms = ToMs(
+          static_cast<double>(sorted[(sorted.size() - 1) * 95 / 100]));
+      profile.processing_max_ms = ToMs(static_cast<double>(sorted.back()));
+    }
+    profiles.push_back(std::move(profile));
+  }
+  return profiles;
+}
+
+std::string FormatProfileTable(const std::vector<ElementProfile>& profiles) {
+  std::string table;
+  char line[256];
+  std::snprintf(line, sizeof(line),
+                "%-20s %-16s %9s %8s %9s %9s %9s %9s %s\n", "element",
+                "factory", "buffers", "rate/s", "mean ms", "p50 ms",
+                "p95 ms", "max ms", "queue fill (mean/max/cap)");
+  table += line;
+  for (const ElementProfile& profile : profiles) {
+    std::snprintf(line, sizeof(line), "%-20.20s %-16.16s %9llu %8.1f",
+                  profile.name.c_str(), profile.factory.c_str(),
+                  static_cast<unsigned long long>(profile.buffers),
+                  profile.rate_hz);
+    table += line;
+    if (profile.processing_samples > 0) {
+      std::snprintf(line, sizeof(line), " %9.3f %9.3f %9.3f %9.3f",
+                    profile.processing_mean_ms, profile.processing_p50_ms,
+                    profile.processing_p95_ms, profile.processing_max_ms);
+    } else {
+      std::snprintf(line, sizeof(line), " %9s %9s %9s %9s", "-", "-", "-",
+                    "-");
+    }
+    table += line;
+    if (profile.is_queue) {
+      std::snprintf(line, sizeof(line), " %.1f/%u/%u", profile.queue_fill_mean,
+                    profile.queue_fill_max, profile.queue_capacity);
+      table += line;
+    }
+    table += '\n';
+  }
+  return table;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
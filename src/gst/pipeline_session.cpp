@@ -0,0 +1,320 @@
+#include "kataglyphis_native_core/pipeline_session.h"
+
+#include <future>
+#include <utility>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_validator.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+struct WorkerCall {
+  const std::function<void()>* fn;
+  std::promise<void> done;
+};
+
+gboolean RunWorkerCall(gpointer user_data) {
+  auto* call = static_cast<WorkerCall*>(user_data);
+  (*call->fn)();
+  call->done.set_value();
+  return G_SOURCE_REMOVE;
+}
+
+// Enough for the summary lines plus the bus errors that caused them.
+constexpr size_t kMaxErrorLines = 32;
+
+gboolean QuitLoop(gpointer user_data) {
+  g_main_loop_quit(static_cast<GMainLoop*>(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// Idle sources (rather than g_main_context_invoke) so the callback always
+// runs on the loop thread, even if the loop has not started yet.
+void AttachIdle(GMainContext* context, GSourceFunc fn, gpointer data) {
+  GSource* source = g_idle_source_new();
+  g_source_set_callback(source, fn, data, nullptr);
+  g_source_attach(source, context);
+  g_source_unref(source);
+}
+
+void StopController(const std::shared_ptr<PipelineController>& controller) {
+  // Another thread may still wait on it; reaching NULL wakes that waiter
+  // and releases the source device right away.
+  if (controller) {
+    controller->SetState(GST_STATE_NULL, std::chrono::milliseconds(0));
+  }
+}
+
+}  // namespace
+
+PipelineSession::PipelineSession()
+    : diagnostics_(std::make_shared<DiagnosticRing>(128)) {
+  context_ = g_main_context_new();
+  loop_ = g_main_loop_new(context_, FALSE);
+  GMainContext* context = context_;
+  GMainLoop* loop = loop_;
+  worker_ = std::thread([context, loop]() {
+    g_main_context_push_thread_default(context);
+    g_main_loop_run(loop);
+    g_main_context_pop_thread_default(context);
+  });
+}
+
+PipelineSession::~PipelineSession() { Close(); }
+
+bool PipelineSession::SetPipeline(const std::string& description,
+                                  const PrepareFn& prepare,
+                                  std::chrono::milliseconds preroll_timeout) {
+  GstRuntime& runtime = GstRuntime::Get();
+  runtime.WaitUntilReady();
+
+  // Checks the whole description against the cached factory index, so a
+  // typo anywhere fails here in microseconds instead of after the preroll
+  // timeout.
+  const PipelineValidation validation =
+      ValidatePipeline(description, runtime.element_index());
+  ResetLastError();
+  std::shared_ptr<StreamingThreadPool> task_pool;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      RecordError("Session is closed");
+      return false;
+    }
+    task_pool = task_pool_;
+  }
+  if (!validation.ok) {
+    RecordError(validation.missing_element.empty()
+                    ? validation.error
+                    : validation.error + "; see diagnose()");
+    return false;
+  }
+
+  auto controller = std::make_shared<PipelineController>(diagnostics_);
+  controller->set_task_pool(task_pool ? std::move(task_pool)
+                                      : StreamingThreadPool::Default());
+  std::string error;
+  bool loaded = false;
+  RunOnWorker([&] {
+    loaded = controller->Load(description, &error) &&
+             (!prepare || prepare(controller->pipeline(), &error));
+  });
+  if (!loaded) {
+    RecordError(error.empty() ? "Failed to prepare pipeline" : error);
+    return false;
+  }
+
+  std::shared_ptr<PipelineController> previous;
+  uint64_t generation = 0;
+  {
+    // Published before prerolling so Stop()/Close() can interrupt the wait.
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous = std::move(controller_);
+    controller_ = controller;
+    generation = ++generation_;
+  }
+  // The old pipeline must be gone before the new one opens the device.
+  StopController(previous);
+  previous.reset();
+
+  // Force READY first to avoid sticky pending states on reuse.
+  controller->SetState(GST_STATE_READY, std::chrono::seconds(5));
+  const GstStateChangeReturn ret =
+      controller->SetState(GST_STATE_PAUSED, preroll_timeout);
+
+  // Element errors (e.g. camera open failures) were already recorded from
+  // the bus, ahead of the summary lines below.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (generation != generation_ || closed_) {
+    RecordError("setPipeline superseded by stop/dispose or a newer pipeline");
+    return false;
+  }
+
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    RecordError("Failed to preroll pipeline");
+  } else if (ret == GST_STATE_CHANGE_ASYNC) {
+    RecordError("Pipeline still ASYNC after " +
+                std::to_string(preroll_timeout.count()) +
+                " ms - caps negotiation failed or source unavailable; see "
+                "diagnose()");
+  }
+
+  // Only accept SUCCESS or NO_PREROLL as valid results. The failed
+  // pipeline is torn down once `controller` goes out of scope.
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+    RecordError("Pipeline failed to reach PAUSED state");
+    controller_.reset();
+    ++generation_;
+    return false;
+  }
+  return true;
+}
+
+bool PipelineSession::Play(std::chrono::milliseconds timeout) {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = controller_;
+  }
+  if (!controller) return false;
+
+  ResetLastError();
+  const GstStateChangeReturn ret =
+      controller->SetState(GST_STATE_PLAYING, timeout);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    RecordError("Failed to set pipeline to PLAYING");
+  }
+  return ret != GST_STATE_CHANGE_FAILURE;
+}
+
+bool PipelineSession::Pause(std::chrono::milliseconds timeout) {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = controller_;
+  }
+  if (!controller) return false;
+  return controller->SetState(GST_STATE_PAUSED, timeout) !=
+         GST_STATE_CHANGE_FAILURE;
+}
+
+bool PipelineSession::Stop() {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = std::move(controller_);
+    ++generation_;
+  }
+  StopController(controller);
+  return controller != nullptr;
+}
+
+bool PipelineSession::Seek(int64_t position_ns,
+                           std::chrono::milliseconds timeout) {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = controller_;
+  }
+  if (!controller || !controller->pipeline()) return false;
+
+  ResetLastError();
+  std::string error;
+  if (!SeekToFrame(controller->pipeline(), position_ns, timeout, &error)) {
+    RecordError(error);
+    return false;
+  }
+  return true;
+}
+
+bool PipelineSession::StepFrames(int frames,
+                                 std::chrono::milliseconds timeout) {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = controller_;
+  }
+  if (!controller || !controller->pipeline()) return false;
+
+  ResetLastError();
+  std::string error;
+  if (!core::StepFrames(controller->pipeline(), frames, timeout, &error)) {
+    RecordError(error);
+    return false;
+  }
+  return true;
+}
+
+int64_t PipelineSession::position_ns() const {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = controller_;
+  }
+  if (!controller || !controller->pipeline()) return -1;
+  return QueryPositionNs(controller->pipeline());
+}
+
+void PipelineSession::SetStreamingThreadPool(
+    std::shared_ptr<StreamingThreadPool> pool) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  task_pool_ = std::move(pool);
+}
+
+void PipelineSession::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    closed_ = true;
+  }
+  Stop();
+  StopWorker();
+}
+
+bool PipelineSession::WithPipeline(
+    const std::function<void(GstElement*)>& fn) {
+  std::shared_ptr<PipelineController> controller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    controller = controller_;
+  }
+  if (!controller || !controller->pipeline()) return false;
+  fn(controller->pipeline());
+  return true;
+}
+
+std::string PipelineSession::last_error() const {
+  return FormatDiagnostics(diagnostics_->Recent(
+      kMaxErrorLines, last_error_since_.load(std::memory_order_acquire)));
+}
+
+bool PipelineSession::has_pipeline() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return controller_ != nullptr;
+}
+
+void PipelineSession::RunOnWorker(const std::function<void()>& fn) {
+  WorkerCall call{&fn, {}};
+  std::future<void> done = call.done.get_future();
+  bool queued = false;
+  {
+    // Close() marks the session closed under the same lock before queueing
+    // the quit, so anything attached here runs before the loop exits.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!closed_) {
+      AttachIdle(context_, RunWorkerCall, &call);
+      queued = true;
+    }
+  }
+  if (!queued) {
+    fn();
+    return;
+  }
+  done.wait();
+}
+
+void PipelineSession::StopWorker() {
+  if (!worker_.joinable()) return;
+  AttachIdle(context_, QuitLoop, loop_);
+  worker_.join();
+  g_main_loop_unref(loop_);
+  loop_ = nullptr;
+  // Sources still attached by elements are dropped with the context.
+  g_main_context_unref(context_);
+  context_ = nullptr;
+}
+
+void PipelineSession::ResetLastError() {
+  last_error_since_.store(diagnostics_->next_sequence(),
+                          std::memory_order_release);
+}
+
+void PipelineSession::RecordError(const std::string& message) {
+  diagnostics_->Record(DiagnosticSeverity::kError, "session", 0, message);
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,40 @@
+#include "kataglyphis_native_core/roi_detections.h"
+
+#include <gst/video/video.h>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+size_t CollectRoiDetections(GstBuffer* buffer, DetectionSet* set) {
+  if (!buffer) return 0;
+  size_t collected = 0;
+  gpointer state = nullptr;
+  GstMeta* meta;
+  while ((meta = gst_buffer_iterate_meta_filtered(
+              buffer, &state, GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE))) {
+    const auto* roi = reinterpret_cast<GstVideoRegionOfInterestMeta*>(meta);
+    Detection detection;
+    detection.left = static_cast<float>(roi->x);
+    detection.top = static_cast<float>(roi->y);
+    detection.width = static_cast<float>(roi->w);
+    detection.height = static_cast<float>(roi->h);
+    const GstStructure* params = gst_video_region_of_interest_meta_get_param(
+        const_cast<GstVideoRegionOfInterestMeta*>(roi), "detection");
+    if (params) {
+      gdouble confidence = 0.0;
+      if (gst_structure_get_double(params, "confidence", &confidence)) {
+        detection.score = static_cast<float>(confidence);
+      }
+      gint label_id = -1;
+      if (gst_structure_get_int(params, "label_id", &label_id)) {
+        detection.class_id = label_id;
+      }
+    }
+    set->detections.push_back(detection);
+    ++collected;
+  }
+  return collected;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,63 @@
+#include "kataglyphis_native_core/sample_frame.h"
+
+#include <gst/video/video.h>
+
+#include <algorithm>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Owns a mapped sample for as long as a Frame points into it.
+struct MappedSample {
+  GstSample* sample;
+  GstMapInfo map;
+
+  ~MappedSample() {
+    gst_buffer_unmap(gst_sample_get_buffer(sample), &map);
+    gst_sample_unref(sample);
+  }
+};
+
+}  // namespace
+
+std::shared_ptr<Frame> WrapVideoSample(GstSample* sample,
+                                       uint32_t fallback_width,
+                                       uint32_t fallback_height) {
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  GstMapInfo map;
+  if (!buffer || !gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    gst_sample_unref(sample);
+    return nullptr;
+  }
+  std::shared_ptr<MappedSample> owner(new MappedSample{sample, map});
+
+  std::shared_ptr<Frame> frame;
+  GstCaps* caps = gst_sample_get_caps(sample);
+  GstVideoInfo info;
+  if (caps && gst_video_info_from_caps(&info, caps)) {
+    const gsize offset = GST_VIDEO_INFO_PLANE_OFFSET(&info, 0);
+    const gint stride = GST_VIDEO_INFO_PLANE_STRIDE(&info, 0);
+    if (offset <= map.size && stride > 0) {
+      frame = Frame::Wrap(
+          map.data + offset,
+          static_cast<uint32_t>(std::max(GST_VIDEO_INFO_WIDTH(&info), 0)),
+          static_cast<uint32_t>(std::max(GST_VIDEO_INFO_HEIGHT(&info), 0)),
+          static_cast<uint32_t>(stride), map.size - offset, owner);
+      // RGBx/BGRx: the padding byte is written as 255 by videoconvert.
+      frame->set_opaque(!GST_VIDEO_INFO_HAS_ALPHA(&info));
+    }
+  }
+  if (!frame) {
+    frame = Frame::Wrap(map.data, fallback_width, fallback_height,
+                        fallback_width * 4U, map.size, owner);
+  }
+  if (GST_BUFFER_PTS_IS_VALID(buffer)) {
+    frame->set_timestamp_ns(static_cast<int64_t>(GST_BUFFER_PTS(buffer)));
+  }
+  return frame;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,284 @@
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Shared by the GObject and every thread it started, so threads that
+// outlive the pool object can still deregister.
+struct PoolState {
+  StreamingThreadOptions options;
+  std::mutex mutex;
+  std::map<uint64_t, ThreadPlacementInfo> threads;
+  uint64_t next_index = 0;
+};
+
+// Handle returned from push(); join() waits on it.
+struct TaskThread {
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+};
+
+using TaskHandle = std::shared_ptr<TaskThread>;
+
+struct KataglyphisTaskPool {
+  GstTaskPool parent;
+  std::shared_ptr<PoolState>* state;
+};
+
+struct KataglyphisTaskPoolClass {
+  GstTaskPoolClass parent_class;
+};
+
+G_DEFINE_TYPE(KataglyphisTaskPool, kataglyphis_task_pool, GST_TYPE_TASK_POOL)
+
+std::shared_ptr<PoolState> StateOf(GstTaskPool* pool) {
+  return *reinterpret_cast<KataglyphisTaskPool*>(pool)->state;
+}
+
+void RunTask(std::shared_ptr<PoolState> state, TaskHandle handle,
+             GstTaskPoolFunction func, gpointer data, uint64_t index) {
+  ThreadPlacement placement;
+  placement.name = state->options.name_prefix + "-" + std::to_string(index);
+  placement.cpus = state->options.cpus;
+  placement.nice = state->options.nice;
+  std::string error;
+  ApplyThreadPlacement(placement, &error);
+  ThreadPlacementInfo info = DescribeCurrentThread();
+  info.error = std::move(error);
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->threads[index] = std::move(info);
+  }
+
+  func(data);
+
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->threads.erase(index);
+  }
+  std::lock_guard<std::mutex> lock(handle->mutex);
+  handle->done = true;
+  handle->finished.notify_all();
+}
+
+// No shared GThreadPool: every task gets its own thread, so placement never
+// leaks into threads GLib would reuse for other pools.
+void PoolPrepare(GstTaskPool* /*pool*/, GError** /*error*/) {}
+void PoolCleanup(GstTaskPool* /*pool*/) {}
+
+gpointer PoolPush(GstTaskPool* pool, GstTaskPoolFunction func, gpointer data,
+                  GError** error) {
+  std::shared_ptr<PoolState> state = StateOf(pool);
+  uint64_t index = 0;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    index = state->next_index++;
+  }
+  auto* handle = new TaskHandle(std::make_shared<TaskThread>());
+  try {
+    std::thread(RunTask, std::move(state), *handle, func, data, index)
+        .detach();
+  } catch (const std::system_error& e) {
+    g_set_error(error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+                "Could not start streaming thread: %s", e.what());
+    delete handle;
+    return nullptr;
+  }
+  return handle;
+}
+
+void PoolJoin(GstTaskPool* /*pool*/, gpointer id) {
+  auto* handle = static_cast<TaskHandle*>(id);
+  if (!handle) return;
+  {
+    std::unique_lock<std::mutex> lock((*handle)->mutex);
+    (*handle)->finished.wait(lock, [handle] { return (*handle)->done; });
+  }
+  delete handle;
+}
+
+#if GST_CHECK_VERSION(1, 20, 0)
+// Called instead of join() when a task does not need joining.
+void PoolDisposeHandle(GstTaskPool* /*pool*/, gpointer id) {
+  delete static_cast<TaskHandle*>(id);
+}
+#endif
+
+void PoolFinalize(GObject* object) {
+  delete reinterpret_cast<KataglyphisTaskPool*>(object)->state;
+  G_OBJECT_CLASS(kataglyphis_task_pool_parent_class)->finalize(object);
+}
+
+void kataglyphis_task_pool_class_init(KataglyphisTaskPoolClass* klass) {
+  G_OBJECT_CLASS(klass)->finalize = PoolFinalize;
+  GstTaskPoolClass* pool_class = GST_TASK_POOL_CLASS(klass);
+  pool_class->prepare = PoolPrepare;
+  pool_class->cleanup = PoolCleanup;
+  pool_class->push = PoolPush;
+  pool_class->join = PoolJoin;
+#if GST_CHECK_VERSION(1, 20, 0)
+  pool_class->dispose_handle = PoolDisposeHandle;
+#endif
+}
+
+void kataglyphis_task_pool_init(KataglyphisTaskPool* self) {
+  self->state = new std::shared_ptr<PoolState>(std::make_shared<PoolState>());
+}
+
+bool MoveTaskToPool(GstMessage* message, GstTaskPool* pool) {
+  if (GST_MESSAGE_TYPE(message) != GST_MESSAGE_STREAM_STATUS) return false;
+  GstStreamStatusType type = GST_STREAM_STATUS_TYPE_CREATE;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(message, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_CREATE) return false;
+
+  const GValue* value = gst_message_get_stream_status_object(message);
+  if (!value || !G_VALUE_HOLDS_OBJECT(value)) return false;
+  GObject* object = G_OBJECT(g_value_get_object(value));
+  if (!object || !GST_IS_TASK(object)) return false;
+  // Only valid before the task starts, which CREATE guarantees.
+  gst_task_set_pool(GST_TASK(object), pool);
+  return true;
+}
+
+GstBusSyncReply OnAttachedBusMessage(GstBus* /*bus*/, GstMessage* message,
+                                     gpointer user_data) {
+  MoveTaskToPool(message, static_cast<GstTaskPool*>(user_data));
+  return GST_BUS_PASS;
+}
+
+bool ParseNice(const char* text, int* nice) {
+  char* end = nullptr;
+  const long value = std::strtol(text, &end, 10);
+  if (end == text || *end != '\0' || value < -20 || value > 19) return false;
+  *nice = static_cast<int>(value);
+  return true;
+}
+
+std::mutex g_default_mutex;
+std::optional<StreamingThreadOptions> g_default_options;
+std::shared_ptr<StreamingThreadPool> g_default_pool;
+
+}  // namespace
+
+// static
+std::shared_ptr<StreamingThreadPool> StreamingThreadPool::Create(
+    StreamingThreadOptions options) {
+  // Registering the GType needs gst_init.
+  GstRuntime::Get().WaitUntilReady();
+  auto* pool = GST_TASK_POOL(g_object_new(kataglyphis_task_pool_get_type(),
+                                          nullptr));
+  gst_object_ref_sink(pool);
+  StateOf(pool)->options = std::move(options);
+  gst_task_pool_prepare(pool, nullptr);
+  return std::shared_ptr<StreamingThreadPool>(new StreamingThreadPool(pool));
+}
+
+// static
+bool StreamingThreadPool::OptionsFromEnvironment(
+    StreamingThreadOptions* options, std::string* error) {
+  const char* cpus = std::getenv("KATAGLYPHIS_GST_CPUS");
+  const char* nice = std::getenv("KATAGLYPHIS_GST_NICE");
+  if ((!cpus || !*cpus) && (!nice || !*nice)) return false;
+
+  StreamingThreadOptions parsed;
+  if (cpus && *cpus && !ParseCpuList(cpus, &parsed.cpus, error)) {
+    return false;
+  }
+  if (nice && *nice) {
+    int value = 0;
+    if (!ParseNice(nice, &value)) {
+      if (error) {
+        *error = std::string("KATAGLYPHIS_GST_NICE must be -20..19, got '") +
+                 nice + "'";
+      }
+      return false;
+    }
+    parsed.nice = value;
+  }
+  *options = std::move(parsed);
+  return true;
+}
+
+// static
+void StreamingThreadPool::SetDefaultOptions(
+    std::optional<StreamingThreadOptions> options) {
+  std::lock_guard<std::mutex> lock(g_default_mutex);
+  g_default_options = std::move(options);
+  g_default_pool.reset();
+}
+
+// static
+std::shared_ptr<StreamingThreadPool> StreamingThreadPool::Default() {
+  std::lock_guard<std::mutex> lock(g_default_mutex);
+  if (!g_default_pool && g_default_options) {
+    g_default_pool = Create(*g_default_options);
+  }
+  return g_default_pool;
+}
+
+StreamingThreadPool::StreamingThreadPool(GstTaskPool* pool) : pool_(pool) {}
+
+StreamingThreadPool::~StreamingThreadPool() {
+  // Tasks hold their own reference; their threads keep running until the
+  // pipeline stops them.
+  gst_object_unref(pool_);
+}
+
+bool StreamingThreadPool::HandleStreamStatus(GstMessage* message) {
+  return MoveTaskToPool(message, pool_);
+}
+
+void StreamingThreadPool::Attach(GstElement* pipeline) {
+  GstBus* bus = gst_element_get_bus(pipeline);
+  if (!bus) return;
+  gst_bus_set_sync_handler(bus, OnAttachedBusMessage, gst_object_ref(pool_),
+                           gst_object_unref);
+  gst_object_unref(bus);
+}
+
+const StreamingThreadOptions& StreamingThreadPool::options() const {
+  return StateOf(pool_)->options;
+}
+
+std::vector<ThreadPlacementInfo> StreamingThreadPool::Threads() const {
+  const std::shared_ptr<PoolState> state = StateOf(pool_);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  std::vector<ThreadPlacementInfo> threads;
+  threads.reserve(state->threads.size());
+  for (const auto& entry : state->threads) threads.push_back(entry.second);
+  return threads;
+}
+
+std::string StreamingThreadPool::Describe() const {
+  const StreamingThreadOptions& config = options();
+  std::string report = "streaming threads: prefix=" + config.name_prefix +
+                       " cpus=" +
+                       (config.cpus.empty() ? "any" : FormatCpuList(config.cpus)) +
+                       " nice=" +
+                       (config.nice ? std::to_string(*config.nice) : "inherit");
+  const std::vector<ThreadPlacementInfo> threads = Threads();
+  if (threads.empty()) {
+    report += "\n  (none running)";
+  }
+  for (const ThreadPlacementInfo& info : threads) {
+    report += "\n  " + FormatThreadPlacement(info);
+  }
+  return report;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,503 @@
+#include "kataglyphis_native_core/image_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+void Put16(std::vector<uint8_t>* out, uint32_t value) {
+  out->push_back(static_cast<uint8_t>(value >> 8));
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+void Put32(std::vector<uint8_t>* out, uint32_t value) {
+  Put16(out, value >> 16);
+  Put16(out, value & 0xFFFFu);
+}
+
+bool FrameIsReadable(const Frame& frame) {
+  if (!frame.data() || frame.width() == 0 || frame.height() == 0 ||
+      frame.stride() < frame.width() * kRgbaBytesPerPixel) {
+    return false;
+  }
+  const size_t last_row =
+      static_cast<size_t>(frame.stride()) * (frame.height() - 1);
+  return frame.size() >= last_row + frame.width() * kRgbaBytesPerPixel;
+}
+
+void EncodeRaw(const Frame& frame, std::vector<uint8_t>* out) {
+  const size_t row_bytes = frame.width() * kRgbaBytesPerPixel;
+  out->resize(row_bytes * frame.height());
+  for (uint32_t row = 0; row < frame.height(); ++row) {
+    std::memcpy(out->data() + row * row_bytes,
+                frame.data() + static_cast<size_t>(row) * frame.stride(),
+                row_bytes);
+  }
+}
+
+// --- PNG ---
+
+uint32_t Crc32(const uint8_t* data, size_t size) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> entries{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      entries[n] = c;
+    }
+    return entries;
+  }();
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t Adler32(const uint8_t* data, size_t size) {
+  // Largest run before the sums can overflow 32 bits.
+  constexpr size_t kRun = 5552;
+  uint32_t a = 1;
+  uint32_t b = 0;
+  while (size > 0) {
+    const size_t run = std::min(size, kRun);
+    for (size_t i = 0; i < run; ++i) {
+      a += data[i];
+      b += a;
+    }
+    a %= 65521u;
+    b %= 65521u;
+    data += run;
+    size -= run;
+  }
+  return (b << 16) | a;
+}
+
+// Appends a chunk whose payload `fill` writes after the type.
+template <typename Fill>
+void PutChunk(std::vector<uint8_t>* out, const char type[4], size_t length,
+              Fill fill) {
+  Put32(out, static_cast<uint32_t>(length));
+  const size_t start = out->size();
+  out->insert(out->end(), type, type + 4);
+  fill();
+  Put32(out, Crc32(out->data() + start, out->size() - start));
+}
+
+void EncodePng(const Frame& frame, std::vector<uint8_t>* out) {
+  // Scanlines with filter type 0 (None) in front of each row.
+  const size_t row_bytes = frame.width() * kRgbaBytesPerPixel;
+  std::vector<uint8_t> scanlines((row_bytes + 1) * frame.height());
+  for (uint32_t row = 0; row < frame.height(); ++row) {
+    uint8_t* line = scanlines.data() + row * (row_bytes + 1);
+    line[0] = 0;
+    std::memcpy(line + 1,
+                frame.data() + static_cast<size_t>(row) * frame.stride(),
+                row_bytes);
+  }
+
+  constexpr size_t kStoredBlock = 65535;
+  const size_t blocks = (scanlines.size() + kStoredBlock - 1) / kStoredBlock;
+  const size_t zlib_size = 2 + blocks * 5 + scanlines.size() + 4;
+
+  out->clear();
+  out->reserve(8 + 25 + 12 + zlib_size + 12);
+  static constexpr uint8_t kSignature[] = {0x89, 'P',  'N',  'G',
+                                           '\r', '\n', 0x1A, '\n'};
+  out->insert(out->end(), kSignature, kSignature + sizeof(kSignature));
+
+  PutChunk(out, "IHDR", 13, [&] {
+    Put32(out, frame.width());
+    Put32(out, frame.height());
+    out->push_back(8);  // bit depth
+    out->push_back(6);  // color type RGBA
+    out->push_back(0);  // deflate
+    out->push_back(0);  // adaptive filtering
+    out->push_back(0);  // no interlace
+  });
+  PutChunk(out, "IDAT", zlib_size, [&] {
+    out->push_back(0x78);  // deflate, 32K window
+    out->push_back(0x01);  // no preset dictionary, fastest level
+    for (size_t offset = 0; offset < scanlines.size(); offset += kStoredBlock) {
+      const size_t length = std::min(kStoredBlock, scanlines.size() - offset);
+      out->push_back(offset + length == scanlines.size() ? 1 : 0);
+      out->push_back(static_cast<uint8_t>(length));
+      out->push_back(static_cast<uint8_t>(length >> 8));
+      out->push_back(static_cast<uint8_t>(~length));
+      out->push_back(static_cast<uint8_t>(~length >> 8));
+      out->insert(out->end(), scanlines.begin() + offset,
+                  scanlines.begin() + offset + length);
+    }
+    Put32(out, Adler32(scanlines.data(), scanlines.size()));
+  });
+  PutChunk(out, "IEND", 0, [] {});
+}
+
+// --- JPEG ---
+
+// Natural (row-major) index of the k-th coefficient in zigzag order.
+constexpr uint8_t kZigzag[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+// ITU T.81 Annex K tables, natural order.
+constexpr uint8_t kLumaQuant[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+constexpr uint8_t kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+
+constexpr uint8_t kDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1,
+                                     1, 0, 0, 0, 0, 0, 0, 0};
+constexpr uint8_t kDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1,
+                                       1, 1, 1, 0, 0, 0, 0, 0};
+constexpr uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+constexpr uint8_t kAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3,
+                                     5, 5, 4, 4, 0, 0, 1, 0x7D};
+constexpr uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06,
+    0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08,
+    0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0, 0x24, 0x33, 0x62, 0x72,
+    0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45,
+    0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75,
+    0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3,
+    0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6,
+    0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9,
+    0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4,
+    0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA};
+
+constexpr uint8_t kAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4,
+                                       7, 5, 4, 4, 0, 1, 2, 0x77};
+constexpr uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41,
+    0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+    0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0, 0x15, 0x62, 0x72, 0xD1,
+    0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+    0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44,
+    0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74,
+    0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A,
+    0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4,
+    0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+    0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4,
+    0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA};
+
+struct HuffmanTable {
+  uint16_t code[256] = {};
+  uint8_t size[256] = {};
+};
+
+HuffmanTable BuildHuffmanTable(const uint8_t bits[16], const uint8_t* values) {
+  HuffmanTable table;
+  uint16_t code = 0;
+  size_t index = 0;
+  for (int length = 1; length <= 16; ++length) {
+    for (int i = 0; i < bits[length - 1]; ++i) {
+      table.code[values[index]] = code++;
+      table.size[values[index]] = static_cast<uint8_t>(length);
+      ++index;
+    }
+    code = static_cast<uint16_t>(code << 1);
+  }
+  return table;
+}
+
+// Entropy-coded segment writer with 0xFF byte stuffing.
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<uint8_t>* out) : out_(out) {}
+
+  void Put(uint32_t bits, int count) {
+    buffer_ = (buffer_ << count) | bits;
+    count_ += count;
+    while (count_ >= 8) {
+      const uint8_t byte = static_cast<uint8_t>(buffer_ >> (count_ - 8));
+      out_->push_back(byte);
+      if (byte == 0xFF) out_->push_back(0);
+      count_ -= 8;
+    }
+    buffer_ &= (1u << count_) - 1u;
+  }
+
+  // Pads the last byte with 1 bits.
+  void Flush() {
+    if (count_ > 0) Put((1u << (8 - count_)) - 1u, 8 - count_);
+  }
+
+ private:
+  std::vector<uint8_t>* out_;
+  uint32_t buffer_ = 0;
+  int count_ = 0;
+};
+
+int BitLength(int value) {
+  int length = 0;
+  for (value = std::abs(value); value > 0; value >>= 1) ++length;
+  return length;
+}
+
+// Magnitude bits of a coefficient: one's complement for negatives.
+uint32_t MagnitudeBits(int value, int length) {
+  return static_cast<uint32_t>(value < 0 ? value + (1 << length) - 1 : value);
+}
+
+// Orthonormal 8-point DCT-II basis, basis[u * 8 + x].
+const std::array<float, 64>& DctBasis() {
+  static const std::array<float, 64> basis = [] {
+    std::array<float, 64> entries{};
+    const double pi = std::acos(-1.0);
+    for (int u = 0; u < 8; ++u) {
+      const double scale = u == 0 ? std::sqrt(0.125) : 0.5;
+      for (int x = 0; x < 8; ++x) {
+        entries[u * 8 + x] =
+            static_cast<float>(scale * std::cos((2 * x + 1) * u * pi / 16));
+      }
+    }
+    return entries;
+  }();
+  return basis;
+}
+
+struct JpegComponent {
+  const float* quant_scale;  // 1 / quantizer, natural order
+  const HuffmanTable* dc;
+  const HuffmanTable* ac;
+  int previous_dc = 0;
+};
+
+// Transforms, quantizes and entropy-codes one level-shifted 8x8 block.
+void EncodeBlock(const float block[64], JpegComponent* component,
+                 BitWriter* writer) {
+  const std::array<float, 64>& basis = DctBasis();
+  float rows[64];
+  for (int y = 0; y < 8; ++y) {
+    for (int u = 0; u < 8; ++u) {
+      float sum = 0;
+      for (int x = 0; x < 8; ++x) sum += block[y * 8 + x] * basis[u * 8 + x];
+      rows[y * 8 + u] = sum;
+    }
+  }
+  int coefficients[64];
+  for (int v = 0; v < 8; ++v) {
+    for (int u = 0; u < 8; ++u) {
+      float sum = 0;
+      for (int y = 0; y < 8; ++y) sum += basis[v * 8 + y] * rows[y * 8 + u];
+      const int natural = v * 8 + u;
+      coefficients[natural] = static_cast<int>(
+          std::lround(sum * component->quant_scale[natural]));
+    }
+  }
+
+  const int dc = coefficients[0];
+  const int diff = dc - component->previous_dc;
+  component->previous_dc = dc;
+  const int dc_length = BitLength(diff);
+  writer->Put(component->dc->code[dc_length], component->dc->size[dc_length]);
+  if (dc_length > 0) writer->Put(MagnitudeBits(diff, dc_length), dc_length);
+
+  int last = 63;
+  while (last > 0 && coefficients[kZigzag[last]] == 0) --last;
+  int run = 0;
+  for (int k = 1; k <= last; ++k) {
+    const int value = std::max(-1023, std::min(1023, coefficients[kZigzag[k]]));
+    if (value == 0) {
+      ++run;
+      continue;
+    }
+    for (; run >= 16; run -= 16) {
+      writer->Put(component->ac->code[0xF0], component->ac->size[0xF0]);
+    }
+    const int length = BitLength(value);
+    const int symbol = (run << 4) | length;
+    writer->Put(component->ac->code[symbol], component->ac->size[symbol]);
+    writer->Put(MagnitudeBits(value, length), length);
+    run = 0;
+  }
+  if (last < 63) writer->Put(component->ac->code[0], component->ac->size[0]);
+}
+
+void ScaleQuantTable(const uint8_t base[64], int quality, uint8_t table[64],
+                     float scale[64]) {
+  quality = std::max(1, std::min(100, quality));
+  const int factor = quality < 50 ? 5000 / quality : 200 - quality * 2;
+  for (int i = 0; i < 64; ++i) {
+    const int value = (base[i] * factor + 50) / 100;
+    table[i] = static_cast<uint8_t>(std::max(1, std::min(255, value)));
+    scale[i] = 1.0f / table[i];
+  }
+}
+
+void PutHuffmanTable(std::vector<uint8_t>* out, uint8_t id,
+                     const uint8_t bits[16], const uint8_t* values) {
+  size_t count = 0;
+  out->push_back(id);
+  for (int i = 0; i < 16; ++i) {
+    out->push_back(bits[i]);
+    count += bits[i];
+  }
+  out->insert(out->end(), values, values + count);
+}
+
+void EncodeJpeg(const Frame& frame, int quality, std::vector<uint8_t>* out) {
+  static const HuffmanTable dc_luma = BuildHuffmanTable(kDcLumaBits, kDcValues);
+  static const HuffmanTable dc_chroma =
+      BuildHuffmanTable(kDcChromaBits, kDcValues);
+  static const HuffmanTable ac_luma =
+      BuildHuffmanTable(kAcLumaBits, kAcLumaValues);
+  static const HuffmanTable ac_chroma =
+      BuildHuffmanTable(kAcChromaBits, kAcChromaValues);
+
+  uint8_t luma_table[64];
+  uint8_t chroma_table[64];
+  float luma_scale[64];
+  float chroma_scale[64];
+  ScaleQuantTable(kLumaQuant, quality, luma_table, luma_scale);
+  ScaleQuantTable(kChromaQuant, quality, chroma_table, chroma_scale);
+
+  const uint32_t width = frame.width();
+  const uint32_t height = frame.height();
+  out->clear();
+  // Roughly what quality 90 needs for camera content.
+  out->reserve(static_cast<size_t>(width) * height / 2 + 1024);
+
+  Put16(out, 0xFFD8);  // SOI
+  Put16(out, 0xFFE0);  // APP0 JFIF 1.01, square pixels
+  Put16(out, 16);
+  static constexpr uint8_t kJfif[] = {'J', 'F', 'I', 'F', 0, 1, 1,
+                                      0,   0,   1,   0,   1, 0, 0};
+  out->insert(out->end(), kJfif, kJfif + sizeof(kJfif));
+
+  Put16(out, 0xFFDB);  // DQT, zigzag order
+  Put16(out, 2 + 2 * 65);
+  out->push_back(0);
+  for (int k = 0; k < 64; ++k) out->push_back(luma_table[kZigzag[k]]);
+  out->push_back(1);
+  for (int k = 0; k < 64; ++k) out->push_back(chroma_table[kZigzag[k]]);
+
+  Put16(out, 0xFFC0);  // SOF0, three components without subsampling
+  Put16(out, 17);
+  out->push_back(8);
+  Put16(out, height);
+  Put16(out, width);
+  out->push_back(3);
+  static constexpr uint8_t kComponents[] = {1, 0x11, 0, 2, 0x11, 1,
+                                            3, 0x11, 1};
+  out->insert(out->end(), kComponents, kComponents + sizeof(kComponents));
+
+  Put16(out, 0xFFC4);  // DHT
+  Put16(out, 2 + 4 * 17 + 2 * 12 + 2 * 162);
+  PutHuffmanTable(out, 0x00, kDcLumaBits, kDcValues);
+  PutHuffmanTable(out, 0x10, kAcLumaBits, kAcLumaValues);
+  PutHuffmanTable(out, 0x01, kDcChromaBits, kDcValues);
+  PutHuffmanTable(out, 0x11, kAcChromaBits, kAcChromaValues);
+
+  Put16(out, 0xFFDA);  // SOS
+  Put16(out, 12);
+  static constexpr uint8_t kScan[] = {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+  out->insert(out->end(), kScan, kScan + sizeof(kScan));
+
+  JpegComponent y{luma_scale, &dc_luma, &ac_luma};
+  JpegComponent cb{chroma_scale, &dc_chroma, &ac_chroma};
+  JpegComponent cr{chroma_scale, &dc_chroma, &ac_chroma};
+  BitWriter writer(out);
+  float y_block[64];
+  float cb_block[64];
+  float cr_block[64];
+  for (uint32_t block_y = 0; block_y < height; block_y += 8) {
+    for (uint32_t block_x = 0; block_x < width; block_x += 8) {
+      // Edge blocks repeat the last row and column.
+      for (uint32_t row = 0; row < 8; ++row) {
+        const uint8_t* line =
+            frame.data() +
+            static_cast<size_t>(std::min(block_y + row, height - 1)) *
+                frame.stride();
+        for (uint32_t col = 0; col < 8; ++col) {
+          const uint8_t* p =
+              line + std::min(block_x + col, width - 1) * kRgbaBytesPerPixel;
+          const float r = p[0];
+          const float g = p[1];
+          const float b = p[2];
+          const uint32_t i = row * 8 + col;
+          y_block[i] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+          cb_block[i] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+          cr_block[i] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+        }
+      }
+      EncodeBlock(y_block, &y, &writer);
+      EncodeBlock(cb_block, &cb, &writer);
+      EncodeBlock(cr_block, &cr, &writer);
+    }
+  }
+  writer.Flush();
+  Put16(out, 0xFFD9);  // EOI
+}
+
+}  // namespace
+
+bool ParseImageFormat(const std::string& name, ImageFormat* format) {
+  if (name == "raw") {
+    *format = ImageFormat::kRaw;
+  } else if (name == "png") {
+    *format = ImageFormat::kPng;
+  } else if (name == "jpeg" || name == "jpg") {
+    *format = ImageFormat::kJpeg;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* ImageFormatName(ImageFormat format) {
+  switch (format) {
+    case ImageFormat::kRaw:
+      return "raw";
+    case ImageFormat::kPng:
+      return "png";
+    case ImageFormat::kJpeg:
+      return "jpeg";
+  }
+  return "raw";
+}
+
+bool EncodeImage(const Frame& frame, ImageFormat format, int jpeg_quality,
+                 std::vector<uint8_t>* out) {
+  if (!FrameIsReadable(frame)) return false;
+  switch (format) {
+    case ImageFormat::kRaw:
+      EncodeRaw(frame, out);
+      return true;
+    case ImageFormat::kPng:
+      EncodePng(frame, out);
+      return true;
+    case ImageFormat::kJpeg:
+      EncodeJpeg(frame, jpeg_quality, out);
+      return true;
+  }
+  return false;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
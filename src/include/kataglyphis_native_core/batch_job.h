@@ -0,0 +1,79 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_BATCH_JOB_H_
+#define KATAGLYPHIS_NATIVE_CORE_BATCH_JOB_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// A time range of one input file, decoded by its own pipeline.
+struct BatchSegment {
+  size_t file_index = 0;
+  // Position within the file, from 0.
+  size_t index = 0;
+  int64_t start_ns = 0;
+  // Exclusive; -1 runs to the end of the file.
+  int64_t end_ns = -1;
+};
+
+// Splits every file into up to `max_segments_per_file` equal segments no
+// shorter than `min_segment_ns`. Files with an unknown duration (<= 0) get
+// a single segment. The last segment of a file always runs to its end, so
+// an inexact duration never loses frames. File-major order.
+std::vector<BatchSegment> PlanBatchSegments(
+    const std::vector<int64_t>& durations_ns, uint32_t max_segments_per_file,
+    int64_t min_segment_ns);
+
+// What the inference hook produced for one decoded frame.
+struct BatchResult {
+  size_t file_index = 0;
+  size_t segment_index = 0;
+  // Position within the segment, from 0.
+  uint64_t frame_index = 0;
+  // Presentation timestamp in the file, -1 if unknown.
+  int64_t timestamp_ns = -1;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // A JSON value from the hook; empty for none.
+  std::string payload;
+};
+
+// `{"file":"...","segment":0,"frame":0,"pts_ns":0,"width":0,"height":0,
+// "result":...}` without a trailing newline.
+std::string FormatBatchResultJson(const BatchResult& result,
+                                  const std::string& file);
+
+// Appends results as JSON lines. Segments run in parallel, so lines are in
+// completion order; sort by file and pts_ns if order matters. Not
+// thread-safe; callers serialize.
+class BatchResultWriter {
+ public:
+  BatchResultWriter() = default;
+  ~BatchResultWriter();
+
+  BatchResultWriter(const BatchResultWriter&) = delete;
+  BatchResultWriter& operator=(const BatchResultWriter&) = delete;
+
+  // Truncates `path`. `files` names the file indices of later results.
+  bool Open(const std::string& path, std::vector<std::string> files,
+            std::string* error);
+  void Write(const BatchResult& result);
+  // Flushes and closes; false if any write failed.
+  bool Close(std::string* error);
+
+  uint64_t written() const { return written_; }
+
+ private:
+  std::FILE* file_ = nullptr;
+  std::vector<std::string> files_;
+  uint64_t written_ = 0;
+  bool failed_ = false;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_BATCH_JOB_H_
@@ -0,0 +1,121 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_BATCH_PROCESSOR_H_
+#define KATAGLYPHIS_NATIVE_CORE_BATCH_PROCESSOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/batch_job.h"
+#include "kataglyphis_native_core/diagnostic_ring.h"
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct BatchOptions {
+  // Segments decoded at the same time; 0 uses the hardware thread count.
+  uint32_t workers = 0;
+  // Files are only split into segments at least this long, so seeking to
+  // the segment start stays cheap relative to decoding it.
+  int64_t min_segment_ns = 30LL * 1000000000LL;
+  // RGBA size handed to the hook; 0 keeps the source size.
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // Decoded frames each segment may queue ahead of the hook before its
+  // decoder blocks.
+  uint32_t max_buffers = 4;
+  // Streaming threads of every segment pipeline; nullptr: GStreamer's.
+  std::shared_ptr<StreamingThreadPool> task_pool;
+};
+
+struct BatchFrame {
+  const BatchSegment* segment = nullptr;
+  uint64_t frame_index = 0;
+  // Position in the file (stream time), -1 if unknown.
+  int64_t stream_time_ns = -1;
+  FrameRef frame;
+};
+
+// Runs inference on one decoded frame and returns its result as a JSON
+// value ("" for none). Called concurrently from the worker threads.
+using BatchInference = std::function<std::string(const BatchFrame& frame)>;
+// Receives every result; calls are serialized.
+using BatchResultCallback = std::function<void(const BatchResult& result)>;
+
+struct BatchProgress {
+  size_t files = 0;
+  size_t segments_total = 0;
+  size_t segments_done = 0;
+  uint64_t frames = 0;
+  double elapsed_s = 0.0;
+  double frames_per_second = 0.0;
+};
+
+// Offline counterpart of PipelineSession: decodes whole files at maximum
+// throughput instead of showing the newest frame.
+//
+// Every file is split into segments (PlanBatchSegments) that run as
+// independent `uridecodebin ! videoconvert ! videoscale ! appsink`
+// pipelines on `workers` threads. The appsinks use sync=false, drop=false
+// and a short queue, so no frame is dropped and a slow hook throttles
+// decoding instead of piling up memory. Each segment is prerolled, seeked
+// accurately to its start with its end as the stop position, and pulled
+// until EOS.
+class BatchProcessor {
+ public:
+  explicit BatchProcessor(BatchOptions options = {});
+
+  BatchProcessor(const BatchProcessor&) = delete;
+  BatchProcessor& operator=(const BatchProcessor&) = delete;
+
+  // Processes `inputs` (paths or URIs) and blocks until all are done, one
+  // fails or Cancel() is called. The first failure stops the remaining
+  // segments. Not reentrant.
+  bool Run(const std::vector<std::string>& inputs,
+           const BatchInference& inference,
+           const BatchResultCallback& on_result, std::string* error);
+
+  // Stops Run() from any thread; in-flight segments end at their next
+  // frame.
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+  bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+  BatchProgress progress() const;
+
+  // Per-segment failures and the bus errors behind them.
+  DiagnosticRing& diagnostics() const { return *diagnostics_; }
+
+ private:
+  bool ProbeDuration(const std::string& uri, int64_t* duration_ns,
+                     std::string* error);
+  bool RunSegment(const std::string& uri, const BatchSegment& segment,
+                  const BatchInference& inference,
+                  const BatchResultCallback& on_result, std::string* error);
+  std::string SegmentDescription() const;
+  bool ShouldStop() const {
+    return cancelled_.load(std::memory_order_relaxed) ||
+           failed_.load(std::memory_order_relaxed);
+  }
+
+  const BatchOptions options_;
+  const std::shared_ptr<DiagnosticRing> diagnostics_;
+  std::atomic<bool> cancelled_{false};
+  std::atomic<bool> failed_{false};
+  // Serializes the result callback.
+  std::mutex results_mutex_;
+  std::atomic<size_t> files_{0};
+  std::atomic<size_t> segments_total_{0};
+  std::atomic<size_t> segments_done_{0};
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<int64_t> start_ns_{0};
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_BATCH_PROCESSOR_H_
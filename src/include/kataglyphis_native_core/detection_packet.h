@@ -0,0 +1,74 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_DETECTION_PACKET_H_
+#define KATAGLYPHIS_NATIVE_CORE_DETECTION_PACKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Packed wire format for the detections of one frame, read in place by the
+// Dart decoder (lib/kataglyphis_detections.dart) through ByteData and
+// typed-list views. All fields little-endian.
+//
+//   offset  size  field
+//        0     4  magic "KGDT"
+//        4     2  version
+//        6     2  header_bytes (offset of the first array)
+//        8     4  count
+//       12     4  flags (bit 0: boxes predicted by the tracker, not
+//                 measured on this frame)
+//       16     8  frame_generation
+//       24     8  timestamp_ns (-1 if unknown)
+//       32     4  frame_width
+//       36     4  frame_height
+//       40     8  reserved
+//
+// followed by seven arrays of `count` 4-byte elements each, in this
+// order: left, top, width, height (float32, frame pixels), score (float32),
+// class_id and track_id (int32, -1 if unknown or untracked). Every array
+// starts 4-byte aligned. Decoders skip `header_bytes`, so later versions
+// may grow the header. Version 1 packets have no flags and no track_id
+// array.
+constexpr uint32_t kDetectionPacketMagic = 0x5444474B;  // "KGDT"
+constexpr uint16_t kDetectionPacketVersion = 2;
+constexpr size_t kDetectionPacketHeaderBytes = 48;
+constexpr size_t kDetectionPacketArrays = 7;
+constexpr uint32_t kDetectionFlagPredicted = 1U << 0;
+
+struct Detection {
+  float left = 0.0f;
+  float top = 0.0f;
+  float width = 0.0f;
+  float height = 0.0f;
+  float score = 0.0f;
+  int32_t class_id = -1;
+  // Stable across frames once a tracker follows the object.
+  int32_t track_id = -1;
+};
+
+struct DetectionSet {
+  uint64_t frame_generation = 0;
+  int64_t timestamp_ns = -1;
+  uint32_t frame_width = 0;
+  uint32_t frame_height = 0;
+  // kDetectionFlag* bits.
+  uint32_t flags = 0;
+  std::vector<Detection> detections;
+};
+
+// Size of the packet for `count` detections.
+size_t DetectionPacketSize(size_t count);
+
+// Replaces `out` with the packet for `set`.
+void EncodeDetections(const DetectionSet& set, std::vector<uint8_t>* out);
+
+// Inverse of EncodeDetections, for native consumers and tests. False if
+// `data` is not a complete packet of a known version.
+bool DecodeDetections(const uint8_t* data, size_t size, DetectionSet* set);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_DETECTION_PACKET_H_
@@ -0,0 +1,94 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_DIAGNOSTIC_RING_H_
+#define KATAGLYPHIS_NATIVE_CORE_DIAGNOSTIC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+enum class DiagnosticSeverity : uint8_t { kInfo, kWarning, kError };
+
+// One fixed-size diagnostic entry. Text fields are NUL-terminated and
+// truncated to fit.
+struct DiagnosticRecord {
+  static constexpr size_t kSourceSize = 32;
+  static constexpr size_t kMessageSize = 200;
+
+  // Position in the ring's write order, starting at 0.
+  uint64_t sequence = 0;
+  // Wall clock, microseconds since the Unix epoch.
+  int64_t timestamp_us = 0;
+  DiagnosticSeverity severity = DiagnosticSeverity::kInfo;
+  // E.g. the GError code of a bus message; 0 if none.
+  int32_t code = 0;
+  // Element or component that reported it.
+  char source[kSourceSize] = {};
+  char message[kMessageSize] = {};
+};
+
+// Fixed-capacity ring of diagnostic records. Record() is lock-free and does
+// not allocate, so bus sync handlers and streaming threads can call it
+// during error storms without contending with the control path. When the
+// ring is full the oldest records are overwritten.
+//
+// Each slot is a seqlock: writers claim a slot with a CAS, readers copy it
+// and discard the copy if a writer touched the slot meanwhile. A writer
+// that finds its slot still being written (the ring lapped during one
+// write) drops its record instead of waiting; see dropped().
+class DiagnosticRing {
+ public:
+  // `capacity` is rounded up to a power of two (minimum 2).
+  explicit DiagnosticRing(size_t capacity = 128);
+
+  DiagnosticRing(const DiagnosticRing&) = delete;
+  DiagnosticRing& operator=(const DiagnosticRing&) = delete;
+
+  // `detail`, if given, is appended to the message after "; ".
+  void Record(DiagnosticSeverity severity, std::string_view source,
+              int32_t code, std::string_view message,
+              std::string_view detail = {});
+
+  // Up to `max_records` of the newest records with sequence >= `since`,
+  // oldest first. Records overwritten while copying are skipped.
+  std::vector<DiagnosticRecord> Recent(size_t max_records,
+                                       uint64_t since = 0) const;
+
+  // Sequence the next record will get; pass to Recent() as `since` to see
+  // only what happens from now on.
+  uint64_t next_sequence() const {
+    return head_.load(std::memory_order_acquire);
+  }
+  size_t capacity() const { return slots_.size(); }
+  // Records lost to concurrent writers on a lapped slot.
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    // 2 * sequence + 1 while being written, 2 * sequence + 2 once done,
+    // 0 if never written.
+    std::atomic<uint64_t> state{0};
+    DiagnosticRecord record;
+  };
+
+  std::vector<Slot> slots_;
+  uint64_t mask_ = 0;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+const char* SeverityToString(DiagnosticSeverity severity);
+
+// "error source: message (code N)"; the code is omitted when 0.
+std::string FormatDiagnostic(const DiagnosticRecord& record);
+// One FormatDiagnostic() line per record.
+std::string FormatDiagnostics(const std::vector<DiagnosticRecord>& records);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_DIAGNOSTIC_RING_H_
@@ -0,0 +1,161 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FFI_API_H_
+#define KATAGLYPHIS_NATIVE_CORE_FFI_API_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+#include "kataglyphis_native_core/frame_exchange.h"
+#include "kataglyphis_native_core/inference_feed.h"
+#include "kataglyphis_native_core/object_tracker.h"
+#include "kataglyphis_native_core/result_slot.h"
+#include "kataglyphis_native_core/stats_aggregator.h"
+#endif
+
+#if defined(_WIN32)
+#define KNT_FFI_EXPORT __declspec(dllexport)
+#else
+#define KNT_FFI_EXPORT __attribute__((visibility("default")))
+#endif
+
+// C ABI for the Dart FFI fast path (lib/kataglyphis_native_inference_ffi.dart),
+// exported from every plugin library that links the core. Calls are plain
+// function calls on the Dart isolate's thread: no codec, no thread hop.
+// Struct layouts are part of the ABI; only append fields and bump
+// knt_ffi_api_version.
+//
+// Return codes: 0 on success, -1 bad arguments, -2 unknown texture,
+// -3 nothing available yet.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct KntFrameStats {
+  uint64_t frames_pushed;
+  uint64_t frames_presented;
+  uint64_t frames_dropped;
+  uint64_t latest_generation;
+  uint64_t presented_generation;
+  double consumer_fps;
+  // 1 while the latest frame has not been presented yet.
+  uint32_t frame_pending;
+  uint32_t reserved;
+} KntFrameStats;
+
+// The latest frame, mapped in place. Valid until knt_release_frame(handle).
+typedef struct KntFrameView {
+  const uint8_t* data;
+  uint64_t size;
+  uint64_t generation;
+  int64_t timestamp_ns;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  uint32_t reserved;
+  void* handle;
+} KntFrameView;
+
+// Counters of the frames offered to inference (knt_acquire_inference_frame).
+typedef struct KntInferenceStats {
+  uint64_t frames_offered;
+  // Held back by the motion gate.
+  uint64_t frames_gated;
+  // Let through, but replaced before the consumer took them.
+  uint64_t frames_replaced;
+  uint64_t frames_taken;
+  // Motion of the last offered frame against the last one let through.
+  float last_mean_diff;
+  float last_changed_fraction;
+  // Skipped by the rate control (InferenceFeed::ConfigureRate).
+  uint64_t frames_throttled;
+  // Smoothed over knt_report_inference_time calls: completed inferences
+  // per second, inference time, and age of the analyzed frame at report.
+  float effective_fps;
+  float inference_ms;
+  float latency_ms;
+  // Current admission rate of the rate control, 0 while it is off.
+  float admitted_fps;
+} KntInferenceStats;
+
+KNT_FFI_EXPORT int32_t knt_ffi_api_version(void);
+
+KNT_FFI_EXPORT int32_t knt_get_frame_stats(int64_t texture_id,
+                                           KntFrameStats* stats);
+
+// References the latest frame without copying and without counting it as
+// presented. The pixels stay valid, and their producer buffer (GstSample,
+// pool slot) stays checked out, until knt_release_frame.
+KNT_FFI_EXPORT int32_t knt_acquire_frame(int64_t texture_id,
+                                         KntFrameView* view);
+// Safe to call with null. Callable from any thread, e.g. a finalizer.
+KNT_FFI_EXPORT void knt_release_frame(void* handle);
+
+// Maps pyramid level `level` (1/2^level of the size, frame_pyramid.h) of a
+// frame acquired by knt_acquire_frame or knt_acquire_inference_frame, as a
+// view of its own with the frame's generation and timestamp. -3 where the
+// producer built no such level. Release both views independently.
+KNT_FFI_EXPORT int32_t knt_map_frame_level(void* handle, uint32_t level,
+                                           KntFrameView* view);
+
+// Like knt_acquire_frame, but for inference: returns each frame at most
+// once, and only frames that passed the texture's motion gate (if one is
+// configured). -3 when nothing new is waiting.
+KNT_FFI_EXPORT int32_t knt_acquire_inference_frame(int64_t texture_id,
+                                                   KntFrameView* view);
+KNT_FFI_EXPORT int32_t knt_get_inference_stats(int64_t texture_id,
+                                               KntInferenceStats* stats);
+
+// Copies the latest inference result into `buffer` if it fits. Returns
+// its size (which may exceed `capacity`; call again with a larger buffer)
+// or a negative code. `frame_generation` and `version` may be null.
+KNT_FFI_EXPORT int64_t knt_copy_latest_result(int64_t texture_id,
+                                              uint8_t* buffer,
+                                              uint64_t capacity,
+                                              uint64_t* frame_generation,
+                                              uint64_t* version);
+
+// Publishes the detections an FFI inference consumer computed, as a packet
+// in the detection_packet.h format (frame_generation and timestamp_ns of
+// the analyzed frame). With tracking enabled the tracker assigns track ids
+// and carries the boxes across the following frames. Returns -1 for
+// malformed packets and -3 where the texture has no result slot.
+KNT_FFI_EXPORT int32_t knt_submit_detections(int64_t texture_id,
+                                             const uint8_t* packet,
+                                             uint64_t size);
+
+// Lets the inference consumer (typically the Dart isolate that acquired the
+// frame) report how long inference on one frame took, for the texture's
+// statistics windows and the inference feed's rate control; call it right
+// after the result of a knt_acquire_inference_frame frame is done. Returns
+// -3 where the texture has neither.
+KNT_FFI_EXPORT int32_t knt_report_inference_time(int64_t texture_id,
+                                                 int64_t duration_ns);
+
+#ifdef __cplusplus
+}  // extern "C"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// What the FFI functions can reach of one texture. All pointers must stay
+// valid until UnregisterFfiTexture returns; all but the exchange may be
+// null.
+struct FfiTexture {
+  FrameExchange* exchange = nullptr;
+  ResultSlot* results = nullptr;
+  StatsAggregator* stats = nullptr;
+  InferenceFeed* inference = nullptr;
+  ObjectTracker* tracker = nullptr;
+};
+
+// Global id → texture registry behind the C ABI. Shims register after the
+// texture registrar assigned the id and unregister before destruction;
+// unregistering waits for FFI calls still using the texture.
+void RegisterFfiTexture(int64_t texture_id, FfiTexture texture);
+void UnregisterFfiTexture(int64_t texture_id);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+#endif  // __cplusplus
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FFI_API_H_
@@ -0,0 +1,106 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FRAME_H_
+#define KATAGLYPHIS_NATIVE_CORE_FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+class FramePool;
+class FramePyramid;
+
+// One RGBA8 image as it travels from a producer (GStreamer appsink, Rust
+// engine, ...) to the texture. Frames are shared by reference; whoever holds
+// the last reference releases the backing storage, which is how lent
+// producer buffers and GStreamer samples get handed back without copies.
+//
+// A frame is mutable only until it is published to a FrameExchange.
+class Frame {
+ public:
+  using ReleaseCallback = void (*)(void* release_context);
+
+  // Allocates a tightly packed frame from `pool` (or the heap if null).
+  static std::shared_ptr<Frame> Allocate(FramePool* pool, uint32_t width,
+                                         uint32_t height);
+
+  // Wraps memory owned elsewhere. `owner` is kept alive for as long as the
+  // frame is referenced; its deleter is the release hook.
+  static std::shared_ptr<Frame> Wrap(const uint8_t* data, uint32_t width,
+                                     uint32_t height, uint32_t stride,
+                                     size_t size,
+                                     std::shared_ptr<const void> owner);
+
+  // Wraps a producer buffer that must stay untouched until
+  // `release(release_context)` fires.
+  static std::shared_ptr<Frame> Lend(const uint8_t* data, uint32_t width,
+                                     uint32_t height, uint32_t stride,
+                                     ReleaseCallback release,
+                                     void* release_context);
+
+  Frame(const Frame&) = delete;
+  Frame& operator=(const Frame&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  // Null for wrapped/lent frames.
+  uint8_t* mutable_data() { return writable_; }
+
+  uint32_t width() const { return width_; }
+  uint32_t height() const { return height_; }
+  uint32_t stride() const { return stride_; }
+  size_t size() const { return size_; }
+  bool is_tightly_packed() const {
+    return stride_ == width_ * 4U &&
+           size_ >= static_cast<size_t>(stride_) * height_;
+  }
+
+  // Assigned by FrameExchange on publish; 0 for unpublished frames.
+  uint64_t generation() const { return generation_; }
+
+  // Producer timestamp in nanoseconds, -1 if unknown.
+  int64_t timestamp_ns() const { return timestamp_ns_; }
+  void set_timestamp_ns(int64_t timestamp_ns) { timestamp_ns_ = timestamp_ns; }
+
+  // Every alpha byte is known to be 255 (fills, RGBx samples), so a
+  // presenter may hand the pixels out without forcing alpha. False for
+  // anything that may carry real alpha.
+  bool opaque() const { return opaque_; }
+  void set_opaque(bool opaque) { opaque_ = opaque; }
+
+  // Downscaled levels of this frame (frame_pyramid.h), null unless the
+  // producer built them.
+  const std::shared_ptr<const FramePyramid>& pyramid() const {
+    return pyramid_;
+  }
+  void set_pyramid(std::shared_ptr<const FramePyramid> pyramid) {
+    pyramid_ = std::move(pyramid);
+  }
+
+ private:
+  friend class FrameExchange;
+
+  Frame(const uint8_t* data, uint8_t* writable, uint32_t width,
+        uint32_t height, uint32_t stride, size_t size,
+        std::shared_ptr<const void> owner);
+
+  const uint8_t* data_;
+  uint8_t* writable_;
+  uint32_t width_;
+  uint32_t height_;
+  uint32_t stride_;
+  size_t size_;
+  uint64_t generation_ = 0;
+  int64_t timestamp_ns_ = -1;
+  bool opaque_ = false;
+  std::shared_ptr<const FramePyramid> pyramid_;
+  std::shared_ptr<const void> owner_;
+};
+
+using FrameRef = std::shared_ptr<const Frame>;
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FRAME_H_
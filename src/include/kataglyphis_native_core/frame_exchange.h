@@ -0,0 +1,108 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FRAME_EXCHANGE_H_
+#define KATAGLYPHIS_NATIVE_CORE_FRAME_EXCHANGE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/frame_pool.h"
+#include "kataglyphis_native_core/rate_estimator.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct FrameStats {
+  uint64_t frames_pushed = 0;
+  uint64_t frames_presented = 0;
+  // Frames replaced by a newer push before the consumer ever saw them.
+  uint64_t frames_dropped = 0;
+  uint64_t latest_generation = 0;
+  uint64_t presented_generation = 0;
+  // True while the latest pushed frame has not been presented yet.
+  bool frame_pending = false;
+  // Smoothed rate at which the consumer takes new frames.
+  double consumer_fps = 0.0;
+};
+
+// Single-slot, latest-wins handoff between one producer thread and the
+// texture's consumer (raster thread on Windows, GTK main thread on Linux).
+//
+// Only pointer swaps happen under the internal lock: copies run on the
+// producer thread before publishing, and the consumer keeps presenting
+// from its own reference while newer frames arrive.
+class FrameExchange {
+ public:
+  explicit FrameExchange(std::shared_ptr<FramePool> pool = nullptr);
+
+  FrameExchange(const FrameExchange&) = delete;
+  FrameExchange& operator=(const FrameExchange&) = delete;
+
+  // --- Producer side ---
+
+  // Copies a tightly packed RGBA frame into a pooled buffer and publishes it.
+  // `previous_consumed` reports whether the replaced frame was presented.
+  bool PushCopy(const uint8_t* rgba, uint32_t width, uint32_t height,
+                bool* previous_consumed = nullptr);
+
+  // Publishes `rgba` without copying; see Frame::Lend.
+  bool PushLent(const uint8_t* rgba, uint32_t width, uint32_t height,
+                Frame::ReleaseCallback release, void* release_context,
+                bool* previous_consumed = nullptr);
+
+  // Publishes an externally built frame (e.g. a wrapped GstSample).
+  void Publish(std::shared_ptr<Frame> frame, bool* previous_consumed = nullptr);
+
+  // Publishes a solid-color frame. Not counted as a push, so placeholder
+  // colors do not show up as producer traffic or drops.
+  void PublishFill(uint32_t width, uint32_t height, uint8_t r, uint8_t g,
+                   uint8_t b);
+
+  // Drops the latest frame, e.g. when the pipeline is torn down.
+  void Reset();
+
+  bool HasPendingFrame() const;
+
+  // Invoked on the consumer thread, outside the lock, each time a pending
+  // frame was presented. Pass an empty function to clear. Waits for a
+  // callback already running on another thread, so whatever the old one
+  // captured may be freed once this returns; called from inside this
+  // exchange's callback it does not wait for that call itself.
+  void SetSlotFreeCallback(std::function<void()> callback);
+
+  // --- Consumer side ---
+
+  // Returns the latest frame (null if none) and marks it presented. The
+  // reference keeps the pixels alive; drop it once the upload is done.
+  FrameRef AcquireLatest();
+
+  // Returns the latest frame without counting it as presented.
+  FrameRef PeekLatest() const;
+
+  FrameStats GetStats() const;
+
+  FramePool* pool() const { return pool_.get(); }
+
+ private:
+  void PublishLocked(std::shared_ptr<Frame> frame, bool tracked,
+                     bool* previous_consumed, FrameRef* displaced);
+
+  std::shared_ptr<FramePool> pool_;
+
+  mutable std::mutex mutex_;
+  FrameRef latest_;
+  uint64_t next_generation_ = 0;
+  FrameStats stats_;
+  RateEstimator consumer_rate_;
+  std::function<void()> slot_free_callback_;
+  // Callbacks currently running outside the lock.
+  int slot_free_running_ = 0;
+  std::condition_variable slot_free_done_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FRAME_EXCHANGE_H_
@@ -0,0 +1,92 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FRAME_HISTORY_H_
+#define KATAGLYPHIS_NATIVE_CORE_FRAME_HISTORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/frame_pool.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// One recorded frame: either a raw RGBA frame or an encoded access unit.
+struct HistoryFrame {
+  int64_t timestamp_ns = -1;
+  // Decodable on its own. Raw frames always are; encoded ones only if they
+  // are not delta units.
+  bool keyframe = true;
+  FrameRef frame;
+  std::shared_ptr<const std::vector<uint8_t>> encoded;
+
+  size_t bytes() const {
+    return frame ? frame->size() : encoded ? encoded->size() : 0;
+  }
+};
+
+struct FrameHistoryOptions {
+  // Span kept behind the newest frame.
+  int64_t window_ns = 10LL * 1000000000LL;
+  // Memory cap; the oldest frames go first when it is reached, even if
+  // that shortens the window.
+  size_t max_bytes = 256u << 20;
+};
+
+struct FrameHistoryStats {
+  size_t frames = 0;
+  size_t bytes = 0;
+  // Oldest to newest timestamp.
+  int64_t span_ns = 0;
+  uint64_t pushed = 0;
+  uint64_t evicted = 0;
+};
+
+// The last few seconds of a stream, so an event can be saved together with
+// what led up to it. Push() runs on the streaming thread and only holds the
+// lock to append and trim; Snapshot() copies references, so writing them
+// out happens without the lock. The oldest retained frame is always a
+// keyframe.
+class FrameHistory {
+ public:
+  explicit FrameHistory(FrameHistoryOptions options = FrameHistoryOptions());
+
+  FrameHistory(const FrameHistory&) = delete;
+  FrameHistory& operator=(const FrameHistory&) = delete;
+
+  // Appends `frame` (ignored without a timestamp). A timestamp older than
+  // the newest one starts a new stream and clears the history.
+  void Push(HistoryFrame frame);
+
+  // Tightly packed copy of a raw frame from the history's own pool, for
+  // frames whose buffers must go back to the producer.
+  std::shared_ptr<Frame> CopyFrame(const Frame& frame);
+
+  // The frames of the newest `window_ns` (all if <= 0), oldest first,
+  // extended back to the keyframe they depend on.
+  std::vector<HistoryFrame> Snapshot(int64_t window_ns) const;
+
+  void Clear();
+  FrameHistoryStats stats() const;
+  const FrameHistoryOptions& options() const { return options_; }
+
+ private:
+  void TrimLocked();
+
+  const FrameHistoryOptions options_;
+  const std::shared_ptr<FramePool> pool_;
+
+  mutable std::mutex mutex_;
+  std::deque<HistoryFrame> frames_;
+  size_t bytes_ = 0;
+  uint64_t pushed_ = 0;
+  uint64_t evicted_ = 0;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FRAME_HISTORY_H_
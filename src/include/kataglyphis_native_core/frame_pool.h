@@ -0,0 +1,48 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FRAME_POOL_H_
+#define KATAGLYPHIS_NATIVE_CORE_FRAME_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Recycles frame-sized byte buffers so steady-state streaming does not hit
+// the allocator. Buffers handed out by Acquire return to the pool when their
+// last reference drops, even if that happens after the pool is gone.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+ public:
+  static std::shared_ptr<FramePool> Create(size_t max_free_buffers = 4);
+
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  // Returns a buffer of at least `size` bytes. Contents are unspecified.
+  std::shared_ptr<uint8_t> Acquire(size_t size);
+
+  size_t free_buffers() const;
+  // Number of heap allocations made so far; flat in steady state.
+  uint64_t allocations() const;
+
+ private:
+  struct FreeBuffer {
+    size_t size;
+    std::unique_ptr<uint8_t[]> data;
+  };
+
+  explicit FramePool(size_t max_free_buffers);
+  void Recycle(size_t size, uint8_t* data);
+
+  const size_t max_free_buffers_;
+  mutable std::mutex mutex_;
+  std::vector<FreeBuffer> free_;
+  uint64_t allocations_ = 0;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FRAME_POOL_H_
@@ -0,0 +1,60 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FRAME_PYRAMID_H_
+#define KATAGLYPHIS_NATIVE_CORE_FRAME_PYRAMID_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+class FramePool;
+
+// Halved copies of one frame (1/2, 1/4, 1/8, ...), built once by the
+// producer and attached to the frame before it is published, so the
+// inference tap, the motion gate and snapshots read a small level instead
+// of each scaling the full-resolution frame themselves. Only level 1 reads
+// the full frame; every further level reads the one before it.
+//
+// Immutable once built; shared read-only like the frame itself.
+class FramePyramid {
+ public:
+  // Builds up to `levels` levels of `frame` with buffers from `pool` (the
+  // heap if null), stopping early once a side would drop below one pixel.
+  // Null if not even level 1 can be built.
+  static std::shared_ptr<const FramePyramid> Build(const Frame& frame,
+                                                   uint32_t levels,
+                                                   FramePool* pool);
+
+  FramePyramid(const FramePyramid&) = delete;
+  FramePyramid& operator=(const FramePyramid&) = delete;
+
+  // Level `index` is 1/2^index of the frame; null for 0 (the frame itself)
+  // and past level_count().
+  FrameRef level(uint32_t index) const;
+  uint32_t level_count() const {
+    return static_cast<uint32_t>(levels_.size());
+  }
+
+  // The largest level whose longer side is at most `max_side`, or the
+  // smallest one if none is.
+  FrameRef FitWithin(uint32_t max_side) const;
+
+ private:
+  FramePyramid() = default;
+
+  std::vector<FrameRef> levels_;
+};
+
+// 2x2 box filter from strided RGBA to `dst` (floor(width / 2) x
+// floor(height / 2), rounded to nearest). SSE2 or NEON where available.
+void Downsample2x(const uint8_t* src, size_t src_stride, uint32_t width,
+                  uint32_t height, uint8_t* dst, size_t dst_stride);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FRAME_PYRAMID_H_
@@ -0,0 +1,112 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_FRAME_SCRUBBER_H_
+#define KATAGLYPHIS_NATIVE_CORE_FRAME_SCRUBBER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "kataglyphis_native_core/diagnostic_ring.h"
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/scrub_cache.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct FrameScrubberOptions {
+  // Memory for decoded frames; the cache evicts beyond it.
+  size_t budget_bytes = 256u << 20;
+  // RGBA size of the cached frames; 0 keeps the source size.
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // Decoded per miss, starting at the requested frame (ending at it when
+  // scrubbing backward), so the following steps hit the cache.
+  int64_t chunk_ns = 500000000;
+  // How far past the playhead, in the scrub direction, the prefetcher keeps
+  // frames decoded while idle.
+  int64_t prefetch_ns = 2000000000;
+  // Streaming threads of the decode pipeline; nullptr: GStreamer's.
+  std::shared_ptr<StreamingThreadPool> task_pool;
+};
+
+// Frame-accurate random access into a video file for scrubbing UIs.
+//
+// A worker thread owns one decode pipeline. Seek() and Step() answer from a
+// ScrubCache when they can; on a miss they hand the worker a demand and
+// wait for the frame, which preempts any prefetch in flight. While idle the
+// worker fills gaps in the cache ahead of the playhead in the direction the
+// user last moved, so continued scrubbing that way stays on cached frames.
+class FrameScrubber {
+ public:
+  explicit FrameScrubber(FrameScrubberOptions options = FrameScrubberOptions());
+  // Calls Close().
+  ~FrameScrubber();
+
+  FrameScrubber(const FrameScrubber&) = delete;
+  FrameScrubber& operator=(const FrameScrubber&) = delete;
+
+  // Opens a file path or URI, prerolls it and starts the worker. The source
+  // must be seekable and report a duration.
+  bool Open(const std::string& input, std::string* error);
+  // Stops the worker and drops the pipeline and cache. Idempotent.
+  void Close();
+
+  // The frame on screen at `position_ns`, clamped to the file. Moves the
+  // playhead there; the scrub direction follows the sign of the move.
+  // Returns nullptr and sets `error` if it could not be decoded.
+  FrameRef Seek(int64_t position_ns, std::string* error);
+  // The frame `frames` away from the one at the playhead.
+  FrameRef Step(int frames, std::string* error);
+
+  // Timestamp of the frame at the playhead.
+  int64_t position_ns() const { return position_ns_.load(); }
+  int64_t duration_ns() const { return duration_ns_; }
+  // From the negotiated framerate, or the first buffer's duration.
+  int64_t frame_duration_ns() const { return frame_ns_; }
+  ScrubCacheStats cache_stats() const { return cache_.stats(); }
+  DiagnosticRing& diagnostics() const { return *diagnostics_; }
+
+ private:
+  struct Decoder;
+
+  void WorkerLoop();
+  // Decodes [begin_ns, end_ns) into the cache. Returns early when
+  // `generation` is no longer current; false on a decoding error.
+  bool DecodeRange(int64_t begin_ns, int64_t end_ns, uint64_t generation,
+                   std::string* error);
+  // Range a demand for `position_ns` decodes, given the scrub direction.
+  void DemandRange(int64_t position_ns, int direction, int64_t* begin_ns,
+                   int64_t* end_ns) const;
+
+  const FrameScrubberOptions options_;
+  const std::shared_ptr<DiagnosticRing> diagnostics_;
+  ScrubCache cache_;
+  std::unique_ptr<Decoder> decoder_;
+  std::thread worker_;
+
+  int64_t duration_ns_ = -1;
+  int64_t frame_ns_ = -1;
+  std::atomic<int64_t> position_ns_{0};
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  // Bumped per demand; a decode started for an older one stops early.
+  std::atomic<uint64_t> generation_{0};
+  bool demand_pending_ = false;
+  int64_t demand_ns_ = 0;
+  int direction_ = 1;
+  // Generation of the last demand the worker finished, and its error.
+  uint64_t served_generation_ = 0;
+  std::string demand_error_;
+  bool stopping_ = false;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_FRAME_SCRUBBER_H_
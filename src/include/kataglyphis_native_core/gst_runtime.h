@@ -0,0 +1,111 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_GST_RUNTIME_H_
+#define KATAGLYPHIS_NATIVE_CORE_GST_RUNTIME_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/pipeline_validator.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Time spent in each initialization phase, in milliseconds.
+struct GstRuntimeTimings {
+  // Start() to the init thread running.
+  double thread_start_ms = 0.0;
+  double gst_init_ms = 0.0;
+  double plugin_register_ms = 0.0;
+  // Building the element-factory index from the registry.
+  double index_ms = 0.0;
+  // Warming the availability cache for the probe lists.
+  double probe_ms = 0.0;
+  // Start() to ready.
+  double total_ms = 0.0;
+};
+
+struct GstRuntimeOptions {
+  // Runs right after gst_init on the init thread, e.g. to register
+  // statically linked plugins.
+  std::function<void()> register_plugins;
+  // Availability listed by Diagnose(); plugins are looked up up front,
+  // elements come from the factory index.
+  std::vector<std::string> probe_plugins;
+  std::vector<std::string> probe_elements;
+};
+
+// Process-wide, one-time GStreamer initialization.
+//
+// The platform shims start it on a background thread when the plugin
+// registers, so gst_init, static plugin registration and registry lookups
+// are off the UI thread and usually done before the first pipeline is set.
+// Plugin availability is cached after the first lookup and every element
+// factory name goes into an index built once, so pipelines can be validated
+// without touching the registry again. Nothing
+// is logged here; Diagnose() produces the full report on demand.
+class GstRuntime {
+ public:
+  static GstRuntime& Get();
+
+  // A separate runtime that nothing else has started, for tests of the
+  // initialization itself; everything else shares Get(). Destruction waits
+  // for a started initialization to finish.
+  GstRuntime() = default;
+  ~GstRuntime();
+
+  GstRuntime(const GstRuntime&) = delete;
+  GstRuntime& operator=(const GstRuntime&) = delete;
+
+  // Starts initialization on a background thread. Only the first call (or
+  // the first WaitUntilReady) takes effect.
+  void StartAsync(GstRuntimeOptions options);
+
+  // Blocks until initialization finished. Initializes inline with default
+  // options if nothing started it yet.
+  void WaitUntilReady();
+
+  bool ready() const;
+
+  // Cached; wait for initialization first.
+  bool HasPlugin(const std::string& name);
+  bool HasElement(const std::string& name);
+  // Whether elements from `factory` have the GObject property `property`.
+  // Loads the factory's plugin on first use; cached afterwards.
+  bool HasElementProperty(const std::string& factory,
+                          const std::string& property);
+
+  // Every element factory known after plugin registration. Waits for
+  // initialization; the reference stays valid for the process lifetime.
+  const ElementFactoryIndex& element_index();
+
+  GstRuntimeTimings timings() const;
+
+  // Probe-list availability, phase timings and every registered plugin.
+  std::string Diagnose();
+
+ private:
+  void Run(GstRuntimeOptions options);
+
+  mutable std::mutex mutex_;
+  std::condition_variable ready_changed_;
+  bool started_ = false;
+  bool ready_ = false;
+  std::chrono::steady_clock::time_point start_time_;
+  GstRuntimeTimings timings_;
+  std::vector<std::string> probe_plugins_;
+  std::vector<std::string> probe_elements_;
+  std::map<std::string, bool> plugins_;
+  // Keyed by "factory.property".
+  std::map<std::string, bool> element_properties_;
+  // Written once before ready_ is set, read-only afterwards.
+  ElementFactoryIndex element_index_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_GST_RUNTIME_H_
@@ -0,0 +1,99 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_HISTORY_RECORDER_H_
+#define KATAGLYPHIS_NATIVE_CORE_HISTORY_RECORDER_H_
+
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/frame_history.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct HistoryRecorderOptions {
+  FrameHistoryOptions history;
+  // Record the output of an encoder branch instead of raw frames; a far
+  // longer window fits the same memory cap.
+  bool encoded = false;
+  // Encoder of that branch, fed RGBA through videoconvert.
+  std::string encoder = "jpegenc quality=85";
+};
+
+struct HistoryDumpResult {
+  bool ok = false;
+  std::string path;
+  std::string error;
+  size_t frames = 0;
+  int64_t span_ns = 0;
+};
+
+// Per-texture pre-event recording: keeps the last seconds of a live
+// pipeline in a FrameHistory and writes them to a Matroska file on demand.
+//
+// Raw mode copies every displayed frame into the history (PushRaw), since
+// the sample buffers belong to the pipeline's pools. Encoded mode splices a
+// tee and a leaky encoder branch in front of the display sink (Attach), so
+// only compressed access units are kept. Dump() snapshots references and
+// muxes them on its own thread; the streaming threads never wait on it.
+class HistoryRecorder {
+ public:
+  using DumpCallback = std::function<void(const HistoryDumpResult& result)>;
+
+  explicit HistoryRecorder(HistoryRecorderOptions options);
+  // Waits for a dump in progress.
+  ~HistoryRecorder();
+
+  HistoryRecorder(const HistoryRecorder&) = delete;
+  HistoryRecorder& operator=(const HistoryRecorder&) = delete;
+
+  // Encoded mode only: inserts `tee ! queue ! <sink>` and the encoder branch
+  // ending in an appsink in front of `sink`. Call while the pipeline is
+  // still in NULL. A no-op in raw mode.
+  bool Attach(GstElement* pipeline, GstElement* sink, std::string* error);
+
+  // Raw mode only: records a copy of `frame`. Called on the streaming
+  // thread.
+  void PushRaw(const Frame& frame);
+
+  // Writes the newest `window_ns` (all if <= 0) to `path` in the
+  // background and reports through `done` on the writer thread. Fails
+  // right away if a dump is running or nothing was recorded yet.
+  bool Dump(const std::string& path, int64_t window_ns, DumpCallback done,
+            std::string* error);
+  bool dumping() const { return dumping_.load(); }
+
+  const HistoryRecorderOptions& options() const { return options_; }
+  FrameHistoryStats stats() const { return history_.stats(); }
+
+ private:
+  static GstFlowReturn OnEncodedSample(GstAppSink* sink, gpointer user_data);
+  HistoryDumpResult WriteFile(const std::string& path,
+                              const std::vector<HistoryFrame>& frames,
+                              const std::string& caps);
+
+  const HistoryRecorderOptions options_;
+  FrameHistory history_;
+
+  // Caps of the encoded frames; only the encoder branch's streaming thread
+  // compares `last_caps_`.
+  GstCaps* last_caps_ = nullptr;
+  mutable std::mutex caps_mutex_;
+  std::string caps_;
+
+  std::thread writer_;
+  std::atomic<bool> dumping_{false};
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_HISTORY_RECORDER_H_
@@ -0,0 +1,37 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_IMAGE_ENCODER_H_
+#define KATAGLYPHIS_NATIVE_CORE_IMAGE_ENCODER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+enum class ImageFormat {
+  // Tightly packed RGBA8, row padding removed.
+  kRaw,
+  // RGBA PNG with stored (uncompressed) deflate blocks: lossless and about
+  // as fast as a copy, at the size of the raw frame.
+  kPng,
+  // Baseline JPEG, 4:4:4, alpha dropped.
+  kJpeg,
+};
+
+// "raw", "png", "jpeg"/"jpg".
+bool ParseImageFormat(const std::string& name, ImageFormat* format);
+const char* ImageFormatName(ImageFormat format);
+
+// Encodes `frame` into `out`, replacing its contents. `jpeg_quality` is
+// 1..100 with the libjpeg scaling of the Annex K tables. Self-contained so
+// it runs on every platform without an image library; fails only for empty
+// or truncated frames.
+bool EncodeImage(const Frame& frame, ImageFormat format, int jpeg_quality,
+                 std::vector<uint8_t>* out);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_IMAGE_ENCODER_H_
@@ -0,0 +1,118 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_INFERENCE_FEED_H_
+#define KATAGLYPHIS_NATIVE_CORE_INFERENCE_FEED_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/motion_gate.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct InferenceFeedStats {
+  // Frames the producer offered.
+  uint64_t offered = 0;
+  // Held back by the motion gate.
+  uint64_t gated = 0;
+  // Let through, but replaced by a newer one before the consumer took them.
+  uint64_t replaced = 0;
+  uint64_t taken = 0;
+  // Motion of the last evaluated frame against the last one let through.
+  float last_mean_diff = 0.0f;
+  float last_changed_fraction = 0.0f;
+  // Skipped by the rate control before reaching the gate.
+  uint64_t throttled = 0;
+  // Smoothed over ReportInference(): completed inferences per second, run
+  // time, and age of the analyzed frame when its result was reported.
+  float effective_fps = 0.0f;
+  float inference_ms = 0.0f;
+  float latency_ms = 0.0f;
+  // Rate the control currently lets frames through at; 0 while it is off.
+  float admitted_fps = 0.0f;
+};
+
+struct InferenceRateOptions {
+  // Never let more than this many frames per second through; 0 for no cap
+  // beyond what the consumer keeps up with.
+  float max_fps = 0.0f;
+  // Slows the rate down while reported results are older than this, and
+  // speeds it back up once they are not. 0 only paces to the inference
+  // time.
+  int64_t target_latency_ns = 0;
+};
+
+// The frames an inference consumer should look at, separate from the
+// texture's presentation path: a single latest-wins slot that hands each
+// frame out at most once, so a consumer polling faster than the producer
+// does not analyze the same frame twice. With a MotionGate set, frames of
+// an unchanged scene never reach the slot.
+//
+// With rate control on, frames are let through no faster than the consumer
+// finishes them (as told by ReportInference()), so a slow model neither
+// builds a backlog nor gets handed frames that are replaced unseen; a
+// latency target additionally backs the rate off (multiplicatively) while
+// results come back too old.
+class InferenceFeed {
+ public:
+  InferenceFeed() = default;
+
+  InferenceFeed(const InferenceFeed&) = delete;
+  InferenceFeed& operator=(const InferenceFeed&) = delete;
+
+  // Null lets every frame through. Takes effect with the next Offer().
+  void SetMotionGate(std::shared_ptr<MotionGate> gate);
+
+  // Turns rate control on or off; restarts its measurements either way.
+  void ConfigureRate(bool enabled, const InferenceRateOptions& options);
+
+  // --- Producer side ---
+
+  // Applies the rate control, runs the gate (outside the lock) and stores
+  // `frame` if it passes. Returns whether it did.
+  bool Offer(const FrameRef& frame, int64_t now_ns);
+
+  // Drops the waiting frame and restarts the gate, e.g. on a new pipeline.
+  void Reset();
+
+  // --- Consumer side ---
+
+  // The waiting frame, or null if nothing new arrived since the last call.
+  FrameRef Take();
+
+  // The consumer finished the last taken frame after `duration_ns`.
+  // `now_ns` must come from the clock passed to Offer().
+  void ReportInference(int64_t duration_ns, int64_t now_ns);
+
+  InferenceFeedStats GetStats() const;
+
+ private:
+  // Recomputes interval_ns_ from the smoothed measurements.
+  void UpdateRateLocked();
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<MotionGate> gate_;
+  bool reset_gate_ = false;
+  FrameRef pending_;
+  int64_t pending_offered_ns_ = -1;
+  int64_t taken_offered_ns_ = -1;
+  InferenceFeedStats stats_;
+
+  bool rate_enabled_ = false;
+  InferenceRateOptions rate_;
+  // Minimum spacing of admitted frames, and when the next one may pass.
+  int64_t interval_ns_ = 0;
+  int64_t next_admit_ns_ = 0;
+  int64_t last_report_ns_ = -1;
+  // Exponentially smoothed, in nanoseconds; negative until the first
+  // sample.
+  double inference_ns_ = -1.0;
+  double latency_ns_ = -1.0;
+  double report_interval_ns_ = -1.0;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_INFERENCE_FEED_H_
@@ -0,0 +1,144 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_MOSAIC_COMPOSITOR_H_
+#define KATAGLYPHIS_NATIVE_CORE_MOSAIC_COMPOSITOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct MosaicTile {
+  // Name the source submits its frames under.
+  std::string source;
+  // Position in the surface, normalized: (0, 0) is the top-left and (1, 1)
+  // the bottom-right corner.
+  float left = 0.0f;
+  float top = 0.0f;
+  float width = 1.0f;
+  float height = 1.0f;
+  // Keep the source's aspect ratio and letterbox it with the background;
+  // otherwise stretch to the tile.
+  bool fit = true;
+};
+
+struct MosaicLayout {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // RGBA of the uncovered surface and of tiles without a frame yet.
+  uint8_t background[4] = {0, 0, 0, 255};
+  std::vector<MosaicTile> tiles;
+};
+
+struct MosaicStats {
+  uint64_t frames_submitted = 0;
+  uint64_t compositions = 0;
+  // Tiles rescaled because their source had a new frame, and tiles left
+  // as they were.
+  uint64_t tiles_drawn = 0;
+  uint64_t tiles_skipped = 0;
+};
+
+// Composites the latest frame of several streams into one RGBA surface, so
+// a video wall needs one texture and one upload per vsync instead of one
+// per stream. Sources submit frames latest-wins from their own threads;
+// Compose() (the presenting thread) rescales only the tiles whose source
+// produced a new frame since the last call and leaves the rest of the
+// surface untouched.
+//
+// Scaling halves large sources with Downsample2x (or takes their
+// FramePyramid level) until they are less than twice the tile size, then
+// finishes with a bilinear pass (SSE2 or NEON).
+class MosaicCompositor {
+ public:
+  MosaicCompositor() = default;
+
+  MosaicCompositor(const MosaicCompositor&) = delete;
+  MosaicCompositor& operator=(const MosaicCompositor&) = delete;
+
+  // Replaces the layout; the next Compose() repaints the whole surface.
+  // A layout without tiles or without a size turns the compositor off.
+  void SetLayout(MosaicLayout layout);
+  bool active() const;
+
+  // --- Producer side ---
+
+  // Keeps `frame` as the latest of `source`. Returns false for sources no
+  // tile shows (the frame is dropped) and null frames.
+  bool Submit(const std::string& source, FrameRef frame);
+
+  // Forgets all submitted frames, e.g. on a new pipeline. The surface
+  // keeps showing them until their sources submit again.
+  void ClearSources();
+
+  // --- Consumer side ---
+
+  // Brings the surface up to date. Returns the number of tiles redrawn;
+  // the surface is unchanged when it is 0 (and no layout change is due).
+  // Not reentrant; call from one thread.
+  size_t Compose();
+
+  // Valid until the next SetLayout(); only Compose() writes it.
+  const uint8_t* surface() const { return surface_.data(); }
+  uint32_t surface_width() const { return surface_width_; }
+  uint32_t surface_height() const { return surface_height_; }
+
+  MosaicStats GetStats() const;
+
+ private:
+  struct Source {
+    FrameRef frame;
+    // last_sequence_ at its Submit().
+    uint64_t sequence = 0;
+  };
+
+  // Pixel rectangle of a tile in the surface.
+  struct Rect {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+  };
+
+  void Fill(const Rect& rect, const uint8_t color[4]);
+  void DrawTile(const MosaicTile& tile, const Rect& rect, const Frame& frame);
+
+  mutable std::mutex mutex_;
+  MosaicLayout layout_;
+  // Bumped by SetLayout(); Compose() repaints when it differs from the one
+  // it last drew.
+  uint64_t layout_version_ = 0;
+  std::unordered_map<std::string, Source> sources_;
+  // One counter for all sources, so a sequence never repeats, not even
+  // after ClearSources().
+  uint64_t last_sequence_ = 0;
+  MosaicStats stats_;
+
+  // Owned by the Compose() thread.
+  MosaicLayout drawn_layout_;
+  uint64_t drawn_layout_version_ = 0;
+  std::vector<uint64_t> drawn_sequences_;
+  std::vector<uint8_t> surface_;
+  uint32_t surface_width_ = 0;
+  uint32_t surface_height_ = 0;
+  std::vector<uint8_t> halved_[2];
+  std::vector<uint8_t> scale_row_;
+};
+
+// Bilinear scale of strided RGBA to `dst` (pixel centers aligned, 7-bit
+// weights). `row` is scratch space reused across calls. Meant for factors
+// below 2; for smaller targets halve first. SSE2 or NEON where available.
+void ScaleRgbaBilinear(const uint8_t* src, size_t src_stride,
+                       uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                       size_t dst_stride, uint32_t dst_width,
+                       uint32_t dst_height, std::vector<uint8_t>* row);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_MOSAIC_COMPOSITOR_H_
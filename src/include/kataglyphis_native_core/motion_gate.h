@@ -0,0 +1,109 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_MOTION_GATE_H_
+#define KATAGLYPHIS_NATIVE_CORE_MOTION_GATE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Part of the frame in normalized coordinates: (0, 0) is the top-left and
+// (1, 1) the bottom-right corner.
+struct MotionRegion {
+  float left = 0.0f;
+  float top = 0.0f;
+  float width = 1.0f;
+  float height = 1.0f;
+};
+
+struct MotionGateOptions {
+  // Side of the square pixel blocks reduced to one luma sample.
+  uint32_t cell_size = 8;
+  // A frame passes when the mean absolute luma difference over the watched
+  // cells reaches `mean_threshold` (0-255)...
+  float mean_threshold = 3.0f;
+  // ...or when more than `changed_fraction` of them changed by more than
+  // `cell_threshold`, which catches small objects in a large static scene.
+  // A fraction of 0 disables this test.
+  uint8_t cell_threshold = 24;
+  float changed_fraction = 0.005f;
+  // Lets a frame through at least this often even when nothing moves, so
+  // results never get older than this. 0 disables it.
+  int64_t keep_alive_ns = 5000000000LL;
+  // Only cells whose center lies in one of these are watched; empty means
+  // the whole frame.
+  std::vector<MotionRegion> regions;
+};
+
+struct MotionDecision {
+  enum class Reason { kFirstFrame, kMotion, kKeepAlive, kStatic };
+
+  bool pass = false;
+  Reason reason = Reason::kStatic;
+  // Against the last frame that passed.
+  float mean_diff = 0.0f;
+  float changed_fraction = 0.0f;
+};
+
+const char* MotionReasonName(MotionDecision::Reason reason);
+
+// Decides whether a frame differs enough from the last frame handed to
+// inference to be worth analyzing. Frames are reduced to a luma grid (one
+// sample per cell, averaged along the cell's middle row, so only every
+// `cell_size`-th row is read) and compared with a masked sum of absolute
+// differences. Comparing against the last passed frame rather than the
+// previous one makes slow drift add up until it crosses the threshold.
+// Frames with a FramePyramid are read from the coarsest level that fits
+// the cells instead of the full frame.
+//
+// Not thread-safe; meant for the producer thread.
+class MotionGate {
+ public:
+  explicit MotionGate(MotionGateOptions options = MotionGateOptions());
+
+  MotionGate(const MotionGate&) = delete;
+  MotionGate& operator=(const MotionGate&) = delete;
+
+  // `now_ns` is only used for the keep-alive; any monotonic clock works.
+  MotionDecision Evaluate(const Frame& frame, int64_t now_ns);
+
+  // The next frame passes as the first one.
+  void Reset();
+
+  const MotionGateOptions& options() const { return options_; }
+
+ private:
+  void RebuildMask();
+
+  MotionGateOptions options_;
+  uint32_t grid_width_ = 0;
+  uint32_t grid_height_ = 0;
+  std::vector<uint8_t> reference_;
+  std::vector<uint8_t> current_;
+  // 0xFF for watched cells, 0 otherwise.
+  std::vector<uint8_t> mask_;
+  size_t watched_cells_ = 0;
+  int64_t last_pass_ns_ = 0;
+};
+
+// Reduces strided RGBA to a grid of ceil(width / cell_size) x
+// ceil(height / cell_size) BT.601 luma samples. Rows past `size` read as
+// black, so truncated buffers are safe.
+void DownsampleLuma(const uint8_t* rgba, size_t size, size_t stride,
+                    uint32_t width, uint32_t height, uint32_t cell_size,
+                    std::vector<uint8_t>* luma, uint32_t* grid_width,
+                    uint32_t* grid_height);
+
+// Over the `count` bytes where `mask` is 0xFF: the sum of |a - b| and how
+// many differ by more than `threshold`. SSE2 or NEON where available.
+void MaskedAbsDiff(const uint8_t* a, const uint8_t* b, const uint8_t* mask,
+                   size_t count, uint8_t threshold, uint64_t* sum,
+                   uint64_t* changed);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_MOTION_GATE_H_
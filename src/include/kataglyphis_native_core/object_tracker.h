@@ -0,0 +1,105 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_OBJECT_TRACKER_H_
+#define KATAGLYPHIS_NATIVE_CORE_OBJECT_TRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "kataglyphis_native_core/detection_packet.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct ObjectTrackerOptions {
+  // Minimum overlap between a track's predicted box and a detection of the
+  // same class for them to be matched.
+  float iou_threshold = 0.3f;
+  // Keyframes a track may go unmatched before it is dropped.
+  uint32_t max_misses = 2;
+  // Tracks are no longer extrapolated this long after their last match, so
+  // boxes vanish when the detector stops sending keyframes.
+  int64_t max_coast_ns = 1000000000LL;
+  // Noise of the constant-velocity model, relative to the box height:
+  // acceleration in heights/s^2 and measurement error in heights.
+  float acceleration_noise = 2.0f;
+  float measurement_noise = 0.05f;
+};
+
+// Multi-object tracker that carries boxes from inference keyframes across
+// the frames in between. Detections are matched to tracks greedily by IoU
+// against each track's prediction; center and size of each track follow
+// independent constant-velocity Kalman filters, so intermediate frames
+// cost a handful of multiply-adds per box.
+//
+// Update() and Predict() may run on different threads (e.g. a detector
+// reporting through FFI and the streaming thread); `time_ns` must come
+// from one clock, typically frame timestamps.
+class ObjectTracker {
+ public:
+  explicit ObjectTracker(ObjectTrackerOptions options = ObjectTrackerOptions(),
+                         bool enabled = true);
+
+  ObjectTracker(const ObjectTracker&) = delete;
+  ObjectTracker& operator=(const ObjectTracker&) = delete;
+
+  // Keyframe: corrects matched tracks, starts tracks for new detections and
+  // ages the rest. Writes the track ids into `detections`, whose boxes stay
+  // as measured.
+  void Update(DetectionSet* detections, int64_t time_ns);
+
+  // Intermediate frame: replaces `out->detections` with every live track
+  // extrapolated to `time_ns` and sets kDetectionFlagPredicted. Does not
+  // change the tracks.
+  void Predict(int64_t time_ns, DetectionSet* out) const;
+
+  void Reset();
+
+  // Replaces the options and drops all tracks. A disabled tracker leaves
+  // keyframes untouched and predicts nothing.
+  void Configure(bool enabled, const ObjectTrackerOptions& options);
+  bool enabled() const;
+
+  size_t track_count() const;
+
+ private:
+  // One coordinate (center x/y, width, height) with its velocity.
+  struct Axis {
+    float position = 0.0f;
+    float velocity = 0.0f;
+    // Covariance of (position, velocity).
+    float p00 = 0.0f;
+    float p01 = 0.0f;
+    float p11 = 0.0f;
+  };
+
+  struct Track {
+    int32_t id = -1;
+    int32_t class_id = -1;
+    float score = 0.0f;
+    Axis axes[4];  // cx, cy, w, h
+    // Time the state refers to, and of the last matched detection.
+    int64_t time_ns = 0;
+    int64_t matched_ns = 0;
+    uint32_t misses = 0;
+  };
+
+  static Detection ToDetection(const Track& track, float dt);
+  void Advance(Track* track, float dt) const;
+  void Correct(Track* track, const Detection& detection) const;
+  Track StartTrack(const Detection& detection, int64_t time_ns);
+
+  mutable std::mutex mutex_;
+  ObjectTrackerOptions options_;
+  bool enabled_;
+  std::vector<Track> tracks_;
+  int32_t next_id_ = 1;
+};
+
+// Intersection over union of two boxes; 0 if either is empty.
+float BoxIou(const Detection& a, const Detection& b);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_OBJECT_TRACKER_H_
@@ -0,0 +1,141 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_PIPELINE_CONTROLLER_H_
+#define KATAGLYPHIS_NATIVE_CORE_PIPELINE_CONTROLLER_H_
+
+#include <gst/gst.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "kataglyphis_native_core/diagnostic_ring.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Owns one parsed GStreamer pipeline and drives its state changes.
+//
+// State completion is signaled from a bus sync handler (ASYNC_DONE,
+// STATE_CHANGED, ERROR) through a condition variable, so waiting returns as
+// soon as the pipeline gets there instead of on a polling quantum. Callers
+// must not hold their own locks while waiting; the controller only locks
+// its internal state.
+//
+// The sync handler consumes every bus message, so popping the pipeline's
+// bus never returns anything; wait for end-of-stream with WaitForEos().
+class PipelineController {
+ public:
+  // Bus errors and warnings are recorded into `diagnostics`; a private ring
+  // is created if none is given.
+  explicit PipelineController(
+      std::shared_ptr<DiagnosticRing> diagnostics = nullptr);
+  ~PipelineController();
+
+  PipelineController(const PipelineController&) = delete;
+  PipelineController& operator=(const PipelineController&) = delete;
+
+  // Parses `description` and replaces the current pipeline (torn down to
+  // NULL first). Does not change the new pipeline's state.
+  bool Load(const std::string& description, std::string* error);
+
+  // Takes ownership of an already constructed pipeline (floating refs are
+  // sunk).
+  void Adopt(GstElement* pipeline);
+
+  // Runs the streaming threads of pipelines loaded from now on in `pool`
+  // (nullptr: GStreamer's default pool). Call before Load/Adopt.
+  void set_task_pool(std::shared_ptr<StreamingThreadPool> pool) {
+    task_pool_ = std::move(pool);
+  }
+
+  // Requests `target` and blocks until it is reached, an error is posted or
+  // `timeout` expires. Returns SUCCESS/NO_PREROLL once reached, FAILURE on
+  // error or when a concurrent request settled the pipeline elsewhere, ASYNC
+  // on timeout. Safe to call while another thread waits on this controller.
+  GstStateChangeReturn SetState(GstState target,
+                                std::chrono::milliseconds timeout);
+
+  // Waits for a transition that is already in flight.
+  GstStateChangeReturn WaitForState(GstState target,
+                                    std::chrono::milliseconds timeout);
+
+  // Blocks until the pipeline posts EOS, an error or `timeout` expires.
+  // EOS and errors count from Load/Adopt on, so a stream that already
+  // ended returns at once. False with the newest bus error (or a timeout
+  // note) in `error` otherwise.
+  bool WaitForEos(std::chrono::milliseconds timeout, std::string* error);
+
+  // Sets the pipeline to NULL and drops it. Must not race SetState on
+  // another thread; share the controller and drop the last reference
+  // instead.
+  void Release();
+
+  // Borrowed; valid until Load/Adopt/Release.
+  GstElement* pipeline() const { return pipeline_; }
+
+  // Parse warnings and bus ERROR/WARNING messages, recorded from the
+  // streaming threads without locking or allocating.
+  DiagnosticRing& diagnostics() const { return *diagnostics_; }
+
+  // Newest recorded bus error, formatted, or "".
+  std::string LastBusError() const;
+
+ private:
+  static GstBusSyncReply OnBusMessage(GstBus* bus, GstMessage* message,
+                                      gpointer user_data);
+  void HandleBusMessage(GstMessage* message);
+  void AttachBus();
+  void DetachBus();
+
+  const std::shared_ptr<DiagnosticRing> diagnostics_;
+  // Read from the bus sync handler; only changed while no pipeline is set.
+  std::shared_ptr<StreamingThreadPool> task_pool_;
+  GstElement* pipeline_ = nullptr;
+  GstBus* bus_ = nullptr;
+
+  std::mutex mutex_;
+  std::condition_variable state_changed_;
+  GstState current_state_ = GST_STATE_NULL;
+  GstState pending_state_ = GST_STATE_VOID_PENDING;
+  // Bumped on every ERROR so waiters only react to errors posted after
+  // their own request.
+  uint64_t error_count_ = 0;
+  // Bumped on every pipeline STATE_CHANGED, for the same reason.
+  uint64_t state_change_count_ = 0;
+  // error_count_ when the current pipeline was adopted.
+  uint64_t errors_at_adopt_ = 0;
+  bool eos_ = false;
+};
+
+// Opening a file and prerolling its decoder; generous for network URIs.
+constexpr std::chrono::seconds kPrerollTimeout(30);
+
+// `input` as a URI for uridecodebin: URIs pass through, file paths are
+// made absolute and converted.
+bool InputToUri(const std::string& input, std::string* uri,
+                std::string* error);
+
+const char* StateToString(GstState state);
+const char* StateChangeReturnToString(GstStateChangeReturn ret);
+
+// Flushing, frame-accurate seek of `pipeline` to `position_ns` (stream
+// time). The state is kept; a paused pipeline prerolls the frame at the new
+// position within `timeout`.
+bool SeekToFrame(GstElement* pipeline, int64_t position_ns,
+                 std::chrono::milliseconds timeout, std::string* error);
+// Shows the frame `frames` away from the current one. Forward steps send a
+// STEP event and need a PAUSED pipeline; backward steps seek to the
+// position that many frames earlier, at the framerate negotiated on a sink.
+bool StepFrames(GstElement* pipeline, int frames,
+                std::chrono::milliseconds timeout, std::string* error);
+// Current stream position, -1 if unknown.
+int64_t QueryPositionNs(GstElement* pipeline);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_PIPELINE_CONTROLLER_H_
@@ -0,0 +1,82 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_PIPELINE_PROFILER_H_
+#define KATAGLYPHIS_NATIVE_CORE_PIPELINE_PROFILER_H_
+
+#include <gst/gst.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// What one element did while the profiler was attached.
+struct ElementProfile {
+  std::string name;
+  std::string factory;
+  // Buffers the element pushed downstream (sinks: buffers received).
+  uint64_t buffers = 0;
+  double rate_hz = 0.0;
+  // Time from a buffer entering the element to the element pushing its
+  // output, for elements that push on the thread they received on. Zero
+  // samples for sources and thread boundaries (queues, most decoders'
+  // output), whose latency shows up as queue fill instead.
+  uint64_t processing_samples = 0;
+  double processing_mean_ms = 0.0;
+  double processing_p50_ms = 0.0;
+  double processing_p95_ms = 0.0;
+  double processing_max_ms = 0.0;
+  // Queues only: buffers held, sampled whenever one arrives.
+  bool is_queue = false;
+  double queue_fill_mean = 0.0;
+  uint32_t queue_fill_max = 0;
+  uint32_t queue_capacity = 0;  // 0: unbounded
+};
+
+// Per-element profiling of a running pipeline through buffer pad probes:
+// every element inside the bin, recursively, gets a probe on each sink and
+// src pad. Processing time is measured from sink-pad entry to src-pad push
+// on the same thread, so it excludes everything downstream. Probes cost a
+// clock read and a short per-element lock per buffer; attach only while
+// profiling.
+//
+// Elements and pads added after construction (e.g. decodebin's dynamic pads)
+// are not covered.
+class PipelineProfiler {
+ public:
+  // Attaches to every element currently in `pipeline`.
+  explicit PipelineProfiler(GstElement* pipeline);
+  // Removes all probes.
+  ~PipelineProfiler();
+
+  PipelineProfiler(const PipelineProfiler&) = delete;
+  PipelineProfiler& operator=(const PipelineProfiler&) = delete;
+
+  // Profiles in pipeline order (sources first), over the time since
+  // construction.
+  std::vector<ElementProfile> Snapshot() const;
+
+  // Counters of one element, updated from its probes.
+  struct ElementState;
+
+ private:
+  struct Probe {
+    GstPad* pad;
+    gulong id;
+  };
+
+  void AttachElement(GstElement* element);
+
+  std::vector<std::unique_ptr<ElementState>> elements_;
+  std::vector<Probe> probes_;
+  int64_t start_ns_ = 0;
+};
+
+// Renders profiles as a fixed-width text table, one element per row.
+std::string FormatProfileTable(const std::vector<ElementProfile>& profiles);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_PIPELINE_PROFILER_H_
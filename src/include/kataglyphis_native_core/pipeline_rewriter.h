@@ -0,0 +1,56 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_PIPELINE_REWRITER_H_
+#define KATAGLYPHIS_NATIVE_CORE_PIPELINE_REWRITER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "kataglyphis_native_core/pipeline_validator.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct PipelineRewriteOptions {
+  // Insert leaky queues after decoders and before converters, where the
+  // stream is raw video, each starting a new streaming thread. Sources
+  // get none, so encoded buffers are never dropped.
+  bool insert_queues = true;
+  // Buffers each inserted queue holds before dropping the oldest.
+  uint32_t queue_max_buffers = 2;
+  // n-threads for videoconvert/videoscale/videoconvertscale without one;
+  // 0 leaves them alone.
+  uint32_t converter_threads = 0;
+  // Whether `factory` has `property` (e.g. GstRuntime::HasElementProperty).
+  // Without it, n-threads is assumed to exist.
+  std::function<bool(const std::string& factory, const std::string& property)>
+      has_property;
+};
+
+struct PipelineRewrite {
+  bool ok = false;
+  // Validation error if !ok.
+  std::string error;
+  // The rewritten description (the input if nothing changed).
+  std::string description;
+  // One human-readable line per change.
+  std::vector<std::string> changes;
+};
+
+// Opt-in rewrite of a user's launch description so decode, conversion and
+// the sink stop sharing one streaming thread: adds size-bounded leaky queues
+// at raw-video stage boundaries that have none (caps filters stay attached
+// to their producer) and raises converter n-threads. Pure string work on top of
+// ValidatePipeline().
+PipelineRewrite RewritePipeline(std::string_view description,
+                                const ElementFactoryIndex& index,
+                                const PipelineRewriteOptions& options);
+
+// Half the hardware threads, clamped to 1..4.
+uint32_t DefaultConverterThreads();
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_PIPELINE_REWRITER_H_
@@ -0,0 +1,121 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_PIPELINE_SESSION_H_
+#define KATAGLYPHIS_NATIVE_CORE_PIPELINE_SESSION_H_
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "kataglyphis_native_core/diagnostic_ring.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// One texture's worth of GStreamer state: the current pipeline (through a
+// PipelineController), a diagnostics ring shared with its controllers and a
+// worker thread running a private GLib main context.
+//
+// Each session has its own lock, held only to swap state, never across a
+// state-change wait. A camera that takes seconds to preroll in one session
+// does not delay play/pause/stop in another, and stop() on the same session
+// interrupts a pending setPipeline.
+class PipelineSession {
+ public:
+  // Runs on the worker thread after parsing, before any state change, e.g.
+  // to bind a native window or check for a sink. Return false and set
+  // `error` to reject the pipeline.
+  using PrepareFn = std::function<bool(GstElement* pipeline,
+                                       std::string* error)>;
+
+  PipelineSession();
+  // Calls Close().
+  ~PipelineSession();
+
+  PipelineSession(const PipelineSession&) = delete;
+  PipelineSession& operator=(const PipelineSession&) = delete;
+
+  // Validates and parses `description`, replaces the current pipeline and
+  // prerolls to PAUSED. Fails if stop/close/another SetPipeline superseded
+  // it while waiting.
+  bool SetPipeline(const std::string& description, const PrepareFn& prepare,
+                   std::chrono::milliseconds preroll_timeout);
+  bool Play(std::chrono::milliseconds timeout);
+  bool Pause(std::chrono::milliseconds timeout);
+  // Moves the current pipeline to NULL and drops it. Returns false if there
+  // was none.
+  bool Stop();
+
+  // Flushing, frame-accurate seek to `position_ns` (stream time). The
+  // pipeline keeps its state; a paused one prerolls the frame at the new
+  // position within `timeout`.
+  bool Seek(int64_t position_ns, std::chrono::milliseconds timeout);
+  // Shows the frame `frames` away from the current one. Forward steps send
+  // a STEP event and need a PAUSED pipeline; backward steps seek to the
+  // position that many frame durations earlier (from the negotiated
+  // framerate of a sink).
+  bool StepFrames(int frames, std::chrono::milliseconds timeout);
+  // Current stream position, -1 if unknown.
+  int64_t position_ns() const;
+
+  // Pool for the streaming threads of pipelines set from now on; without
+  // one, StreamingThreadPool::Default() is used if configured.
+  void SetStreamingThreadPool(std::shared_ptr<StreamingThreadPool> pool);
+
+  // Stops the pipeline and joins the worker thread. Idempotent.
+  void Close();
+
+  // Calls `fn` with the current pipeline; false if there is none. The
+  // pipeline stays alive for the call but the session lock is not held.
+  bool WithPipeline(const std::function<void(GstElement*)>& fn);
+
+  // Formatted diagnostics recorded since the last SetPipeline/Play started,
+  // one per line.
+  std::string last_error() const;
+  bool has_pipeline() const;
+
+  // Session and bus diagnostics for every pipeline this session ran.
+  DiagnosticRing& diagnostics() const { return *diagnostics_; }
+
+  // Thread-default context of the worker thread; elements are created
+  // there so sources that attach GSources use it.
+  GMainContext* worker_context() const { return context_; }
+
+ private:
+  // Runs `fn` on the worker thread and waits for it (inline once closed).
+  void RunOnWorker(const std::function<void()>& fn);
+  void StopWorker();
+  // Starts a new last_error() window.
+  void ResetLastError();
+  void RecordError(const std::string& message);
+
+  GMainContext* context_ = nullptr;
+  GMainLoop* loop_ = nullptr;
+  std::thread worker_;
+
+  const std::shared_ptr<DiagnosticRing> diagnostics_;
+  // First diagnostic sequence reported by last_error().
+  std::atomic<uint64_t> last_error_since_{0};
+
+  mutable std::mutex mutex_;
+  // Shared so Play/Pause can wait on it without holding mutex_. Set as soon
+  // as a pipeline is parsed, so Stop() also reaches one still prerolling.
+  std::shared_ptr<PipelineController> controller_;
+  // Bumped whenever controller_ is replaced or taken; a SetPipeline that
+  // waited outside the lock uses it to detect that it was superseded.
+  uint64_t generation_ = 0;
+  bool closed_ = false;
+  std::shared_ptr<StreamingThreadPool> task_pool_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_PIPELINE_SESSION_H_
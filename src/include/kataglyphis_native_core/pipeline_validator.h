@@ -0,0 +1,84 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_PIPELINE_VALIDATOR_H_
+#define KATAGLYPHIS_NATIVE_CORE_PIPELINE_VALIDATOR_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Sorted set of element factory names, built once from the GStreamer
+// registry (see GstRuntime::element_index()). Immutable after construction,
+// so lookups need no locking.
+class ElementFactoryIndex {
+ public:
+  ElementFactoryIndex() = default;
+  explicit ElementFactoryIndex(std::vector<std::string> names);
+
+  bool Contains(std::string_view name) const;
+  // Closest known name by edit distance, or "" if nothing is close.
+  std::string Suggest(std::string_view name) const;
+
+  size_t size() const { return names_.size(); }
+  bool empty() const { return names_.empty(); }
+
+ private:
+  std::vector<std::string> names_;
+};
+
+// One element instantiation found in a launch description.
+struct PipelineElementRef {
+  enum class Kind {
+    kElement,  // `factory prop=value ...`
+    kBin,      // `factory.( ... )` or a bare `( ... )`
+    kUri,      // `scheme://...`, resolved by a URI handler
+  };
+  Kind kind = Kind::kElement;
+  std::string factory;
+  // Byte offset into the description.
+  size_t offset = 0;
+  // One past the factory name or its last `key=value` property.
+  size_t end = 0;
+};
+
+// One `!` in a launch description.
+struct PipelineLink {
+  // Byte offset of the `!`.
+  size_t offset = 0;
+  // Byte offset of the token after it.
+  size_t next_offset = 0;
+  // Indices into PipelineValidation::elements of the plain elements on
+  // either side; -1 for caps filters, bins and `name.pad` references.
+  int upstream = -1;
+  int downstream = -1;
+  // The `!` links into a caps filter.
+  bool to_caps = false;
+  // That caps filter's text, trimmed and without quotes.
+  std::string caps;
+};
+
+struct PipelineValidation {
+  bool ok = false;
+  // Human-readable reason, including the byte offset of the problem.
+  std::string error;
+  size_t error_offset = 0;
+  // Set when the failure is an unknown element factory.
+  std::string missing_element;
+  std::vector<PipelineElementRef> elements;
+  // In description order.
+  std::vector<PipelineLink> links;
+};
+
+// Tokenizes a gst-launch description (elements, properties, caps filters,
+// bins and `name.pad` references) and checks its structure. Elements are
+// looked up in `index` unless it is empty. Pure string work: no GStreamer
+// calls, no parsing side effects, typically a few microseconds.
+PipelineValidation ValidatePipeline(std::string_view description,
+                                    const ElementFactoryIndex& index);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_PIPELINE_VALIDATOR_H_
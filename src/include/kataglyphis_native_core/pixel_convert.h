@@ -0,0 +1,28 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_PIXEL_CONVERT_H_
+#define KATAGLYPHIS_NATIVE_CORE_PIXEL_CONVERT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+constexpr size_t kRgbaBytesPerPixel = 4;
+
+// Copies the overlapping top-left region of a strided RGBA source into a
+// tightly packed `dst_width` x `dst_height` destination and clears the rest.
+// Rows that would read past `src_size` are skipped, so truncated buffers
+// are safe. Alpha is forced to 255 when `force_opaque` is set.
+void CopyRgbaFrame(const uint8_t* src, size_t src_size, size_t src_stride,
+                   uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                   uint32_t dst_width, uint32_t dst_height, bool force_opaque);
+
+void FillRgba(uint8_t* dst, size_t pixel_count, uint8_t r, uint8_t g,
+              uint8_t b);
+
+void ForceAlphaOpaque(uint8_t* rgba, size_t pixel_count);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_PIXEL_CONVERT_H_
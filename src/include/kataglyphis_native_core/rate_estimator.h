@@ -0,0 +1,34 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_RATE_ESTIMATOR_H_
+#define KATAGLYPHIS_NATIVE_CORE_RATE_ESTIMATOR_H_
+
+#include <chrono>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Exponentially weighted event rate. Not thread-safe; callers serialize.
+class RateEstimator {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // `smoothing` is the weight of the newest interval (0 < smoothing <= 1).
+  explicit RateEstimator(double smoothing = 0.1) : smoothing_(smoothing) {}
+
+  void Tick(Clock::time_point now = Clock::now());
+  void Reset();
+
+  // Events per second, 0 until two ticks were seen.
+  double rate_hz() const;
+  double interval_ms() const { return interval_ms_; }
+
+ private:
+  double smoothing_;
+  bool has_last_ = false;
+  Clock::time_point last_;
+  double interval_ms_ = 0.0;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_RATE_ESTIMATOR_H_
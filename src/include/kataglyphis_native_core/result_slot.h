@@ -0,0 +1,43 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_RESULT_SLOT_H_
+#define KATAGLYPHIS_NATIVE_CORE_RESULT_SLOT_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+using ResultBytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+// Latest inference result of one texture as opaque bytes, tagged with the
+// generation of the frame it was computed on. Latest-wins like
+// FrameExchange: the producer replaces, readers take a reference.
+class ResultSlot {
+ public:
+  ResultSlot() = default;
+
+  ResultSlot(const ResultSlot&) = delete;
+  ResultSlot& operator=(const ResultSlot&) = delete;
+
+  void Publish(uint64_t frame_generation, ResultBytes bytes);
+  void Clear();
+
+  // Null until the first Publish(). `frame_generation` may be null.
+  ResultBytes Latest(uint64_t* frame_generation) const;
+
+  // Bumped by every Publish(), so pollers can skip unchanged results.
+  uint64_t version() const;
+
+ private:
+  mutable std::mutex mutex_;
+  ResultBytes bytes_;
+  uint64_t frame_generation_ = 0;
+  uint64_t version_ = 0;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_RESULT_SLOT_H_
@@ -0,0 +1,21 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_ROI_DETECTIONS_H_
+#define KATAGLYPHIS_NATIVE_CORE_ROI_DETECTIONS_H_
+
+#include <gst/gst.h>
+
+#include "kataglyphis_native_core/detection_packet.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Appends the GstVideoRegionOfInterestMeta boxes that inference elements
+// attached to `buffer`. Score and class come from the ROI's "detection"
+// parameter ("confidence" double, "label_id" int), the convention of the
+// common detector elements; boxes without it get score 0 and class -1.
+// Returns the number of boxes appended.
+size_t CollectRoiDetections(GstBuffer* buffer, DetectionSet* set);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_ROI_DETECTIONS_H_
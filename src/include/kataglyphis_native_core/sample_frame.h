@@ -0,0 +1,27 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_SAMPLE_FRAME_H_
+#define KATAGLYPHIS_NATIVE_CORE_SAMPLE_FRAME_H_
+
+#include <gst/gst.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Wraps the first plane of an RGBA appsink sample as a frame without
+// copying; the sample stays mapped until the frame's last reference drops.
+// Takes ownership of `sample`. Without video caps the payload is taken as
+// tightly packed `fallback_width` x `fallback_height`. Frames of formats
+// without alpha (RGBx) are marked opaque. Returns nullptr (and
+// releases the sample) if the buffer cannot be mapped.
+std::shared_ptr<Frame> WrapVideoSample(GstSample* sample,
+                                       uint32_t fallback_width,
+                                       uint32_t fallback_height);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_SAMPLE_FRAME_H_
@@ -0,0 +1,90 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_SCRUB_CACHE_H_
+#define KATAGLYPHIS_NATIVE_CORE_SCRUB_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct ScrubCacheStats {
+  size_t frames = 0;
+  size_t bytes = 0;
+  size_t budget_bytes = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+// Decoded frames around the playhead of a file being scrubbed, keyed by
+// presentation time. Bounded by a byte budget: when full, the frames
+// farthest from the playhead go first, with frames behind the scrub
+// direction counting twice as far as those ahead of it. Thread-safe; a
+// decoder thread inserts while the UI looks up.
+class ScrubCache {
+ public:
+  explicit ScrubCache(size_t budget_bytes);
+
+  ScrubCache(const ScrubCache&) = delete;
+  ScrubCache& operator=(const ScrubCache&) = delete;
+
+  // Adds a frame shown from `frame->timestamp_ns()` for `duration_ns`,
+  // replacing one with the same timestamp. Returns false if it did not fit
+  // (larger than the budget, or itself the farthest from the playhead).
+  bool Insert(FrameRef frame, int64_t duration_ns);
+
+  // The frame on screen at `position_ns`, or nullptr. Counts a hit or miss.
+  FrameRef Lookup(int64_t position_ns);
+
+  // The frame `offset` frames away from the one at `position_ns`, if it
+  // and every frame in between are cached back to back.
+  FrameRef Step(int64_t position_ns, int offset);
+
+  // Where the viewer is and which way it moves (+1 forward, -1 backward);
+  // steers eviction.
+  void SetPlayhead(int64_t position_ns, int direction);
+
+  // The uncovered range of [begin, end) closest to the playhead when
+  // walking in `direction`: the first gap after `begin` going forward, the
+  // last gap before `end` going backward. False if all of it is cached.
+  bool FindGap(int64_t begin, int64_t end, int direction, int64_t* gap_begin,
+               int64_t* gap_end) const;
+
+  void Clear();
+  ScrubCacheStats stats() const;
+
+ private:
+  struct Entry {
+    FrameRef frame;
+    int64_t duration_ns;
+  };
+  using Map = std::map<int64_t, Entry>;
+
+  static size_t BytesOf(const Frame& frame) { return frame.size(); }
+  // Entry on screen at `position_ns`, or end().
+  Map::const_iterator Find(int64_t position_ns) const;
+  // Whether `next` starts where `entry` ends, within half a frame.
+  static bool Adjacent(const Map::value_type& entry,
+                       const Map::value_type& next);
+  // Evicts until within budget; returns false if `keep` was evicted.
+  bool EvictLocked(int64_t keep);
+
+  const size_t budget_bytes_;
+  mutable std::mutex mutex_;
+  Map entries_;
+  size_t bytes_ = 0;
+  int64_t playhead_ns_ = 0;
+  int direction_ = 1;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_SCRUB_CACHE_H_
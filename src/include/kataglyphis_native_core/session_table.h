@@ -0,0 +1,67 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_SESSION_TABLE_H_
+#define KATAGLYPHIS_NATIVE_CORE_SESSION_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Id -> session map. The table lock only covers lookup, insert and removal;
+// callers work on the returned shared_ptr after it is released, so a slow
+// operation on one session never blocks access to another. Ids start at 1,
+// 0 is never handed out and can mean "no session".
+template <typename T>
+class SessionTable {
+ public:
+  int64_t Add(std::shared_ptr<T> session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t id = next_id_++;
+    sessions_.emplace(id, std::move(session));
+    return id;
+  }
+
+  std::shared_ptr<T> Find(int64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = sessions_.find(id);
+    return it == sessions_.end() ? nullptr : it->second;
+  }
+
+  // The caller tears the session down after the table lock is released.
+  std::shared_ptr<T> Remove(int64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = sessions_.find(id);
+    if (it == sessions_.end()) return nullptr;
+    std::shared_ptr<T> session = std::move(it->second);
+    sessions_.erase(it);
+    return session;
+  }
+
+  std::vector<std::shared_ptr<T>> RemoveAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::shared_ptr<T>> sessions;
+    sessions.reserve(sessions_.size());
+    for (auto& entry : sessions_) sessions.push_back(std::move(entry.second));
+    sessions_.clear();
+    return sessions;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  int64_t next_id_ = 1;
+  std::unordered_map<int64_t, std::shared_ptr<T>> sessions_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_SESSION_TABLE_H_
@@ -0,0 +1,172 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_SHARED_FRAME_RING_H_
+#define KATAGLYPHIS_NATIVE_CORE_SHARED_FRAME_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Memory layout shared with sidecar processes; all fields native-endian.
+// The region starts with one SharedFrameRingHeader, followed by
+// `slot_count` slots of `slot_stride` bytes, each a SharedFrameSlot with
+// the pixels right behind it.
+//
+// Slots are seqlocks: `lock` is odd while the writer fills the slot. A
+// reader copies `lock`, reads, and accepts what it read only if `lock` is
+// still the same even value afterwards.
+constexpr uint32_t kSharedFrameRingMagic = 0x5246474B;  // "KGFR"
+constexpr uint32_t kSharedFrameRingVersion = 2;
+constexpr uint32_t kFourccRgba = 0x41424752;  // "RGBA"
+
+struct SharedFrameRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t reserved;
+  uint64_t slot_bytes;   // pixel capacity of a slot
+  uint64_t slot_stride;  // distance between slot headers
+  // Sequence of the newest complete frame; 0 until the first one.
+  std::atomic<uint64_t> latest;
+  // Futex word, bumped after every frame; readers wait on it.
+  std::atomic<uint32_t> notify;
+  // Readers blocked on `notify`; the writer skips the wake syscall while
+  // it is 0.
+  std::atomic<uint32_t> waiters;
+  uint32_t padding[4];
+};
+
+struct SharedFrameSlot {
+  std::atomic<uint64_t> lock;
+  uint64_t sequence;  // 1-based frame number, slot = (sequence - 1) % count
+  int64_t timestamp_ns;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  uint32_t fourcc;
+  uint64_t size;
+  uint64_t padding[2];
+};
+
+static_assert(sizeof(SharedFrameRingHeader) == 64, "shared layout");
+static_assert(sizeof(SharedFrameSlot) == 64, "shared layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "cross-process atomics must not use a lock");
+
+struct SharedFrameRingStats {
+  uint64_t written = 0;
+  // Frames larger than a slot, dropped.
+  uint64_t oversized = 0;
+  // Frames that found a reader waiting and made the wake syscall.
+  uint64_t wakes = 0;
+};
+
+// Producer side: copies each frame once into a sealed memfd that any
+// number of sidecars map read-only, so a box decodes once however many
+// consumers it has. Linux and Android only; Create() fails elsewhere.
+//
+// Sidecars of the same user open the region as /proc/<pid>/fd/<fd>. A
+// Write() wakes futex waiters on `notify`, and makes no syscall when no
+// reader is waiting.
+class SharedFrameRingWriter {
+ public:
+  // `slot_bytes` is the largest frame accepted.
+  static std::unique_ptr<SharedFrameRingWriter> Create(const std::string& name,
+                                                       uint32_t slot_count,
+                                                       size_t slot_bytes,
+                                                       std::string* error);
+  ~SharedFrameRingWriter();
+
+  SharedFrameRingWriter(const SharedFrameRingWriter&) = delete;
+  SharedFrameRingWriter& operator=(const SharedFrameRingWriter&) = delete;
+
+  // Single producer. Returns false if `frame` does not fit a slot.
+  bool Write(const Frame& frame);
+
+  int fd() const { return fd_; }
+  uint32_t slot_count() const { return header_->slot_count; }
+  size_t slot_bytes() const { return header_->slot_bytes; }
+  SharedFrameRingStats stats() const;
+
+ private:
+  SharedFrameRingWriter(int fd, uint8_t* base, size_t size);
+
+  const int fd_;
+  uint8_t* const base_;
+  const size_t size_;
+  SharedFrameRingHeader* const header_;
+  uint64_t sequence_ = 0;
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> oversized_{0};
+  std::atomic<uint64_t> wakes_{0};
+};
+
+// A frame inside a reader's mapping. The pixels may be overwritten at any
+// time; check SharedFrameRingReader::Validate() after using them.
+struct SharedFrameView {
+  const uint8_t* data = nullptr;
+  uint64_t sequence = 0;
+  int64_t timestamp_ns = -1;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t stride = 0;
+  uint32_t fourcc = 0;
+  size_t size = 0;
+
+ private:
+  friend class SharedFrameRingReader;
+  const SharedFrameSlot* slot = nullptr;
+  uint64_t lock = 0;
+};
+
+// Consumer side, for sidecars and tests: maps the ring read-only, plus the
+// header writable so WaitForFrame() can register in `waiters`. Without
+// write access it still works but polls.
+class SharedFrameRingReader {
+ public:
+  // `path` is usually /proc/<pid>/fd/<fd> of the writer.
+  static std::unique_ptr<SharedFrameRingReader> Open(const std::string& path,
+                                                     std::string* error);
+  ~SharedFrameRingReader();
+
+  SharedFrameRingReader(const SharedFrameRingReader&) = delete;
+  SharedFrameRingReader& operator=(const SharedFrameRingReader&) = delete;
+
+  uint64_t latest() const { return header_->latest.load(); }
+
+  // Blocks until a frame newer than `after_sequence` exists. False on
+  // timeout (< 0: wait forever).
+  bool WaitForFrame(uint64_t after_sequence, int timeout_ms) const;
+
+  // Points `view` at the newest frame without copying. False if there is
+  // none yet or the writer keeps lapping the reader.
+  bool Acquire(SharedFrameView* view) const;
+  // Whether the pixels behind `view` were left alone since Acquire().
+  bool Validate(const SharedFrameView& view) const;
+
+  // Copies the newest frame's pixels, retrying if it gets overwritten.
+  bool CopyLatest(SharedFrameView* view, std::vector<uint8_t>* pixels) const;
+
+ private:
+  SharedFrameRingReader(const uint8_t* base, size_t size,
+                        SharedFrameRingHeader* control, size_t control_size);
+
+  const uint8_t* const base_;
+  const size_t size_;
+  const SharedFrameRingHeader* const header_;
+  // Writable mapping of the header page, null if the ring is read-only.
+  SharedFrameRingHeader* const control_;
+  const size_t control_size_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_SHARED_FRAME_RING_H_
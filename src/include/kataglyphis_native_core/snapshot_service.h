@@ -0,0 +1,92 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_SNAPSHOT_SERVICE_H_
+#define KATAGLYPHIS_NATIVE_CORE_SNAPSHOT_SERVICE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kataglyphis_native_core/frame.h"
+#include "kataglyphis_native_core/image_encoder.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct SnapshotRequest {
+  ImageFormat format = ImageFormat::kPng;
+  int jpeg_quality = 90;
+  // Written there if set; otherwise the bytes come back in the result.
+  std::string path;
+  // Thumbnail: encodes the largest pyramid level whose longer side is at
+  // most this (or the smallest level). 0, or a frame without a pyramid,
+  // encodes the full frame.
+  uint32_t max_side = 0;
+};
+
+struct SnapshotResult {
+  bool ok = false;
+  std::string error;
+  ImageFormat format = ImageFormat::kPng;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  int64_t timestamp_ns = -1;
+  // Empty when written to `path`.
+  std::vector<uint8_t> bytes;
+  std::string path;
+};
+
+// Encodes frames on a small pool of low-priority worker threads. Submit()
+// only queues a reference, so taking a snapshot of the live frame costs
+// the caller a refcount: the GstSample or pool slot behind it stays alive
+// until the worker is done and the pipeline never waits on the encoder.
+class SnapshotService {
+ public:
+  using Callback = std::function<void(SnapshotResult result)>;
+
+  // 0 workers: half the hardware threads, at least 1 and at most 4.
+  // `max_pending` bounds the referenced frames a burst can hold back from
+  // the producer's pool.
+  explicit SnapshotService(size_t workers = 0, size_t max_pending = 8);
+  // Finishes the queued snapshots, so every callback runs exactly once.
+  ~SnapshotService();
+
+  SnapshotService(const SnapshotService&) = delete;
+  SnapshotService& operator=(const SnapshotService&) = delete;
+
+  // Queues `frame`; `done` runs on a worker thread. Fails right away if
+  // the frame is null or the queue is full.
+  bool Submit(FrameRef frame, SnapshotRequest request, Callback done,
+              std::string* error);
+
+  // Queued plus in progress.
+  size_t pending() const;
+  size_t workers() const { return workers_.size(); }
+
+ private:
+  struct Job {
+    FrameRef frame;
+    SnapshotRequest request;
+    Callback done;
+  };
+
+  void Run();
+  static SnapshotResult Encode(const Job& job);
+
+  const size_t max_pending_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Job> queue_;
+  size_t running_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_SNAPSHOT_SERVICE_H_
@@ -0,0 +1,120 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_STATS_AGGREGATOR_H_
+#define KATAGLYPHIS_NATIVE_CORE_STATS_AGGREGATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Distribution of one duration metric over a window, in milliseconds.
+struct DurationSummary {
+  uint32_t count = 0;
+  float p50_ms = 0.0f;
+  float p95_ms = 0.0f;
+  float p99_ms = 0.0f;
+  float max_ms = 0.0f;
+};
+
+// One closed aggregation window of a texture.
+struct StatsWindow {
+  // Steady-clock end of the window and its actual length.
+  int64_t end_ns = 0;
+  int64_t duration_ns = 0;
+  // Frames that arrived from the producer, and how many of those were
+  // replaced before being presented.
+  uint32_t frames = 0;
+  uint32_t dropped = 0;
+  float fps = 0.0f;
+  // Arrival to presentation of the same frame.
+  DurationSummary latency;
+  // Time spent copying pixels for presentation (zero-copy frames skip it).
+  DurationSummary copy;
+  // As reported by the inference consumer.
+  DurationSummary inference;
+};
+
+// Collects per-frame timings from the producer, presentation and inference
+// threads and summarizes them once per window. Recording takes a short
+// uncontended lock and never allocates: every metric keeps at most
+// `max_samples` per window, the newest ones.
+class StatsAggregator {
+ public:
+  explicit StatsAggregator(size_t max_samples = 2048);
+
+  StatsAggregator(const StatsAggregator&) = delete;
+  StatsAggregator& operator=(const StatsAggregator&) = delete;
+
+  // Steady clock in nanoseconds; the time base of all `now_ns` arguments.
+  static int64_t NowNs();
+
+  // Opens a fresh window, discarding anything recorded so far.
+  // `dropped_total` is the producer's running drop counter.
+  void Start(int64_t now_ns, uint64_t dropped_total);
+
+  void RecordArrival(uint64_t generation, int64_t now_ns);
+  // Frames presented more than once only count the first time.
+  void RecordPresented(uint64_t generation, int64_t now_ns);
+  void RecordCopy(int64_t duration_ns);
+  void RecordInference(int64_t duration_ns);
+
+  // Summarizes the current window and opens the next one.
+  StatsWindow Collect(int64_t now_ns, uint64_t dropped_total);
+
+ private:
+  // Recent arrivals, for matching presentations to them.
+  static constexpr size_t kArrivals = 16;
+
+  struct Samples {
+    std::vector<int64_t> values;
+    size_t recorded = 0;
+  };
+
+  void Add(Samples* samples, int64_t value);
+  DurationSummary Summarize(Samples* samples);
+
+  const size_t max_samples_;
+  std::mutex mutex_;
+  int64_t start_ns_ = 0;
+  uint64_t dropped_at_start_ = 0;
+  uint32_t frames_ = 0;
+  std::array<std::pair<uint64_t, int64_t>, kArrivals> arrivals_{};
+  uint64_t last_presented_ = 0;
+  Samples latency_;
+  Samples copy_;
+  Samples inference_;
+  // Scratch space for Summarize(), reused across windows.
+  std::vector<int64_t> sorted_;
+};
+
+// Wire format of one window for the Dart stream (StatsWindow in
+// lib/kataglyphis_frame_stats.dart), little-endian:
+//
+//   offset  size  field
+//        0     4  magic "KGST"
+//        4     2  version
+//        6     2  size of the message
+//        8     8  end_ns
+//       16     8  duration_ns
+//       24     4  frames
+//       28     4  dropped
+//       32     4  fps (float32)
+//       36     4  reserved
+//       40    20  latency:   count (uint32), p50, p95, p99, max (float32 ms)
+//       60    20  copy:      same
+//       80    20  inference: same
+//      100     4  reserved
+constexpr uint32_t kStatsWindowMagic = 0x5453474B;  // "KGST"
+constexpr uint16_t kStatsWindowVersion = 1;
+constexpr size_t kStatsWindowBytes = 104;
+
+void EncodeStatsWindow(const StatsWindow& window, std::vector<uint8_t>* out);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_STATS_AGGREGATOR_H_
@@ -0,0 +1,81 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_STREAMING_THREAD_POOL_H_
+#define KATAGLYPHIS_NATIVE_CORE_STREAMING_THREAD_POOL_H_
+
+#include <gst/gst.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/thread_placement.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct StreamingThreadOptions {
+  // Threads are named "<prefix>-<n>"; keep it short, Linux allows 15 bytes.
+  std::string name_prefix = "kgst-media";
+  // CPUs the streaming threads are pinned to; empty means no pinning.
+  std::vector<int> cpus;
+  // Nice value under SCHED_OTHER; unset keeps the creator's.
+  std::optional<int> nice;
+};
+
+// A GstTaskPool that runs each streaming task (source loops, queue and
+// decoder threads) on its own named thread with the configured CPU set and
+// nice value, so media work can be kept off the cores running Flutter's UI
+// and raster threads.
+//
+// Tasks are moved onto the pool when the pipeline posts STREAM_STATUS
+// CREATE, which must be handled from a bus sync handler:
+// PipelineController does this when given a pool; other pipelines can use
+// Attach().
+class StreamingThreadPool {
+ public:
+  static std::shared_ptr<StreamingThreadPool> Create(
+      StreamingThreadOptions options);
+
+  // Reads KATAGLYPHIS_GST_CPUS ("4-7") and KATAGLYPHIS_GST_NICE ("5").
+  // Returns false if neither is set or one does not parse (see `error`).
+  static bool OptionsFromEnvironment(StreamingThreadOptions* options,
+                                     std::string* error);
+
+  // Process-wide pool the platform shims use for new pipelines. nullopt
+  // disables it; running pipelines keep the pool they started with.
+  static void SetDefaultOptions(std::optional<StreamingThreadOptions> options);
+  // nullptr unless configured; created on first use (waits for GstRuntime).
+  static std::shared_ptr<StreamingThreadPool> Default();
+
+  ~StreamingThreadPool();
+
+  StreamingThreadPool(const StreamingThreadPool&) = delete;
+  StreamingThreadPool& operator=(const StreamingThreadPool&) = delete;
+
+  // Moves the task announced by a STREAM_STATUS CREATE message onto this
+  // pool. Returns false for any other message. Call from a sync handler.
+  bool HandleStreamStatus(GstMessage* message);
+
+  // Installs a bus sync handler on `pipeline` that only handles
+  // STREAM_STATUS and passes everything on. For pipelines whose bus has no
+  // other sync handler. Keeps the pool alive while the bus uses it.
+  void Attach(GstElement* pipeline);
+
+  const StreamingThreadOptions& options() const;
+  // Placement of every live streaming thread, as read back from the OS.
+  std::vector<ThreadPlacementInfo> Threads() const;
+  // Configuration plus one FormatThreadPlacement() line per live thread.
+  std::string Describe() const;
+
+  GstTaskPool* gst_pool() const { return pool_; }
+
+ private:
+  explicit StreamingThreadPool(GstTaskPool* pool);
+
+  GstTaskPool* pool_;
+};
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_STREAMING_THREAD_POOL_H_
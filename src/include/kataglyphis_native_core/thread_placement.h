@@ -0,0 +1,54 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_THREAD_PLACEMENT_H_
+#define KATAGLYPHIS_NATIVE_CORE_THREAD_PLACEMENT_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+// Where and how eagerly a thread runs. Unset fields are left alone.
+struct ThreadPlacement {
+  // Truncated to 15 bytes on Linux/Android.
+  std::string name;
+  // CPU indices to pin to; empty means no pinning.
+  std::vector<int> cpus;
+  // Nice value for the thread under SCHED_OTHER (-20..19; lowering it
+  // usually needs privileges). Mapped to a thread priority on Windows.
+  std::optional<int> nice;
+};
+
+// What a thread actually got, read back from the OS.
+struct ThreadPlacementInfo {
+  int64_t thread_id = 0;
+  std::string name;
+  // Allowed CPUs; empty if unknown.
+  std::vector<int> cpus;
+  int nice = 0;
+  // Set if applying the requested placement partly failed.
+  std::string error;
+};
+
+// Applies `placement` to the calling thread. Keeps going after a failed
+// step and returns false with all failures in `error`.
+bool ApplyThreadPlacement(const ThreadPlacement& placement,
+                          std::string* error);
+
+ThreadPlacementInfo DescribeCurrentThread();
+
+// Parses "0-3,6" style CPU lists (as in /sys/devices/system/cpu/online).
+bool ParseCpuList(std::string_view text, std::vector<int>* cpus,
+                  std::string* error);
+// Inverse of ParseCpuList; ranges are collapsed.
+std::string FormatCpuList(std::vector<int> cpus);
+
+// "name tid=123 cpus=4-7 nice=5", plus the error if any.
+std::string FormatThreadPlacement(const ThreadPlacementInfo& info);
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_THREAD_PLACEMENT_H_
@@ -0,0 +1,139 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_TRACE_RECORDER_H_
+#define KATAGLYPHIS_NATIVE_CORE_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+struct TraceStats {
+  uint64_t events = 0;
+  // Events lost because their thread's buffer was full.
+  uint64_t dropped = 0;
+  size_t threads = 0;
+};
+
+// Process-wide recorder of scoped trace events on the frame path, written
+// out as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Every thread writes into its own fixed-size buffer: no locks and no
+// allocation per event, only the thread's first event of a session
+// registers its buffer. While tracing is off, an event costs one relaxed
+// atomic load. Full buffers drop further events rather than wrapping, so a
+// session keeps its beginning.
+//
+// Timestamps come from the steady clock, which is CLOCK_MONOTONIC on Linux
+// and Android like Flutter's timeline, so both traces line up when loaded
+// together.
+class TraceRecorder {
+ public:
+  static constexpr size_t kDefaultEventsPerThread = 16384;
+
+  static TraceRecorder& Get();
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Starts a new session, discarding the previous one's events.
+  void Start(size_t events_per_thread = kDefaultEventsPerThread);
+  // Stops recording; the session's events stay until the next Start().
+  void Stop();
+
+  // Writes the current session's events, also while it is still running.
+  bool WriteChromeTrace(const std::string& path, TraceStats* stats,
+                        std::string* error) const;
+
+  // `name` and `arg_name` must be string literals (or otherwise outlive
+  // the session); they are stored as pointers. `arg_name` may be null.
+  void RecordComplete(const char* name, int64_t start_ns, int64_t end_ns,
+                      const char* arg_name, int64_t arg);
+  void RecordInstant(const char* name, const char* arg_name, int64_t arg);
+
+  static int64_t NowNs();
+
+ private:
+  struct Event {
+    const char* name;
+    const char* arg_name;
+    int64_t start_ns;
+    // -1 for instant events.
+    int64_t duration_ns;
+    int64_t arg;
+  };
+
+  struct ThreadBuffer {
+    uint64_t session = 0;
+    uint32_t tid = 0;
+    std::string thread_name;
+    std::unique_ptr<Event[]> events;
+    size_t capacity = 0;
+    // Written only by the owning thread; the release store publishes the
+    // event below it to WriteChromeTrace().
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+  };
+
+  TraceRecorder() = default;
+
+  void Record(const Event& event);
+  ThreadBuffer* BufferForThisThread();
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> session_{0};
+  mutable std::mutex mutex_;
+  size_t events_per_thread_ = kDefaultEventsPerThread;
+  uint32_t next_tid_ = 1;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+// Records a complete event spanning its own lifetime if tracing was on
+// when it was constructed.
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(const char* name, const char* arg_name = nullptr,
+                       int64_t arg = 0)
+      : name_(name),
+        arg_name_(arg_name),
+        arg_(arg),
+        start_ns_(TraceRecorder::Get().enabled() ? TraceRecorder::NowNs()
+                                                 : -1) {}
+  ~ScopedTrace() {
+    if (start_ns_ >= 0) {
+      TraceRecorder::Get().RecordComplete(name_, start_ns_,
+                                          TraceRecorder::NowNs(), arg_name_,
+                                          arg_);
+    }
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+  // For values only known inside the scope, e.g. a frame generation.
+  void set_arg(int64_t arg) { arg_ = arg; }
+
+ private:
+  const char* name_;
+  const char* arg_name_;
+  int64_t arg_;
+  int64_t start_ns_;
+};
+
+// Instant event, a no-op while tracing is off.
+inline void TraceInstant(const char* name, const char* arg_name = nullptr,
+                         int64_t arg = 0) {
+  TraceRecorder& recorder = TraceRecorder::Get();
+  if (recorder.enabled()) recorder.RecordInstant(name, arg_name, arg);
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_TRACE_RECORDER_H_
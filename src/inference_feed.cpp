@@ -0,0 +1,167 @@
+#include "kataglyphis_native_core/inference_feed.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Weight of a new sample in the smoothed measurements.
+constexpr double kSmoothing = 0.2;
+// Multiplicative back-off while over the latency target, and the recovery
+// per report below it.
+constexpr double kBackOff = 1.25;
+constexpr double kRecover = 0.95;
+// The latency control spaces frames at least this far apart once it backs
+// off, and never further than kMaxIntervalNs (unless a single inference
+// takes longer).
+constexpr double kMinBackOffNs = 1e6;
+constexpr double kMaxIntervalNs = 1e9;
+
+void Smooth(double sample, double* value) {
+  *value = *value < 0.0 ? sample : *value + kSmoothing * (sample - *value);
+}
+
+float NsToMs(double ns) {
+  return ns < 0.0 ? 0.0f : static_cast<float>(ns / 1e6);
+}
+
+}  // namespace
+
+void InferenceFeed::SetMotionGate(std::shared_ptr<MotionGate> gate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  gate_ = std::move(gate);
+}
+
+void InferenceFeed::ConfigureRate(bool enabled,
+                                  const InferenceRateOptions& options) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  rate_enabled_ = enabled;
+  rate_ = options;
+  interval_ns_ = 0;
+  next_admit_ns_ = 0;
+  last_report_ns_ = -1;
+  inference_ns_ = -1.0;
+  latency_ns_ = -1.0;
+  report_interval_ns_ = -1.0;
+  UpdateRateLocked();
+}
+
+bool InferenceFeed::Offer(const FrameRef& frame, int64_t now_ns) {
+  if (!frame) {
+    return false;
+  }
+  std::shared_ptr<MotionGate> gate;
+  bool reset_gate = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Before the gate, so throttled frames cost no motion check either.
+    if (rate_enabled_ && now_ns < next_admit_ns_) {
+      ++stats_.offered;
+      ++stats_.throttled;
+      return false;
+    }
+    gate = gate_;
+    reset_gate = reset_gate_;
+    reset_gate_ = false;
+  }
+  // Only the producer thread evaluates, so the gate needs no lock of its
+  // own; a replaced gate finishes this frame and is dropped.
+  MotionDecision decision;
+  decision.pass = true;
+  if (gate) {
+    if (reset_gate) gate->Reset();
+    decision = gate->Evaluate(*frame, now_ns);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.offered;
+  stats_.last_mean_diff = decision.mean_diff;
+  stats_.last_changed_fraction = decision.changed_fraction;
+  if (!decision.pass) {
+    ++stats_.gated;
+    return false;
+  }
+  if (pending_) {
+    ++stats_.replaced;
+  }
+  pending_ = frame;
+  pending_offered_ns_ = now_ns;
+  if (rate_enabled_) {
+    next_admit_ns_ = now_ns + interval_ns_;
+  }
+  return true;
+}
+
+void InferenceFeed::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.reset();
+  reset_gate_ = true;
+}
+
+FrameRef InferenceFeed::Take() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_) {
+    ++stats_.taken;
+    taken_offered_ns_ = pending_offered_ns_;
+  }
+  return std::move(pending_);
+}
+
+void InferenceFeed::ReportInference(int64_t duration_ns, int64_t now_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Smooth(static_cast<double>(duration_ns), &inference_ns_);
+  if (taken_offered_ns_ >= 0 && now_ns >= taken_offered_ns_) {
+    Smooth(static_cast<double>(now_ns - taken_offered_ns_), &latency_ns_);
+    taken_offered_ns_ = -1;
+  }
+  if (last_report_ns_ >= 0 && now_ns > last_report_ns_) {
+    Smooth(static_cast<double>(now_ns - last_report_ns_),
+           &report_interval_ns_);
+  }
+  last_report_ns_ = now_ns;
+  UpdateRateLocked();
+}
+
+void InferenceFeed::UpdateRateLocked() {
+  if (!rate_enabled_) {
+    return;
+  }
+  // Admitting faster than the consumer finishes only replaces frames.
+  double floor_ns = std::max(inference_ns_, 0.0);
+  if (rate_.max_fps > 0.0f) {
+    floor_ns = std::max(floor_ns, 1e9 / rate_.max_fps);
+  }
+  double interval = floor_ns;
+  if (rate_.target_latency_ns > 0 && latency_ns_ >= 0.0) {
+    interval = std::max(static_cast<double>(interval_ns_), floor_ns);
+    if (latency_ns_ > static_cast<double>(rate_.target_latency_ns)) {
+      // Backing off from zero needs a starting point.
+      interval = std::max(interval * kBackOff, kMinBackOffNs);
+    } else {
+      interval *= kRecover;
+    }
+    interval = std::min(interval, std::max(floor_ns, kMaxIntervalNs));
+  }
+  interval_ns_ = static_cast<int64_t>(std::max(interval, floor_ns));
+}
+
+InferenceFeedStats InferenceFeed::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  InferenceFeedStats stats = stats_;
+  stats.effective_fps =
+      report_interval_ns_ > 0.0 ? static_cast<float>(1e9 / report_interval_ns_)
+                                : 0.0f;
+  stats.inference_ms = NsToMs(inference_ns_);
+  stats.latency_ms = NsToMs(latency_ns_);
+  stats.admitted_fps =
+      rate_enabled_ && interval_ns_ > 0
+          ? static_cast<float>(1e9 / static_cast<double>(interval_ns_))
+          : 0.0f;
+  return stats;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
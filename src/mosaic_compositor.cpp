@@ -0,0 +1,359 @@
+#include "kataglyphis_native_core/mosaic_compositor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KATAGLYPHIS_MOSAIC_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KATAGLYPHIS_MOSAIC_NEON 1
+#endif
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Weights are in 1/128ths, so a weighted pixel pair fits 16-bit lanes.
+constexpr uint32_t kWeightOne = 128;
+
+// Left source sample and weight of the right one for output `i` of
+// `dst_size`, pixel centers aligned.
+void SourceTap(uint32_t i, uint32_t src_size, uint32_t dst_size,
+               uint32_t* first, uint32_t* weight) {
+  const int64_t position =
+      (static_cast<int64_t>(2 * i + 1) * src_size * kWeightOne) /
+          (2 * static_cast<int64_t>(dst_size)) -
+      kWeightOne / 2;
+  if (position <= 0) {
+    *first = 0;
+    *weight = 0;
+    return;
+  }
+  *first = static_cast<uint32_t>(position / kWeightOne);
+  *weight = static_cast<uint32_t>(position % kWeightOne);
+  if (*first >= src_size - 1) {
+    *first = src_size - 1;
+    *weight = 0;
+  }
+}
+
+// out = (a * (128 - weight) + b * weight + 64) / 128, bytewise.
+void BlendRows(const uint8_t* a, const uint8_t* b, uint32_t weight,
+               size_t count, uint8_t* out) {
+  const uint32_t keep = kWeightOne - weight;
+  size_t i = 0;
+#if defined(KATAGLYPHIS_MOSAIC_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wa = _mm_set1_epi16(static_cast<int16_t>(keep));
+  const __m128i wb = _mm_set1_epi16(static_cast<int16_t>(weight));
+  const __m128i rounding = _mm_set1_epi16(kWeightOne / 2);
+  for (; i + 16 <= count; i += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i lo = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                      _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb)),
+        rounding);
+    const __m128i hi = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                      _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb)),
+        rounding);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packus_epi16(_mm_srli_epi16(lo, 7),
+                                      _mm_srli_epi16(hi, 7)));
+  }
+#elif defined(KATAGLYPHIS_MOSAIC_NEON)
+  const uint8x8_t wa = vdup_n_u8(static_cast<uint8_t>(keep));
+  const uint8x8_t wb = vdup_n_u8(static_cast<uint8_t>(weight));
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t va = vld1q_u8(a + i);
+    const uint8x16_t vb = vld1q_u8(b + i);
+    const uint16x8_t lo =
+        vmlal_u8(vmull_u8(vget_low_u8(va), wa), vget_low_u8(vb), wb);
+    const uint16x8_t hi =
+        vmlal_u8(vmull_u8(vget_high_u8(va), wa), vget_high_u8(vb), wb);
+    vst1q_u8(out + i, vcombine_u8(vrshrn_n_u16(lo, 7), vrshrn_n_u16(hi, 7)));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = static_cast<uint8_t>((a[i] * keep + b[i] * weight +
+                                   kWeightOne / 2) /
+                                  kWeightOne);
+  }
+}
+
+// One output pixel from `pair` (two neighbouring RGBA pixels).
+inline void BlendPair(const uint8_t* pair, uint32_t weight, uint8_t* out) {
+  const uint32_t keep = kWeightOne - weight;
+#if defined(KATAGLYPHIS_MOSAIC_SSE2)
+  const __m128i pixels = _mm_unpacklo_epi8(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pair)),
+      _mm_setzero_si128());
+  const int16_t k = static_cast<int16_t>(keep);
+  const int16_t w = static_cast<int16_t>(weight);
+  const __m128i product =
+      _mm_mullo_epi16(pixels, _mm_set_epi16(w, w, w, w, k, k, k, k));
+  const __m128i sum = _mm_srli_epi16(
+      _mm_add_epi16(_mm_add_epi16(product, _mm_srli_si128(product, 8)),
+                    _mm_set1_epi16(kWeightOne / 2)),
+      7);
+  const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+  std::memcpy(out, &packed, kRgbaBytesPerPixel);
+#elif defined(KATAGLYPHIS_MOSAIC_NEON)
+  const uint8x8_t weights = vreinterpret_u8_u32(
+      vset_lane_u32(weight * 0x01010101U, vdup_n_u32(keep * 0x01010101U), 1));
+  const uint16x8_t product = vmull_u8(vld1_u8(pair), weights);
+  const uint16x4_t sum =
+      vadd_u16(vget_low_u16(product), vget_high_u16(product));
+  const uint8x8_t narrowed = vrshrn_n_u16(vcombine_u16(sum, sum), 7);
+  vst1_lane_u32(reinterpret_cast<uint32_t*>(out),
+                vreinterpret_u32_u8(narrowed), 0);
+#else
+  for (size_t c = 0; c < kRgbaBytesPerPixel; ++c) {
+    out[c] = static_cast<uint8_t>(
+        (pair[c] * keep + pair[kRgbaBytesPerPixel + c] * weight +
+         kWeightOne / 2) /
+        kWeightOne);
+  }
+#endif
+}
+
+bool HasRows(const Frame& frame) {
+  const size_t row_bytes =
+      static_cast<size_t>(frame.width()) * kRgbaBytesPerPixel;
+  return frame.data() && frame.width() > 0 && frame.height() > 0 &&
+         frame.stride() >= row_bytes &&
+         frame.size() >= static_cast<size_t>(frame.stride()) *
+                                 (frame.height() - 1) +
+                             row_bytes;
+}
+
+uint32_t ToPixels(float position, uint32_t size) {
+  const float clamped = std::min(std::max(position, 0.0f), 1.0f);
+  return static_cast<uint32_t>(std::lround(clamped * size));
+}
+
+}  // namespace
+
+void ScaleRgbaBilinear(const uint8_t* src, size_t src_stride,
+                       uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                       size_t dst_stride, uint32_t dst_width,
+                       uint32_t dst_height, std::vector<uint8_t>* row) {
+  if (src_width == 0 || src_height == 0 || dst_width == 0 ||
+      dst_height == 0) {
+    return;
+  }
+  const size_t row_bytes = static_cast<size_t>(src_width) * kRgbaBytesPerPixel;
+  // One extra pixel repeats the last one, so every pair read stays inside.
+  row->resize(row_bytes + kRgbaBytesPerPixel);
+  std::vector<uint32_t> columns(dst_width);
+  std::vector<uint32_t> weights(dst_width);
+  for (uint32_t x = 0; x < dst_width; ++x) {
+    SourceTap(x, src_width, dst_width, &columns[x], &weights[x]);
+  }
+
+  for (uint32_t y = 0; y < dst_height; ++y) {
+    uint32_t first = 0;
+    uint32_t weight = 0;
+    SourceTap(y, src_height, dst_height, &first, &weight);
+    // A non-zero weight implies a row below `first`.
+    const uint8_t* top = src + static_cast<size_t>(first) * src_stride;
+    const uint8_t* bottom = weight > 0 ? top + src_stride : top;
+    BlendRows(top, bottom, weight, row_bytes, row->data());
+    std::memcpy(row->data() + row_bytes,
+                row->data() + row_bytes - kRgbaBytesPerPixel,
+                kRgbaBytesPerPixel);
+
+    uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+    for (uint32_t x = 0; x < dst_width; ++x) {
+      BlendPair(row->data() + static_cast<size_t>(columns[x]) *
+                                  kRgbaBytesPerPixel,
+                weights[x], out + static_cast<size_t>(x) * kRgbaBytesPerPixel);
+    }
+  }
+}
+
+void MosaicCompositor::SetLayout(MosaicLayout layout) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  layout_ = std::move(layout);
+  ++layout_version_;
+}
+
+bool MosaicCompositor::active() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return layout_.width > 0 && layout_.height > 0 && !layout_.tiles.empty();
+}
+
+bool MosaicCompositor::Submit(const std::string& source, FrameRef frame) {
+  if (!frame) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  const bool shown = std::any_of(
+      layout_.tiles.begin(), layout_.tiles.end(),
+      [&source](const MosaicTile& tile) { return tile.source == source; });
+  if (!shown) {
+    return false;
+  }
+  Source& entry = sources_[source];
+  entry.frame = std::move(frame);
+  entry.sequence = ++last_sequence_;
+  ++stats_.frames_submitted;
+  return true;
+}
+
+void MosaicCompositor::ClearSources() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sources_.clear();
+}
+
+size_t MosaicCompositor::Compose() {
+  std::vector<std::pair<size_t, FrameRef>> work;
+  bool relayout = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    relayout = layout_version_ != drawn_layout_version_;
+    if (relayout) {
+      drawn_layout_ = layout_;
+      drawn_layout_version_ = layout_version_;
+      drawn_sequences_.assign(drawn_layout_.tiles.size(), 0);
+    }
+    ++stats_.compositions;
+    for (size_t i = 0; i < drawn_layout_.tiles.size(); ++i) {
+      const auto it = sources_.find(drawn_layout_.tiles[i].source);
+      if (it == sources_.end() || it->second.sequence == drawn_sequences_[i]) {
+        ++stats_.tiles_skipped;
+        continue;
+      }
+      drawn_sequences_[i] = it->second.sequence;
+      work.emplace_back(i, it->second.frame);
+    }
+    stats_.tiles_drawn += work.size();
+  }
+
+  if (relayout) {
+    surface_width_ = drawn_layout_.width;
+    surface_height_ = drawn_layout_.height;
+    surface_.resize(static_cast<size_t>(surface_width_) * surface_height_ *
+                    kRgbaBytesPerPixel);
+    Fill(Rect{0, 0, surface_width_, surface_height_},
+         drawn_layout_.background);
+  }
+
+  // Frames are drawn outside the lock; sources keep submitting meanwhile.
+  for (const auto& entry : work) {
+    const MosaicTile& tile = drawn_layout_.tiles[entry.first];
+    Rect rect;
+    rect.x = ToPixels(tile.left, surface_width_);
+    rect.y = ToPixels(tile.top, surface_height_);
+    rect.width = ToPixels(tile.left + tile.width, surface_width_) - rect.x;
+    rect.height = ToPixels(tile.top + tile.height, surface_height_) - rect.y;
+    if (rect.width > 0 && rect.height > 0) {
+      DrawTile(tile, rect, *entry.second);
+    }
+  }
+  return work.size();
+}
+
+void MosaicCompositor::Fill(const Rect& rect, const uint8_t color[4]) {
+  const size_t stride =
+      static_cast<size_t>(surface_width_) * kRgbaBytesPerPixel;
+  for (uint32_t y = rect.y; y < rect.y + rect.height; ++y) {
+    uint8_t* out = surface_.data() + y * stride +
+                   static_cast<size_t>(rect.x) * kRgbaBytesPerPixel;
+    for (uint32_t x = 0; x < rect.width; ++x) {
+      std::memcpy(out + static_cast<size_t>(x) * kRgbaBytesPerPixel, color,
+                  kRgbaBytesPerPixel);
+    }
+  }
+}
+
+void MosaicCompositor::DrawTile(const MosaicTile& tile, const Rect& rect,
+                                const Frame& frame) {
+  const uint8_t* background = drawn_layout_.background;
+  if (!HasRows(frame)) {
+    Fill(rect, background);
+    return;
+  }
+
+  Rect target = rect;
+  if (tile.fit) {
+    const double scale =
+        std::min(static_cast<double>(rect.width) / frame.width(),
+                 static_cast<double>(rect.height) / frame.height());
+    target.width = std::min<uint32_t>(
+        rect.width,
+        std::max<uint32_t>(1, static_cast<uint32_t>(
+                                  std::lround(frame.width() * scale))));
+    target.height = std::min<uint32_t>(
+        rect.height,
+        std::max<uint32_t>(1, static_cast<uint32_t>(
+                                  std::lround(frame.height() * scale))));
+    target.x = rect.x + (rect.width - target.width) / 2;
+    target.y = rect.y + (rect.height - target.height) / 2;
+    // Letterbox bars only; the picture covers the rest.
+    Fill(Rect{rect.x, rect.y, rect.width, target.y - rect.y}, background);
+    Fill(Rect{rect.x, target.y + target.height, rect.width,
+              rect.y + rect.height - target.y - target.height},
+         background);
+    Fill(Rect{rect.x, target.y, target.x - rect.x, target.height},
+         background);
+    Fill(Rect{target.x + target.width, target.y,
+              rect.x + rect.width - target.x - target.width, target.height},
+         background);
+  }
+
+  // Start from the smallest pyramid level still covering the target...
+  const uint8_t* src = frame.data();
+  size_t src_stride = frame.stride();
+  uint32_t width = frame.width();
+  uint32_t height = frame.height();
+  if (const auto& pyramid = frame.pyramid()) {
+    for (uint32_t index = 1; index <= pyramid->level_count(); ++index) {
+      const FrameRef level = pyramid->level(index);
+      if (level->width() < target.width || level->height() < target.height) {
+        break;
+      }
+      src = level->data();
+      src_stride = level->stride();
+      width = level->width();
+      height = level->height();
+    }
+  }
+  // ...then halve until bilinear no longer skips source pixels.
+  for (int i = 0; width >= 2 * target.width && height >= 2 * target.height;
+       i ^= 1) {
+    std::vector<uint8_t>& halved = halved_[i];
+    const size_t stride = static_cast<size_t>(width / 2) * kRgbaBytesPerPixel;
+    halved.resize(stride * (height / 2));
+    Downsample2x(src, src_stride, width, height, halved.data(), stride);
+    src = halved.data();
+    src_stride = stride;
+    width /= 2;
+    height /= 2;
+  }
+
+  const size_t surface_stride =
+      static_cast<size_t>(surface_width_) * kRgbaBytesPerPixel;
+  ScaleRgbaBilinear(src, src_stride, width, height,
+                    surface_.data() + target.y * surface_stride +
+                        static_cast<size_t>(target.x) * kRgbaBytesPerPixel,
+                    surface_stride, target.width, target.height, &scale_row_);
+}
+
+MosaicStats MosaicCompositor::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,221 @@
+#include "kataglyphis_native_core/motion_gate.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KATAGLYPHIS_MOTION_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KATAGLYPHIS_MOTION_NEON 1
+#endif
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+#include "kataglyphis_native_core/pixel_convert.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+#if defined(KATAGLYPHIS_MOTION_SSE2)
+int PopCount(uint32_t bits) {
+  int count = 0;
+  for (; bits != 0; bits &= bits - 1) ++count;
+  return count;
+}
+#endif
+
+}  // namespace
+
+const char* MotionReasonName(MotionDecision::Reason reason) {
+  switch (reason) {
+    case MotionDecision::Reason::kFirstFrame:
+      return "first-frame";
+    case MotionDecision::Reason::kMotion:
+      return "motion";
+    case MotionDecision::Reason::kKeepAlive:
+      return "keep-alive";
+    case MotionDecision::Reason::kStatic:
+      return "static";
+  }
+  return "unknown";
+}
+
+void DownsampleLuma(const uint8_t* rgba, size_t size, size_t stride,
+                    uint32_t width, uint32_t height, uint32_t cell_size,
+                    std::vector<uint8_t>* luma, uint32_t* grid_width,
+                    uint32_t* grid_height) {
+  cell_size = std::max<uint32_t>(cell_size, 1);
+  *grid_width = (width + cell_size - 1) / cell_size;
+  *grid_height = (height + cell_size - 1) / cell_size;
+  luma->assign(static_cast<size_t>(*grid_width) * *grid_height, 0);
+  const size_t row_bytes = static_cast<size_t>(width) * kRgbaBytesPerPixel;
+
+  for (uint32_t gy = 0; gy < *grid_height; ++gy) {
+    const uint32_t y = std::min(gy * cell_size + cell_size / 2, height - 1);
+    const size_t offset = static_cast<size_t>(y) * stride;
+    if (!rgba || offset + row_bytes > size) continue;
+    const uint8_t* row = rgba + offset;
+    uint8_t* out = luma->data() + static_cast<size_t>(gy) * *grid_width;
+    for (uint32_t gx = 0; gx < *grid_width; ++gx) {
+      const uint32_t x0 = gx * cell_size;
+      const uint32_t x1 = std::min(x0 + cell_size, width);
+      uint32_t sum = 0;
+      for (uint32_t x = x0; x < x1; ++x) {
+        const uint8_t* p = row + static_cast<size_t>(x) * kRgbaBytesPerPixel;
+        // BT.601 weights in 8-bit fixed point.
+        sum += 77U * p[0] + 150U * p[1] + 29U * p[2];
+      }
+      out[gx] = static_cast<uint8_t>(sum / (256U * (x1 - x0)));
+    }
+  }
+}
+
+void MaskedAbsDiff(const uint8_t* a, const uint8_t* b, const uint8_t* mask,
+                   size_t count, uint8_t threshold, uint64_t* sum,
+                   uint64_t* changed) {
+  uint64_t total = 0;
+  uint64_t over = 0;
+  size_t i = 0;
+#if defined(KATAGLYPHIS_MOTION_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold));
+  __m128i acc = zero;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i vm =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+    const __m128i diff = _mm_and_si128(
+        _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va)), vm);
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(diff, zero));
+    // Lanes at or below the threshold saturate to zero.
+    const __m128i within = _mm_cmpeq_epi8(_mm_subs_epu8(diff, limit), zero);
+    over += 16 - PopCount(static_cast<uint32_t>(_mm_movemask_epi8(within)));
+  }
+  alignas(16) uint64_t lanes[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+  total = lanes[0] + lanes[1];
+#elif defined(KATAGLYPHIS_MOTION_NEON)
+  const uint8x16_t limit = vdupq_n_u8(threshold);
+  uint64x2_t acc = vdupq_n_u64(0);
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t diff =
+        vandq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i)),
+                 vld1q_u8(mask + i));
+    acc = vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(diff)));
+    over += vaddvq_u8(vshrq_n_u8(vcgtq_u8(diff, limit), 7));
+  }
+  total = vaddvq_u64(acc);
+#endif
+  for (; i < count; ++i) {
+    const int diff = mask[i] ? std::abs(static_cast<int>(a[i]) - b[i]) : 0;
+    total += static_cast<uint64_t>(diff);
+    if (diff > threshold) ++over;
+  }
+  *sum = total;
+  *changed = over;
+}
+
+MotionGate::MotionGate(MotionGateOptions options)
+    : options_(std::move(options)) {
+  options_.cell_size = std::max<uint32_t>(options_.cell_size, 1);
+}
+
+void MotionGate::Reset() {
+  reference_.clear();
+  grid_width_ = 0;
+  grid_height_ = 0;
+}
+
+void MotionGate::RebuildMask() {
+  mask_.assign(reference_.size(), 0);
+  watched_cells_ = 0;
+  for (uint32_t gy = 0; gy < grid_height_; ++gy) {
+    const float y = (static_cast<float>(gy) + 0.5f) / grid_height_;
+    for (uint32_t gx = 0; gx < grid_width_; ++gx) {
+      const float x = (static_cast<float>(gx) + 0.5f) / grid_width_;
+      bool watched = options_.regions.empty();
+      for (const MotionRegion& region : options_.regions) {
+        if (x >= region.left && x < region.left + region.width &&
+            y >= region.top && y < region.top + region.height) {
+          watched = true;
+          break;
+        }
+      }
+      if (watched) {
+        mask_[static_cast<size_t>(gy) * grid_width_ + gx] = 0xFF;
+        ++watched_cells_;
+      }
+    }
+  }
+}
+
+MotionDecision MotionGate::Evaluate(const Frame& frame, int64_t now_ns) {
+  // The coarsest pyramid level the cells still divide evenly replaces the
+  // full frame: fewer bytes, and a cell then averages all of its pixels.
+  const Frame* source = &frame;
+  uint32_t cell_size = options_.cell_size;
+  if (const auto& pyramid = frame.pyramid()) {
+    for (uint32_t index = pyramid->level_count(); index > 0; --index) {
+      const uint32_t factor = 1U << index;
+      if (cell_size % factor == 0) {
+        source = pyramid->level(index).get();
+        cell_size /= factor;
+        break;
+      }
+    }
+  }
+  uint32_t grid_width = 0;
+  uint32_t grid_height = 0;
+  DownsampleLuma(source->data(), source->size(), source->stride(),
+                 source->width(), source->height(), cell_size, &current_,
+                 &grid_width, &grid_height);
+
+  MotionDecision decision;
+  if (reference_.empty() || grid_width != grid_width_ ||
+      grid_height != grid_height_) {
+    grid_width_ = grid_width;
+    grid_height_ = grid_height;
+    reference_.swap(current_);
+    RebuildMask();
+    last_pass_ns_ = now_ns;
+    decision.pass = true;
+    decision.reason = MotionDecision::Reason::kFirstFrame;
+    return decision;
+  }
+
+  if (watched_cells_ > 0) {
+    uint64_t sum = 0;
+    uint64_t changed = 0;
+    MaskedAbsDiff(current_.data(), reference_.data(), mask_.data(),
+                  current_.size(), options_.cell_threshold, &sum, &changed);
+    decision.mean_diff =
+        static_cast<float>(sum) / static_cast<float>(watched_cells_);
+    decision.changed_fraction =
+        static_cast<float>(changed) / static_cast<float>(watched_cells_);
+  }
+
+  if (decision.mean_diff >= options_.mean_threshold ||
+      (options_.changed_fraction > 0.0f &&
+       decision.changed_fraction > options_.changed_fraction)) {
+    decision.pass = true;
+    decision.reason = MotionDecision::Reason::kMotion;
+  } else if (options_.keep_alive_ns > 0 &&
+             now_ns - last_pass_ns_ >= options_.keep_alive_ns) {
+    decision.pass = true;
+    decision.reason = MotionDecision::Reason::kKeepAlive;
+  }
+  if (decision.pass) {
+    reference_.swap(current_);
+    last_pass_ns_ = now_ns;
+  }
+  return decision;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,216 @@
+#include "kataglyphis_native_core/object_tracker.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+float Seconds(int64_t ns) {
+  return static_cast<float>(std::max<int64_t>(ns, 0)) / 1e9f;
+}
+
+// Measured center x, center y, width and height.
+void Measure(const Detection& detection, float z[4]) {
+  z[0] = detection.left + detection.width * 0.5f;
+  z[1] = detection.top + detection.height * 0.5f;
+  z[2] = detection.width;
+  z[3] = detection.height;
+}
+
+}  // namespace
+
+float BoxIou(const Detection& a, const Detection& b) {
+  const float left = std::max(a.left, b.left);
+  const float top = std::max(a.top, b.top);
+  const float right = std::min(a.left + a.width, b.left + b.width);
+  const float bottom = std::min(a.top + a.height, b.top + b.height);
+  if (right <= left || bottom <= top) {
+    return 0.0f;
+  }
+  const float intersection = (right - left) * (bottom - top);
+  const float united =
+      a.width * a.height + b.width * b.height - intersection;
+  return united > 0.0f ? intersection / united : 0.0f;
+}
+
+ObjectTracker::ObjectTracker(ObjectTrackerOptions options, bool enabled)
+    : options_(options), enabled_(enabled) {}
+
+// static
+Detection ObjectTracker::ToDetection(const Track& track, float dt) {
+  float state[4];
+  for (int i = 0; i < 4; ++i) {
+    state[i] = track.axes[i].position + track.axes[i].velocity * dt;
+  }
+  Detection detection;
+  detection.width = std::max(state[2], 0.0f);
+  detection.height = std::max(state[3], 0.0f);
+  detection.left = state[0] - detection.width * 0.5f;
+  detection.top = state[1] - detection.height * 0.5f;
+  detection.score = track.score;
+  detection.class_id = track.class_id;
+  detection.track_id = track.id;
+  return detection;
+}
+
+void ObjectTracker::Advance(Track* track, float dt) const {
+  if (dt <= 0.0f) {
+    return;
+  }
+  const float scale = std::max(track->axes[3].position, 1.0f);
+  const float q = options_.acceleration_noise * options_.acceleration_noise *
+                  scale * scale;
+  for (Axis& axis : track->axes) {
+    axis.position += axis.velocity * dt;
+    // P = F P F^T + Q for a white-noise acceleration model.
+    axis.p00 += dt * (2.0f * axis.p01 + dt * axis.p11) +
+                q * dt * dt * dt / 3.0f;
+    axis.p01 += dt * axis.p11 + q * dt * dt / 2.0f;
+    axis.p11 += q * dt;
+  }
+}
+
+void ObjectTracker::Correct(Track* track, const Detection& detection) const {
+  float z[4];
+  Measure(detection, z);
+  const float noise = std::max(options_.measurement_noise * z[3], 1.0f);
+  const float r = noise * noise;
+  for (int i = 0; i < 4; ++i) {
+    Axis& axis = track->axes[i];
+    const float s = axis.p00 + r;
+    const float k0 = axis.p00 / s;
+    const float k1 = axis.p01 / s;
+    const float innovation = z[i] - axis.position;
+    axis.position += k0 * innovation;
+    axis.velocity += k1 * innovation;
+    axis.p11 -= k1 * axis.p01;
+    axis.p01 *= 1.0f - k0;
+    axis.p00 *= 1.0f - k0;
+  }
+  track->score = detection.score;
+  track->class_id = detection.class_id;
+  track->misses = 0;
+}
+
+ObjectTracker::Track ObjectTracker::StartTrack(const Detection& detection,
+                                               int64_t time_ns) {
+  float z[4];
+  Measure(detection, z);
+  const float noise = std::max(options_.measurement_noise * z[3], 1.0f);
+  // Unknown velocity: up to a couple of box heights per second.
+  const float speed = 2.0f * std::max(z[3], 1.0f);
+  Track track;
+  track.id = next_id_++;
+  track.class_id = detection.class_id;
+  track.score = detection.score;
+  for (int i = 0; i < 4; ++i) {
+    track.axes[i].position = z[i];
+    track.axes[i].p00 = noise * noise;
+    track.axes[i].p11 = speed * speed;
+  }
+  track.time_ns = time_ns;
+  track.matched_ns = time_ns;
+  return track;
+}
+
+void ObjectTracker::Update(DetectionSet* detections, int64_t time_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_) {
+    return;
+  }
+  for (Track& track : tracks_) {
+    // A keyframe older than the state (late report) corrects in place.
+    Advance(&track, Seconds(time_ns - track.time_ns));
+    track.time_ns = std::max(track.time_ns, time_ns);
+  }
+
+  // Greedy assignment, best overlap first.
+  std::vector<std::tuple<float, size_t, size_t>> pairs;
+  for (size_t t = 0; t < tracks_.size(); ++t) {
+    const Detection predicted = ToDetection(tracks_[t], 0.0f);
+    for (size_t d = 0; d < detections->detections.size(); ++d) {
+      const Detection& detection = detections->detections[d];
+      if (detection.class_id >= 0 && tracks_[t].class_id >= 0 &&
+          detection.class_id != tracks_[t].class_id) {
+        continue;
+      }
+      const float iou = BoxIou(predicted, detection);
+      if (iou >= options_.iou_threshold) pairs.emplace_back(iou, t, d);
+    }
+  }
+  std::sort(pairs.begin(), pairs.end(),
+            [](const auto& a, const auto& b) {
+              return std::get<0>(a) > std::get<0>(b);
+            });
+  std::vector<bool> track_matched(tracks_.size(), false);
+  std::vector<bool> detection_matched(detections->detections.size(), false);
+  for (const auto& [iou, t, d] : pairs) {
+    (void)iou;
+    if (track_matched[t] || detection_matched[d]) continue;
+    track_matched[t] = true;
+    detection_matched[d] = true;
+    Detection& detection = detections->detections[d];
+    Correct(&tracks_[t], detection);
+    tracks_[t].matched_ns = std::max(tracks_[t].matched_ns, time_ns);
+    detection.track_id = tracks_[t].id;
+  }
+
+  std::vector<Track> kept;
+  kept.reserve(tracks_.size() + detections->detections.size());
+  for (size_t t = 0; t < tracks_.size(); ++t) {
+    if (!track_matched[t] && ++tracks_[t].misses > options_.max_misses) {
+      continue;
+    }
+    kept.push_back(std::move(tracks_[t]));
+  }
+  for (size_t d = 0; d < detections->detections.size(); ++d) {
+    if (detection_matched[d]) continue;
+    kept.push_back(StartTrack(detections->detections[d], time_ns));
+    detections->detections[d].track_id = kept.back().id;
+  }
+  tracks_ = std::move(kept);
+}
+
+void ObjectTracker::Predict(int64_t time_ns, DetectionSet* out) const {
+  out->detections.clear();
+  out->flags |= kDetectionFlagPredicted;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_) {
+    return;
+  }
+  for (const Track& track : tracks_) {
+    if (time_ns - track.matched_ns > options_.max_coast_ns) continue;
+    out->detections.push_back(
+        ToDetection(track, Seconds(time_ns - track.time_ns)));
+  }
+}
+
+void ObjectTracker::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tracks_.clear();
+}
+
+void ObjectTracker::Configure(bool enabled,
+                              const ObjectTrackerOptions& options) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_ = enabled;
+  options_ = options;
+  tracks_.clear();
+}
+
+bool ObjectTracker::enabled() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return enabled_;
+}
+
+size_t ObjectTracker::track_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tracks_.size();
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
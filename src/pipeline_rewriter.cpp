@@ -0,0 +1,148 @@
+#include "kataglyphis_native_core/pipeline_rewriter.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+enum class Stage { kOther, kDecoder, kConverter, kQueue };
+
+bool EndsWith(std::string_view text, std::string_view suffix) {
+  return text.size() >= suffix.size() &&
+         text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Sources are kOther: most of them (filesrc, rtspsrc, souphttpsrc, v4l2src
+// with image/jpeg) produce encoded or bytestream buffers, which a leaky
+// queue must never drop.
+Stage Classify(const PipelineElementRef& element) {
+  if (element.kind != PipelineElementRef::Kind::kElement) return Stage::kOther;
+  const std::string_view factory = element.factory;
+  if (factory == "queue" || factory == "queue2" || factory == "multiqueue") {
+    return Stage::kQueue;
+  }
+  if (factory == "videoconvert" || factory == "videoscale" ||
+      factory == "videoconvertscale" || factory == "autovideoconvert") {
+    return Stage::kConverter;
+  }
+  // uridecodebin/decodebin3/avdec_h264/jpegdec/v4l2h264dec/...
+  if (factory.find("decodebin") != std::string_view::npos ||
+      factory.find("dec_") != std::string_view::npos ||
+      EndsWith(factory, "dec")) {
+    return Stage::kDecoder;
+  }
+  return Stage::kOther;
+}
+
+bool TakesThreads(const PipelineElementRef& element) {
+  return element.kind == PipelineElementRef::Kind::kElement &&
+         (element.factory == "videoconvert" ||
+          element.factory == "videoscale" ||
+          element.factory == "videoconvertscale");
+}
+
+struct Insertion {
+  size_t offset;
+  std::string text;
+};
+
+}  // namespace
+
+PipelineRewrite RewritePipeline(std::string_view description,
+                                const ElementFactoryIndex& index,
+                                const PipelineRewriteOptions& options) {
+  PipelineRewrite rewrite;
+  const PipelineValidation validation = ValidatePipeline(description, index);
+  if (!validation.ok) {
+    rewrite.error = validation.error;
+    return rewrite;
+  }
+  rewrite.ok = true;
+  const std::vector<PipelineElementRef>& elements = validation.elements;
+  std::vector<Insertion> insertions;
+
+  if (options.insert_queues) {
+    const std::string queue =
+        "queue leaky=downstream max-size-buffers=" +
+        std::to_string(std::max<uint32_t>(1, options.queue_max_buffers)) +
+        " max-size-bytes=0 max-size-time=0 ! ";
+    // Producer of the current link, looking through caps filters so that
+    // `src ! caps ! sink` gets its queue after the caps, and the caps filter
+    // in between, if any.
+    int producer = -1;
+    bool previous_to_caps = false;
+    std::string_view caps;
+    for (const PipelineLink& link : validation.links) {
+      if (link.upstream >= 0 || !previous_to_caps) {
+        producer = link.upstream;
+        caps = std::string_view();
+      }
+      previous_to_caps = link.to_caps;
+      if (link.to_caps) {
+        caps = link.caps;
+        continue;
+      }
+
+      const Stage up = producer >= 0 ? Classify(elements[producer]) : Stage::kOther;
+      const Stage down = link.downstream >= 0 ? Classify(elements[link.downstream])
+                                              : Stage::kOther;
+      if (up == Stage::kQueue || down == Stage::kQueue) continue;
+      // Leaky queues only carry raw video: decoders produce it and
+      // converters accept nothing else, unless a caps filter says otherwise.
+      if (!caps.empty() && caps.substr(0, 11) != "video/x-raw") continue;
+
+      std::string reason;
+      if (up == Stage::kDecoder) {
+        reason = "after decoder '" + elements[producer].factory + "'";
+      } else if (down == Stage::kConverter) {
+        reason = "before converter '" + elements[link.downstream].factory + "'";
+      } else {
+        continue;
+      }
+      insertions.push_back({link.next_offset, queue});
+      rewrite.changes.push_back("Inserted queue " + reason + " at offset " +
+                                std::to_string(link.next_offset));
+    }
+  }
+
+  if (options.converter_threads > 0) {
+    const std::string value = std::to_string(options.converter_threads);
+    for (const PipelineElementRef& element : elements) {
+      if (!TakesThreads(element)) continue;
+      const std::string_view text =
+          description.substr(element.offset, element.end - element.offset);
+      if (text.find("n-threads=") != std::string_view::npos) continue;
+      if (options.has_property &&
+          !options.has_property(element.factory, "n-threads")) {
+        continue;
+      }
+      insertions.push_back({element.end, " n-threads=" + value});
+      rewrite.changes.push_back("Set n-threads=" + value + " on '" +
+                                element.factory + "' at offset " +
+                                std::to_string(element.offset));
+    }
+  }
+
+  // Splice back to front so earlier offsets stay valid.
+  std::stable_sort(insertions.begin(), insertions.end(),
+                   [](const Insertion& a, const Insertion& b) {
+                     return a.offset > b.offset;
+                   });
+  rewrite.description.assign(description.data(), description.size());
+  for (const Insertion& insertion : insertions) {
+    rewrite.description.insert(insertion.offset, insertion.text);
+  }
+  return rewrite;
+}
+
+uint32_t DefaultConverterThreads() {
+  const unsigned hardware = std::thread::hardware_concurrency();
+  return std::clamp<uint32_t>(hardware / 2, 1, 4);
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,431 @@
+#include "kataglyphis_native_core/pipeline_validator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+enum class TokenType { kLink, kOpen, kClose, kWord, kCaps };
+
+struct Token {
+  TokenType type;
+  std::string_view text;
+  size_t offset;
+  // kWord ending in '.' directly followed by '(' (`factory.( ... )`).
+  bool opens_bin = false;
+};
+
+bool IsSpace(char c) {
+  return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+bool IsNameChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' ||
+         c == '-' || c == '+';
+}
+
+bool IsMediaTypeChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '-' ||
+         c == '+' || c == '.';
+}
+
+// `type/subtype` followed by a caps delimiter, e.g. `video/x-raw,` or
+// `video/x-raw(memory:GLMemory)`.
+bool LooksLikeCaps(std::string_view text) {
+  size_t i = 0;
+  while (i < text.size() &&
+         (std::isalnum(static_cast<unsigned char>(text[i])) != 0 ||
+          text[i] == '-')) {
+    ++i;
+  }
+  if (i == 0 || i >= text.size() || text[i] != '/') return false;
+  const size_t subtype_start = ++i;
+  while (i < text.size() && IsMediaTypeChar(text[i])) ++i;
+  if (i == subtype_start) return false;
+  return i == text.size() || text[i] == ',' || text[i] == '(' ||
+         text[i] == ';' || IsSpace(text[i]);
+}
+
+std::string_view Trim(std::string_view text) {
+  while (!text.empty() && IsSpace(text.front())) text.remove_prefix(1);
+  while (!text.empty() && IsSpace(text.back())) text.remove_suffix(1);
+  return text;
+}
+
+// Length of `key` in a `key=value` property word, 0 if `word` is not one.
+// Keys may use the child-proxy form `child::property`.
+size_t PropertyKeyLength(std::string_view word) {
+  size_t i = 0;
+  while (i < word.size() && (IsNameChar(word[i]) || word[i] == ':')) ++i;
+  return (i > 0 && i < word.size() && word[i] == '=') ? i : 0;
+}
+
+std::string AtOffset(std::string message, size_t offset) {
+  return message + " at offset " + std::to_string(offset);
+}
+
+class Lexer {
+ public:
+  explicit Lexer(std::string_view text) : text_(text) {}
+
+  // Returns false and sets `error`/`error_offset` on malformed input.
+  bool Run(std::vector<Token>* tokens, std::string* error,
+           size_t* error_offset) {
+    size_t i = 0;
+    while (i < text_.size()) {
+      const char c = text_[i];
+      if (IsSpace(c)) {
+        ++i;
+        continue;
+      }
+      if (c == '!' || c == '(' || c == ')') {
+        const TokenType type = c == '!'   ? TokenType::kLink
+                               : c == '(' ? TokenType::kOpen
+                                          : TokenType::kClose;
+        tokens->push_back({type, text_.substr(i, 1), i});
+        ++i;
+        continue;
+      }
+
+      const bool after_link =
+          !tokens->empty() && tokens->back().type == TokenType::kLink;
+      if (c == '"' || c == '\'') {
+        // A quoted token right after '!' is a caps filter in quotes.
+        const size_t end = SkipQuoted(i);
+        if (end == std::string_view::npos) {
+          *error = AtOffset("Unterminated quote", i);
+          *error_offset = i;
+          return false;
+        }
+        const std::string_view inner = Trim(text_.substr(i + 1, end - i - 2));
+        tokens->push_back({after_link && LooksLikeCaps(inner)
+                               ? TokenType::kCaps
+                               : TokenType::kWord,
+                           inner, i});
+        i = end;
+        continue;
+      }
+
+      if (LooksLikeCaps(text_.substr(i))) {
+        // Like gst_parse, caps run up to the next link.
+        const size_t start = i;
+        while (i < text_.size() && text_[i] != '!') {
+          if (text_[i] == '"' || text_[i] == '\'') {
+            const size_t end = SkipQuoted(i);
+            if (end == std::string_view::npos) {
+              *error = AtOffset("Unterminated quote", i);
+              *error_offset = i;
+              return false;
+            }
+            i = end;
+          } else {
+            ++i;
+          }
+        }
+        tokens->push_back(
+            {TokenType::kCaps, Trim(text_.substr(start, i - start)), start});
+        continue;
+      }
+
+      const size_t start = i;
+      int depth = 0;
+      bool opens_bin = false;
+      while (i < text_.size()) {
+        const char ch = text_[i];
+        if (ch == '"' || ch == '\'') {
+          const size_t end = SkipQuoted(i);
+          if (end == std::string_view::npos) {
+            *error = AtOffset("Unterminated quote", i);
+            *error_offset = i;
+            return false;
+          }
+          i = end;
+          continue;
+        }
+        if (depth == 0 && (IsSpace(ch) || ch == '!')) break;
+        if (ch == '(') {
+          if (depth == 0 && i > start && text_[i - 1] == '.') {
+            opens_bin = true;
+            break;
+          }
+          ++depth;
+        } else if (ch == '[' || ch == '{') {
+          ++depth;
+        } else if (ch == ')' || ch == ']' || ch == '}') {
+          if (depth == 0) break;
+          --depth;
+        }
+        ++i;
+      }
+      Token token{TokenType::kWord, text_.substr(start, i - start), start};
+      token.opens_bin = opens_bin;
+      tokens->push_back(token);
+    }
+    return true;
+  }
+
+ private:
+  // Index one past the closing quote, npos if unterminated.
+  size_t SkipQuoted(size_t open) const {
+    const char quote = text_[open];
+    for (size_t i = open + 1; i < text_.size(); ++i) {
+      if (text_[i] == '\\') {
+        ++i;
+      } else if (text_[i] == quote) {
+        return i + 1;
+      }
+    }
+    return std::string_view::npos;
+  }
+
+  std::string_view text_;
+};
+
+size_t EditDistance(std::string_view a, std::string_view b) {
+  std::vector<size_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+  for (size_t i = 1; i <= a.size(); ++i) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      const size_t above = row[j];
+      row[j] = std::min({row[j] + 1, row[j - 1] + 1,
+                         diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+      diagonal = above;
+    }
+  }
+  return row[b.size()];
+}
+
+}  // namespace
+
+ElementFactoryIndex::ElementFactoryIndex(std::vector<std::string> names)
+    : names_(std::move(names)) {
+  std::sort(names_.begin(), names_.end());
+  names_.erase(std::unique(names_.begin(), names_.end()), names_.end());
+}
+
+bool ElementFactoryIndex::Contains(std::string_view name) const {
+  const auto it = std::lower_bound(
+      names_.begin(), names_.end(), name,
+      [](const std::string& lhs, std::string_view rhs) { return lhs < rhs; });
+  return it != names_.end() && *it == name;
+}
+
+std::string ElementFactoryIndex::Suggest(std::string_view name) const {
+  const size_t max_distance = std::max<size_t>(2, name.size() / 3);
+  size_t best_distance = max_distance + 1;
+  std::string best;
+  for (const std::string& candidate : names_) {
+    const size_t length_gap = candidate.size() > name.size()
+                                  ? candidate.size() - name.size()
+                                  : name.size() - candidate.size();
+    if (length_gap >= best_distance) continue;
+    const size_t distance = EditDistance(name, candidate);
+    if (distance < best_distance) {
+      best_distance = distance;
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+PipelineValidation ValidatePipeline(std::string_view description,
+                                    const ElementFactoryIndex& index) {
+  PipelineValidation result;
+  const auto fail = [&result](std::string message, size_t offset) {
+    result.ok = false;
+    result.error = AtOffset(std::move(message), offset);
+    result.error_offset = offset;
+    return result;
+  };
+
+  std::vector<Token> tokens;
+  if (!Lexer(description).Run(&tokens, &result.error, &result.error_offset)) {
+    return result;
+  }
+
+  std::vector<size_t> open_bins;  // offsets of unmatched '('
+  bool after_link = false;        // last token was '!'
+  bool has_upstream = false;      // something linkable precedes a '!'
+  bool takes_properties = false;  // an element/bin is open for `key=value`
+  bool after_caps = false;        // caps must be followed by '!'
+  bool named_bin_pending = false; // `factory.` already recorded the bin
+  // Element (index) a following '!' would link from; -1 if not a plain
+  // element.
+  int link_source = -1;
+  // Element (index) whose `key=value` properties extend its `end`.
+  int property_owner = -1;
+
+  for (const Token& token : tokens) {
+    if (after_caps && token.type != TokenType::kLink) {
+      return fail("Caps filter must be followed by '!'", token.offset);
+    }
+    after_caps = false;
+    if (after_link) {
+      // Complete the link this token is the downstream side of.
+      PipelineLink& link = result.links.back();
+      link.next_offset = token.offset;
+      link.to_caps = token.type == TokenType::kCaps;
+      if (link.to_caps) link.caps = std::string(token.text);
+    }
+
+    switch (token.type) {
+      case TokenType::kLink:
+        if (after_link || !has_upstream) {
+          return fail("'!' has nothing to link from", token.offset);
+        }
+        after_link = true;
+        has_upstream = false;
+        takes_properties = false;
+        result.links.push_back({token.offset, 0, link_source, -1, false, ""});
+        link_source = -1;
+        property_owner = -1;
+        break;
+
+      case TokenType::kOpen:
+        if (!named_bin_pending) {
+          result.elements.push_back(
+              {PipelineElementRef::Kind::kBin, "bin", token.offset});
+        }
+        named_bin_pending = false;
+        open_bins.push_back(token.offset);
+        link_source = -1;
+        property_owner = -1;
+        after_link = false;
+        has_upstream = false;
+        // `( name=foo ... )` sets properties on the bin.
+        takes_properties = true;
+        break;
+
+      case TokenType::kClose:
+        if (open_bins.empty()) {
+          return fail("Unmatched ')'", token.offset);
+        }
+        if (after_link) {
+          return fail("'!' has nothing to link to", token.offset);
+        }
+        open_bins.pop_back();
+        has_upstream = true;
+        takes_properties = false;
+        link_source = -1;
+        property_owner = -1;
+        break;
+
+      case TokenType::kCaps:
+        if (!after_link) {
+          return fail("Caps filter '" + std::string(token.text) +
+                          "' must follow '!'",
+                      token.offset);
+        }
+        after_link = false;
+        has_upstream = true;
+        takes_properties = false;
+        after_caps = true;
+        link_source = -1;
+        property_owner = -1;
+        break;
+
+      case TokenType::kWord: {
+        const std::string_view word = token.text;
+        if (word.empty()) {
+          return fail("Empty element name", token.offset);
+        }
+        const size_t key_length = PropertyKeyLength(word);
+        if (key_length > 0) {
+          const std::string key(word.substr(0, key_length));
+          if (after_link || !takes_properties) {
+            return fail("Property '" + key + "' has no element",
+                        token.offset);
+          }
+          if (property_owner >= 0) {
+            result.elements[property_owner].end =
+                token.offset + token.text.size();
+          }
+          break;
+        }
+
+        if (word.find("://") != std::string_view::npos) {
+          result.elements.push_back({PipelineElementRef::Kind::kUri,
+                                     std::string(word), token.offset});
+        } else if (token.opens_bin) {
+          const std::string_view factory = word.substr(0, word.size() - 1);
+          if (factory.empty() ||
+              !std::all_of(factory.begin(), factory.end(), IsNameChar)) {
+            return fail("Invalid bin name '" + std::string(word) + "'",
+                        token.offset);
+          }
+          result.elements.push_back({PipelineElementRef::Kind::kBin,
+                                     std::string(factory), token.offset});
+          named_bin_pending = true;
+        } else if (word.find('.') != std::string_view::npos) {
+          // `name.` or `name.pad`: links to an existing element.
+          if (word.front() == '.') {
+            return fail("Pad reference '" + std::string(word) +
+                            "' has no element name",
+                        token.offset);
+          }
+          after_link = false;
+          has_upstream = true;
+          takes_properties = false;
+          link_source = -1;
+          property_owner = -1;
+          break;
+        } else {
+          if (!std::all_of(word.begin(), word.end(), IsNameChar)) {
+            return fail("Invalid element name '" + std::string(word) + "'",
+                        token.offset);
+          }
+          result.elements.push_back({PipelineElementRef::Kind::kElement,
+                                     std::string(word), token.offset});
+        }
+
+        PipelineElementRef& added = result.elements.back();
+        added.end = token.offset + token.text.size();
+        if (added.kind != PipelineElementRef::Kind::kUri && !index.empty() &&
+            !index.Contains(added.factory)) {
+          const std::string suggestion = index.Suggest(added.factory);
+          fail("Missing GStreamer element '" + added.factory + "'",
+               token.offset);
+          result.missing_element = added.factory;
+          if (!suggestion.empty()) {
+            result.error += " (did you mean '" + suggestion + "'?)";
+          }
+          return result;
+        }
+        const int added_index = static_cast<int>(result.elements.size()) - 1;
+        if (after_link) result.links.back().downstream = added_index;
+        // A named bin's properties and links belong to its `( ... )`.
+        const bool plain = added.kind != PipelineElementRef::Kind::kBin;
+        link_source = plain ? added_index : -1;
+        property_owner = plain ? added_index : -1;
+        after_link = false;
+        has_upstream = true;
+        takes_properties = true;
+        break;
+      }
+    }
+  }
+
+  if (after_caps) {
+    return fail("Caps filter must be followed by '!'", description.size());
+  }
+  if (after_link) {
+    return fail("Pipeline ends with '!'", description.size());
+  }
+  if (!open_bins.empty()) {
+    return fail("Unclosed '('", open_bins.back());
+  }
+  if (result.elements.empty()) {
+    return fail("Pipeline string has no elements", 0);
+  }
+  result.ok = true;
+  return result;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
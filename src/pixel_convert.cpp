@@ -0,0 +1,55 @@
+#include "kataglyphis_native_core/pixel_convert.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+void CopyRgbaFrame(const uint8_t* src, size_t src_size, size_t src_stride,
+                   uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                   uint32_t dst_width, uint32_t dst_height,
+                   bool force_opaque) {
+  const size_t dst_stride = static_cast<size_t>(dst_width) * kRgbaBytesPerPixel;
+  const size_t row_bytes =
+      static_cast<size_t>(std::min(dst_width, src_width)) * kRgbaBytesPerPixel;
+  const uint32_t copy_rows = std::min(dst_height, src_height);
+
+  for (uint32_t row = 0; row < dst_height; ++row) {
+    uint8_t* dst_row = dst + static_cast<size_t>(row) * dst_stride;
+    const size_t src_offset = static_cast<size_t>(row) * src_stride;
+    size_t copied = 0;
+    if (src && row < copy_rows && row_bytes > 0U &&
+        src_offset + row_bytes <= src_size) {
+      std::memcpy(dst_row, src + src_offset, row_bytes);
+      copied = row_bytes;
+    }
+    if (copied < dst_stride) {
+      std::memset(dst_row + copied, 0, dst_stride - copied);
+    }
+  }
+
+  if (force_opaque) {
+    ForceAlphaOpaque(dst, static_cast<size_t>(dst_width) * dst_height);
+  }
+}
+
+void FillRgba(uint8_t* dst, size_t pixel_count, uint8_t r, uint8_t g,
+              uint8_t b) {
+  for (size_t i = 0; i < pixel_count; ++i) {
+    uint8_t* p = dst + i * kRgbaBytesPerPixel;
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+    p[3] = 255;
+  }
+}
+
+void ForceAlphaOpaque(uint8_t* rgba, size_t pixel_count) {
+  for (size_t i = 0; i < pixel_count; ++i) {
+    rgba[i * kRgbaBytesPerPixel + 3U] = 255U;
+  }
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,29 @@
+#include "kataglyphis_native_core/rate_estimator.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+void RateEstimator::Tick(Clock::time_point now) {
+  if (has_last_) {
+    const double interval_ms =
+        std::chrono::duration<double, std::milli>(now - last_).count();
+    interval_ms_ = interval_ms_ > 0.0
+                       ? interval_ms_ * (1.0 - smoothing_) +
+                             interval_ms * smoothing_
+                       : interval_ms;
+  }
+  last_ = now;
+  has_last_ = true;
+}
+
+void RateEstimator::Reset() {
+  has_last_ = false;
+  interval_ms_ = 0.0;
+}
+
+double RateEstimator::rate_hz() const {
+  return interval_ms_ > 0.0 ? 1000.0 / interval_ms_ : 0.0;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,37 @@
+#include "kataglyphis_native_core/result_slot.h"
+
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+void ResultSlot::Publish(uint64_t frame_generation, ResultBytes bytes) {
+  ResultBytes replaced;
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The old bytes are freed after the lock is released.
+  replaced = std::exchange(bytes_, std::move(bytes));
+  frame_generation_ = frame_generation;
+  ++version_;
+}
+
+void ResultSlot::Clear() {
+  ResultBytes replaced;
+  std::lock_guard<std::mutex> lock(mutex_);
+  replaced = std::move(bytes_);
+  frame_generation_ = 0;
+  ++version_;
+}
+
+ResultBytes ResultSlot::Latest(uint64_t* frame_generation) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (frame_generation) *frame_generation = frame_generation_;
+  return bytes_;
+}
+
+uint64_t ResultSlot::version() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return version_;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,176 @@
+#include "kataglyphis_native_core/scrub_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+ScrubCache::ScrubCache(size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+bool ScrubCache::Insert(FrameRef frame, int64_t duration_ns) {
+  if (!frame || frame->timestamp_ns() < 0 || duration_ns <= 0 ||
+      BytesOf(*frame) > budget_bytes_) {
+    return false;
+  }
+  const int64_t timestamp = frame->timestamp_ns();
+  const size_t bytes = BytesOf(*frame);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(timestamp);
+  if (it != entries_.end()) {
+    bytes_ -= BytesOf(*it->second.frame);
+    it->second = Entry{std::move(frame), duration_ns};
+  } else {
+    entries_.emplace(timestamp, Entry{std::move(frame), duration_ns});
+  }
+  bytes_ += bytes;
+  return EvictLocked(timestamp);
+}
+
+FrameRef ScrubCache::Lookup(int64_t position_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = Find(position_ns);
+  if (it == entries_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  return it->second.frame;
+}
+
+FrameRef ScrubCache::Step(int64_t position_ns, int offset) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = Find(position_ns);
+  if (it == entries_.end()) return nullptr;
+  for (; offset > 0; --offset) {
+    const auto next = std::next(it);
+    if (next == entries_.end() || !Adjacent(*it, *next)) return nullptr;
+    it = next;
+  }
+  for (; offset < 0; ++offset) {
+    if (it == entries_.begin()) return nullptr;
+    const auto previous = std::prev(it);
+    if (!Adjacent(*previous, *it)) return nullptr;
+    it = previous;
+  }
+  return it->second.frame;
+}
+
+void ScrubCache::SetPlayhead(int64_t position_ns, int direction) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  playhead_ns_ = position_ns;
+  direction_ = direction < 0 ? -1 : 1;
+}
+
+bool ScrubCache::FindGap(int64_t begin, int64_t end, int direction,
+                         int64_t* gap_begin, int64_t* gap_end) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Timestamps rounded to the nanosecond leave slivers between frames that
+  // are not worth decoding; half a frame is tolerated, as in Adjacent().
+  int64_t slack = 0;
+  if (direction >= 0) {
+    int64_t cursor = begin;
+    while (cursor < end) {
+      const auto it = Find(cursor);
+      if (it != entries_.end()) {
+        cursor = it->first + it->second.duration_ns;
+        slack = it->second.duration_ns / 2;
+        continue;
+      }
+      const auto next = entries_.upper_bound(cursor);
+      if (next != entries_.end() && next->first - cursor <= slack) {
+        cursor = next->first;
+        continue;
+      }
+      *gap_begin = cursor;
+      *gap_end = next == entries_.end() ? end : std::min(end, next->first);
+      return true;
+    }
+    return false;
+  }
+
+  int64_t cursor = end;
+  while (cursor > begin) {
+    const auto it = Find(cursor - 1);
+    if (it != entries_.end()) {
+      cursor = it->first;
+      slack = it->second.duration_ns / 2;
+      continue;
+    }
+    // Nothing covers cursor - 1; the gap reaches back to the previous frame.
+    const auto next = entries_.lower_bound(cursor);
+    int64_t start = begin;
+    if (next != entries_.begin()) {
+      const auto previous = std::prev(next);
+      const int64_t previous_end =
+          previous->first + previous->second.duration_ns;
+      if (cursor - previous_end <= slack) {
+        cursor = previous->first;
+        continue;
+      }
+      start = std::max(begin, previous_end);
+    }
+    *gap_begin = start;
+    *gap_end = cursor;
+    return true;
+  }
+  return false;
+}
+
+void ScrubCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  bytes_ = 0;
+}
+
+ScrubCacheStats ScrubCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ScrubCacheStats stats;
+  stats.frames = entries_.size();
+  stats.bytes = bytes_;
+  stats.budget_bytes = budget_bytes_;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  return stats;
+}
+
+ScrubCache::Map::const_iterator ScrubCache::Find(int64_t position_ns) const {
+  auto it = entries_.upper_bound(position_ns);
+  if (it == entries_.begin()) return entries_.end();
+  --it;
+  return position_ns < it->first + it->second.duration_ns ? it
+                                                          : entries_.end();
+}
+
+// static
+bool ScrubCache::Adjacent(const Map::value_type& entry,
+                          const Map::value_type& next) {
+  const int64_t gap = next.first - (entry.first + entry.second.duration_ns);
+  return gap <= entry.second.duration_ns / 2;
+}
+
+bool ScrubCache::EvictLocked(int64_t keep) {
+  bool kept = true;
+  while (bytes_ > budget_bytes_ && !entries_.empty()) {
+    // The farthest frame is always at one end of the map.
+    const auto weighted_distance = [this](int64_t timestamp) {
+      const int64_t ahead = (timestamp - playhead_ns_) * direction_;
+      return ahead >= 0 ? ahead : -2 * ahead;
+    };
+    auto victim = entries_.begin();
+    const auto last = std::prev(entries_.end());
+    if (weighted_distance(last->first) > weighted_distance(victim->first)) {
+      victim = last;
+    }
+    if (victim->first == keep) kept = false;
+    bytes_ -= BytesOf(*victim->second.frame);
+    entries_.erase(victim);
+    ++evictions_;
+  }
+  return kept;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
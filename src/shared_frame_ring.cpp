@@ -0,0 +1,366 @@
+#include "kataglyphis_native_core/shared_frame_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+
+#include "kataglyphis_native_core/pixel_convert.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Slots start on cache lines; pixel rows keep the 64-byte alignment that
+// SIMD consumers like.
+constexpr size_t kSlotAlignment = 64;
+// Acquire() gives up after this many torn reads in a row.
+constexpr int kReadAttempts = 8;
+// Wait slice of readers that cannot register as waiters.
+constexpr int kPollMs = 5;
+
+size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+const SharedFrameSlot* SlotAt(const uint8_t* base,
+                              const SharedFrameRingHeader& header,
+                              uint64_t sequence) {
+  const uint64_t index = (sequence - 1) % header.slot_count;
+  return reinterpret_cast<const SharedFrameSlot*>(
+      base + sizeof(SharedFrameRingHeader) + index * header.slot_stride);
+}
+
+#if defined(__linux__)
+
+void FutexWake(std::atomic<uint32_t>* word) {
+  // Shared futex: no FUTEX_PRIVATE_FLAG, the waiters live in other processes.
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX,
+          nullptr, nullptr, 0);
+}
+
+void FutexWait(const std::atomic<uint32_t>* word, uint32_t expected,
+               int timeout_ms) {
+  timespec timeout{};
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+  syscall(SYS_futex,
+          const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(word)),
+          FUTEX_WAIT, expected, timeout_ms < 0 ? nullptr : &timeout, nullptr,
+          0);
+}
+
+#endif
+
+}  // namespace
+
+// --- Writer ---
+
+std::unique_ptr<SharedFrameRingWriter> SharedFrameRingWriter::Create(
+    const std::string& name, uint32_t slot_count, size_t slot_bytes,
+    std::string* error) {
+#if defined(__linux__)
+  if (slot_count == 0 || slot_bytes == 0) {
+    *error = "A frame ring needs at least one non-empty slot";
+    return nullptr;
+  }
+  const size_t slot_stride =
+      AlignUp(sizeof(SharedFrameSlot) + slot_bytes, kSlotAlignment);
+  const size_t size =
+      sizeof(SharedFrameRingHeader) + slot_stride * slot_count;
+
+  // Via syscall: the libc wrapper only exists from Android API 30 on.
+  const int fd = static_cast<int>(syscall(SYS_memfd_create, name.c_str(),
+                                          MFD_CLOEXEC | MFD_ALLOW_SEALING));
+  if (fd < 0) {
+    *error = std::string("memfd_create failed: ") + std::strerror(errno);
+    return nullptr;
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    *error = std::string("Sizing the frame ring failed: ") +
+             std::strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  // Nobody can shrink the region under a reader's mapping (SIGBUS).
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    *error = std::string("Mapping the frame ring failed: ") +
+             std::strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+
+  auto* header = new (base) SharedFrameRingHeader{};
+  header->slot_count = slot_count;
+  header->slot_bytes = slot_bytes;
+  header->slot_stride = slot_stride;
+  header->version = kSharedFrameRingVersion;
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    new (static_cast<uint8_t*>(base) + sizeof(SharedFrameRingHeader) +
+         i * slot_stride) SharedFrameSlot{};
+  }
+  // Published last: readers check the magic before anything else.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kSharedFrameRingMagic;
+  return std::unique_ptr<SharedFrameRingWriter>(
+      new SharedFrameRingWriter(fd, static_cast<uint8_t*>(base), size));
+#else
+  (void)name;
+  (void)slot_count;
+  (void)slot_bytes;
+  *error = "Shared-memory frame export needs Linux or Android";
+  return nullptr;
+#endif
+}
+
+SharedFrameRingWriter::SharedFrameRingWriter(int fd, uint8_t* base,
+                                             size_t size)
+    : fd_(fd),
+      base_(base),
+      size_(size),
+      header_(reinterpret_cast<SharedFrameRingHeader*>(base)) {}
+
+SharedFrameRingWriter::~SharedFrameRingWriter() {
+#if defined(__linux__)
+  // Readers keep their own mappings; the memory lives until the last one
+  // is gone.
+  munmap(base_, size_);
+  close(fd_);
+#endif
+}
+
+bool SharedFrameRingWriter::Write(const Frame& frame) {
+  const size_t row_bytes = frame.width() * kRgbaBytesPerPixel;
+  const size_t bytes = row_bytes * frame.height();
+  if (bytes > header_->slot_bytes || !frame.data() ||
+      frame.stride() < row_bytes ||
+      frame.size() < static_cast<size_t>(frame.stride()) *
+                             (frame.height() > 0 ? frame.height() - 1 : 0) +
+                         row_bytes) {
+    oversized_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  const uint64_t sequence = ++sequence_;
+  auto* slot = const_cast<SharedFrameSlot*>(SlotAt(base_, *header_, sequence));
+  const uint64_t lock = slot->lock.load(std::memory_order_relaxed);
+  slot->lock.store(lock + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->sequence = sequence;
+  slot->timestamp_ns = frame.timestamp_ns();
+  slot->width = frame.width();
+  slot->height = frame.height();
+  slot->stride = static_cast<uint32_t>(row_bytes);
+  slot->fourcc = kFourccRgba;
+  slot->size = bytes;
+  uint8_t* pixels = reinterpret_cast<uint8_t*>(slot + 1);
+  if (frame.stride() == row_bytes) {
+    std::memcpy(pixels, frame.data(), bytes);
+  } else {
+    for (uint32_t row = 0; row < frame.height(); ++row) {
+      std::memcpy(pixels + row * row_bytes,
+                  frame.data() + static_cast<size_t>(row) * frame.stride(),
+                  row_bytes);
+    }
+  }
+
+  slot->lock.store(lock + 2, std::memory_order_release);
+  header_->latest.store(sequence, std::memory_order_release);
+  // Sequentially consistent with the reader's waiters increment: either
+  // it sees the new `notify` or the writer sees it waiting.
+  header_->notify.fetch_add(1, std::memory_order_seq_cst);
+#if defined(__linux__)
+  if (header_->waiters.load(std::memory_order_seq_cst) > 0) {
+    FutexWake(&header_->notify);
+    wakes_.fetch_add(1, std::memory_order_relaxed);
+  }
+#endif
+  written_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+SharedFrameRingStats SharedFrameRingWriter::stats() const {
+  SharedFrameRingStats stats;
+  stats.written = written_.load(std::memory_order_relaxed);
+  stats.oversized = oversized_.load(std::memory_order_relaxed);
+  stats.wakes = wakes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+// --- Reader ---
+
+std::unique_ptr<SharedFrameRingReader> SharedFrameRingReader::Open(
+    const std::string& path, std::string* error) {
+#if defined(__linux__)
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *error = "Cannot open '" + path + "': " + std::strerror(errno);
+    return nullptr;
+  }
+  struct stat info {};
+  void* base = MAP_FAILED;
+  const bool sized = fstat(fd, &info) == 0 &&
+                     static_cast<size_t>(info.st_size) >=
+                         sizeof(SharedFrameRingHeader);
+  if (sized) {
+    base = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                MAP_SHARED, fd, 0);
+  }
+  // The mapping keeps the region alive on its own.
+  close(fd);
+  if (base == MAP_FAILED) {
+    *error = "'" + path + "' is not a frame ring";
+    return nullptr;
+  }
+  const size_t size = static_cast<size_t>(info.st_size);
+  // The header page again, writable, for `waiters` only. Optional: a
+  // read-only ring falls back to polling.
+  const size_t control_size =
+      std::min(size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+  void* control = MAP_FAILED;
+  const int control_fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+  if (control_fd >= 0) {
+    control = mmap(nullptr, control_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   control_fd, 0);
+    close(control_fd);
+  }
+  const auto* header = static_cast<const SharedFrameRingHeader*>(base);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->magic != kSharedFrameRingMagic ||
+      header->version != kSharedFrameRingVersion || header->slot_count == 0 ||
+      sizeof(SharedFrameRingHeader) +
+              header->slot_stride * header->slot_count > size ||
+      header->slot_stride < sizeof(SharedFrameSlot) + header->slot_bytes) {
+    munmap(base, size);
+    if (control != MAP_FAILED) munmap(control, control_size);
+    *error = "'" + path + "' is not a version " +
+             std::to_string(kSharedFrameRingVersion) + " frame ring";
+    return nullptr;
+  }
+  return std::unique_ptr<SharedFrameRingReader>(new SharedFrameRingReader(
+      static_cast<const uint8_t*>(base), size,
+      control == MAP_FAILED ? nullptr
+                            : static_cast<SharedFrameRingHeader*>(control),
+      control_size));
+#else
+  (void)path;
+  *error = "Shared-memory frame export needs Linux or Android";
+  return nullptr;
+#endif
+}
+
+SharedFrameRingReader::SharedFrameRingReader(const uint8_t* base, size_t size,
+                                             SharedFrameRingHeader* control,
+                                             size_t control_size)
+    : base_(base),
+      size_(size),
+      header_(reinterpret_cast<const SharedFrameRingHeader*>(base)),
+      control_(control),
+      control_size_(control_size) {}
+
+SharedFrameRingReader::~SharedFrameRingReader() {
+#if defined(__linux__)
+  munmap(const_cast<uint8_t*>(base_), size_);
+  if (control_) munmap(control_, control_size_);
+#endif
+}
+
+bool SharedFrameRingReader::WaitForFrame(uint64_t after_sequence,
+                                         int timeout_ms) const {
+#if defined(__linux__)
+  if (latest() > after_sequence) return true;
+  // Registered before `notify` is read, see Write().
+  if (control_) control_->waiters.fetch_add(1, std::memory_order_seq_cst);
+  timespec start{};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  bool found = false;
+  for (;;) {
+    const uint32_t notify = header_->notify.load(std::memory_order_seq_cst);
+    if (latest() > after_sequence) {
+      found = true;
+      break;
+    }
+    int remaining_ms = -1;
+    if (timeout_ms >= 0) {
+      timespec now{};
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      const long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000L +
+                              (now.tv_nsec - start.tv_nsec) / 1000000L;
+      if (elapsed_ms >= timeout_ms) break;
+      remaining_ms = static_cast<int>(timeout_ms - elapsed_ms);
+    }
+    if (!control_ && (remaining_ms < 0 || remaining_ms > kPollMs)) {
+      remaining_ms = kPollMs;
+    }
+    FutexWait(&header_->notify, notify, remaining_ms);
+  }
+  if (control_) control_->waiters.fetch_sub(1, std::memory_order_seq_cst);
+  return found;
+#else
+  (void)timeout_ms;
+  return latest() > after_sequence;
+#endif
+}
+
+bool SharedFrameRingReader::Acquire(SharedFrameView* view) const {
+  for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+    const uint64_t sequence = latest();
+    if (sequence == 0) return false;
+    const SharedFrameSlot* slot = SlotAt(base_, *header_, sequence);
+    const uint64_t lock = slot->lock.load(std::memory_order_acquire);
+    if (lock & 1u) continue;
+
+    view->sequence = slot->sequence;
+    view->timestamp_ns = slot->timestamp_ns;
+    view->width = slot->width;
+    view->height = slot->height;
+    view->stride = slot->stride;
+    view->fourcc = slot->fourcc;
+    view->size = static_cast<size_t>(slot->size);
+    view->data = reinterpret_cast<const uint8_t*>(slot + 1);
+    view->slot = slot;
+    view->lock = lock;
+    if (view->sequence == sequence && view->size <= header_->slot_bytes &&
+        Validate(*view)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SharedFrameRingReader::Validate(const SharedFrameView& view) const {
+  if (!view.slot) return false;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return view.slot->lock.load(std::memory_order_relaxed) == view.lock;
+}
+
+bool SharedFrameRingReader::CopyLatest(SharedFrameView* view,
+                                       std::vector<uint8_t>* pixels) const {
+  for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+    if (!Acquire(view)) return false;
+    pixels->assign(view->data, view->data + view->size);
+    if (Validate(*view)) {
+      view->data = pixels->data();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,140 @@
+#include "kataglyphis_native_core/snapshot_service.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+#include "kataglyphis_native_core/thread_placement.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+// Below the streaming threads' default of 0.
+constexpr int kWorkerNice = 5;
+
+bool WriteBytes(const std::string& path, const std::vector<uint8_t>& bytes,
+                std::string* error) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    *error = "Cannot open '" + path + "': " + std::strerror(errno);
+    return false;
+  }
+  const bool written =
+      std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  if (std::fclose(file) != 0 || !written) {
+    *error = "Writing '" + path + "' failed";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+SnapshotService::SnapshotService(size_t workers, size_t max_pending)
+    : max_pending_(std::max<size_t>(max_pending, 1)) {
+  if (workers == 0) {
+    workers = std::min<size_t>(
+        4, std::max<size_t>(1, std::thread::hardware_concurrency() / 2));
+  }
+  workers_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this] { Run(); });
+  }
+}
+
+SnapshotService::~SnapshotService() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+bool SnapshotService::Submit(FrameRef frame, SnapshotRequest request,
+                             Callback done, std::string* error) {
+  if (!frame) {
+    *error = "No frame to snapshot yet";
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() + running_ >= max_pending_) {
+      *error = "Too many snapshots in progress";
+      return false;
+    }
+    queue_.push_back(Job{std::move(frame), std::move(request),
+                         std::move(done)});
+  }
+  wake_.notify_one();
+  return true;
+}
+
+size_t SnapshotService::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size() + running_;
+}
+
+void SnapshotService::Run() {
+  ThreadPlacement placement;
+  placement.name = "kg-snapshot";
+  placement.nice = kWorkerNice;
+  std::string ignored;
+  ApplyThreadPlacement(placement, &ignored);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) return;
+    Job job = std::move(queue_.front());
+    queue_.pop_front();
+    ++running_;
+    lock.unlock();
+
+    SnapshotResult result = Encode(job);
+    // Hand the frame back to its producer before reporting.
+    job.frame.reset();
+    if (job.done) job.done(std::move(result));
+
+    lock.lock();
+    --running_;
+  }
+}
+
+// static
+SnapshotResult SnapshotService::Encode(const Job& job) {
+  // A level the producer already built; no scaling on this thread.
+  FrameRef source = job.frame;
+  if (job.request.max_side > 0 && job.frame->pyramid() &&
+      std::max(job.frame->width(), job.frame->height()) >
+          job.request.max_side) {
+    source = job.frame->pyramid()->FitWithin(job.request.max_side);
+  }
+  SnapshotResult result;
+  result.format = job.request.format;
+  result.width = source->width();
+  result.height = source->height();
+  result.timestamp_ns = job.frame->timestamp_ns();
+  if (!EncodeImage(*source, job.request.format, job.request.jpeg_quality,
+                   &result.bytes)) {
+    result.error = "The frame cannot be encoded";
+    result.bytes.clear();
+    return result;
+  }
+  if (!job.request.path.empty()) {
+    result.path = job.request.path;
+    const bool written = WriteBytes(result.path, result.bytes, &result.error);
+    result.bytes.clear();
+    if (!written) return result;
+  }
+  result.ok = true;
+  return result;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
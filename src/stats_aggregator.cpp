@@ -0,0 +1,175 @@
+#include "kataglyphis_native_core/stats_aggregator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+constexpr double kNsPerMs = 1e6;
+
+void PutU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void PutU64(uint8_t* out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void PutF32(uint8_t* out, float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  PutU32(out, bits);
+}
+
+void PutSummary(uint8_t* out, const DurationSummary& summary) {
+  PutU32(out, summary.count);
+  PutF32(out + 4, summary.p50_ms);
+  PutF32(out + 8, summary.p95_ms);
+  PutF32(out + 12, summary.p99_ms);
+  PutF32(out + 16, summary.max_ms);
+}
+
+// Nearest-rank percentile of an ascending, non-empty range.
+float PercentileMs(const std::vector<int64_t>& sorted, double percentile) {
+  const size_t rank = static_cast<size_t>(
+      std::ceil(percentile * static_cast<double>(sorted.size())));
+  const size_t index = std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1;
+  return static_cast<float>(static_cast<double>(sorted[index]) / kNsPerMs);
+}
+
+}  // namespace
+
+StatsAggregator::StatsAggregator(size_t max_samples)
+    : max_samples_(std::max<size_t>(max_samples, 1)) {
+  for (Samples* samples : {&latency_, &copy_, &inference_}) {
+    samples->values.reserve(max_samples_);
+  }
+  sorted_.reserve(max_samples_);
+}
+
+// static
+int64_t StatsAggregator::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void StatsAggregator::Start(int64_t now_ns, uint64_t dropped_total) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  start_ns_ = now_ns;
+  dropped_at_start_ = dropped_total;
+  frames_ = 0;
+  arrivals_.fill({0, 0});
+  for (Samples* samples : {&latency_, &copy_, &inference_}) {
+    samples->values.clear();
+    samples->recorded = 0;
+  }
+}
+
+void StatsAggregator::RecordArrival(uint64_t generation, int64_t now_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++frames_;
+  arrivals_[generation % kArrivals] = {generation, now_ns};
+}
+
+void StatsAggregator::RecordPresented(uint64_t generation, int64_t now_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (generation == last_presented_) return;
+  last_presented_ = generation;
+  const auto& arrival = arrivals_[generation % kArrivals];
+  // Frames that arrived before Start() or were overwritten in the ring
+  // have no arrival time left.
+  if (arrival.first == generation && now_ns >= arrival.second) {
+    Add(&latency_, now_ns - arrival.second);
+  }
+}
+
+void StatsAggregator::RecordCopy(int64_t duration_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Add(&copy_, duration_ns);
+}
+
+void StatsAggregator::RecordInference(int64_t duration_ns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Add(&inference_, duration_ns);
+}
+
+void StatsAggregator::Add(Samples* samples, int64_t value) {
+  if (samples->values.size() < max_samples_) {
+    samples->values.push_back(value);
+  } else {
+    // Full: overwrite the oldest, keeping the newest `max_samples_`.
+    samples->values[samples->recorded % max_samples_] = value;
+  }
+  ++samples->recorded;
+}
+
+DurationSummary StatsAggregator::Summarize(Samples* samples) {
+  DurationSummary summary;
+  summary.count = static_cast<uint32_t>(samples->recorded);
+  if (!samples->values.empty()) {
+    sorted_.assign(samples->values.begin(), samples->values.end());
+    std::sort(sorted_.begin(), sorted_.end());
+    summary.p50_ms = PercentileMs(sorted_, 0.50);
+    summary.p95_ms = PercentileMs(sorted_, 0.95);
+    summary.p99_ms = PercentileMs(sorted_, 0.99);
+    summary.max_ms =
+        static_cast<float>(static_cast<double>(sorted_.back()) / kNsPerMs);
+  }
+  samples->values.clear();
+  samples->recorded = 0;
+  return summary;
+}
+
+StatsWindow StatsAggregator::Collect(int64_t now_ns, uint64_t dropped_total) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  StatsWindow window;
+  window.end_ns = now_ns;
+  window.duration_ns = std::max<int64_t>(now_ns - start_ns_, 0);
+  window.frames = frames_;
+  window.dropped = static_cast<uint32_t>(
+      dropped_total >= dropped_at_start_ ? dropped_total - dropped_at_start_
+                                         : 0);
+  if (window.duration_ns > 0) {
+    window.fps = static_cast<float>(frames_ * 1e9 /
+                                    static_cast<double>(window.duration_ns));
+  }
+  window.latency = Summarize(&latency_);
+  window.copy = Summarize(&copy_);
+  window.inference = Summarize(&inference_);
+
+  // Arrivals stay, so frames presented early next window still match.
+  start_ns_ = now_ns;
+  dropped_at_start_ = dropped_total;
+  frames_ = 0;
+  return window;
+}
+
+void EncodeStatsWindow(const StatsWindow& window, std::vector<uint8_t>* out) {
+  out->assign(kStatsWindowBytes, 0);
+  uint8_t* bytes = out->data();
+  PutU32(bytes, kStatsWindowMagic);
+  PutU16(bytes + 4, kStatsWindowVersion);
+  PutU16(bytes + 6, static_cast<uint16_t>(kStatsWindowBytes));
+  PutU64(bytes + 8, static_cast<uint64_t>(window.end_ns));
+  PutU64(bytes + 16, static_cast<uint64_t>(window.duration_ns));
+  PutU32(bytes + 24, window.frames);
+  PutU32(bytes + 28, window.dropped);
+  PutF32(bytes + 32, window.fps);
+  PutSummary(bytes + 40, window.latency);
+  PutSummary(bytes + 60, window.copy);
+  PutSummary(bytes + 80, window.inference);
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
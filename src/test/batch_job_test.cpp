@@ -0,0 +1,82 @@
+#include "kataglyphis_native_core/batch_job.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kSecond = 1000000000;
+
+}  // namespace
+
+TEST(BatchJob, SplitsLongFilesIntoContiguousSegments) {
+  const std::vector<BatchSegment> segments = PlanBatchSegments(
+      {100 * kSecond, 15 * kSecond, -1}, /*max_segments_per_file=*/4,
+      /*min_segment_ns=*/10 * kSecond);
+  ASSERT_EQ(segments.size(), 4u + 1u + 1u);
+
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(segments[i].file_index, 0u);
+    EXPECT_EQ(segments[i].index, i);
+    EXPECT_EQ(segments[i].start_ns, static_cast<int64_t>(i) * 25 * kSecond);
+    if (i + 1 < 4) EXPECT_EQ(segments[i].end_ns, segments[i + 1].start_ns);
+  }
+  // The last segment runs to the end, whatever the real duration is.
+  EXPECT_EQ(segments[3].end_ns, -1);
+
+  // Shorter than two minimum segments, or of unknown length: one piece.
+  EXPECT_EQ(segments[4].file_index, 1u);
+  EXPECT_EQ(segments[4].start_ns, 0);
+  EXPECT_EQ(segments[4].end_ns, -1);
+  EXPECT_EQ(segments[5].file_index, 2u);
+  EXPECT_EQ(segments[5].end_ns, -1);
+}
+
+TEST(BatchJob, FormatsResultsAsJsonLines) {
+  BatchResult result;
+  result.file_index = 0;
+  result.segment_index = 2;
+  result.frame_index = 7;
+  result.timestamp_ns = 40000000;
+  result.width = 640;
+  result.height = 360;
+  EXPECT_EQ(FormatBatchResultJson(result, "C:\\clips\\\"a\".mp4"),
+            "{\"file\":\"C:\\\\clips\\\\\\\"a\\\".mp4\",\"segment\":2,"
+            "\"frame\":7,\"pts_ns\":40000000,\"width\":640,\"height\":360}");
+
+  result.payload = "{\"boxes\":[]}";
+  const std::string path = ::testing::TempDir() + "batch_job_test.jsonl";
+  BatchResultWriter writer;
+  std::string error;
+  ASSERT_TRUE(writer.Open(path, {"a.mp4"}, &error)) << error;
+  writer.Write(result);
+  writer.Write(result);
+  EXPECT_EQ(writer.written(), 2u);
+  ASSERT_TRUE(writer.Close(&error)) << error;
+
+  std::ifstream in(path);
+  std::string line;
+  int lines = 0;
+  while (std::getline(in, line)) {
+    EXPECT_EQ(line, FormatBatchResultJson(result, "a.mp4"));
+    ++lines;
+  }
+  EXPECT_EQ(lines, 2);
+  std::remove(path.c_str());
+
+  EXPECT_FALSE(writer.Open(::testing::TempDir() + "no/such/dir/x.jsonl", {},
+                           &error));
+  EXPECT_NE(error.find("Cannot open"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
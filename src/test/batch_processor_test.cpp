@@ -0,0 +1,92 @@
+#include "kataglyphis_native_core/batch_processor.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "test_clip.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int kFrames = 60;
+
+}  // namespace
+
+class BatchProcessorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GstRuntime& runtime = GstRuntime::Get();
+    runtime.WaitUntilReady();
+    for (const char* element : {"jpegenc", "jpegdec", "avimux", "avidemux"}) {
+      if (!runtime.HasElement(element)) GTEST_SKIP() << "needs " << element;
+    }
+    path_ = ::testing::TempDir() + "batch_processor_test.avi";
+    std::string error;
+    ASSERT_TRUE(WriteTestClip(path_, kFrames, &error)) << error;
+  }
+
+  void TearDown() override {
+    if (!path_.empty()) std::remove(path_.c_str());
+  }
+
+  std::string path_;
+};
+
+TEST_F(BatchProcessorTest, DecodesEveryFrameOnceAcrossParallelSegments) {
+  BatchOptions options;
+  options.workers = 2;
+  options.min_segment_ns = 500000000;  // 2 s clip: two segments
+  options.width = 32;
+  options.height = 24;
+  BatchProcessor processor(options);
+
+  std::vector<BatchResult> results;
+  std::string error;
+  ASSERT_TRUE(processor.Run(
+      {path_},
+      [](const BatchFrame& frame) {
+        return "{\"bytes\":" + std::to_string(frame.frame->size()) + "}";
+      },
+      [&results](const BatchResult& result) { results.push_back(result); },
+      &error))
+      << error;
+
+  ASSERT_EQ(results.size(), static_cast<size_t>(kFrames));
+  std::set<int64_t> timestamps;
+  std::set<size_t> segments;
+  for (const BatchResult& result : results) {
+    EXPECT_EQ(result.width, 32u);
+    EXPECT_EQ(result.height, 24u);
+    EXPECT_EQ(result.payload, "{\"bytes\":" + std::to_string(32 * 24 * 4) + "}");
+    timestamps.insert(result.timestamp_ns);
+    segments.insert(result.segment_index);
+  }
+  // No frame lost or duplicated at the segment boundary.
+  EXPECT_EQ(timestamps.size(), static_cast<size_t>(kFrames));
+  EXPECT_EQ(segments.size(), 2u);
+
+  const BatchProgress progress = processor.progress();
+  EXPECT_EQ(progress.segments_total, 2u);
+  EXPECT_EQ(progress.segments_done, 2u);
+  EXPECT_EQ(progress.frames, static_cast<uint64_t>(kFrames));
+}
+
+TEST_F(BatchProcessorTest, ReportsUnreadableInputs) {
+  BatchProcessor processor;
+  std::string error;
+  EXPECT_FALSE(processor.Run({path_ + ".missing"}, nullptr, nullptr, &error));
+  EXPECT_NE(error.find("Cannot open"), std::string::npos) << error;
+  EXPECT_FALSE(processor.diagnostics().Recent(4).empty());
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,130 @@
+#include "kataglyphis_native_core/detection_packet.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+DetectionSet TwoDetections() {
+  DetectionSet set;
+  set.frame_generation = 42;
+  set.timestamp_ns = 1234567890123;
+  set.frame_width = 1280;
+  set.frame_height = 720;
+  set.flags = kDetectionFlagPredicted;
+  Detection person;
+  person.left = 10.5f;
+  person.top = 20.0f;
+  person.width = 100.0f;
+  person.height = 200.25f;
+  person.score = 0.875f;
+  person.class_id = 0;
+  person.track_id = 17;
+  Detection unknown;
+  unknown.left = 640.0f;
+  unknown.score = 0.5f;
+  set.detections = {person, unknown};
+  return set;
+}
+
+float FloatAt(const std::vector<uint8_t>& bytes, size_t offset) {
+  const uint32_t bits = uint32_t{bytes[offset]} |
+                        (uint32_t{bytes[offset + 1]} << 8) |
+                        (uint32_t{bytes[offset + 2]} << 16) |
+                        (uint32_t{bytes[offset + 3]} << 24);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+TEST(DetectionPacket, RoundTrips) {
+  const DetectionSet set = TwoDetections();
+  std::vector<uint8_t> bytes;
+  EncodeDetections(set, &bytes);
+  ASSERT_EQ(bytes.size(), DetectionPacketSize(2));
+
+  DetectionSet decoded;
+  ASSERT_TRUE(DecodeDetections(bytes.data(), bytes.size(), &decoded));
+  EXPECT_EQ(decoded.frame_generation, 42u);
+  EXPECT_EQ(decoded.timestamp_ns, 1234567890123);
+  EXPECT_EQ(decoded.frame_width, 1280u);
+  EXPECT_EQ(decoded.frame_height, 720u);
+  ASSERT_EQ(decoded.detections.size(), 2u);
+  EXPECT_EQ(decoded.detections[0].height, 200.25f);
+  EXPECT_EQ(decoded.detections[0].score, 0.875f);
+  EXPECT_EQ(decoded.detections[0].class_id, 0);
+  EXPECT_EQ(decoded.detections[1].left, 640.0f);
+  EXPECT_EQ(decoded.detections[1].class_id, -1);
+  EXPECT_EQ(decoded.detections[0].track_id, 17);
+  EXPECT_EQ(decoded.flags, kDetectionFlagPredicted);
+}
+
+TEST(DetectionPacket, LaysOutColumnsLittleEndian) {
+  std::vector<uint8_t> bytes;
+  EncodeDetections(TwoDetections(), &bytes);
+  EXPECT_EQ(std::memcmp(bytes.data(), "KGDT", 4), 0);
+  EXPECT_EQ(bytes[8], 2u);  // count
+  // Column-major: both lefts, then both tops, ..., then the scores.
+  EXPECT_EQ(FloatAt(bytes, kDetectionPacketHeaderBytes), 10.5f);
+  EXPECT_EQ(FloatAt(bytes, kDetectionPacketHeaderBytes + 4), 640.0f);
+  EXPECT_EQ(FloatAt(bytes, kDetectionPacketHeaderBytes + 4 * 2 * 4), 0.875f);
+  // track_id -1 of the second detection is the last word.
+  EXPECT_EQ(bytes.back(), 0xFFu);
+}
+
+TEST(DetectionPacket, EncodesEmptySets) {
+  DetectionSet set;
+  set.frame_generation = 7;
+  std::vector<uint8_t> bytes;
+  EncodeDetections(set, &bytes);
+  EXPECT_EQ(bytes.size(), kDetectionPacketHeaderBytes);
+
+  DetectionSet decoded;
+  decoded.detections.resize(3);
+  ASSERT_TRUE(DecodeDetections(bytes.data(), bytes.size(), &decoded));
+  EXPECT_EQ(decoded.frame_generation, 7u);
+  EXPECT_TRUE(decoded.detections.empty());
+}
+
+TEST(DetectionPacket, RejectsTruncatedAndForeignData) {
+  std::vector<uint8_t> bytes;
+  EncodeDetections(TwoDetections(), &bytes);
+  DetectionSet decoded;
+  EXPECT_FALSE(DecodeDetections(bytes.data(), bytes.size() - 1, &decoded));
+  EXPECT_FALSE(DecodeDetections(bytes.data(), 10, &decoded));
+
+  bytes[4] = 99;  // unknown version
+  EXPECT_FALSE(DecodeDetections(bytes.data(), bytes.size(), &decoded));
+  bytes[4] = 1;
+  bytes[0] = 'X';
+  EXPECT_FALSE(DecodeDetections(bytes.data(), bytes.size(), &decoded));
+}
+
+TEST(DetectionPacket, DecodesVersionOnePackets) {
+  std::vector<uint8_t> bytes;
+  EncodeDetections(TwoDetections(), &bytes);
+  // A version 1 packet is the same without flags and the track_id column.
+  bytes[4] = 1;
+  std::fill(bytes.begin() + 12, bytes.begin() + 16, 0);
+  bytes.resize(DetectionPacketSize(2) - 2 * 4);
+
+  DetectionSet decoded;
+  ASSERT_TRUE(DecodeDetections(bytes.data(), bytes.size(), &decoded));
+  ASSERT_EQ(decoded.detections.size(), 2u);
+  EXPECT_EQ(decoded.detections[0].class_id, 0);
+  EXPECT_EQ(decoded.detections[0].track_id, -1);
+  EXPECT_EQ(decoded.flags, 0u);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,105 @@
+#include "kataglyphis_native_core/diagnostic_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(DiagnosticRing, ReturnsNewestRecordsOldestFirst) {
+  DiagnosticRing ring(4);
+  for (int i = 0; i < 6; ++i) {
+    ring.Record(DiagnosticSeverity::kWarning, "src", i,
+                "message " + std::to_string(i));
+  }
+  EXPECT_EQ(ring.capacity(), 4u);
+  EXPECT_EQ(ring.next_sequence(), 6u);
+
+  const std::vector<DiagnosticRecord> all = ring.Recent(10);
+  ASSERT_EQ(all.size(), 4u);
+  EXPECT_EQ(all.front().sequence, 2u);
+  EXPECT_STREQ(all.back().message, "message 5");
+
+  const std::vector<DiagnosticRecord> last_two = ring.Recent(2);
+  ASSERT_EQ(last_two.size(), 2u);
+  EXPECT_EQ(last_two[0].code, 4);
+  EXPECT_EQ(last_two[1].code, 5);
+}
+
+TEST(DiagnosticRing, SinceSkipsEarlierRecords) {
+  DiagnosticRing ring(8);
+  ring.Record(DiagnosticSeverity::kError, "old", 0, "before");
+  const uint64_t mark = ring.next_sequence();
+  EXPECT_TRUE(ring.Recent(8, mark).empty());
+
+  ring.Record(DiagnosticSeverity::kError, "new", 0, "after");
+  const std::vector<DiagnosticRecord> records = ring.Recent(8, mark);
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_STREQ(records[0].source, "new");
+}
+
+TEST(DiagnosticRing, TruncatesLongTextAndFormats) {
+  DiagnosticRing ring(2);
+  const std::string long_source(100, 's');
+  const std::string long_message(1000, 'm');
+  ring.Record(DiagnosticSeverity::kError, long_source, 7, long_message,
+              "detail");
+  ring.Record(DiagnosticSeverity::kWarning, "", 0, "short", "why");
+
+  const std::vector<DiagnosticRecord> records = ring.Recent(2);
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(std::string(records[0].source).size(),
+            DiagnosticRecord::kSourceSize - 1);
+  EXPECT_EQ(std::string(records[0].message).size(),
+            DiagnosticRecord::kMessageSize - 1);
+  EXPECT_GT(records[0].timestamp_us, 0);
+  EXPECT_EQ(FormatDiagnostic(records[1]), "warning short; why");
+  EXPECT_NE(FormatDiagnostics(records).find("(code 7)\nwarning"),
+            std::string::npos);
+}
+
+TEST(DiagnosticRing, ConcurrentWritersNeverProduceTornRecords) {
+  DiagnosticRing ring(16);
+  constexpr int kWriters = 4;
+  constexpr int kPerWriter = 20000;
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&ring, w] {
+      const std::string source = "writer" + std::to_string(w);
+      const std::string message(40, static_cast<char>('a' + w));
+      for (int i = 0; i < kPerWriter; ++i) {
+        ring.Record(DiagnosticSeverity::kError, source, w, message);
+      }
+    });
+  }
+
+  // Every record a reader sees must be internally consistent. No ASSERTs
+  // here: returning early would leave the writers unjoined.
+  constexpr uint64_t kTotal = static_cast<uint64_t>(kWriters) * kPerWriter;
+  while (ring.next_sequence() < kTotal) {
+    for (const DiagnosticRecord& record : ring.Recent(16)) {
+      const int w = record.code;
+      if (w < 0 || w >= kWriters) {
+        ADD_FAILURE() << "torn code " << w;
+        continue;
+      }
+      EXPECT_EQ(std::string(record.source), "writer" + std::to_string(w));
+      EXPECT_EQ(std::string(record.message),
+                std::string(40, static_cast<char>('a' + w)));
+    }
+  }
+  for (std::thread& writer : writers) writer.join();
+
+  EXPECT_EQ(ring.next_sequence(), kTotal);
+  const size_t kept = ring.Recent(100).size();
+  EXPECT_GE(kept, 1u);
+  EXPECT_LE(kept, ring.capacity());
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,182 @@
+#include "kataglyphis_native_core/ffi_api.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kTextureId = 4711;
+
+class FfiApiTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    RegisterFfiTexture(kTextureId,
+                       FfiTexture{&exchange_, &results_, &stats_, &inference_,
+                                  &tracker_});
+  }
+  void TearDown() override { UnregisterFfiTexture(kTextureId); }
+
+  FrameExchange exchange_;
+  ResultSlot results_;
+  StatsAggregator stats_;
+  InferenceFeed inference_;
+  ObjectTracker tracker_;
+};
+
+}  // namespace
+
+TEST_F(FfiApiTest, ReportsStatsAndRejectsUnknownTextures) {
+  EXPECT_EQ(knt_ffi_api_version(), 6);
+  KntFrameStats stats;
+  EXPECT_EQ(knt_get_frame_stats(kTextureId + 1, &stats), -2);
+  EXPECT_EQ(knt_get_frame_stats(kTextureId, nullptr), -1);
+
+  std::vector<uint8_t> rgba(4 * 4 * 4, 1);
+  exchange_.PushCopy(rgba.data(), 4, 4);
+  exchange_.PushCopy(rgba.data(), 4, 4);
+  ASSERT_EQ(knt_get_frame_stats(kTextureId, &stats), 0);
+  EXPECT_EQ(stats.frames_pushed, 2u);
+  EXPECT_EQ(stats.frames_dropped, 1u);
+  EXPECT_EQ(stats.frame_pending, 1u);
+}
+
+TEST_F(FfiApiTest, MappedFrameOutlivesTheTexture) {
+  KntFrameView view;
+  EXPECT_EQ(knt_acquire_frame(kTextureId, &view), -3);
+
+  std::vector<uint8_t> rgba(2 * 2 * 4, 9);
+  exchange_.PushCopy(rgba.data(), 2, 2);
+  ASSERT_EQ(knt_acquire_frame(kTextureId, &view), 0);
+  EXPECT_EQ(view.width, 2u);
+  EXPECT_EQ(view.stride, 8u);
+  EXPECT_EQ(view.generation, 1u);
+  // Mapping does not count as presenting.
+  EXPECT_TRUE(exchange_.HasPendingFrame());
+
+  exchange_.Reset();
+  UnregisterFfiTexture(kTextureId);
+  EXPECT_EQ(view.data[view.size - 1], 9);
+  knt_release_frame(view.handle);
+  knt_release_frame(nullptr);
+}
+
+TEST_F(FfiApiTest, CopiesTheLatestResultWhenItFits) {
+  uint8_t buffer[4];
+  EXPECT_EQ(knt_copy_latest_result(kTextureId, buffer, sizeof(buffer),
+                                   nullptr, nullptr),
+            -3);
+
+  results_.Publish(7, std::make_shared<const std::vector<uint8_t>>(
+                          std::vector<uint8_t>{1, 2, 3, 4, 5, 6}));
+  uint64_t generation = 0;
+  uint64_t version = 0;
+  EXPECT_EQ(knt_copy_latest_result(kTextureId, buffer, sizeof(buffer),
+                                   &generation, &version),
+            6);
+  EXPECT_EQ(generation, 7u);
+  EXPECT_EQ(version, 1u);
+
+  uint8_t large[8] = {};
+  ASSERT_EQ(knt_copy_latest_result(kTextureId, large, sizeof(large), nullptr,
+                                   nullptr),
+            6);
+  EXPECT_EQ(large[5], 6);
+  EXPECT_EQ(knt_copy_latest_result(kTextureId, nullptr, 8, nullptr, nullptr),
+            -1);
+}
+
+TEST_F(FfiApiTest, RecordsReportedInferenceTimes) {
+  stats_.Start(0, 0);
+  EXPECT_EQ(knt_report_inference_time(kTextureId, 4000000), 0);
+  EXPECT_EQ(knt_report_inference_time(kTextureId, -1), -1);
+  EXPECT_EQ(knt_report_inference_time(kTextureId + 1, 1), -2);
+  const StatsWindow window = stats_.Collect(1000000000, 0);
+  EXPECT_EQ(window.inference.count, 1u);
+  EXPECT_FLOAT_EQ(window.inference.p50_ms, 4.0f);
+}
+
+TEST_F(FfiApiTest, MapsPyramidLevelsOfAnAcquiredFrame) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 4, 4);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(), 9);
+  frame->set_pyramid(FramePyramid::Build(*frame, 4, nullptr));
+  exchange_.Publish(std::move(frame));
+
+  KntFrameView view;
+  ASSERT_EQ(knt_acquire_frame(kTextureId, &view), 0);
+  KntFrameView level;
+  ASSERT_EQ(knt_map_frame_level(view.handle, 1, &level), 0);
+  EXPECT_EQ(level.width, 2u);
+  EXPECT_EQ(level.height, 2u);
+  EXPECT_EQ(level.generation, view.generation);
+  EXPECT_EQ(level.data[0], 9);
+  EXPECT_EQ(knt_map_frame_level(view.handle, 3, &level), -3);
+  EXPECT_EQ(knt_map_frame_level(nullptr, 1, &level), -1);
+  knt_release_frame(view.handle);
+  // The level outlives the frame's view.
+  EXPECT_EQ(level.data[3], 9);
+  knt_release_frame(level.handle);
+}
+
+TEST_F(FfiApiTest, HandsInferenceFramesOutOnce) {
+  KntFrameView view;
+  EXPECT_EQ(knt_acquire_inference_frame(kTextureId, &view), -3);
+  EXPECT_EQ(knt_acquire_inference_frame(kTextureId, nullptr), -1);
+
+  std::vector<uint8_t> rgba(2 * 2 * 4, 5);
+  exchange_.PushCopy(rgba.data(), 2, 2);
+  inference_.Offer(exchange_.PeekLatest(), 0);
+  ASSERT_EQ(knt_acquire_inference_frame(kTextureId, &view), 0);
+  EXPECT_EQ(view.generation, 1u);
+  EXPECT_EQ(view.data[0], 5);
+  knt_release_frame(view.handle);
+  EXPECT_EQ(knt_acquire_inference_frame(kTextureId, &view), -3);
+
+  KntInferenceStats stats;
+  ASSERT_EQ(knt_get_inference_stats(kTextureId, &stats), 0);
+  EXPECT_EQ(stats.frames_offered, 1u);
+  EXPECT_EQ(stats.frames_taken, 1u);
+  EXPECT_EQ(stats.frames_throttled, 0u);
+  EXPECT_EQ(knt_get_inference_stats(kTextureId + 1, &stats), -2);
+
+  ASSERT_EQ(knt_report_inference_time(kTextureId, 2000000), 0);
+  ASSERT_EQ(knt_get_inference_stats(kTextureId, &stats), 0);
+  EXPECT_FLOAT_EQ(stats.inference_ms, 2.0f);
+}
+
+TEST_F(FfiApiTest, TracksSubmittedDetections) {
+  DetectionSet set;
+  set.frame_generation = 3;
+  set.timestamp_ns = 0;
+  Detection box;
+  box.width = 10.0f;
+  box.height = 10.0f;
+  set.detections = {box};
+  std::vector<uint8_t> packet;
+  EncodeDetections(set, &packet);
+  EXPECT_EQ(knt_submit_detections(kTextureId, packet.data(), 3), -1);
+  ASSERT_EQ(knt_submit_detections(kTextureId, packet.data(), packet.size()),
+            0);
+
+  uint64_t generation = 0;
+  ResultBytes bytes = results_.Latest(&generation);
+  ASSERT_NE(bytes, nullptr);
+  EXPECT_EQ(generation, 3u);
+  DetectionSet published;
+  ASSERT_TRUE(DecodeDetections(bytes->data(), bytes->size(), &published));
+  ASSERT_EQ(published.detections.size(), 1u);
+  EXPECT_EQ(published.detections[0].track_id, 1);
+  EXPECT_EQ(tracker_.track_count(), 1u);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,208 @@
+#include "kataglyphis_native_core/frame_exchange.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(FrameExchange, ReportsDroppedFrames) {
+  FrameExchange exchange;
+  const std::vector<uint8_t> frame(2 * 2 * 4, 0x7f);
+
+  bool previous_consumed = false;
+  ASSERT_TRUE(exchange.PushCopy(frame.data(), 2, 2, &previous_consumed));
+  EXPECT_TRUE(previous_consumed);
+  EXPECT_TRUE(exchange.HasPendingFrame());
+
+  ASSERT_TRUE(exchange.PushCopy(frame.data(), 2, 2, &previous_consumed));
+  EXPECT_FALSE(previous_consumed);
+
+  const FrameStats stats = exchange.GetStats();
+  EXPECT_EQ(stats.frames_pushed, 2u);
+  EXPECT_EQ(stats.frames_presented, 0u);
+  EXPECT_EQ(stats.frames_dropped, 1u);
+  EXPECT_TRUE(stats.frame_pending);
+}
+
+TEST(FrameExchange, AcquireMarksPresentedOnce) {
+  FrameExchange exchange;
+  const std::vector<uint8_t> frame(4 * 4, 0x10);
+  int slot_free_calls = 0;
+  exchange.SetSlotFreeCallback([&] { ++slot_free_calls; });
+
+  ASSERT_TRUE(exchange.PushCopy(frame.data(), 2, 2));
+  FrameRef first = exchange.AcquireLatest();
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first->data()[0], 0x10);
+  EXPECT_FALSE(exchange.HasPendingFrame());
+
+  // Re-presenting the same frame is not new consumption.
+  FrameRef again = exchange.AcquireLatest();
+  EXPECT_EQ(again, first);
+  EXPECT_EQ(exchange.GetStats().frames_presented, 1u);
+  EXPECT_EQ(slot_free_calls, 1);
+}
+
+TEST(FrameExchange, ConsumerReferenceSurvivesNewerPush) {
+  FrameExchange exchange;
+  std::vector<uint8_t> frame(2 * 2 * 4, 0x01);
+  ASSERT_TRUE(exchange.PushCopy(frame.data(), 2, 2));
+  FrameRef presenting = exchange.AcquireLatest();
+
+  frame.assign(frame.size(), 0x02);
+  ASSERT_TRUE(exchange.PushCopy(frame.data(), 2, 2));
+  EXPECT_EQ(presenting->data()[0], 0x01);
+  EXPECT_GT(exchange.PeekLatest()->generation(), presenting->generation());
+}
+
+TEST(FrameExchange, LentFrameReleasedOnlyWhenUnreferenced) {
+  FrameExchange exchange;
+  const std::vector<uint8_t> pixels(2 * 2 * 4, 0x7f);
+  int releases = 0;
+  const auto release = [](void* context) { ++*static_cast<int*>(context); };
+
+  ASSERT_TRUE(exchange.PushLent(pixels.data(), 2, 2, release, &releases));
+  FrameRef presenting = exchange.AcquireLatest();
+  EXPECT_EQ(presenting->data(), pixels.data());
+
+  // Superseded while the consumer still reads it: release waits.
+  ASSERT_TRUE(exchange.PushCopy(pixels.data(), 2, 2));
+  EXPECT_EQ(releases, 0);
+  presenting.reset();
+  EXPECT_EQ(releases, 1);
+}
+
+TEST(FrameExchange, FillIsNotCountedAsPush) {
+  FrameExchange exchange;
+  exchange.PublishFill(2, 2, 5, 83, 177);
+  const FrameStats stats = exchange.GetStats();
+  EXPECT_EQ(stats.frames_pushed, 0u);
+  EXPECT_FALSE(stats.frame_pending);
+
+  FrameRef frame = exchange.AcquireLatest();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->data()[2], 177);
+  EXPECT_EQ(frame->data()[3], 255);
+  EXPECT_TRUE(frame->opaque());
+}
+
+TEST(FrameExchange, ClearingTheCallbackWaitsForARunningOne) {
+  FrameExchange exchange;
+  const std::vector<uint8_t> pixels(2 * 2 * 4, 1);
+  std::promise<void> entered;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<bool> running{false};
+  exchange.SetSlotFreeCallback([&] {
+    running = true;
+    entered.set_value();
+    released.wait();
+    running = false;
+  });
+  ASSERT_TRUE(exchange.PushCopy(pixels.data(), 2, 2));
+  std::thread consumer([&exchange] { exchange.AcquireLatest(); });
+  entered.get_future().wait();
+
+  std::atomic<bool> cleared{false};
+  std::thread producer([&] {
+    exchange.SetSlotFreeCallback(nullptr);
+    // The producer may tear down the callback's state from here on.
+    EXPECT_FALSE(running);
+    cleared = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(cleared);
+  release.set_value();
+  producer.join();
+  consumer.join();
+  EXPECT_TRUE(cleared);
+
+  // Clearing from inside the callback does not wait for itself.
+  int calls = 0;
+  exchange.SetSlotFreeCallback([&] {
+    ++calls;
+    exchange.SetSlotFreeCallback(nullptr);
+  });
+  ASSERT_TRUE(exchange.PushCopy(pixels.data(), 2, 2));
+  exchange.AcquireLatest();
+  ASSERT_TRUE(exchange.PushCopy(pixels.data(), 2, 2));
+  exchange.AcquireLatest();
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(FrameExchange, OnlyItsOwnCallbackSkipsTheWait) {
+  FrameExchange exchange;
+  FrameExchange other;
+  const std::vector<uint8_t> pixels(2 * 2 * 4, 1);
+  std::promise<void> entered;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<bool> running{false};
+  exchange.SetSlotFreeCallback([&] {
+    running = true;
+    entered.set_value();
+    released.wait();
+    running = false;
+  });
+  ASSERT_TRUE(exchange.PushCopy(pixels.data(), 2, 2));
+  std::thread consumer([&exchange] { exchange.AcquireLatest(); });
+  entered.get_future().wait();
+
+  // Clearing from inside another exchange's callback still waits for the
+  // one running on the consumer thread.
+  std::thread releaser([&release] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release.set_value();
+  });
+  bool still_running = true;
+  other.SetSlotFreeCallback([&] {
+    exchange.SetSlotFreeCallback(nullptr);
+    still_running = running;
+  });
+  ASSERT_TRUE(other.PushCopy(pixels.data(), 2, 2));
+  other.AcquireLatest();
+  releaser.join();
+  consumer.join();
+  EXPECT_FALSE(still_running);
+}
+
+TEST(FrameExchange, ConcurrentProducerAndConsumer) {
+  FrameExchange exchange;
+  constexpr int kFrames = 2000;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    std::vector<uint8_t> frame(8 * 8 * 4);
+    for (int i = 0; i < kFrames; ++i) {
+      frame[0] = static_cast<uint8_t>(i);
+      exchange.PushCopy(frame.data(), 8, 8);
+    }
+    done = true;
+  });
+
+  uint64_t last_generation = 0;
+  while (!done) {
+    if (FrameRef frame = exchange.AcquireLatest()) {
+      EXPECT_GE(frame->generation(), last_generation);
+      last_generation = frame->generation();
+    }
+  }
+  producer.join();
+  exchange.AcquireLatest();
+
+  const FrameStats stats = exchange.GetStats();
+  EXPECT_EQ(stats.frames_pushed, static_cast<uint64_t>(kFrames));
+  EXPECT_EQ(stats.frames_presented + stats.frames_dropped,
+            static_cast<uint64_t>(kFrames));
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,79 @@
+#include "kataglyphis_native_core/frame_history.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kFrameNs = 100000000;  // 10 fps
+
+HistoryFrame Encoded(int index, bool keyframe, size_t bytes = 10) {
+  HistoryFrame frame;
+  frame.timestamp_ns = index * kFrameNs;
+  frame.keyframe = keyframe;
+  frame.encoded = std::make_shared<const std::vector<uint8_t>>(bytes, 0);
+  return frame;
+}
+
+}  // namespace
+
+TEST(FrameHistory, KeepsTheWindowStartingAtAKeyframe) {
+  FrameHistoryOptions options;
+  options.window_ns = 10 * kFrameNs;
+  FrameHistory history(options);
+  // Keyframe every 4th frame.
+  for (int i = 0; i < 30; ++i) history.Push(Encoded(i, i % 4 == 0));
+
+  FrameHistoryStats stats = history.stats();
+  // Window [19, 29]; 19 is a delta frame, so the history starts at 20.
+  EXPECT_EQ(stats.frames, 10u);
+  EXPECT_EQ(stats.span_ns, 9 * kFrameNs);
+  EXPECT_EQ(stats.bytes, 100u);
+  EXPECT_EQ(stats.pushed, 30u);
+  EXPECT_EQ(stats.evicted, 20u);
+
+  // The last 3 frames (27..29) depend on keyframe 24.
+  const std::vector<HistoryFrame> recent = history.Snapshot(2 * kFrameNs);
+  ASSERT_EQ(recent.size(), 6u);
+  EXPECT_EQ(recent.front().timestamp_ns, 24 * kFrameNs);
+  EXPECT_TRUE(recent.front().keyframe);
+  EXPECT_EQ(recent.back().timestamp_ns, 29 * kFrameNs);
+  EXPECT_EQ(history.Snapshot(0).size(), 10u);
+}
+
+TEST(FrameHistory, MemoryCapShortensTheWindowAndRestartsOnRewind) {
+  FrameHistoryOptions options;
+  options.max_bytes = 4 * 4 * 4 * 5;  // five 4x4 frames
+  FrameHistory history(options);
+  for (int i = 0; i < 8; ++i) {
+    std::shared_ptr<Frame> source = Frame::Allocate(nullptr, 4, 4);
+    source->mutable_data()[0] = static_cast<uint8_t>(i);
+    source->set_timestamp_ns(i * kFrameNs);
+    HistoryFrame frame;
+    frame.timestamp_ns = source->timestamp_ns();
+    frame.frame = history.CopyFrame(*source);
+    history.Push(frame);
+  }
+  std::vector<HistoryFrame> frames = history.Snapshot(0);
+  ASSERT_EQ(frames.size(), 5u);
+  EXPECT_EQ(frames.front().frame->data()[0], 3);
+  EXPECT_EQ(frames.front().frame->timestamp_ns(), 3 * kFrameNs);
+
+  // Frames without a timestamp are not recorded.
+  HistoryFrame untimed = Encoded(0, true);
+  untimed.timestamp_ns = -1;
+  history.Push(untimed);
+  EXPECT_EQ(history.stats().frames, 5u);
+
+  history.Push(Encoded(1, true));
+  EXPECT_EQ(history.stats().frames, 1u);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
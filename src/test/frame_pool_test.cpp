@@ -0,0 +1,55 @@
+#include "kataglyphis_native_core/frame_pool.h"
+
+#include <gtest/gtest.h>
+
+#include "kataglyphis_native_core/frame.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(FramePool, RecyclesBuffersOfTheSameSize) {
+  auto pool = FramePool::Create(2);
+  uint8_t* first_address = nullptr;
+  {
+    auto buffer = pool->Acquire(1024);
+    first_address = buffer.get();
+  }
+  EXPECT_EQ(pool->free_buffers(), 1u);
+
+  auto again = pool->Acquire(1024);
+  EXPECT_EQ(again.get(), first_address);
+  EXPECT_EQ(pool->allocations(), 1u);
+}
+
+TEST(FramePool, BoundsFreeList) {
+  auto pool = FramePool::Create(1);
+  {
+    auto a = pool->Acquire(64);
+    auto b = pool->Acquire(64);
+  }
+  EXPECT_EQ(pool->free_buffers(), 1u);
+}
+
+TEST(FramePool, BuffersOutliveThePool) {
+  std::shared_ptr<uint8_t> buffer;
+  {
+    auto pool = FramePool::Create();
+    buffer = pool->Acquire(16);
+  }
+  buffer.get()[0] = 1;  // Still valid; freed on release without the pool.
+  buffer.reset();
+}
+
+TEST(FramePool, AllocatedFramesAreTightlyPacked) {
+  auto pool = FramePool::Create();
+  auto frame = Frame::Allocate(pool.get(), 3, 2);
+  EXPECT_EQ(frame->stride(), 12u);
+  EXPECT_EQ(frame->size(), 24u);
+  EXPECT_TRUE(frame->is_tightly_packed());
+  EXPECT_NE(frame->mutable_data(), nullptr);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
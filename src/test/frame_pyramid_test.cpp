@@ -0,0 +1,92 @@
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "kataglyphis_native_core/frame_pool.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+// Pixel (x, y) gets channel c = x * 7 + y * 13 + c * 31 (mod 256).
+uint8_t Pattern(uint32_t x, uint32_t y, uint32_t c) {
+  return static_cast<uint8_t>(x * 7 + y * 13 + c * 31);
+}
+
+}  // namespace
+
+TEST(FramePyramid, AveragesTwoByTwoBlocksLikeTheScalarFilter) {
+  // Wide enough for the vector path plus an odd tail, with row padding.
+  const uint32_t width = 21;
+  const uint32_t height = 6;
+  const size_t stride = width * 4 + 12;
+  std::vector<uint8_t> src(stride * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      for (uint32_t c = 0; c < 4; ++c) {
+        src[y * stride + x * 4 + c] = Pattern(x, y, c);
+      }
+    }
+  }
+  std::vector<uint8_t> dst((width / 2) * 4 * (height / 2), 0);
+  Downsample2x(src.data(), stride, width, height, dst.data(), (width / 2) * 4);
+
+  for (uint32_t y = 0; y < height / 2; ++y) {
+    for (uint32_t x = 0; x < width / 2; ++x) {
+      for (uint32_t c = 0; c < 4; ++c) {
+        const unsigned sum =
+            Pattern(2 * x, 2 * y, c) + Pattern(2 * x + 1, 2 * y, c) +
+            Pattern(2 * x, 2 * y + 1, c) + Pattern(2 * x + 1, 2 * y + 1, c);
+        ASSERT_EQ(dst[(y * (width / 2) + x) * 4 + c], (sum + 2) / 4)
+            << "x=" << x << " y=" << y << " c=" << c;
+      }
+    }
+  }
+}
+
+TEST(FramePyramid, BuildsLevelsFromThePool) {
+  auto pool = FramePool::Create(4);
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 40, 10);
+  frame->set_timestamp_ns(123);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(), 80);
+
+  auto pyramid = FramePyramid::Build(*frame, 8, pool.get());
+  ASSERT_NE(pyramid, nullptr);
+  // 20x5, 10x2, 5x1; a fourth level would have no rows.
+  ASSERT_EQ(pyramid->level_count(), 3u);
+  EXPECT_EQ(pyramid->level(0), nullptr);
+  EXPECT_EQ(pyramid->level(4), nullptr);
+  EXPECT_EQ(pyramid->level(2)->width(), 10u);
+  EXPECT_EQ(pyramid->level(2)->height(), 2u);
+  EXPECT_EQ(pyramid->level(3)->timestamp_ns(), 123);
+  EXPECT_EQ(pyramid->level(3)->data()[0], 80);
+  EXPECT_EQ(pool->allocations(), 3u);
+
+  EXPECT_EQ(pyramid->FitWithin(12)->width(), 10u);
+  EXPECT_EQ(pyramid->FitWithin(1)->width(), 5u);
+
+  // Released levels are reused by the next frame's pyramid.
+  pyramid.reset();
+  FramePyramid::Build(*frame, 8, pool.get());
+  EXPECT_EQ(pool->allocations(), 3u);
+}
+
+TEST(FramePyramid, RejectsFramesTooSmallOrTruncated) {
+  std::shared_ptr<Frame> tiny = Frame::Allocate(nullptr, 1, 8);
+  EXPECT_EQ(FramePyramid::Build(*tiny, 2, nullptr), nullptr);
+
+  std::vector<uint8_t> bytes(8 * 4 * 3);
+  auto truncated = Frame::Wrap(bytes.data(), 8, 4, 8 * 4, bytes.size(),
+                               nullptr);
+  EXPECT_EQ(FramePyramid::Build(*truncated, 2, nullptr), nullptr);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,121 @@
+#include "kataglyphis_native_core/frame_scrubber.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "test_clip.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int kFrames = 60;
+constexpr int64_t kFrameNs = 1000000000 / 30;
+
+// Frame index shown at a timestamp, tolerating rounded timestamps.
+int64_t IndexOf(const FrameRef& frame) {
+  return (frame->timestamp_ns() + kFrameNs / 2) / kFrameNs;
+}
+
+}  // namespace
+
+class FrameScrubberTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GstRuntime& runtime = GstRuntime::Get();
+    runtime.WaitUntilReady();
+    for (const char* element : {"jpegenc", "jpegdec", "avimux", "avidemux"}) {
+      if (!runtime.HasElement(element)) GTEST_SKIP() << "needs " << element;
+    }
+    path_ = ::testing::TempDir() + "frame_scrubber_test.avi";
+    std::string error;
+    ASSERT_TRUE(WriteTestClip(path_, kFrames, &error)) << error;
+  }
+
+  void TearDown() override {
+    if (!path_.empty()) std::remove(path_.c_str());
+  }
+
+  std::string path_;
+};
+
+TEST_F(FrameScrubberTest, SeeksAndStepsFrameAccuratelyInBothDirections) {
+  FrameScrubberOptions options;
+  options.width = 32;
+  options.height = 24;
+  options.chunk_ns = 200000000;
+  FrameScrubber scrubber(options);
+  std::string error;
+  ASSERT_TRUE(scrubber.Open(path_, &error)) << error;
+  EXPECT_EQ(scrubber.frame_duration_ns(), kFrameNs);
+
+  FrameRef frame = scrubber.Seek(30 * kFrameNs + kFrameNs / 2, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), 30);
+  EXPECT_EQ(frame->width(), 32u);
+
+  frame = scrubber.Step(1, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), 31);
+  frame = scrubber.Step(-5, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), 26);
+  frame = scrubber.Step(-1, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), 25);
+
+  // Past the end clamps to the last frame.
+  frame = scrubber.Seek(10 * 1000000000LL, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), kFrames - 1);
+
+  // The frames decoded for the first seek are still cached.
+  const uint64_t hits = scrubber.cache_stats().hits;
+  frame = scrubber.Seek(31 * kFrameNs, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), 31);
+  EXPECT_EQ(scrubber.cache_stats().hits, hits + 1);
+}
+
+TEST_F(FrameScrubberTest, PrefetchesAheadWithinTheBudget) {
+  FrameScrubberOptions options;
+  options.width = 32;
+  options.height = 24;
+  options.budget_bytes = 20 * 32 * 24 * 4;
+  options.chunk_ns = 100000000;
+  options.prefetch_ns = 1000000000;
+  FrameScrubber scrubber(options);
+  std::string error;
+  ASSERT_TRUE(scrubber.Open(path_, &error)) << error;
+  ASSERT_TRUE(scrubber.Seek(0, &error)) << error;
+
+  // The worker keeps decoding ahead of the playhead until the budget is
+  // full.
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (scrubber.cache_stats().frames < 20 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  const ScrubCacheStats stats = scrubber.cache_stats();
+  EXPECT_EQ(stats.frames, 20u);
+  EXPECT_LE(stats.bytes, options.budget_bytes);
+
+  FrameRef frame = scrubber.Step(15, &error);
+  ASSERT_TRUE(frame) << error;
+  EXPECT_EQ(IndexOf(frame), 15);
+  scrubber.Close();
+  EXPECT_FALSE(scrubber.Seek(0, &error));
+  EXPECT_EQ(error, "No file is open");
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
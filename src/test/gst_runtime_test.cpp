@@ -0,0 +1,54 @@
+#include "kataglyphis_native_core/gst_runtime.h"
+
+#include <gst/gst.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(GstRuntime, InitializesOnceInTheBackground) {
+  std::atomic<int> register_calls{0};
+  GstRuntimeOptions options;
+  options.register_plugins = [&register_calls] { ++register_calls; };
+  options.probe_plugins = {"coreelements"};
+  options.probe_elements = {"fakesink", "no_such_element_xyz"};
+
+  // Get() is usually started already by earlier tests in this binary.
+  GstRuntime runtime;
+  runtime.StartAsync(options);
+  runtime.StartAsync(options);
+  runtime.WaitUntilReady();
+
+  EXPECT_TRUE(runtime.ready());
+  EXPECT_TRUE(gst_is_initialized());
+  EXPECT_EQ(register_calls.load(), 1);
+  EXPECT_TRUE(runtime.HasPlugin("coreelements"));
+  EXPECT_TRUE(runtime.HasElement("fakesink"));
+  EXPECT_FALSE(runtime.HasElement("no_such_element_xyz"));
+  // Not in the probe list, but in the registry-wide index.
+  EXPECT_TRUE(runtime.HasElement("identity"));
+  EXPECT_GT(runtime.element_index().size(), 2u);
+  EXPECT_TRUE(ValidatePipeline("fakesrc ! identity ! fakesink",
+                               runtime.element_index())
+                  .ok);
+  EXPECT_TRUE(runtime.HasElementProperty("fakesink", "sync"));
+  EXPECT_FALSE(runtime.HasElementProperty("fakesink", "no-such-property"));
+  EXPECT_FALSE(runtime.HasElementProperty("no_such_element_xyz", "sync"));
+
+  const GstRuntimeTimings timings = runtime.timings();
+  EXPECT_GE(timings.total_ms, timings.gst_init_ms);
+  EXPECT_GE(timings.gst_init_ms, 0.0);
+
+  const std::string report = runtime.Diagnose();
+  EXPECT_NE(report.find("- fakesink: yes"), std::string::npos);
+  EXPECT_NE(report.find("- no_such_element_xyz: no"), std::string::npos);
+  EXPECT_NE(report.find("init timings:"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,129 @@
+#include "kataglyphis_native_core/history_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <string>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kFrameNs = 1000000000 / 30;
+
+long FileSize(const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (!file) return -1;
+  std::fseek(file, 0, SEEK_END);
+  const long size = std::ftell(file);
+  std::fclose(file);
+  return size;
+}
+
+HistoryDumpResult DumpAndWait(HistoryRecorder& recorder,
+                              const std::string& path, int64_t window_ns) {
+  std::promise<HistoryDumpResult> done;
+  std::string error;
+  if (!recorder.Dump(path, window_ns,
+                     [&done](const HistoryDumpResult& result) {
+                       done.set_value(result);
+                     },
+                     &error)) {
+    HistoryDumpResult failed;
+    failed.error = error;
+    return failed;
+  }
+  std::future<HistoryDumpResult> result = done.get_future();
+  if (result.wait_for(std::chrono::seconds(30)) !=
+      std::future_status::ready) {
+    HistoryDumpResult failed;
+    failed.error = "dump timed out";
+    return failed;
+  }
+  return result.get();
+}
+
+}  // namespace
+
+class HistoryRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GstRuntime& runtime = GstRuntime::Get();
+    runtime.WaitUntilReady();
+    for (const char* element : {"jpegenc", "matroskamux"}) {
+      if (!runtime.HasElement(element)) GTEST_SKIP() << "needs " << element;
+    }
+    path_ = ::testing::TempDir() + "history_recorder_test.mkv";
+  }
+
+  void TearDown() override {
+    if (!path_.empty()) std::remove(path_.c_str());
+  }
+
+  std::string path_;
+};
+
+TEST_F(HistoryRecorderTest, DumpsTheLastSecondsOfRawFrames) {
+  HistoryRecorderOptions options;
+  options.history.window_ns = 30 * kFrameNs;
+  HistoryRecorder recorder(options);
+  std::string error;
+  EXPECT_FALSE(recorder.Dump(path_, 0, nullptr, &error));
+  EXPECT_EQ(error, "Nothing recorded yet");
+
+  for (int i = 0; i < 90; ++i) {
+    std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 32, 24);
+    frame->set_timestamp_ns(i * kFrameNs);
+    recorder.PushRaw(*frame);
+  }
+  EXPECT_EQ(recorder.stats().frames, 31u);
+
+  const HistoryDumpResult result = DumpAndWait(recorder, path_, 10 * kFrameNs);
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(result.frames, 11u);
+  EXPECT_EQ(result.span_ns, 10 * kFrameNs);
+  EXPECT_GT(FileSize(path_), 0);
+  EXPECT_FALSE(recorder.dumping());
+}
+
+TEST_F(HistoryRecorderTest, RecordsAnEncoderBranchSplicedBeforeTheSink) {
+  HistoryRecorderOptions options;
+  options.encoded = true;
+  HistoryRecorder recorder(options);
+
+  PipelineController controller;
+  std::string error;
+  ASSERT_TRUE(controller.Load(
+      "videotestsrc num-buffers=20 ! "
+      "video/x-raw,format=RGBA,width=64,height=48,framerate=30/1 ! "
+      "fakesink name=sink",
+      &error))
+      << error;
+  GstElement* sink =
+      gst_bin_get_by_name(GST_BIN(controller.pipeline()), "sink");
+  ASSERT_TRUE(recorder.Attach(controller.pipeline(), sink, &error)) << error;
+  gst_object_unref(sink);
+
+  gst_element_set_state(controller.pipeline(), GST_STATE_PLAYING);
+  ASSERT_TRUE(controller.WaitForEos(std::chrono::seconds(10), &error))
+      << error;
+  controller.Release();
+
+  // The leaky queue may drop under load, but JPEG frames are all keyframes.
+  EXPECT_GT(recorder.stats().frames, 0u);
+  const HistoryDumpResult result = DumpAndWait(recorder, path_, 0);
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(result.frames, recorder.stats().frames);
+  EXPECT_GT(FileSize(path_), 0);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,112 @@
+#include "kataglyphis_native_core/image_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+uint32_t Read32(const std::vector<uint8_t>& bytes, size_t offset) {
+  return (uint32_t{bytes[offset]} << 24) | (uint32_t{bytes[offset + 1]} << 16) |
+         (uint32_t{bytes[offset + 2]} << 8) | bytes[offset + 3];
+}
+
+// 3x2 frame with 4 bytes of row padding marked 0xEE.
+std::shared_ptr<Frame> PaddedFrame(std::vector<uint8_t>* storage) {
+  *storage = std::vector<uint8_t>(16 * 2, 0xEE);
+  for (size_t row = 0; row < 2; ++row) {
+    for (size_t i = 0; i < 12; ++i) {
+      (*storage)[row * 16 + i] = static_cast<uint8_t>(row * 12 + i);
+    }
+  }
+  return Frame::Wrap(storage->data(), 3, 2, 16, storage->size(), nullptr);
+}
+
+}  // namespace
+
+TEST(ImageEncoder, ParsesFormatNames) {
+  ImageFormat format = ImageFormat::kRaw;
+  EXPECT_TRUE(ParseImageFormat("jpg", &format));
+  EXPECT_EQ(format, ImageFormat::kJpeg);
+  EXPECT_TRUE(ParseImageFormat("png", &format));
+  EXPECT_STREQ(ImageFormatName(format), "png");
+  EXPECT_FALSE(ParseImageFormat("gif", &format));
+}
+
+TEST(ImageEncoder, RawDropsRowPadding) {
+  std::vector<uint8_t> storage;
+  std::shared_ptr<Frame> frame = PaddedFrame(&storage);
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(EncodeImage(*frame, ImageFormat::kRaw, 0, &out));
+  ASSERT_EQ(out.size(), 24u);
+  for (size_t i = 0; i < out.size(); ++i) EXPECT_EQ(out[i], i);
+
+  // Rows past the end of the buffer are refused, not read.
+  std::shared_ptr<Frame> truncated =
+      Frame::Wrap(storage.data(), 3, 3, 16, storage.size(), nullptr);
+  EXPECT_FALSE(EncodeImage(*truncated, ImageFormat::kPng, 0, &out));
+}
+
+TEST(ImageEncoder, PngStoresFilteredScanlines) {
+  std::vector<uint8_t> storage;
+  std::shared_ptr<Frame> frame = PaddedFrame(&storage);
+  std::vector<uint8_t> png;
+  ASSERT_TRUE(EncodeImage(*frame, ImageFormat::kPng, 0, &png));
+
+  const std::vector<uint8_t> signature = {0x89, 'P', 'N', 'G',
+                                          '\r', '\n', 0x1A, '\n'};
+  ASSERT_TRUE(std::equal(signature.begin(), signature.end(), png.begin()));
+  EXPECT_EQ(Read32(png, 8), 13u);  // IHDR length
+  EXPECT_EQ(Read32(png, 16), 3u);
+  EXPECT_EQ(Read32(png, 20), 2u);
+
+  // IDAT follows IHDR: zlib header, one final stored block, Adler-32.
+  const size_t idat = 8 + 12 + 13;
+  ASSERT_EQ(std::string(png.begin() + idat + 4, png.begin() + idat + 8),
+            "IDAT");
+  const size_t zlib = idat + 8;
+  EXPECT_EQ(png[zlib], 0x78);
+  EXPECT_EQ(png[zlib + 2], 1);  // BFINAL, stored
+  const size_t length = png[zlib + 3] | (png[zlib + 4] << 8);
+  ASSERT_EQ(length, 2u * (1 + 12));
+  const uint8_t* scanlines = png.data() + zlib + 7;
+  EXPECT_EQ(scanlines[0], 0);  // filter None
+  EXPECT_EQ(scanlines[1], 0);
+  EXPECT_EQ(scanlines[13], 0);
+  EXPECT_EQ(scanlines[14], 12);
+  EXPECT_EQ(std::string(png.end() - 8, png.end() - 4), "IEND");
+}
+
+TEST(ImageEncoder, JpegHasFrameHeaderAndEndMarker) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 20, 9);
+  for (size_t i = 0; i < frame->size(); ++i) {
+    frame->mutable_data()[i] = static_cast<uint8_t>(i * 13);
+  }
+  std::vector<uint8_t> low;
+  std::vector<uint8_t> high;
+  ASSERT_TRUE(EncodeImage(*frame, ImageFormat::kJpeg, 20, &low));
+  ASSERT_TRUE(EncodeImage(*frame, ImageFormat::kJpeg, 95, &high));
+  EXPECT_LT(low.size(), high.size());
+
+  ASSERT_GE(high.size(), 4u);
+  EXPECT_EQ(high[0], 0xFF);
+  EXPECT_EQ(high[1], 0xD8);
+  EXPECT_EQ(high[high.size() - 2], 0xFF);
+  EXPECT_EQ(high[high.size() - 1], 0xD9);
+  const std::vector<uint8_t> sof = {0xFF, 0xC0};
+  auto it = std::search(high.begin(), high.end(), sof.begin(), sof.end());
+  ASSERT_NE(it, high.end());
+  const size_t offset = static_cast<size_t>(it - high.begin());
+  EXPECT_EQ((high[offset + 5] << 8) | high[offset + 6], 9);   // height
+  EXPECT_EQ((high[offset + 7] << 8) | high[offset + 8], 20);  // width
+  EXPECT_EQ(high[offset + 9], 3);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,132 @@
+#include "kataglyphis_native_core/inference_feed.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+FrameRef SolidFrame(uint8_t level) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 16, 16);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(),
+            level);
+  return frame;
+}
+
+}  // namespace
+
+TEST(InferenceFeed, HandsEachFrameOutOnceAndCountsReplacements) {
+  InferenceFeed feed;
+  EXPECT_EQ(feed.Take(), nullptr);
+
+  const FrameRef first = SolidFrame(1);
+  const FrameRef second = SolidFrame(2);
+  EXPECT_TRUE(feed.Offer(first, 0));
+  EXPECT_TRUE(feed.Offer(second, 1));
+  EXPECT_EQ(feed.Take(), second);
+  EXPECT_EQ(feed.Take(), nullptr);
+  EXPECT_FALSE(feed.Offer(nullptr, 2));
+
+  const InferenceFeedStats stats = feed.GetStats();
+  EXPECT_EQ(stats.offered, 2u);
+  EXPECT_EQ(stats.replaced, 1u);
+  EXPECT_EQ(stats.taken, 1u);
+  EXPECT_EQ(stats.gated, 0u);
+}
+
+TEST(InferenceFeed, HoldsBackUnchangedFramesWithAGate) {
+  InferenceFeed feed;
+  MotionGateOptions options;
+  options.cell_size = 4;
+  options.keep_alive_ns = 0;
+  feed.SetMotionGate(std::make_shared<MotionGate>(options));
+
+  EXPECT_TRUE(feed.Offer(SolidFrame(50), 0));
+  EXPECT_NE(feed.Take(), nullptr);
+  EXPECT_FALSE(feed.Offer(SolidFrame(50), 1));
+  EXPECT_EQ(feed.Take(), nullptr);
+  EXPECT_TRUE(feed.Offer(SolidFrame(200), 2));
+  EXPECT_GT(feed.GetStats().last_mean_diff, 100.0f);
+
+  // Reset drops the waiting frame; the next one passes as a first frame.
+  feed.Reset();
+  EXPECT_EQ(feed.Take(), nullptr);
+  EXPECT_TRUE(feed.Offer(SolidFrame(200), 3));
+  EXPECT_EQ(feed.GetStats().gated, 1u);
+
+  feed.SetMotionGate(nullptr);
+  EXPECT_TRUE(feed.Offer(SolidFrame(200), 4));
+}
+
+TEST(InferenceFeed, PacesFramesToTheReportedInferenceTime) {
+  InferenceFeed feed;
+  InferenceRateOptions options;
+  options.max_fps = 100.0f;
+  feed.ConfigureRate(true, options);
+
+  // 100 fps cap: one frame per 10 ms.
+  EXPECT_TRUE(feed.Offer(SolidFrame(1), 0));
+  EXPECT_FALSE(feed.Offer(SolidFrame(1), 5000000));
+  EXPECT_TRUE(feed.Offer(SolidFrame(1), 10000000));
+  ASSERT_NE(feed.Take(), nullptr);
+
+  // A 40 ms model sets the pace once it reports.
+  feed.ReportInference(40000000, 50000000);
+  EXPECT_TRUE(feed.Offer(SolidFrame(1), 50000000));
+  EXPECT_FALSE(feed.Offer(SolidFrame(1), 80000000));
+  EXPECT_TRUE(feed.Offer(SolidFrame(1), 90000000));
+
+  InferenceFeedStats stats = feed.GetStats();
+  EXPECT_EQ(stats.throttled, 2u);
+  EXPECT_EQ(stats.replaced, 2u);
+  EXPECT_FLOAT_EQ(stats.inference_ms, 40.0f);
+  EXPECT_FLOAT_EQ(stats.latency_ms, 40.0f);
+  EXPECT_FLOAT_EQ(stats.admitted_fps, 25.0f);
+
+  feed.ConfigureRate(false, options);
+  EXPECT_TRUE(feed.Offer(SolidFrame(1), 90000001));
+  EXPECT_FLOAT_EQ(feed.GetStats().admitted_fps, 0.0f);
+}
+
+TEST(InferenceFeed, BacksOffWhileResultsExceedTheLatencyTarget) {
+  InferenceFeed feed;
+  InferenceRateOptions options;
+  options.target_latency_ns = 50000000;
+  feed.ConfigureRate(true, options);
+
+  // Each result arrives 100 ms after its frame: too old, so the admission
+  // interval grows by a factor per report.
+  int64_t now = 0;
+  float previous_fps = 0.0f;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(feed.Offer(SolidFrame(1), now));
+    ASSERT_NE(feed.Take(), nullptr);
+    now += 100000000;
+    feed.ReportInference(20000000, now);
+    const float fps = feed.GetStats().admitted_fps;
+    if (i > 0) EXPECT_LT(fps, previous_fps);
+    previous_fps = fps;
+  }
+  EXPECT_NEAR(feed.GetStats().effective_fps, 10.0f, 0.01f);
+
+  // Fresh results let the rate recover once the smoothed latency is back
+  // under the target.
+  float lowest_fps = previous_fps;
+  for (int i = 0; i < 20; ++i) {
+    now += 200000000;
+    ASSERT_TRUE(feed.Offer(SolidFrame(1), now));
+    ASSERT_NE(feed.Take(), nullptr);
+    feed.ReportInference(20000000, now + 1000000);
+    lowest_fps = std::min(lowest_fps, feed.GetStats().admitted_fps);
+  }
+  EXPECT_GT(feed.GetStats().admitted_fps, lowest_fps);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,186 @@
+#include "kataglyphis_native_core/mosaic_compositor.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+std::shared_ptr<Frame> SolidFrame(uint32_t width, uint32_t height,
+                                  uint8_t r, uint8_t g, uint8_t b) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, width, height);
+  for (size_t i = 0; i < frame->size(); i += 4) {
+    frame->mutable_data()[i] = r;
+    frame->mutable_data()[i + 1] = g;
+    frame->mutable_data()[i + 2] = b;
+    frame->mutable_data()[i + 3] = 255;
+  }
+  return frame;
+}
+
+const uint8_t* PixelAt(const MosaicCompositor& mosaic, uint32_t x,
+                       uint32_t y) {
+  return mosaic.surface() + (y * mosaic.surface_width() + x) * 4;
+}
+
+// Two side-by-side tiles on a 64x32 surface.
+MosaicLayout TwoTiles() {
+  MosaicLayout layout;
+  layout.width = 64;
+  layout.height = 32;
+  layout.tiles.push_back(MosaicTile{"left", 0.0f, 0.0f, 0.5f, 1.0f, false});
+  layout.tiles.push_back(MosaicTile{"right", 0.5f, 0.0f, 0.5f, 1.0f, false});
+  return layout;
+}
+
+}  // namespace
+
+TEST(MosaicCompositor, BilinearScaleMatchesTheScalarReference) {
+  // Odd sizes exercise the vector bodies and their tails in both passes.
+  const uint32_t src_width = 13;
+  const uint32_t src_height = 7;
+  const size_t src_stride = src_width * 4 + 8;
+  std::vector<uint8_t> src(src_stride * src_height);
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  const uint32_t dst_width = 19;
+  const uint32_t dst_height = 10;
+  std::vector<uint8_t> dst(dst_width * 4 * dst_height);
+  std::vector<uint8_t> row;
+  ScaleRgbaBilinear(src.data(), src_stride, src_width, src_height, dst.data(),
+                    dst_width * 4, dst_width, dst_height, &row);
+
+  // Same fixed-point taps as the implementation, without vectors.
+  const auto tap = [](uint32_t i, uint32_t src_size, uint32_t dst_size,
+                      uint32_t* first, uint32_t* weight) {
+    const int64_t position =
+        (static_cast<int64_t>(2 * i + 1) * src_size * 128) / (2 * dst_size) -
+        64;
+    *first = position <= 0 ? 0 : static_cast<uint32_t>(position / 128);
+    *weight = position <= 0 ? 0 : static_cast<uint32_t>(position % 128);
+    if (*first >= src_size - 1) {
+      *first = src_size - 1;
+      *weight = 0;
+    }
+  };
+  for (uint32_t y = 0; y < dst_height; ++y) {
+    uint32_t sy = 0;
+    uint32_t wy = 0;
+    tap(y, src_height, dst_height, &sy, &wy);
+    const uint32_t sy1 = wy > 0 ? sy + 1 : sy;
+    for (uint32_t x = 0; x < dst_width; ++x) {
+      uint32_t sx = 0;
+      uint32_t wx = 0;
+      tap(x, src_width, dst_width, &sx, &wx);
+      const uint32_t sx1 = std::min(sx + 1, src_width - 1);
+      for (uint32_t c = 0; c < 4; ++c) {
+        const auto at = [&](uint32_t yy, uint32_t xx) {
+          return static_cast<uint32_t>(src[yy * src_stride + xx * 4 + c]);
+        };
+        const uint32_t left =
+            (at(sy, sx) * (128 - wy) + at(sy1, sx) * wy + 64) / 128;
+        const uint32_t right =
+            (at(sy, sx1) * (128 - wy) + at(sy1, sx1) * wy + 64) / 128;
+        ASSERT_EQ(dst[(y * dst_width + x) * 4 + c],
+                  (left * (128 - wx) + right * wx + 64) / 128)
+            << "x=" << x << " y=" << y << " c=" << c;
+      }
+    }
+  }
+}
+
+TEST(MosaicCompositor, SameSizeScaleIsACopy) {
+  std::vector<uint8_t> src(9 * 4 * 5);
+  for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<uint8_t>(i);
+  std::vector<uint8_t> dst(src.size());
+  std::vector<uint8_t> row;
+  ScaleRgbaBilinear(src.data(), 9 * 4, 9, 5, dst.data(), 9 * 4, 9, 5, &row);
+  EXPECT_EQ(dst, src);
+}
+
+TEST(MosaicCompositor, RedrawsOnlyTilesWithNewFrames) {
+  MosaicCompositor mosaic;
+  EXPECT_FALSE(mosaic.active());
+  EXPECT_FALSE(mosaic.Submit("left", SolidFrame(8, 8, 1, 2, 3)));
+
+  mosaic.SetLayout(TwoTiles());
+  EXPECT_TRUE(mosaic.active());
+  EXPECT_FALSE(mosaic.Submit("elsewhere", SolidFrame(8, 8, 1, 2, 3)));
+  EXPECT_FALSE(mosaic.Submit("left", nullptr));
+
+  // Before any frame: background only.
+  EXPECT_EQ(mosaic.Compose(), 0u);
+  ASSERT_EQ(mosaic.surface_width(), 64u);
+  EXPECT_EQ(PixelAt(mosaic, 40, 10)[3], 255);
+  EXPECT_EQ(PixelAt(mosaic, 40, 10)[0], 0);
+
+  EXPECT_TRUE(mosaic.Submit("left", SolidFrame(200, 100, 10, 20, 30)));
+  EXPECT_TRUE(mosaic.Submit("right", SolidFrame(16, 16, 40, 50, 60)));
+  EXPECT_EQ(mosaic.Compose(), 2u);
+  EXPECT_EQ(PixelAt(mosaic, 5, 5)[1], 20);
+  EXPECT_EQ(PixelAt(mosaic, 60, 30)[2], 60);
+
+  // Only the right source moved on.
+  EXPECT_TRUE(mosaic.Submit("right", SolidFrame(16, 16, 70, 80, 90)));
+  EXPECT_EQ(mosaic.Compose(), 1u);
+  EXPECT_EQ(mosaic.Compose(), 0u);
+  EXPECT_EQ(PixelAt(mosaic, 5, 5)[1], 20);
+  EXPECT_EQ(PixelAt(mosaic, 60, 30)[0], 70);
+
+  const MosaicStats stats = mosaic.GetStats();
+  EXPECT_EQ(stats.frames_submitted, 3u);
+  EXPECT_EQ(stats.compositions, 4u);
+  EXPECT_EQ(stats.tiles_drawn, 3u);
+  EXPECT_EQ(stats.tiles_skipped, 5u);
+
+  // A new layout repaints every tile that has a frame.
+  mosaic.SetLayout(TwoTiles());
+  EXPECT_EQ(mosaic.Compose(), 2u);
+  mosaic.ClearSources();
+  EXPECT_EQ(mosaic.Compose(), 0u);
+  EXPECT_EQ(PixelAt(mosaic, 60, 30)[0], 70);
+
+  // The new stream submits as often as the old one had before its last
+  // draw; its frame must still count as new.
+  EXPECT_TRUE(mosaic.Submit("right", SolidFrame(16, 16, 4, 4, 4)));
+  EXPECT_TRUE(mosaic.Submit("right", SolidFrame(16, 16, 5, 5, 5)));
+  EXPECT_EQ(mosaic.Compose(), 1u);
+  EXPECT_EQ(PixelAt(mosaic, 60, 30)[0], 5);
+  EXPECT_EQ(mosaic.Compose(), 0u);
+}
+
+TEST(MosaicCompositor, LetterboxesFittedTiles) {
+  MosaicLayout layout;
+  layout.width = 40;
+  layout.height = 40;
+  layout.background[0] = 9;
+  layout.tiles.push_back(MosaicTile{"cam", 0.0f, 0.0f, 1.0f, 1.0f, true});
+  MosaicCompositor mosaic;
+  mosaic.SetLayout(layout);
+
+  // 2:1 source in a square tile: 40x20 picture, 10-pixel bars.
+  std::shared_ptr<Frame> frame = SolidFrame(160, 80, 100, 100, 100);
+  frame->set_pyramid(FramePyramid::Build(*frame, 3, nullptr));
+  ASSERT_TRUE(mosaic.Submit("cam", frame));
+  EXPECT_EQ(mosaic.Compose(), 1u);
+  EXPECT_EQ(PixelAt(mosaic, 20, 5)[0], 9);
+  EXPECT_EQ(PixelAt(mosaic, 20, 20)[0], 100);
+  EXPECT_EQ(PixelAt(mosaic, 20, 35)[0], 9);
+  EXPECT_EQ(PixelAt(mosaic, 0, 10)[0], 100);
+  EXPECT_EQ(PixelAt(mosaic, 39, 29)[0], 100);
+  EXPECT_EQ(PixelAt(mosaic, 39, 30)[0], 9);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
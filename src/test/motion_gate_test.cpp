@@ -0,0 +1,172 @@
+#include "kataglyphis_native_core/motion_gate.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "kataglyphis_native_core/frame_pyramid.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kWidth = 64;
+constexpr uint32_t kHeight = 48;
+constexpr int64_t kSecond = 1000000000;
+
+std::shared_ptr<Frame> GrayFrame(uint8_t level) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, kWidth, kHeight);
+  std::vector<uint8_t> pixels(frame->size(), level);
+  std::copy(pixels.begin(), pixels.end(), frame->mutable_data());
+  return frame;
+}
+
+// Paints a white square of `side` pixels at (x, y).
+void PaintSquare(Frame* frame, uint32_t x, uint32_t y, uint32_t side) {
+  for (uint32_t row = y; row < y + side; ++row) {
+    uint8_t* p = frame->mutable_data() + row * frame->stride() + x * 4;
+    std::fill(p, p + side * 4, 255);
+  }
+}
+
+}  // namespace
+
+TEST(MotionGate, DownsamplesToLumaCells) {
+  // 3x2 pixels, cells of 2: two columns of cells, one row.
+  std::vector<uint8_t> rgba = {255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255,
+                               255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255};
+  std::vector<uint8_t> luma;
+  uint32_t grid_width = 0;
+  uint32_t grid_height = 0;
+  DownsampleLuma(rgba.data(), rgba.size(), 12, 3, 2, 2, &luma, &grid_width,
+                 &grid_height);
+  ASSERT_EQ(grid_width, 2u);
+  ASSERT_EQ(grid_height, 1u);
+  EXPECT_EQ(luma[0], (77 * 255 + 150 * 255) / 512);  // red and green
+  EXPECT_EQ(luma[1], 29 * 255 / 256);                 // blue alone
+
+  // Truncated: the sampled row is missing and reads as black.
+  DownsampleLuma(rgba.data(), 12, 12, 3, 2, 2, &luma, &grid_width,
+                 &grid_height);
+  EXPECT_EQ(luma[0], 0);
+}
+
+TEST(MotionGate, MaskedAbsDiffMatchesScalarAcrossVectorTail) {
+  // 37 bytes: two full vectors and a scalar tail.
+  std::vector<uint8_t> a(37);
+  std::vector<uint8_t> b(37);
+  std::vector<uint8_t> mask(37, 0xFF);
+  uint64_t expected_sum = 0;
+  uint64_t expected_changed = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = static_cast<uint8_t>(i * 7);
+    b[i] = static_cast<uint8_t>(255 - i * 3);
+    if (i % 5 == 0) mask[i] = 0;
+    if (!mask[i]) continue;
+    const int diff = std::abs(a[i] - b[i]);
+    expected_sum += static_cast<uint64_t>(diff);
+    if (diff > 40) ++expected_changed;
+  }
+  uint64_t sum = 0;
+  uint64_t changed = 0;
+  MaskedAbsDiff(a.data(), b.data(), mask.data(), a.size(), 40, &sum, &changed);
+  EXPECT_EQ(sum, expected_sum);
+  EXPECT_EQ(changed, expected_changed);
+}
+
+TEST(MotionGate, PassesFirstFrameAndMotionButNotAStaticScene) {
+  MotionGateOptions options;
+  options.keep_alive_ns = 0;
+  MotionGate gate(options);
+
+  EXPECT_EQ(gate.Evaluate(*GrayFrame(100), 0).reason,
+            MotionDecision::Reason::kFirstFrame);
+  const MotionDecision still = gate.Evaluate(*GrayFrame(100), kSecond);
+  EXPECT_FALSE(still.pass);
+  EXPECT_EQ(still.mean_diff, 0.0f);
+
+  // A small object: below the mean threshold, caught by changed cells.
+  std::shared_ptr<Frame> moved = GrayFrame(100);
+  PaintSquare(moved.get(), 8, 10, 4);
+  const MotionDecision motion = gate.Evaluate(*moved, 2 * kSecond);
+  EXPECT_TRUE(motion.pass);
+  EXPECT_EQ(motion.reason, MotionDecision::Reason::kMotion);
+  EXPECT_LT(motion.mean_diff, options.mean_threshold);
+  EXPECT_GT(motion.changed_fraction, 0.0f);
+
+  // The passed frame is the new reference.
+  EXPECT_FALSE(gate.Evaluate(*moved, 3 * kSecond).pass);
+}
+
+TEST(MotionGate, ReadsTheCoarsestFittingPyramidLevel) {
+  MotionGateOptions options;
+  options.keep_alive_ns = 0;
+  MotionGate gate(options);
+
+  std::shared_ptr<Frame> still = GrayFrame(100);
+  still->set_pyramid(FramePyramid::Build(*still, 3, nullptr));
+  EXPECT_TRUE(gate.Evaluate(*still, 0).pass);
+  EXPECT_FALSE(gate.Evaluate(*still, kSecond).pass);
+
+  // The full-resolution pixels are unchanged; only the 1/8 level, whose
+  // pixels are the 8x8 cells, shows the square.
+  std::shared_ptr<Frame> moved = GrayFrame(100);
+  PaintSquare(moved.get(), 8, 10, 4);
+  std::shared_ptr<Frame> same = GrayFrame(100);
+  same->set_pyramid(FramePyramid::Build(*moved, 3, nullptr));
+  const MotionDecision motion = gate.Evaluate(*same, 2 * kSecond);
+  EXPECT_TRUE(motion.pass);
+  EXPECT_GT(motion.changed_fraction, 0.0f);
+}
+
+TEST(MotionGate, AccumulatesSlowDriftAgainstTheLastPassedFrame) {
+  MotionGateOptions options;
+  options.mean_threshold = 3.0f;
+  options.changed_fraction = 0.0f;
+  options.keep_alive_ns = 0;
+  MotionGate gate(options);
+  gate.Evaluate(*GrayFrame(100), 0);
+  EXPECT_FALSE(gate.Evaluate(*GrayFrame(101), 1).pass);
+  EXPECT_FALSE(gate.Evaluate(*GrayFrame(102), 2).pass);
+  EXPECT_TRUE(gate.Evaluate(*GrayFrame(103), 3).pass);
+}
+
+TEST(MotionGate, IgnoresMotionOutsideRegionsAndKeepsAlive) {
+  MotionGateOptions options;
+  options.regions.push_back(MotionRegion{0.5f, 0.0f, 0.5f, 1.0f});
+  options.keep_alive_ns = 5 * kSecond;
+  MotionGate gate(options);
+  gate.Evaluate(*GrayFrame(100), 0);
+
+  std::shared_ptr<Frame> left = GrayFrame(100);
+  PaintSquare(left.get(), 0, 0, 16);
+  EXPECT_FALSE(gate.Evaluate(*left, kSecond).pass);
+
+  std::shared_ptr<Frame> right = GrayFrame(100);
+  PaintSquare(right.get(), 40, 16, 16);
+  EXPECT_TRUE(gate.Evaluate(*right, 2 * kSecond).pass);
+
+  EXPECT_FALSE(gate.Evaluate(*right, 6 * kSecond).pass);
+  const MotionDecision alive = gate.Evaluate(*right, 7 * kSecond);
+  EXPECT_TRUE(alive.pass);
+  EXPECT_EQ(alive.reason, MotionDecision::Reason::kKeepAlive);
+  EXPECT_STREQ(MotionReasonName(alive.reason), "keep-alive");
+}
+
+TEST(MotionGate, RestartsOnResolutionChangeAndReset) {
+  MotionGate gate;
+  gate.Evaluate(*GrayFrame(100), 0);
+  std::shared_ptr<Frame> small = Frame::Allocate(nullptr, 32, 32);
+  EXPECT_EQ(gate.Evaluate(*small, 1).reason,
+            MotionDecision::Reason::kFirstFrame);
+  gate.Reset();
+  EXPECT_EQ(gate.Evaluate(*small, 2).reason,
+            MotionDecision::Reason::kFirstFrame);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,122 @@
+#include "kataglyphis_native_core/object_tracker.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kMs = 1000000;
+
+Detection Box(float left, float top, float width, float height,
+              int32_t class_id = 0) {
+  Detection detection;
+  detection.left = left;
+  detection.top = top;
+  detection.width = width;
+  detection.height = height;
+  detection.score = 0.9f;
+  detection.class_id = class_id;
+  return detection;
+}
+
+DetectionSet Keyframe(std::vector<Detection> detections) {
+  DetectionSet set;
+  set.detections = std::move(detections);
+  return set;
+}
+
+}  // namespace
+
+TEST(ObjectTracker, ComputesIntersectionOverUnion) {
+  EXPECT_FLOAT_EQ(BoxIou(Box(0, 0, 10, 10), Box(0, 0, 10, 10)), 1.0f);
+  EXPECT_FLOAT_EQ(BoxIou(Box(0, 0, 10, 10), Box(5, 0, 10, 10)), 50.0f / 150.0f);
+  EXPECT_EQ(BoxIou(Box(0, 0, 10, 10), Box(20, 0, 10, 10)), 0.0f);
+  EXPECT_EQ(BoxIou(Box(0, 0, 0, 0), Box(0, 0, 0, 0)), 0.0f);
+}
+
+TEST(ObjectTracker, KeepsIdsAndExtrapolatesBetweenKeyframes) {
+  ObjectTracker tracker;
+  // Two objects; the first moves right at 100 px/s, the second stands.
+  for (int frame = 0; frame <= 5; ++frame) {
+    const float x = 100.0f + 10.0f * static_cast<float>(frame);
+    DetectionSet set = Keyframe({Box(x, 50, 40, 80), Box(400, 300, 40, 80)});
+    tracker.Update(&set, frame * 100 * kMs);
+    EXPECT_EQ(set.detections[0].track_id, 1);
+    EXPECT_EQ(set.detections[1].track_id, 2);
+  }
+  EXPECT_EQ(tracker.track_count(), 2u);
+
+  DetectionSet predicted;
+  tracker.Predict(550 * kMs, &predicted);
+  EXPECT_EQ(predicted.flags, kDetectionFlagPredicted);
+  ASSERT_EQ(predicted.detections.size(), 2u);
+  EXPECT_EQ(predicted.detections[0].track_id, 1);
+  // True position at 550 ms is 155; the filter has learned the velocity.
+  EXPECT_NEAR(predicted.detections[0].left, 155.0f, 2.0f);
+  EXPECT_NEAR(predicted.detections[0].width, 40.0f, 0.5f);
+  EXPECT_NEAR(predicted.detections[1].left, 400.0f, 0.5f);
+  EXPECT_EQ(predicted.detections[1].class_id, 0);
+  // Predicting does not move the tracks.
+  tracker.Predict(550 * kMs, &predicted);
+  EXPECT_NEAR(predicted.detections[0].left, 155.0f, 2.0f);
+}
+
+TEST(ObjectTracker, StartsNewTracksForOtherClassesAndFarBoxes) {
+  ObjectTracker tracker;
+  DetectionSet first = Keyframe({Box(0, 0, 20, 20, 1)});
+  tracker.Update(&first, 0);
+  DetectionSet second =
+      Keyframe({Box(0, 0, 20, 20, 2), Box(200, 200, 20, 20, 1)});
+  tracker.Update(&second, 33 * kMs);
+  EXPECT_EQ(second.detections[0].track_id, 2);
+  EXPECT_EQ(second.detections[1].track_id, 3);
+}
+
+TEST(ObjectTracker, DropsLostTracksAndStopsCoasting) {
+  ObjectTrackerOptions options;
+  options.max_misses = 1;
+  options.max_coast_ns = 300 * kMs;
+  ObjectTracker tracker(options);
+  DetectionSet set = Keyframe({Box(10, 10, 20, 20)});
+  tracker.Update(&set, 0);
+
+  DetectionSet predicted;
+  tracker.Predict(200 * kMs, &predicted);
+  EXPECT_EQ(predicted.detections.size(), 1u);
+  tracker.Predict(400 * kMs, &predicted);
+  EXPECT_TRUE(predicted.detections.empty());
+
+  DetectionSet empty;
+  tracker.Update(&empty, 100 * kMs);
+  EXPECT_EQ(tracker.track_count(), 1u);
+  tracker.Update(&empty, 200 * kMs);
+  EXPECT_EQ(tracker.track_count(), 0u);
+
+  tracker.Update(&set, 300 * kMs);
+  EXPECT_EQ(set.detections[0].track_id, 2);
+  tracker.Reset();
+  EXPECT_EQ(tracker.track_count(), 0u);
+}
+
+TEST(ObjectTracker, PassesKeyframesThroughWhileDisabled) {
+  ObjectTracker tracker(ObjectTrackerOptions(), false);
+  DetectionSet set = Keyframe({Box(10, 10, 20, 20)});
+  tracker.Update(&set, 0);
+  EXPECT_EQ(set.detections[0].track_id, -1);
+  EXPECT_EQ(tracker.track_count(), 0u);
+
+  tracker.Configure(true, ObjectTrackerOptions());
+  EXPECT_TRUE(tracker.enabled());
+  tracker.Update(&set, 0);
+  EXPECT_EQ(set.detections[0].track_id, 1);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,121 @@
+#include "kataglyphis_native_core/pipeline_controller.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+class PipelineControllerTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GstRuntime::Get().WaitUntilReady(); }
+};
+
+TEST_F(PipelineControllerTest, ReachesPlaying) {
+  PipelineController controller;
+  std::string error;
+  ASSERT_TRUE(controller.Load(
+      "videotestsrc is-live=false num-buffers=1000 ! fakesink sync=false",
+      &error))
+      << error;
+
+  const GstStateChangeReturn ret =
+      controller.SetState(GST_STATE_PLAYING, std::chrono::seconds(5));
+  EXPECT_EQ(ret, GST_STATE_CHANGE_SUCCESS) << StateChangeReturnToString(ret);
+
+  GstState current = GST_STATE_VOID_PENDING;
+  gst_element_get_state(controller.pipeline(), &current, nullptr, 0);
+  EXPECT_EQ(current, GST_STATE_PLAYING);
+}
+
+TEST_F(PipelineControllerTest, LiveSourceReportsNoPreroll) {
+  PipelineController controller;
+  std::string error;
+  ASSERT_TRUE(controller.Load("videotestsrc is-live=true ! fakesink",
+                              &error))
+      << error;
+  EXPECT_EQ(controller.SetState(GST_STATE_PAUSED, std::chrono::seconds(5)),
+            GST_STATE_CHANGE_NO_PREROLL);
+}
+
+TEST_F(PipelineControllerTest, RejectsUnparsableDescription) {
+  PipelineController controller;
+  std::string error;
+  EXPECT_FALSE(controller.Load("no_such_element_xyz ! fakesink", &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_EQ(controller.pipeline(), nullptr);
+}
+
+TEST_F(PipelineControllerTest, ReloadReleasesPreviousPipeline) {
+  PipelineController controller;
+  std::string error;
+  ASSERT_TRUE(controller.Load("videotestsrc ! fakesink", &error)) << error;
+  GstElement* first = controller.pipeline();
+  gst_object_ref(first);
+  ASSERT_NE(controller.SetState(GST_STATE_PLAYING, std::chrono::seconds(5)),
+            GST_STATE_CHANGE_FAILURE);
+
+  ASSERT_TRUE(controller.Load("videotestsrc ! fakesink", &error)) << error;
+  GstState state = GST_STATE_VOID_PENDING;
+  gst_element_get_state(first, &state, nullptr, 0);
+  EXPECT_EQ(state, GST_STATE_NULL);
+  EXPECT_EQ(GST_OBJECT_REFCOUNT_VALUE(first), 1);
+  gst_object_unref(first);
+}
+
+TEST_F(PipelineControllerTest, WaitsForEndOfStream) {
+  PipelineController controller;
+  std::string error;
+  ASSERT_TRUE(controller.Load(
+      "videotestsrc num-buffers=3 ! fakesink sync=false", &error))
+      << error;
+  EXPECT_FALSE(controller.WaitForEos(std::chrono::milliseconds(0), &error));
+
+  ASSERT_NE(controller.SetState(GST_STATE_PLAYING, std::chrono::seconds(5)),
+            GST_STATE_CHANGE_FAILURE);
+  EXPECT_TRUE(controller.WaitForEos(std::chrono::seconds(5), &error))
+      << error;
+  // Sticky until the next Load.
+  EXPECT_TRUE(controller.WaitForEos(std::chrono::milliseconds(0), &error));
+}
+
+TEST_F(PipelineControllerTest, WaitForEosReportsBusErrors) {
+  PipelineController controller;
+  std::string error;
+  ASSERT_TRUE(controller.Load(
+      "filesrc name=missing location=/nonexistent/kataglyphis ! fakesink",
+      &error))
+      << error;
+  gst_element_set_state(controller.pipeline(), GST_STATE_PLAYING);
+  EXPECT_FALSE(controller.WaitForEos(std::chrono::seconds(5), &error));
+  EXPECT_NE(error.find("missing"), std::string::npos) << error;
+}
+
+TEST_F(PipelineControllerTest, RecordsBusErrorsInSharedDiagnostics) {
+  auto diagnostics = std::make_shared<DiagnosticRing>(16);
+  PipelineController controller(diagnostics);
+  std::string error;
+  ASSERT_TRUE(controller.Load(
+      "filesrc name=missing location=/nonexistent/kataglyphis ! fakesink",
+      &error))
+      << error;
+  EXPECT_EQ(controller.SetState(GST_STATE_PAUSED, std::chrono::seconds(5)),
+            GST_STATE_CHANGE_FAILURE);
+
+  const std::vector<DiagnosticRecord> records = diagnostics->Recent(16);
+  ASSERT_FALSE(records.empty());
+  EXPECT_EQ(records.front().severity, DiagnosticSeverity::kError);
+  EXPECT_STREQ(records.front().source, "missing");
+  EXPECT_EQ(&controller.diagnostics(), diagnostics.get());
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,121 @@
+#include "kataglyphis_native_core/pipeline_profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+const ElementProfile* Find(const std::vector<ElementProfile>& profiles,
+                           const std::string& name) {
+  for (const ElementProfile& profile : profiles) {
+    if (profile.name == name) return &profile;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+class PipelineProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GstRuntime& runtime = GstRuntime::Get();
+    runtime.WaitUntilReady();
+    for (const char* element : {"videotestsrc", "videoconvert", "fakesink"}) {
+      if (!runtime.HasElement(element)) GTEST_SKIP() << "needs " << element;
+    }
+  }
+
+  void TearDown() override {
+    if (pipeline_) {
+      gst_element_set_state(pipeline_, GST_STATE_NULL);
+      gst_object_unref(pipeline_);
+    }
+  }
+
+  void Launch(const char* description) {
+    GError* error = nullptr;
+    pipeline_ = gst_parse_launch(description, &error);
+    ASSERT_NE(pipeline_, nullptr) << (error ? error->message : "");
+  }
+
+  void RunToEos() {
+    ASSERT_NE(gst_element_set_state(pipeline_, GST_STATE_PLAYING),
+              GST_STATE_CHANGE_FAILURE);
+    GstBus* bus = gst_element_get_bus(pipeline_);
+    GstMessage* message = gst_bus_timed_pop_filtered(
+        bus, 30 * GST_SECOND,
+        static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    ASSERT_NE(message, nullptr);
+    EXPECT_EQ(GST_MESSAGE_TYPE(message), GST_MESSAGE_EOS);
+    gst_message_unref(message);
+    gst_object_unref(bus);
+  }
+
+  GstElement* pipeline_ = nullptr;
+};
+
+TEST_F(PipelineProfilerTest, MeasuresEveryElementInPipelineOrder) {
+  Launch(
+      "videotestsrc name=src num-buffers=20 ! "
+      "video/x-raw,format=RGBA,width=64,height=48 ! "
+      "videoconvert name=convert ! queue name=q max-size-buffers=4 ! "
+      "fakesink name=sink");
+  PipelineProfiler profiler(pipeline_);
+  RunToEos();
+
+  const std::vector<ElementProfile> profiles = profiler.Snapshot();
+  ASSERT_GE(profiles.size(), 5u);  // plus the capsfilter
+  EXPECT_EQ(profiles.front().name, "src");
+  EXPECT_EQ(profiles.back().name, "sink");
+
+  const ElementProfile* src = Find(profiles, "src");
+  ASSERT_NE(src, nullptr);
+  EXPECT_EQ(src->buffers, 20u);
+  EXPECT_EQ(src->processing_samples, 0u);
+  EXPECT_GT(src->rate_hz, 0.0);
+
+  const ElementProfile* convert = Find(profiles, "convert");
+  ASSERT_NE(convert, nullptr);
+  EXPECT_EQ(convert->factory, "videoconvert");
+  EXPECT_EQ(convert->buffers, 20u);
+  EXPECT_EQ(convert->processing_samples, 20u);
+  EXPECT_GE(convert->processing_max_ms, convert->processing_p50_ms);
+
+  const ElementProfile* queue = Find(profiles, "q");
+  ASSERT_NE(queue, nullptr);
+  EXPECT_TRUE(queue->is_queue);
+  EXPECT_EQ(queue->queue_capacity, 4u);
+  EXPECT_LE(queue->queue_fill_max, 4u);
+  // The queue hands buffers to another thread.
+  EXPECT_EQ(queue->processing_samples, 0u);
+
+  const ElementProfile* sink = Find(profiles, "sink");
+  ASSERT_NE(sink, nullptr);
+  EXPECT_EQ(sink->buffers, 20u);
+  EXPECT_FALSE(sink->is_queue);
+
+  const std::string table = FormatProfileTable(profiles);
+  EXPECT_NE(table.find("videoconvert"), std::string::npos);
+  EXPECT_NE(table.find("/4"), std::string::npos);
+}
+
+TEST_F(PipelineProfilerTest, StopsCountingOnceDestroyed) {
+  Launch("videotestsrc name=src num-buffers=5 ! fakesink name=sink");
+  {
+    PipelineProfiler profiler(pipeline_);
+    EXPECT_EQ(profiler.Snapshot().size(), 2u);
+  }
+  // Running without probes must neither crash nor touch freed state.
+  RunToEos();
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
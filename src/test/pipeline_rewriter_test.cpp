@@ -0,0 +1,149 @@
+#include "kataglyphis_native_core/pipeline_rewriter.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr char kQueue[] =
+    "queue leaky=downstream max-size-buffers=2 max-size-bytes=0 "
+    "max-size-time=0 ! ";
+
+ElementFactoryIndex TestIndex() {
+  return ElementFactoryIndex(
+      {"videotestsrc", "v4l2src", "jpegdec", "videoconvert", "videoscale",
+       "appsink", "queue", "tee", "filesrc", "qtdemux", "h264parse",
+       "avdec_h264", "rtspsrc", "rtph264depay", "decodebin"});
+}
+
+PipelineRewriteOptions QueuesOnly() {
+  PipelineRewriteOptions options;
+  options.converter_threads = 0;
+  return options;
+}
+
+}  // namespace
+
+TEST(PipelineRewriter, InsertsQueuesAfterDecodersOnly) {
+  const PipelineRewrite rewrite =
+      RewritePipeline("v4l2src ! jpegdec ! videoconvert ! appsink name=sink",
+                      TestIndex(), QueuesOnly());
+  ASSERT_TRUE(rewrite.ok) << rewrite.error;
+  EXPECT_EQ(rewrite.description, std::string("v4l2src ! jpegdec ! ") +
+                                     kQueue +
+                                     "videoconvert ! appsink name=sink");
+  ASSERT_EQ(rewrite.changes.size(), 1u);
+  EXPECT_NE(rewrite.changes[0].find("after decoder 'jpegdec'"),
+            std::string::npos);
+  // The result still validates.
+  EXPECT_TRUE(ValidatePipeline(rewrite.description, TestIndex()).ok);
+}
+
+TEST(PipelineRewriter, NeverQueuesEncodedData) {
+  // Demuxers stay in pull mode and depayloaders see every packet.
+  const char* const encoded[] = {
+      "filesrc location=x.mp4 ! qtdemux ! h264parse ! avdec_h264 ! "
+      "videoconvert ! appsink",
+      "rtspsrc location=rtsp://cam ! rtph264depay ! h264parse ! "
+      "avdec_h264 ! videoconvert ! appsink",
+  };
+  for (const char* description : encoded) {
+    const PipelineRewrite rewrite =
+        RewritePipeline(description, TestIndex(), QueuesOnly());
+    ASSERT_TRUE(rewrite.ok) << rewrite.error;
+    const size_t decoder = rewrite.description.find("avdec_h264");
+    ASSERT_NE(decoder, std::string::npos);
+    EXPECT_EQ(rewrite.description.rfind("leaky", decoder), std::string::npos)
+        << rewrite.description;
+    EXPECT_EQ(rewrite.description,
+              std::string(description)
+                  .insert(std::string(description).find("videoconvert"),
+                          kQueue));
+  }
+
+  // An explicitly encoded caps filter in front of a decoder stays direct.
+  const std::string mjpeg = "v4l2src ! image/jpeg ! jpegdec ! appsink";
+  const PipelineRewrite rewrite =
+      RewritePipeline(mjpeg, TestIndex(), QueuesOnly());
+  ASSERT_TRUE(rewrite.ok) << rewrite.error;
+  EXPECT_EQ(rewrite.description,
+            std::string("v4l2src ! image/jpeg ! jpegdec ! ") + kQueue +
+                "appsink");
+}
+
+TEST(PipelineRewriter, KeepsCapsWithProducerAndExistingQueues) {
+  const PipelineRewrite with_caps = RewritePipeline(
+      "videotestsrc ! video/x-raw,width=64 ! videoconvert ! appsink",
+      TestIndex(), QueuesOnly());
+  ASSERT_TRUE(with_caps.ok) << with_caps.error;
+  EXPECT_EQ(with_caps.description,
+            std::string("videotestsrc ! video/x-raw,width=64 ! ") + kQueue +
+                "videoconvert ! appsink");
+  EXPECT_EQ(with_caps.changes.size(), 1u);
+
+  // Quoted caps are still raw video.
+  const PipelineRewrite quoted = RewritePipeline(
+      "filesrc ! decodebin ! \"video/x-raw,format=RGBA\" ! appsink",
+      TestIndex(), QueuesOnly());
+  ASSERT_TRUE(quoted.ok) << quoted.error;
+  EXPECT_EQ(quoted.description,
+            std::string("filesrc ! decodebin ! ") +
+                "\"video/x-raw,format=RGBA\" ! " + kQueue + "appsink");
+
+  const std::string queued =
+      "videotestsrc ! queue ! videoconvert ! appsink "
+      "tee name=t t. ! videoscale ! appsink";
+  const PipelineRewrite untouched =
+      RewritePipeline(queued, TestIndex(), QueuesOnly());
+  ASSERT_TRUE(untouched.ok) << untouched.error;
+  // Only the tee branch, which feeds a converter directly, gets a queue.
+  EXPECT_EQ(untouched.description,
+            "videotestsrc ! queue ! videoconvert ! appsink "
+            "tee name=t t. ! " + std::string(kQueue) + "videoscale ! appsink");
+  ASSERT_EQ(untouched.changes.size(), 1u);
+  EXPECT_NE(untouched.changes[0].find("before converter 'videoscale'"),
+            std::string::npos);
+}
+
+TEST(PipelineRewriter, RaisesConverterThreadsWhereSupported) {
+  PipelineRewriteOptions options;
+  options.insert_queues = false;
+  options.converter_threads = 3;
+  const std::string description =
+      "videotestsrc ! videoconvert ! videoscale n-threads=2 ! appsink";
+  const PipelineRewrite rewrite =
+      RewritePipeline(description, TestIndex(), options);
+  ASSERT_TRUE(rewrite.ok) << rewrite.error;
+  EXPECT_EQ(rewrite.description,
+            "videotestsrc ! videoconvert n-threads=3 ! "
+            "videoscale n-threads=2 ! appsink");
+  EXPECT_EQ(rewrite.changes.size(), 1u);
+
+  options.has_property = [](const std::string&, const std::string&) {
+    return false;
+  };
+  const PipelineRewrite unsupported =
+      RewritePipeline(description, TestIndex(), options);
+  EXPECT_EQ(unsupported.description, description);
+  EXPECT_TRUE(unsupported.changes.empty());
+}
+
+TEST(PipelineRewriter, ReportsValidationErrors) {
+  const PipelineRewrite rewrite =
+      RewritePipeline("videotestsrc ! nosuchelement ! appsink", TestIndex(),
+                      PipelineRewriteOptions());
+  EXPECT_FALSE(rewrite.ok);
+  EXPECT_NE(rewrite.error.find("nosuchelement"), std::string::npos);
+  EXPECT_TRUE(rewrite.description.empty());
+  EXPECT_GE(DefaultConverterThreads(), 1u);
+  EXPECT_LE(DefaultConverterThreads(), 4u);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,142 @@
+#include "kataglyphis_native_core/pipeline_session.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/session_table.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+// appsrc without data never prerolls, standing in for a slow camera open.
+constexpr const char* kStalledPipeline = "appsrc ! fakesink";
+constexpr const char* kFakeCamera =
+    "videotestsrc is-live=true ! video/x-raw,width=64,height=48 ! fakesink";
+
+class PipelineSessionTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GstRuntime::Get().WaitUntilReady(); }
+};
+
+TEST_F(PipelineSessionTest, PlaysFakeSourceAndStops) {
+  PipelineSession session;
+  ASSERT_TRUE(session.SetPipeline(kFakeCamera, nullptr, seconds(5)))
+      << session.last_error();
+  EXPECT_TRUE(session.Play(seconds(5)));
+  EXPECT_TRUE(session.Pause(seconds(5)));
+  EXPECT_TRUE(session.Stop());
+  EXPECT_FALSE(session.has_pipeline());
+  EXPECT_FALSE(session.Play(seconds(1)));
+}
+
+TEST_F(PipelineSessionTest, SlowPrerollDoesNotBlockOtherSessions) {
+  SessionTable<PipelineSession> sessions;
+  const int64_t slow_id = sessions.Add(std::make_shared<PipelineSession>());
+  const int64_t fast_id = sessions.Add(std::make_shared<PipelineSession>());
+
+  std::atomic<bool> slow_returned{false};
+  auto slow = std::async(std::launch::async, [&] {
+    const bool ok =
+        sessions.Find(slow_id)->SetPipeline(kStalledPipeline, nullptr,
+                                            seconds(3));
+    slow_returned = true;
+    return ok;
+  });
+
+  std::shared_ptr<PipelineSession> fast = sessions.Find(fast_id);
+  ASSERT_TRUE(fast->SetPipeline(kFakeCamera, nullptr, seconds(5)))
+      << fast->last_error();
+  EXPECT_TRUE(fast->Play(seconds(5)));
+  EXPECT_TRUE(fast->Stop());
+  EXPECT_FALSE(slow_returned.load());
+
+  EXPECT_FALSE(slow.get());
+  EXPECT_NE(sessions.Find(slow_id)->last_error().find("ASYNC"),
+            std::string::npos);
+}
+
+TEST_F(PipelineSessionTest, StopInterruptsPendingPreroll) {
+  PipelineSession session;
+  auto pending = std::async(std::launch::async, [&] {
+    return session.SetPipeline(kStalledPipeline, nullptr, seconds(20));
+  });
+  std::this_thread::sleep_for(milliseconds(200));
+
+  const auto start = std::chrono::steady_clock::now();
+  session.Stop();
+  ASSERT_EQ(pending.wait_for(seconds(5)), std::future_status::ready);
+  EXPECT_FALSE(pending.get());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, seconds(5));
+  EXPECT_NE(session.last_error().find("superseded"), std::string::npos);
+}
+
+TEST_F(PipelineSessionTest, PrepareRunsOnWorkerContextAndCanReject) {
+  PipelineSession session;
+  GMainContext* seen_context = nullptr;
+  const bool ok = session.SetPipeline(
+      kFakeCamera,
+      [&](GstElement*, std::string* error) {
+        seen_context = g_main_context_get_thread_default();
+        *error = "No video sink (glimagesink or appsink) found in pipeline";
+        return false;
+      },
+      seconds(5));
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(seen_context, session.worker_context());
+  EXPECT_NE(session.last_error().find("No video sink"), std::string::npos);
+  EXPECT_FALSE(session.has_pipeline());
+}
+
+TEST_F(PipelineSessionTest, RejectsInvalidDescriptionWithoutParsing) {
+  PipelineSession session;
+  EXPECT_FALSE(
+      session.SetPipeline("videotestsrc ! no_such_sink", nullptr, seconds(5)));
+  EXPECT_NE(session.last_error().find("no_such_sink"), std::string::npos);
+}
+
+TEST_F(PipelineSessionTest, CloseIsIdempotentAndRejectsNewPipelines) {
+  PipelineSession session;
+  ASSERT_TRUE(session.SetPipeline(kFakeCamera, nullptr, seconds(5)));
+  session.Close();
+  session.Close();
+  EXPECT_FALSE(session.has_pipeline());
+  EXPECT_FALSE(session.SetPipeline(kFakeCamera, nullptr, seconds(5)));
+}
+
+TEST_F(PipelineSessionTest, SeeksAndStepsPausedFileLikeSource) {
+  constexpr int64_t kFrameNs = 1000000000 / 25;
+  PipelineSession session;
+  ASSERT_TRUE(session.SetPipeline(
+      "videotestsrc ! video/x-raw,width=64,height=48,framerate=25/1 ! "
+      "fakesink",
+      nullptr, seconds(5)))
+      << session.last_error();
+
+  ASSERT_TRUE(session.Seek(40 * kFrameNs, seconds(5))) << session.last_error();
+  const int64_t seeked = session.position_ns();
+  EXPECT_GE(seeked, 40 * kFrameNs);
+  EXPECT_LT(seeked, 41 * kFrameNs);
+
+  ASSERT_TRUE(session.StepFrames(3, seconds(5))) << session.last_error();
+  const int64_t stepped = session.position_ns();
+  EXPECT_GT(stepped, seeked);
+
+  ASSERT_TRUE(session.StepFrames(-2, seconds(5))) << session.last_error();
+  EXPECT_LT(session.position_ns(), stepped);
+  EXPECT_TRUE(session.Stop());
+  EXPECT_FALSE(session.Seek(0, seconds(1)));
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,130 @@
+#include "kataglyphis_native_core/pipeline_validator.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+ElementFactoryIndex TestIndex() {
+  return ElementFactoryIndex({"videotestsrc", "videoconvert", "videoscale",
+                              "appsink", "queue", "tee", "fakesink",
+                              "capsfilter", "x264enc", "bin", "glupload",
+                              "v4l2src"});
+}
+
+std::vector<std::string> Factories(const PipelineValidation& result) {
+  std::vector<std::string> names;
+  for (const auto& element : result.elements) names.push_back(element.factory);
+  return names;
+}
+
+}  // namespace
+
+TEST(PipelineValidator, AcceptsLinearPipelineWithCaps) {
+  const PipelineValidation result = ValidatePipeline(
+      "videotestsrc pattern=ball is-live=true ! "
+      "video/x-raw,width=640,height=480,framerate=30/1 ! videoconvert ! "
+      "video/x-raw, format=(string)RGBA ! appsink name=sink sync=false",
+      TestIndex());
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(Factories(result),
+            (std::vector<std::string>{"videotestsrc", "videoconvert",
+                                      "appsink"}));
+}
+
+TEST(PipelineValidator, AcceptsTeeBranchesBinsAndQuotedValues) {
+  const PipelineValidation result = ValidatePipeline(
+      "v4l2src device=\"/dev/video0\" ! tee name=t "
+      "t. ! queue ! videoconvert ! appsink name=sink "
+      "t.src_1 ! queue leaky=downstream ! "
+      "\"video/x-raw(memory:GLMemory), format={ RGBA, BGRA }\" ! "
+      "bin.( name=inner queue ! fakesink ) "
+      "( queue ! fakesink )",
+      TestIndex());
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(Factories(result),
+            (std::vector<std::string>{"v4l2src", "tee", "queue",
+                                      "videoconvert", "appsink", "queue",
+                                      "bin", "queue", "fakesink", "bin",
+                                      "queue", "fakesink"}));
+}
+
+TEST(PipelineValidator, ReportsMissingElementAnywhereWithOffset) {
+  const std::string description =
+      "videotestsrc ! videoconvert ! x246enc ! fakesink";
+  const PipelineValidation result =
+      ValidatePipeline(description, TestIndex());
+  EXPECT_FALSE(result.ok);
+  EXPECT_EQ(result.error_offset, description.find("x246enc"));
+  EXPECT_EQ(result.missing_element, "x246enc");
+  EXPECT_NE(result.error.find("Missing GStreamer element 'x246enc'"),
+            std::string::npos);
+  EXPECT_NE(result.error.find("did you mean 'x264enc'"), std::string::npos);
+}
+
+TEST(PipelineValidator, RejectsStructuralErrors) {
+  const ElementFactoryIndex index = TestIndex();
+  EXPECT_FALSE(ValidatePipeline("", index).ok);
+  EXPECT_FALSE(ValidatePipeline("   ", index).ok);
+  EXPECT_FALSE(ValidatePipeline("videotestsrc !", index).ok);
+  EXPECT_FALSE(ValidatePipeline("! fakesink", index).ok);
+  EXPECT_FALSE(ValidatePipeline("videotestsrc ! ! fakesink", index).ok);
+  EXPECT_FALSE(ValidatePipeline("videotestsrc ! video/x-raw", index).ok);
+  EXPECT_FALSE(ValidatePipeline("video/x-raw ! fakesink", index).ok);
+  EXPECT_FALSE(ValidatePipeline("( queue ! fakesink", index).ok);
+  EXPECT_FALSE(ValidatePipeline("queue ! fakesink )", index).ok);
+  EXPECT_FALSE(ValidatePipeline("name=foo ! fakesink", index).ok);
+  EXPECT_FALSE(
+      ValidatePipeline("videotestsrc ! fakesink name=\"open", index).ok);
+}
+
+TEST(PipelineValidator, SkipsLookupsWithEmptyIndexAndAcceptsUris) {
+  const PipelineValidation result = ValidatePipeline(
+      "file:///tmp/clip.mp4 ! decodebin ! autovideosink",
+      ElementFactoryIndex());
+  ASSERT_TRUE(result.ok) << result.error;
+  ASSERT_EQ(result.elements.size(), 3u);
+  EXPECT_EQ(result.elements[0].kind, PipelineElementRef::Kind::kUri);
+}
+
+TEST(PipelineValidator, RecordsLinksAndElementExtents) {
+  const std::string description =
+      "videotestsrc is-live=true ! video/x-raw,width=64 ! queue ! "
+      "tee name=t t. ! fakesink";
+  const PipelineValidation result =
+      ValidatePipeline(description, TestIndex());
+  ASSERT_TRUE(result.ok) << result.error;
+  ASSERT_EQ(result.elements.size(), 4u);
+  EXPECT_EQ(description.substr(result.elements[0].offset,
+                               result.elements[0].end -
+                                   result.elements[0].offset),
+            "videotestsrc is-live=true");
+  EXPECT_EQ(description.substr(result.elements[2].offset,
+                               result.elements[2].end -
+                                   result.elements[2].offset),
+            "tee name=t");
+
+  ASSERT_EQ(result.links.size(), 4u);
+  EXPECT_EQ(result.links[0].upstream, 0);
+  EXPECT_EQ(result.links[0].downstream, -1);
+  EXPECT_TRUE(result.links[0].to_caps);
+  EXPECT_EQ(result.links[0].caps, "video/x-raw,width=64");
+  EXPECT_EQ(result.links[1].upstream, -1);
+  EXPECT_EQ(result.links[1].downstream, 1);
+  EXPECT_EQ(result.links[1].next_offset, description.find("queue"));
+  EXPECT_EQ(result.links[2].upstream, 1);
+  EXPECT_EQ(result.links[2].downstream, 2);
+  // `t. ! fakesink` starts from a name reference.
+  EXPECT_EQ(result.links[3].upstream, -1);
+  EXPECT_EQ(result.links[3].downstream, 3);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,43 @@
+#include "kataglyphis_native_core/pixel_convert.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(PixelConvert, CopiesStridedSourceAndPadsRemainder) {
+  // 2x2 source with 4 bytes of row padding, copied into a 3x3 destination.
+  std::vector<uint8_t> src = {1, 2, 3, 0, 4, 5, 6, 0, 9, 9, 9, 9,
+                              7, 8, 9, 0, 1, 1, 1, 0, 9, 9, 9, 9};
+  std::vector<uint8_t> dst(3 * 3 * 4, 0xAA);
+  CopyRgbaFrame(src.data(), src.size(), 12, 2, 2, dst.data(), 3, 3, true);
+
+  EXPECT_EQ(dst[0], 1);
+  EXPECT_EQ(dst[3], 255);       // alpha forced
+  EXPECT_EQ(dst[4 * 1 + 0], 4);
+  EXPECT_EQ(dst[4 * 2 + 0], 0);  // padded column
+  EXPECT_EQ(dst[12 + 0], 7);     // second row
+  EXPECT_EQ(dst[24 + 0], 0);     // padded row
+  EXPECT_EQ(dst[24 + 3], 255);
+}
+
+TEST(PixelConvert, SkipsRowsBeyondTruncatedSource) {
+  std::vector<uint8_t> src(8, 0x11);  // only one 2-pixel row present
+  std::vector<uint8_t> dst(2 * 2 * 4, 0xAA);
+  CopyRgbaFrame(src.data(), src.size(), 8, 2, 2, dst.data(), 2, 2, false);
+  EXPECT_EQ(dst[0], 0x11);
+  EXPECT_EQ(dst[8], 0x00);
+}
+
+TEST(PixelConvert, FillWritesOpaqueColor) {
+  std::vector<uint8_t> dst(2 * 4);
+  FillRgba(dst.data(), 2, 10, 20, 30);
+  EXPECT_EQ(dst, (std::vector<uint8_t>{10, 20, 30, 255, 10, 20, 30, 255}));
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,50 @@
+#include "kataglyphis_native_core/roi_detections.h"
+
+#include <gst/video/video.h>
+#include <gtest/gtest.h>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+class RoiDetectionsTest : public ::testing::Test {
+ protected:
+  void SetUp() override { GstRuntime::Get().WaitUntilReady(); }
+};
+
+TEST_F(RoiDetectionsTest, CollectsBoxesWithScoreAndClass) {
+  GstBuffer* buffer = gst_buffer_new();
+  GstVideoRegionOfInterestMeta* person =
+      gst_buffer_add_video_region_of_interest_meta(buffer, "person", 10, 20,
+                                                   30, 40);
+  gst_video_region_of_interest_meta_add_param(
+      person, gst_structure_new("detection", "confidence", G_TYPE_DOUBLE, 0.75,
+                                "label_id", G_TYPE_INT, 3, nullptr));
+  gst_buffer_add_video_region_of_interest_meta(buffer, "face", 1, 2, 3, 4);
+
+  DetectionSet set;
+  EXPECT_EQ(CollectRoiDetections(buffer, &set), 2u);
+  ASSERT_EQ(set.detections.size(), 2u);
+  EXPECT_EQ(set.detections[0].left, 10.0f);
+  EXPECT_EQ(set.detections[0].height, 40.0f);
+  EXPECT_FLOAT_EQ(set.detections[0].score, 0.75f);
+  EXPECT_EQ(set.detections[0].class_id, 3);
+  EXPECT_EQ(set.detections[1].score, 0.0f);
+  EXPECT_EQ(set.detections[1].class_id, -1);
+  gst_buffer_unref(buffer);
+}
+
+TEST_F(RoiDetectionsTest, IgnoresBuffersWithoutBoxes) {
+  GstBuffer* buffer = gst_buffer_new();
+  DetectionSet set;
+  EXPECT_EQ(CollectRoiDetections(buffer, &set), 0u);
+  EXPECT_EQ(CollectRoiDetections(nullptr, &set), 0u);
+  EXPECT_TRUE(set.detections.empty());
+  gst_buffer_unref(buffer);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,105 @@
+#include "kataglyphis_native_core/scrub_cache.h"
+
+#include <gtest/gtest.h>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kFrameNs = 40000000;  // 25 fps
+// 4x4 RGBA.
+constexpr size_t kFrameBytes = 4 * 4 * 4;
+
+FrameRef MakeFrame(int index) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 4, 4);
+  frame->set_timestamp_ns(index * kFrameNs);
+  return frame;
+}
+
+}  // namespace
+
+TEST(ScrubCache, LooksUpTheFrameOnScreenAndStepsThroughNeighbours) {
+  ScrubCache cache(16 * kFrameBytes);
+  for (int i = 0; i < 5; ++i) ASSERT_TRUE(cache.Insert(MakeFrame(i), kFrameNs));
+
+  FrameRef frame = cache.Lookup(2 * kFrameNs + kFrameNs / 2);
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(frame->timestamp_ns(), 2 * kFrameNs);
+  EXPECT_FALSE(cache.Lookup(5 * kFrameNs));
+
+  frame = cache.Step(2 * kFrameNs, 2);
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(frame->timestamp_ns(), 4 * kFrameNs);
+  frame = cache.Step(2 * kFrameNs, -2);
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(frame->timestamp_ns(), 0);
+  EXPECT_FALSE(cache.Step(4 * kFrameNs, 1));
+  EXPECT_FALSE(cache.Step(0, -1));
+
+  // A missing frame breaks the chain rather than skipping over it.
+  ASSERT_TRUE(cache.Insert(MakeFrame(7), kFrameNs));
+  EXPECT_FALSE(cache.Step(4 * kFrameNs, 1));
+
+  const ScrubCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.frames, 6u);
+  EXPECT_EQ(stats.bytes, 6 * kFrameBytes);
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+}
+
+TEST(ScrubCache, EvictsFramesBehindTheScrubDirectionFirst) {
+  ScrubCache cache(4 * kFrameBytes);
+  cache.SetPlayhead(4 * kFrameNs, /*direction=*/1);
+  for (int i = 2; i <= 6; ++i) cache.Insert(MakeFrame(i), kFrameNs);
+  // Frame 2 is two frames behind (weighted four), frame 6 two ahead.
+  EXPECT_FALSE(cache.Lookup(2 * kFrameNs));
+  EXPECT_TRUE(cache.Lookup(6 * kFrameNs));
+
+  cache.SetPlayhead(4 * kFrameNs, /*direction=*/-1);
+  ASSERT_TRUE(cache.Insert(MakeFrame(2), kFrameNs));
+  EXPECT_TRUE(cache.Lookup(2 * kFrameNs));
+  EXPECT_FALSE(cache.Lookup(6 * kFrameNs));
+
+  // Far behind a backward scrub, a frame is not worth its bytes.
+  EXPECT_FALSE(cache.Insert(MakeFrame(9), kFrameNs));
+  EXPECT_EQ(cache.stats().evictions, 3u);
+  EXPECT_EQ(cache.stats().bytes, 4 * kFrameBytes);
+}
+
+TEST(ScrubCache, FindsTheGapNearestThePlayheadInEitherDirection) {
+  ScrubCache cache(64 * kFrameBytes);
+  for (int i : {0, 1, 2, 5, 6, 9}) cache.Insert(MakeFrame(i), kFrameNs);
+
+  int64_t begin = 0;
+  int64_t end = 0;
+  ASSERT_TRUE(cache.FindGap(0, 12 * kFrameNs, 1, &begin, &end));
+  EXPECT_EQ(begin, 3 * kFrameNs);
+  EXPECT_EQ(end, 5 * kFrameNs);
+  ASSERT_TRUE(cache.FindGap(5 * kFrameNs, 12 * kFrameNs, 1, &begin, &end));
+  EXPECT_EQ(begin, 7 * kFrameNs);
+  EXPECT_EQ(end, 9 * kFrameNs);
+
+  ASSERT_TRUE(cache.FindGap(0, 10 * kFrameNs, -1, &begin, &end));
+  EXPECT_EQ(begin, 7 * kFrameNs);
+  EXPECT_EQ(end, 9 * kFrameNs);
+  ASSERT_TRUE(cache.FindGap(0, 12 * kFrameNs, -1, &begin, &end));
+  EXPECT_EQ(begin, 10 * kFrameNs);
+  EXPECT_EQ(end, 12 * kFrameNs);
+
+  EXPECT_FALSE(cache.FindGap(0, 3 * kFrameNs, 1, &begin, &end));
+  EXPECT_FALSE(cache.FindGap(5 * kFrameNs, 7 * kFrameNs, -1, &begin, &end));
+
+  // Rounded timestamps leave nanosecond slivers that are not gaps.
+  std::shared_ptr<Frame> late = Frame::Allocate(nullptr, 4, 4);
+  late->set_timestamp_ns(3 * kFrameNs + 1);
+  cache.Insert(late, kFrameNs);
+  ASSERT_TRUE(cache.FindGap(0, 12 * kFrameNs, 1, &begin, &end));
+  EXPECT_EQ(begin, 4 * kFrameNs + 1);
+  EXPECT_EQ(end, 5 * kFrameNs);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,43 @@
+#include "kataglyphis_native_core/session_table.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(SessionTable, HandsOutDistinctNonZeroIds) {
+  SessionTable<std::string> table;
+  const int64_t first = table.Add(std::make_shared<std::string>("a"));
+  const int64_t second = table.Add(std::make_shared<std::string>("b"));
+  EXPECT_NE(first, 0);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(*table.Find(second), "b");
+  EXPECT_EQ(table.Find(0), nullptr);
+}
+
+TEST(SessionTable, RemovedSessionOutlivesTheEntry) {
+  SessionTable<std::string> table;
+  const int64_t id = table.Add(std::make_shared<std::string>("camera"));
+  std::shared_ptr<std::string> in_use = table.Find(id);
+
+  std::shared_ptr<std::string> removed = table.Remove(id);
+  EXPECT_EQ(table.Find(id), nullptr);
+  EXPECT_EQ(table.Remove(id), nullptr);
+  EXPECT_EQ(removed, in_use);
+  EXPECT_EQ(*in_use, "camera");
+}
+
+TEST(SessionTable, RemoveAllEmptiesTheTable) {
+  SessionTable<int> table;
+  table.Add(std::make_shared<int>(1));
+  table.Add(std::make_shared<int>(2));
+  EXPECT_EQ(table.RemoveAll().size(), 2u);
+  EXPECT_EQ(table.size(), 0u);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,114 @@
+#include "kataglyphis_native_core/shared_frame_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+#if defined(__linux__)
+
+namespace {
+
+std::shared_ptr<Frame> Filled(uint32_t width, uint32_t height, uint8_t value,
+                              int64_t timestamp_ns) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, width, height);
+  std::fill(frame->mutable_data(), frame->mutable_data() + frame->size(),
+            value);
+  frame->set_timestamp_ns(timestamp_ns);
+  return frame;
+}
+
+// How a sidecar opens the ring of another process.
+std::string ProcPath(const SharedFrameRingWriter& writer) {
+  return "/proc/self/fd/" + std::to_string(writer.fd());
+}
+
+}  // namespace
+
+TEST(SharedFrameRing, ReaderSeesFramesThroughItsOwnMapping) {
+  std::string error;
+  std::unique_ptr<SharedFrameRingWriter> writer =
+      SharedFrameRingWriter::Create("test-ring", 3, 8 * 4 * 4, &error);
+  ASSERT_TRUE(writer) << error;
+  std::unique_ptr<SharedFrameRingReader> reader =
+      SharedFrameRingReader::Open(ProcPath(*writer), &error);
+  ASSERT_TRUE(reader) << error;
+
+  SharedFrameView view;
+  EXPECT_FALSE(reader->Acquire(&view));
+  EXPECT_FALSE(reader->WaitForFrame(0, 10));
+
+  // Row padding is dropped on the way in.
+  std::vector<uint8_t> padded(2 * 40, 7);
+  std::shared_ptr<Frame> strided =
+      Frame::Wrap(padded.data(), 8, 2, 40, padded.size(), nullptr);
+  strided->set_timestamp_ns(1000);
+  ASSERT_TRUE(writer->Write(*strided));
+  ASSERT_TRUE(reader->WaitForFrame(0, 0));
+  ASSERT_TRUE(reader->Acquire(&view));
+  EXPECT_EQ(view.sequence, 1u);
+  EXPECT_EQ(view.timestamp_ns, 1000);
+  EXPECT_EQ(view.width, 8u);
+  EXPECT_EQ(view.stride, 32u);
+  EXPECT_EQ(view.fourcc, kFourccRgba);
+  EXPECT_EQ(view.size, 64u);
+  EXPECT_EQ(view.data[63], 7);
+  EXPECT_TRUE(reader->Validate(view));
+
+  // Lapping the reader invalidates the slot it still looks at.
+  for (int i = 0; i < 3; ++i) writer->Write(*Filled(8, 4, 9, 2000 + i));
+  EXPECT_FALSE(reader->Validate(view));
+  std::vector<uint8_t> copy;
+  ASSERT_TRUE(reader->CopyLatest(&view, &copy));
+  EXPECT_EQ(view.sequence, 4u);
+  EXPECT_EQ(copy.size(), 8u * 4 * 4);
+  EXPECT_EQ(copy.back(), 9);
+
+  EXPECT_FALSE(writer->Write(*Filled(16, 16, 1, 0)));
+  EXPECT_EQ(writer->stats().written, 4u);
+  EXPECT_EQ(writer->stats().oversized, 1u);
+  // Nobody was blocked in WaitForFrame during any of these writes.
+  EXPECT_EQ(writer->stats().wakes, 0u);
+}
+
+TEST(SharedFrameRing, WaitWakesOnTheNextFrame) {
+  std::string error;
+  std::unique_ptr<SharedFrameRingWriter> writer =
+      SharedFrameRingWriter::Create("test-ring", 2, 64, &error);
+  ASSERT_TRUE(writer) << error;
+  std::unique_ptr<SharedFrameRingReader> reader =
+      SharedFrameRingReader::Open(ProcPath(*writer), &error);
+  ASSERT_TRUE(reader) << error;
+
+  std::thread producer([&writer] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writer->Write(*Filled(4, 4, 3, 0));
+  });
+  EXPECT_TRUE(reader->WaitForFrame(0, 5000));
+  producer.join();
+  EXPECT_EQ(reader->latest(), 1u);
+  EXPECT_EQ(writer->stats().wakes, 1u);
+
+  // The reader has left; the next frame skips the syscall.
+  writer->Write(*Filled(4, 4, 3, 0));
+  EXPECT_EQ(writer->stats().wakes, 1u);
+}
+
+TEST(SharedFrameRing, RejectsOtherFiles) {
+  std::string error;
+  EXPECT_FALSE(SharedFrameRingReader::Open("/proc/self/status", &error));
+  EXPECT_FALSE(error.empty());
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,97 @@
+#include "kataglyphis_native_core/snapshot_service.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <string>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+FrameRef TestFrame(int64_t timestamp_ns) {
+  std::shared_ptr<Frame> frame = Frame::Allocate(nullptr, 16, 8);
+  for (size_t i = 0; i < frame->size(); ++i) {
+    frame->mutable_data()[i] = static_cast<uint8_t>(i);
+  }
+  frame->set_timestamp_ns(timestamp_ns);
+  return frame;
+}
+
+}  // namespace
+
+TEST(SnapshotService, EncodesReferencedFrameOffThread) {
+  SnapshotService service(1);
+  FrameRef frame = TestFrame(42);
+  std::weak_ptr<const Frame> watched = frame;
+
+  std::promise<SnapshotResult> done;
+  SnapshotRequest request;
+  request.format = ImageFormat::kJpeg;
+  std::string error;
+  ASSERT_TRUE(service.Submit(
+      std::move(frame), request,
+      [&done](SnapshotResult result) { done.set_value(std::move(result)); },
+      &error))
+      << error;
+  std::future<SnapshotResult> future = done.get_future();
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  const SnapshotResult result = future.get();
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(result.width, 16u);
+  EXPECT_EQ(result.height, 8u);
+  EXPECT_EQ(result.timestamp_ns, 42);
+  EXPECT_EQ(result.bytes.front(), 0xFF);
+  // The frame went back to its producer before the callback.
+  EXPECT_TRUE(watched.expired());
+
+  EXPECT_FALSE(service.Submit(nullptr, request, nullptr, &error));
+  EXPECT_EQ(error, "No frame to snapshot yet");
+}
+
+TEST(SnapshotService, WritesFilesAndBoundsTheQueue) {
+  const std::string path = ::testing::TempDir() + "snapshot_service_test.png";
+  std::promise<SnapshotResult> written;
+  {
+    SnapshotService service(1, 2);
+    SnapshotRequest request;
+    request.path = path;
+    std::string error;
+    // Blocks the only worker until the queue has been probed.
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ASSERT_TRUE(service.Submit(
+        TestFrame(0), SnapshotRequest{ImageFormat::kRaw, 0, ""},
+        [released](SnapshotResult) { released.wait(); }, &error));
+    ASSERT_TRUE(service.Submit(
+        TestFrame(1), request,
+        [&written](SnapshotResult result) {
+          written.set_value(std::move(result));
+        },
+        &error));
+    EXPECT_FALSE(service.Submit(TestFrame(2), request, nullptr, &error));
+    EXPECT_EQ(error, "Too many snapshots in progress");
+    EXPECT_EQ(service.pending(), 2u);
+    release.set_value();
+  }
+  // The destructor finished the queue.
+  const SnapshotResult result = written.get_future().get();
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_TRUE(result.bytes.empty());
+  EXPECT_EQ(result.path, path);
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  ASSERT_TRUE(file);
+  std::fseek(file, 0, SEEK_END);
+  EXPECT_GT(std::ftell(file), 16 * 8 * 4);
+  std::fclose(file);
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,105 @@
+#include "kataglyphis_native_core/stats_aggregator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+constexpr int64_t kMs = 1000000;
+
+float FloatAt(const std::vector<uint8_t>& bytes, size_t offset) {
+  const uint32_t bits = uint32_t{bytes[offset]} |
+                        (uint32_t{bytes[offset + 1]} << 8) |
+                        (uint32_t{bytes[offset + 2]} << 16) |
+                        (uint32_t{bytes[offset + 3]} << 24);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+TEST(StatsAggregator, SummarizesAWindow) {
+  StatsAggregator stats;
+  stats.Start(0, 10);
+  // 100 frames at 10 ms intervals, each presented 1..100 ms after arrival.
+  for (int i = 1; i <= 100; ++i) {
+    const int64_t arrival = i * 10 * kMs;
+    stats.RecordArrival(static_cast<uint64_t>(i), arrival);
+    stats.RecordPresented(static_cast<uint64_t>(i), arrival + i * kMs / 10);
+  }
+  stats.RecordCopy(2 * kMs);
+  const StatsWindow window = stats.Collect(1000 * kMs, 13);
+
+  EXPECT_EQ(window.duration_ns, 1000 * kMs);
+  EXPECT_EQ(window.frames, 100u);
+  EXPECT_EQ(window.dropped, 3u);
+  EXPECT_FLOAT_EQ(window.fps, 100.0f);
+  EXPECT_EQ(window.latency.count, 100u);
+  EXPECT_FLOAT_EQ(window.latency.p50_ms, 5.0f);
+  EXPECT_FLOAT_EQ(window.latency.p95_ms, 9.5f);
+  EXPECT_FLOAT_EQ(window.latency.p99_ms, 9.9f);
+  EXPECT_FLOAT_EQ(window.latency.max_ms, 10.0f);
+  EXPECT_EQ(window.copy.count, 1u);
+  EXPECT_EQ(window.inference.count, 0u);
+
+  // The next window starts empty.
+  const StatsWindow next = stats.Collect(2000 * kMs, 13);
+  EXPECT_EQ(next.frames, 0u);
+  EXPECT_EQ(next.dropped, 0u);
+  EXPECT_EQ(next.latency.count, 0u);
+}
+
+TEST(StatsAggregator, CountsRepeatedPresentationsOnce) {
+  StatsAggregator stats;
+  stats.Start(0, 0);
+  stats.RecordArrival(1, 0);
+  stats.RecordPresented(1, 5 * kMs);
+  stats.RecordPresented(1, 20 * kMs);
+  // Never arrived in this window.
+  stats.RecordPresented(40, 20 * kMs);
+  const StatsWindow window = stats.Collect(100 * kMs, 0);
+  EXPECT_EQ(window.latency.count, 1u);
+  EXPECT_FLOAT_EQ(window.latency.max_ms, 5.0f);
+}
+
+TEST(StatsAggregator, KeepsTheNewestSamplesWhenFull) {
+  StatsAggregator stats(4);
+  stats.Start(0, 0);
+  for (int64_t i = 1; i <= 10; ++i) stats.RecordCopy(i * kMs);
+  const StatsWindow window = stats.Collect(kMs, 0);
+  EXPECT_EQ(window.copy.count, 10u);
+  EXPECT_FLOAT_EQ(window.copy.p50_ms, 8.0f);
+  EXPECT_FLOAT_EQ(window.copy.max_ms, 10.0f);
+}
+
+TEST(StatsAggregator, EncodesTheWireFormat) {
+  StatsWindow window;
+  window.end_ns = 5;
+  window.frames = 30;
+  window.fps = 29.5f;
+  window.latency.count = 2;
+  window.latency.p99_ms = 12.5f;
+  window.inference.max_ms = 40.0f;
+  std::vector<uint8_t> bytes;
+  EncodeStatsWindow(window, &bytes);
+  ASSERT_EQ(bytes.size(), kStatsWindowBytes);
+  EXPECT_EQ(std::memcmp(bytes.data(), "KGST", 4), 0);
+  EXPECT_EQ(bytes[6], kStatsWindowBytes);
+  EXPECT_EQ(bytes[8], 5u);
+  EXPECT_EQ(bytes[24], 30u);
+  EXPECT_FLOAT_EQ(FloatAt(bytes, 32), 29.5f);
+  EXPECT_EQ(bytes[40], 2u);
+  EXPECT_FLOAT_EQ(FloatAt(bytes, 52), 12.5f);
+  EXPECT_FLOAT_EQ(FloatAt(bytes, 96), 40.0f);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,101 @@
+#include "kataglyphis_native_core/streaming_thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+class StreamingThreadPoolTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GstRuntime::Get().WaitUntilReady(); }
+};
+
+TEST_F(StreamingThreadPoolTest, RunsStreamingTasksOnNamedPlacedThreads) {
+  const ThreadPlacementInfo self = DescribeCurrentThread();
+  StreamingThreadOptions options;
+  options.name_prefix = "kgst-test";
+  options.nice = self.nice + 1;
+  std::shared_ptr<StreamingThreadPool> pool =
+      StreamingThreadPool::Create(options);
+
+  PipelineController controller;
+  controller.set_task_pool(pool);
+  std::string error;
+  // Two streaming tasks: the source loop and the queue's output.
+  ASSERT_TRUE(controller.Load(
+      "videotestsrc is-live=true ! queue ! fakesink sync=false", &error))
+      << error;
+  ASSERT_NE(controller.SetState(GST_STATE_PLAYING, std::chrono::seconds(5)),
+            GST_STATE_CHANGE_FAILURE);
+
+  std::vector<ThreadPlacementInfo> threads;
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((threads = pool->Threads()).size() < 2 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  ASSERT_EQ(threads.size(), 2u) << pool->Describe();
+  for (const ThreadPlacementInfo& info : threads) {
+#if defined(__linux__)
+    EXPECT_EQ(info.name.rfind("kgst-test-", 0), 0u) << info.name;
+    EXPECT_EQ(info.nice, self.nice + 1);
+#endif
+    EXPECT_TRUE(info.error.empty()) << info.error;
+  }
+  EXPECT_NE(pool->Describe().find("kgst-test-"), std::string::npos);
+
+  // Stopping joins the tasks; their threads deregister.
+  controller.Release();
+  EXPECT_TRUE(pool->Threads().empty()) << pool->Describe();
+}
+
+TEST_F(StreamingThreadPoolTest, ReadsOptionsFromEnvironment) {
+  StreamingThreadOptions options;
+  std::string error;
+  unsetenv("KATAGLYPHIS_GST_CPUS");
+  unsetenv("KATAGLYPHIS_GST_NICE");
+  EXPECT_FALSE(StreamingThreadPool::OptionsFromEnvironment(&options, &error));
+
+  setenv("KATAGLYPHIS_GST_CPUS", "4-7", 1);
+  setenv("KATAGLYPHIS_GST_NICE", "5", 1);
+  ASSERT_TRUE(StreamingThreadPool::OptionsFromEnvironment(&options, &error))
+      << error;
+  EXPECT_EQ(options.cpus, (std::vector<int>{4, 5, 6, 7}));
+  ASSERT_TRUE(options.nice.has_value());
+  EXPECT_EQ(*options.nice, 5);
+
+  setenv("KATAGLYPHIS_GST_NICE", "99", 1);
+  EXPECT_FALSE(StreamingThreadPool::OptionsFromEnvironment(&options, &error));
+  EXPECT_NE(error.find("KATAGLYPHIS_GST_NICE"), std::string::npos);
+  unsetenv("KATAGLYPHIS_GST_CPUS");
+  unsetenv("KATAGLYPHIS_GST_NICE");
+}
+
+TEST_F(StreamingThreadPoolTest, DefaultPoolFollowsConfiguration) {
+  StreamingThreadPool::SetDefaultOptions(std::nullopt);
+  EXPECT_EQ(StreamingThreadPool::Default(), nullptr);
+
+  StreamingThreadOptions options;
+  options.name_prefix = "kgst-default";
+  StreamingThreadPool::SetDefaultOptions(options);
+  std::shared_ptr<StreamingThreadPool> pool = StreamingThreadPool::Default();
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(StreamingThreadPool::Default(), pool);
+  EXPECT_EQ(pool->options().name_prefix, "kgst-default");
+  StreamingThreadPool::SetDefaultOptions(std::nullopt);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
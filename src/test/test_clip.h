@@ -0,0 +1,35 @@
+#ifndef KATAGLYPHIS_NATIVE_CORE_TEST_TEST_CLIP_H_
+#define KATAGLYPHIS_NATIVE_CORE_TEST_TEST_CLIP_H_
+
+#include <chrono>
+#include <string>
+
+#include "kataglyphis_native_core/pipeline_controller.h"
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+// Writes a 30 fps, 64x48 motion-JPEG AVI of `frames` frames, every one a
+// keyframe. Needs videotestsrc, jpegenc and avimux.
+inline bool WriteTestClip(const std::string& path, int frames,
+                          std::string* error) {
+  PipelineController controller;
+  if (!controller.Load("videotestsrc num-buffers=" + std::to_string(frames) +
+                           " ! video/x-raw,width=64,height=48,framerate=30/1"
+                           " ! jpegenc ! avimux ! filesink location=\"" +
+                           path + "\"",
+                       error)) {
+    return false;
+  }
+  gst_element_set_state(controller.pipeline(), GST_STATE_PLAYING);
+  const bool ok = controller.WaitForEos(std::chrono::seconds(10), error);
+  controller.Release();
+  return ok;
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
+
+#endif  // KATAGLYPHIS_NATIVE_CORE_TEST_TEST_CLIP_H_
@@ -0,0 +1,59 @@
+#include "kataglyphis_native_core/thread_placement.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+TEST(ThreadPlacement, ParsesAndFormatsCpuLists) {
+  std::vector<int> cpus;
+  std::string error;
+  ASSERT_TRUE(ParseCpuList("4-7, 2,3 ,7", &cpus, &error)) << error;
+  EXPECT_EQ(cpus, (std::vector<int>{2, 3, 4, 5, 6, 7}));
+  EXPECT_EQ(FormatCpuList(cpus), "2-7");
+  EXPECT_EQ(FormatCpuList({0, 2, 3, 9}), "0,2-3,9");
+
+  EXPECT_TRUE(ParseCpuList("", &cpus, &error));
+  EXPECT_TRUE(cpus.empty());
+  EXPECT_FALSE(ParseCpuList("3-1", &cpus, &error));
+  EXPECT_FALSE(ParseCpuList("a", &cpus, &error));
+  EXPECT_FALSE(error.empty());
+}
+
+#if defined(__linux__)
+TEST(ThreadPlacement, AppliesNameAffinityAndNiceToCurrentThread) {
+  ThreadPlacementInfo before;
+  ThreadPlacementInfo after;
+  std::string error;
+  bool applied = false;
+  std::thread worker([&] {
+    before = DescribeCurrentThread();
+    ThreadPlacement placement;
+    placement.name = "kgst-media-test-long-name";
+    // Pin to one CPU the thread may already use; raising nice needs no
+    // privileges.
+    placement.cpus = {before.cpus.front()};
+    placement.nice = before.nice + 1;
+    applied = ApplyThreadPlacement(placement, &error);
+    after = DescribeCurrentThread();
+  });
+  worker.join();
+
+  ASSERT_FALSE(before.cpus.empty());
+  EXPECT_TRUE(applied) << error;
+  EXPECT_EQ(after.name, "kgst-media-test");
+  EXPECT_EQ(after.cpus, std::vector<int>{before.cpus.front()});
+  EXPECT_EQ(after.nice, before.nice + 1);
+  EXPECT_NE(FormatThreadPlacement(after).find("kgst-media-test tid="),
+            std::string::npos);
+}
+#endif
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,108 @@
+#include "kataglyphis_native_core/trace_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace kataglyphis_native_inference {
+namespace core {
+namespace test {
+
+namespace {
+
+size_t CountOf(const std::string& text, const std::string& needle) {
+  size_t count = 0;
+  for (size_t at = text.find(needle); at != std::string::npos;
+       at = text.find(needle, at + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+class TraceRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "trace_recorder_test.json";
+  }
+
+  void TearDown() override {
+    TraceRecorder::Get().Stop();
+    std::remove(path_.c_str());
+  }
+
+  std::string WriteAndRead(TraceStats* stats) {
+    std::string error;
+    EXPECT_TRUE(TraceRecorder::Get().WriteChromeTrace(path_, stats, &error))
+        << error;
+    std::ifstream file(path_);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+  }
+
+  std::string path_;
+};
+
+TEST_F(TraceRecorderTest, RecordsNothingWhileStopped) {
+  TraceRecorder::Get().Start();
+  TraceRecorder::Get().Stop();
+  { ScopedTrace scope("stopped_scope"); }
+  TraceInstant("stopped_instant");
+
+  TraceStats stats;
+  const std::string trace = WriteAndRead(&stats);
+  EXPECT_EQ(stats.events, 0u);
+  EXPECT_EQ(trace.find("stopped_"), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, WritesEventsOfEveryThread) {
+  TraceRecorder::Get().Start();
+  {
+    ScopedTrace scope("main_scope", "generation");
+    scope.set_arg(42);
+  }
+  std::thread worker([] {
+    ScopedTrace scope("worker_scope");
+    TraceInstant("worker_instant", "frame", 7);
+  });
+  worker.join();
+
+  TraceStats stats;
+  const std::string trace = WriteAndRead(&stats);
+  EXPECT_EQ(stats.events, 3u);
+  EXPECT_EQ(stats.threads, 2u);
+  EXPECT_EQ(stats.dropped, 0u);
+  EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0),
+            0u);
+  EXPECT_NE(trace.find("\"main_scope\""), std::string::npos);
+  EXPECT_NE(trace.find("\"generation\":42"), std::string::npos);
+  EXPECT_NE(trace.find("\"frame\":7"), std::string::npos);
+  EXPECT_EQ(CountOf(trace, "\"ph\":\"X\""), 2u);
+  EXPECT_EQ(CountOf(trace, "\"ph\":\"i\""), 1u);
+}
+
+TEST_F(TraceRecorderTest, DropsEventsBeyondTheThreadBuffer) {
+  TraceRecorder::Get().Start(2);
+  for (int i = 0; i < 5; ++i) TraceInstant("tick");
+  TraceStats stats;
+  WriteAndRead(&stats);
+  EXPECT_EQ(stats.events, 2u);
+  EXPECT_EQ(stats.dropped, 3u);
+
+  // A new session starts empty.
+  TraceRecorder::Get().Start(2);
+  TraceInstant("tock");
+  WriteAndRead(&stats);
+  EXPECT_EQ(stats.events, 1u);
+  EXPECT_EQ(stats.dropped, 0u);
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,236 @@
+#include "kataglyphis_native_core/thread_placement.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+void AddError(std::string* error, const std::string& message) {
+  if (!error) return;
+  if (!error->empty()) *error += "; ";
+  *error += message;
+}
+
+#if defined(__linux__)
+
+// Linux limits thread names to 16 bytes including the terminator.
+constexpr size_t kMaxThreadName = 15;
+
+int64_t CurrentThreadId() { return static_cast<int64_t>(syscall(SYS_gettid)); }
+
+#elif defined(_WIN32)
+
+int NiceToWindowsPriority(int nice) {
+  if (nice <= -10) return THREAD_PRIORITY_HIGHEST;
+  if (nice < 0) return THREAD_PRIORITY_ABOVE_NORMAL;
+  if (nice == 0) return THREAD_PRIORITY_NORMAL;
+  if (nice < 10) return THREAD_PRIORITY_BELOW_NORMAL;
+  return THREAD_PRIORITY_LOWEST;
+}
+
+int WindowsPriorityToNice(int priority) {
+  switch (priority) {
+    case THREAD_PRIORITY_TIME_CRITICAL:
+    case THREAD_PRIORITY_HIGHEST: return -10;
+    case THREAD_PRIORITY_ABOVE_NORMAL: return -5;
+    case THREAD_PRIORITY_BELOW_NORMAL: return 5;
+    case THREAD_PRIORITY_LOWEST:
+    case THREAD_PRIORITY_IDLE: return 10;
+    default: return 0;
+  }
+}
+
+#endif
+
+}  // namespace
+
+bool ApplyThreadPlacement(const ThreadPlacement& placement,
+                          std::string* error) {
+  bool ok = true;
+#if defined(__linux__)
+  if (!placement.name.empty()) {
+    const std::string name = placement.name.substr(0, kMaxThreadName);
+    if (prctl(PR_SET_NAME, name.c_str(), 0, 0, 0) != 0) {
+      AddError(error, std::string("name: ") + std::strerror(errno));
+      ok = false;
+    }
+  }
+  if (!placement.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : placement.cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+      AddError(error, "affinity " + FormatCpuList(placement.cpus) + ": " +
+                          std::strerror(errno));
+      ok = false;
+    }
+  }
+  if (placement.nice) {
+    // Per-thread on Linux: PRIO_PROCESS with a thread id.
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(CurrentThreadId()),
+                    *placement.nice) != 0) {
+      AddError(error, "nice " + std::to_string(*placement.nice) + ": " +
+                          std::strerror(errno));
+      ok = false;
+    }
+  }
+#elif defined(_WIN32)
+  const HANDLE thread = GetCurrentThread();
+  if (!placement.name.empty()) {
+    const std::wstring name(placement.name.begin(), placement.name.end());
+    if (FAILED(SetThreadDescription(thread, name.c_str()))) {
+      AddError(error, "name: SetThreadDescription failed");
+      ok = false;
+    }
+  }
+  if (!placement.cpus.empty()) {
+    DWORD_PTR mask = 0;
+    for (const int cpu : placement.cpus) {
+      if (cpu >= 0 && cpu < static_cast<int>(sizeof(mask) * 8)) {
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+      }
+    }
+    if (mask == 0 || SetThreadAffinityMask(thread, mask) == 0) {
+      AddError(error, "affinity " + FormatCpuList(placement.cpus) +
+                          ": SetThreadAffinityMask failed");
+      ok = false;
+    }
+  }
+  if (placement.nice &&
+      !SetThreadPriority(thread, NiceToWindowsPriority(*placement.nice))) {
+    AddError(error, "priority: SetThreadPriority failed");
+    ok = false;
+  }
+#else
+  if (!placement.name.empty() || !placement.cpus.empty() || placement.nice) {
+    AddError(error, "thread placement is not supported on this platform");
+    ok = false;
+  }
+#endif
+  return ok;
+}
+
+ThreadPlacementInfo DescribeCurrentThread() {
+  ThreadPlacementInfo info;
+#if defined(__linux__)
+  info.thread_id = CurrentThreadId();
+  char name[kMaxThreadName + 1] = {};
+  if (prctl(PR_GET_NAME, name, 0, 0, 0) == 0) info.name = name;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) info.cpus.push_back(cpu);
+    }
+  }
+  errno = 0;
+  const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(info.thread_id));
+  if (errno == 0) info.nice = nice;
+#elif defined(_WIN32)
+  info.thread_id = static_cast<int64_t>(GetCurrentThreadId());
+  PWSTR description = nullptr;
+  if (SUCCEEDED(GetThreadDescription(GetCurrentThread(), &description)) &&
+      description) {
+    for (const wchar_t* c = description; *c; ++c) {
+      info.name += static_cast<char>(*c < 0x80 ? *c : L'?');
+    }
+    LocalFree(description);
+  }
+  info.nice = WindowsPriorityToNice(GetThreadPriority(GetCurrentThread()));
+#endif
+  return info;
+}
+
+bool ParseCpuList(std::string_view text, std::vector<int>* cpus,
+                  std::string* error) {
+  std::vector<int> result;
+  size_t i = 0;
+  const auto read_number = [&](int* value) {
+    const size_t start = i;
+    long number = 0;
+    while (i < text.size() &&
+           std::isdigit(static_cast<unsigned char>(text[i])) != 0) {
+      number = number * 10 + (text[i] - '0');
+      if (number > 4095) return false;
+      ++i;
+    }
+    *value = static_cast<int>(number);
+    return i > start;
+  };
+
+  while (i < text.size()) {
+    if (text[i] == ' ' || text[i] == ',') {
+      ++i;
+      continue;
+    }
+    int first = 0;
+    if (!read_number(&first)) {
+      if (error) *error = "Invalid CPU list '" + std::string(text) + "'";
+      return false;
+    }
+    int last = first;
+    if (i < text.size() && text[i] == '-') {
+      ++i;
+      if (!read_number(&last) || last < first) {
+        if (error) *error = "Invalid CPU range in '" + std::string(text) + "'";
+        return false;
+      }
+    }
+    for (int cpu = first; cpu <= last; ++cpu) result.push_back(cpu);
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  *cpus = std::move(result);
+  return true;
+}
+
+std::string FormatCpuList(std::vector<int> cpus) {
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  std::string text;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t end = i;
+    while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1) ++end;
+    if (!text.empty()) text += ',';
+    text += std::to_string(cpus[i]);
+    if (end > i) text += '-' + std::to_string(cpus[end]);
+    i = end + 1;
+  }
+  return text;
+}
+
+std::string FormatThreadPlacement(const ThreadPlacementInfo& info) {
+  std::string line = info.name.empty() ? "<unnamed>" : info.name;
+  line += " tid=" + std::to_string(info.thread_id);
+  line += " cpus=" + (info.cpus.empty() ? "?" : FormatCpuList(info.cpus));
+  line += " nice=" + std::to_string(info.nice);
+  if (!info.error.empty()) line += " (" + info.error + ")";
+  return line;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -0,0 +1,142 @@
+// Offline batch processing of recorded footage.
+//
+// Decodes every frame of the given files (paths or URIs) with
+// BatchProcessor at full speed and writes one JSON line per frame:
+//
+//   kataglyphis_batch_process [--workers N] [--size WxH] [--out file.jsonl]
+//                             <file> [<file>...]
+//
+// Without --out the lines go to stdout; progress goes to stderr once per
+// second. KATAGLYPHIS_GST_CPUS / KATAGLYPHIS_GST_NICE place the streaming
+// threads as in the plugin.
+
+#include <gst/gst.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kataglyphis_native_core/batch_processor.h"
+
+namespace {
+
+using kataglyphis_native_inference::core::BatchOptions;
+using kataglyphis_native_inference::core::BatchProcessor;
+using kataglyphis_native_inference::core::BatchProgress;
+using kataglyphis_native_inference::core::BatchResult;
+using kataglyphis_native_inference::core::BatchResultWriter;
+using kataglyphis_native_inference::core::FormatBatchResultJson;
+using kataglyphis_native_inference::core::StreamingThreadOptions;
+using kataglyphis_native_inference::core::StreamingThreadPool;
+
+int Usage() {
+  std::fprintf(stderr,
+               "usage: kataglyphis_batch_process [--workers N] [--size WxH] "
+               "[--out file.jsonl] <file> [<file>...]\n");
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(nullptr, nullptr);
+
+  BatchOptions options;
+  std::string out_path;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--workers" && i + 1 < argc) {
+      options.workers = static_cast<uint32_t>(std::atoi(argv[++i]));
+    } else if (arg == "--size" && i + 1 < argc) {
+      unsigned width = 0;
+      unsigned height = 0;
+      if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2) return Usage();
+      options.width = width;
+      options.height = height;
+    } else if (arg == "--out" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (arg.rfind("--", 0) == 0) {
+      return Usage();
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if (inputs.empty()) return Usage();
+
+  StreamingThreadOptions pool_options;
+  std::string pool_error;
+  if (StreamingThreadPool::OptionsFromEnvironment(&pool_options,
+                                                  &pool_error)) {
+    options.task_pool = StreamingThreadPool::Create(pool_options);
+  } else if (!pool_error.empty()) {
+    std::fprintf(stderr, "%s\n", pool_error.c_str());
+    return 1;
+  }
+
+  BatchResultWriter writer;
+  std::string error;
+  if (!out_path.empty() && !writer.Open(out_path, inputs, &error)) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  BatchProcessor processor(options);
+  std::mutex done_mutex;
+  std::condition_variable done_changed;
+  bool done = false;
+  std::thread reporter([&] {
+    std::unique_lock<std::mutex> lock(done_mutex);
+    while (!done_changed.wait_for(lock, std::chrono::seconds(1),
+                                  [&] { return done; })) {
+      const BatchProgress progress = processor.progress();
+      std::fprintf(stderr, "segments %zu/%zu, %llu frames, %.1f fps\n",
+                   progress.segments_done, progress.segments_total,
+                   static_cast<unsigned long long>(progress.frames),
+                   progress.frames_per_second);
+    }
+  });
+
+  // No model is linked into the tool; frames are decoded and reported
+  // without a result payload.
+  const bool ok = processor.Run(
+      inputs, nullptr,
+      [&](const BatchResult& result) {
+        if (!out_path.empty()) {
+          writer.Write(result);
+        } else {
+          std::printf("%s\n",
+                      FormatBatchResultJson(result, inputs[result.file_index])
+                          .c_str());
+        }
+      },
+      &error);
+
+  {
+    std::lock_guard<std::mutex> lock(done_mutex);
+    done = true;
+  }
+  done_changed.notify_all();
+  reporter.join();
+
+  std::string close_error;
+  if (!out_path.empty() && !writer.Close(&close_error)) {
+    std::fprintf(stderr, "%s\n", close_error.c_str());
+    return 1;
+  }
+  const BatchProgress progress = processor.progress();
+  std::fprintf(stderr, "%s: %llu frames in %.2f s (%.1f fps)\n",
+               ok ? "done" : "failed",
+               static_cast<unsigned long long>(progress.frames),
+               progress.elapsed_s, progress.frames_per_second);
+  if (!ok) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+  return 0;
+}
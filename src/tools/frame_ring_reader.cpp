@@ -0,0 +1,78 @@
+// Minimal sidecar for the plugin's shared-memory frame export.
+//
+// Maps the ring read-only and prints one line per frame it sees:
+//
+//   kataglyphis_frame_ring_reader /proc/<pid>/fd/<fd> [--frames N]
+//
+// The path is what `exportFrames` returns. Frames are used in place: the
+// line is only printed if the slot was not overwritten meanwhile, which is
+// the pattern an analytics sidecar follows around its own processing.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "kataglyphis_native_core/shared_frame_ring.h"
+
+namespace {
+
+using kataglyphis_native_inference::core::SharedFrameRingReader;
+using kataglyphis_native_inference::core::SharedFrameView;
+
+int Usage() {
+  std::fprintf(stderr,
+               "usage: kataglyphis_frame_ring_reader <ring path> "
+               "[--frames N]\n");
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2 && !(argc == 4 && std::strcmp(argv[2], "--frames") == 0)) {
+    return Usage();
+  }
+  const long limit = argc == 4 ? std::strtol(argv[3], nullptr, 10) : -1;
+
+  std::string error;
+  std::unique_ptr<SharedFrameRingReader> reader =
+      SharedFrameRingReader::Open(argv[1], &error);
+  if (!reader) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  uint64_t last = 0;
+  long seen = 0;
+  uint64_t torn = 0;
+  while (limit < 0 || seen < limit) {
+    if (!reader->WaitForFrame(last, 5000)) {
+      std::fprintf(stderr, "no frame for 5 s\n");
+      continue;
+    }
+    SharedFrameView view;
+    if (!reader->Acquire(&view)) continue;
+    // A real consumer runs its model on view.data here.
+    unsigned checksum = 0;
+    for (size_t i = 0; i < view.size; i += 4096) checksum += view.data[i];
+    if (!reader->Validate(view)) {
+      ++torn;
+      continue;
+    }
+    if (last != 0 && view.sequence > last + 1) {
+      std::printf("skipped %llu\n",
+                  static_cast<unsigned long long>(view.sequence - last - 1));
+    }
+    std::printf("frame %llu pts=%lld %ux%u checksum=%u\n",
+                static_cast<unsigned long long>(view.sequence),
+                static_cast<long long>(view.timestamp_ns), view.width,
+                view.height, checksum);
+    last = view.sequence;
+    ++seen;
+  }
+  std::fprintf(stderr, "%ld frames, %llu overwritten while in use\n", seen,
+               static_cast<unsigned long long>(torn));
+  return 0;
+}
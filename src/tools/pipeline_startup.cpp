@@ -0,0 +1,189 @@
+// Headless startup-latency harness.
+//
+// Measures, for a pipeline description, how long it takes from "set the
+// pipeline" to PLAYING and to the first frame arriving at an appsink named
+// `sink`. Descriptions without such a sink get one appended.
+//
+//   kataglyphis_pipeline_startup [runs] ["<pipeline description>"]
+//
+// With KATAGLYPHIS_GST_CPUS / KATAGLYPHIS_GST_NICE set, streaming threads run
+// in a StreamingThreadPool and their placement is printed for the first run.
+// With KATAGLYPHIS_GST_AUTO_THREADS=1 the description goes through
+// RewritePipeline() first and the changes are printed, to compare startup
+// and throughput with and without the extra thread boundaries.
+// With KATAGLYPHIS_GST_PROFILE=<seconds> the first run keeps playing that
+// long after its first frame under a PipelineProfiler and prints the
+// per-element table (not counted in the startup numbers).
+
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "kataglyphis_native_core/gst_runtime.h"
+#include "kataglyphis_native_core/pipeline_controller.h"
+#include "kataglyphis_native_core/pipeline_profiler.h"
+#include "kataglyphis_native_core/pipeline_rewriter.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using kataglyphis_native_inference::core::DefaultConverterThreads;
+using kataglyphis_native_inference::core::FormatDiagnostic;
+using kataglyphis_native_inference::core::FormatProfileTable;
+using kataglyphis_native_inference::core::GstRuntime;
+using kataglyphis_native_inference::core::PipelineController;
+using kataglyphis_native_inference::core::PipelineProfiler;
+using kataglyphis_native_inference::core::PipelineRewrite;
+using kataglyphis_native_inference::core::PipelineRewriteOptions;
+using kataglyphis_native_inference::core::RewritePipeline;
+using kataglyphis_native_inference::core::StateChangeReturnToString;
+using kataglyphis_native_inference::core::StreamingThreadOptions;
+using kataglyphis_native_inference::core::StreamingThreadPool;
+
+constexpr const char* kDefaultPipeline =
+    "videotestsrc is-live=true ! video/x-raw,width=1280,height=720 ! "
+    "videoconvert ! video/x-raw,format=RGBA ! "
+    "appsink name=sink emit-signals=true sync=false max-buffers=1 drop=true";
+
+struct FirstFrame {
+  std::mutex mutex;
+  std::condition_variable arrived;
+  bool seen = false;
+};
+
+GstFlowReturn OnNewSample(GstAppSink* sink, gpointer user_data) {
+  auto* first = static_cast<FirstFrame*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (sample) gst_sample_unref(sample);
+  std::lock_guard<std::mutex> lock(first->mutex);
+  first->seen = true;
+  first->arrived.notify_all();
+  return GST_FLOW_OK;
+}
+
+double Ms(Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(nullptr, nullptr);
+
+  const int runs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+  std::string description = argc > 2 ? argv[2] : kDefaultPipeline;
+
+  const char* auto_threads = std::getenv("KATAGLYPHIS_GST_AUTO_THREADS");
+  if (auto_threads && std::string(auto_threads) == "1") {
+    GstRuntime& runtime = GstRuntime::Get();
+    PipelineRewriteOptions options;
+    options.converter_threads = DefaultConverterThreads();
+    options.has_property = [&runtime](const std::string& factory,
+                                      const std::string& property) {
+      return runtime.HasElementProperty(factory, property);
+    };
+    PipelineRewrite rewrite =
+        RewritePipeline(description, runtime.element_index(), options);
+    if (!rewrite.ok) {
+      std::fprintf(stderr, "rewrite failed: %s\n", rewrite.error.c_str());
+      return 1;
+    }
+    for (const std::string& change : rewrite.changes) {
+      std::printf("rewrite: %s\n", change.c_str());
+    }
+    description = std::move(rewrite.description);
+    std::printf("pipeline: %s\n", description.c_str());
+  }
+
+  const char* profile = std::getenv("KATAGLYPHIS_GST_PROFILE");
+  const double profile_seconds = profile ? std::atof(profile) : 0.0;
+
+  std::shared_ptr<StreamingThreadPool> pool;
+  StreamingThreadOptions pool_options;
+  std::string pool_error;
+  if (StreamingThreadPool::OptionsFromEnvironment(&pool_options,
+                                                  &pool_error)) {
+    pool = StreamingThreadPool::Create(pool_options);
+  } else if (!pool_error.empty()) {
+    std::fprintf(stderr, "%s\n", pool_error.c_str());
+    return 1;
+  }
+
+  std::vector<double> playing_ms;
+  std::vector<double> first_frame_ms;
+  for (int i = 0; i < runs; ++i) {
+    FirstFrame first;
+    PipelineController controller;
+    controller.set_task_pool(pool);
+    const auto start = Clock::now();
+
+    std::string error;
+    if (!controller.Load(description, &error)) {
+      std::fprintf(stderr, "load failed: %s\n", error.c_str());
+      return 1;
+    }
+    GstElement* sink =
+        gst_bin_get_by_name(GST_BIN(controller.pipeline()), "sink");
+    if (!sink || !GST_IS_APP_SINK(sink)) {
+      std::fprintf(stderr, "pipeline needs an appsink named 'sink'\n");
+      if (sink) gst_object_unref(sink);
+      return 1;
+    }
+    g_object_set(sink, "emit-signals", TRUE, nullptr);
+    g_signal_connect(sink, "new-sample", G_CALLBACK(OnNewSample), &first);
+    gst_object_unref(sink);
+
+    const GstStateChangeReturn ret =
+        controller.SetState(GST_STATE_PLAYING, std::chrono::seconds(10));
+    const auto playing = Clock::now();
+    if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+      std::fprintf(stderr, "PLAYING not reached: %s\n",
+                   StateChangeReturnToString(ret));
+      for (const auto& record : controller.diagnostics().Recent(32)) {
+        std::fprintf(stderr, "  %s\n", FormatDiagnostic(record).c_str());
+      }
+      return 1;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(first.mutex);
+      if (!first.arrived.wait_for(lock, std::chrono::seconds(10),
+                                  [&] { return first.seen; })) {
+        std::fprintf(stderr, "no frame within 10 s\n");
+        return 1;
+      }
+    }
+    const auto frame = Clock::now();
+    if (pool && i == 0) std::printf("%s\n", pool->Describe().c_str());
+    if (profile_seconds > 0 && i == 0) {
+      PipelineProfiler profiler(controller.pipeline());
+      std::this_thread::sleep_for(
+          std::chrono::duration<double>(profile_seconds));
+      std::printf("%s\n", FormatProfileTable(profiler.Snapshot()).c_str());
+    }
+    controller.Release();
+
+    playing_ms.push_back(Ms(playing - start));
+    first_frame_ms.push_back(Ms(frame - start));
+    std::printf("run %d: playing %.2f ms, first frame %.2f ms\n", i,
+                playing_ms.back(), first_frame_ms.back());
+  }
+
+  std::sort(playing_ms.begin(), playing_ms.end());
+  std::sort(first_frame_ms.begin(), first_frame_ms.end());
+  std::printf("median: playing %.2f ms, first frame %.2f ms\n",
+              playing_ms[playing_ms.size() / 2],
+              first_frame_ms[first_frame_ms.size() / 2]);
+  return 0;
+}
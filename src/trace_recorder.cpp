@@ -0,0 +1,189 @@
+#include "kataglyphis_native_core/trace_recorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace kataglyphis_native_inference {
+namespace core {
+
+namespace {
+
+int ProcessId() {
+#if defined(_WIN32)
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif
+}
+
+std::string CurrentThreadName() {
+#if defined(__linux__) || defined(__ANDROID__)
+  char name[16] = {};
+  if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+    return name;
+  }
+#endif
+  return std::string();
+}
+
+// Names are literals from our own trace points; escaping keeps the file
+// valid JSON anyway.
+void WriteJsonString(std::FILE* file, const char* text) {
+  std::fputc('"', file);
+  for (const char* c = text; *c; ++c) {
+    if (*c == '"' || *c == '\\') std::fputc('\\', file);
+    if (static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, file);
+  }
+  std::fputc('"', file);
+}
+
+}  // namespace
+
+// static
+TraceRecorder& TraceRecorder::Get() {
+  // Leaked: trace points may run in threads that outlive static
+  // destruction.
+  static TraceRecorder* recorder = new TraceRecorder();
+  return *recorder;
+}
+
+// static
+int64_t TraceRecorder::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void TraceRecorder::Start(size_t events_per_thread) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Threads still holding an old buffer switch on their next event; the
+  // old buffer dies with their reference.
+  buffers_.clear();
+  events_per_thread_ = std::max<size_t>(events_per_thread, 1);
+  next_tid_ = 1;
+  session_.fetch_add(1, std::memory_order_acq_rel);
+  enabled_.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::Stop() { enabled_.store(false, std::memory_order_release); }
+
+void TraceRecorder::RecordComplete(const char* name, int64_t start_ns,
+                                   int64_t end_ns, const char* arg_name,
+                                   int64_t arg) {
+  Record(Event{name, arg_name, start_ns, std::max<int64_t>(end_ns - start_ns, 0),
+               arg});
+}
+
+void TraceRecorder::RecordInstant(const char* name, const char* arg_name,
+                                  int64_t arg) {
+  Record(Event{name, arg_name, NowNs(), -1, arg});
+}
+
+void TraceRecorder::Record(const Event& event) {
+  ThreadBuffer* buffer = BufferForThisThread();
+  const size_t index = buffer->count.load(std::memory_order_relaxed);
+  if (index >= buffer->capacity) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer->events[index] = event;
+  buffer->count.store(index + 1, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::BufferForThisThread() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (buffer &&
+      buffer->session == session_.load(std::memory_order_acquire)) {
+    return buffer.get();
+  }
+  // First event of this thread in the session.
+  auto fresh = std::make_shared<ThreadBuffer>();
+  fresh->thread_name = CurrentThreadName();
+  std::lock_guard<std::mutex> lock(mutex_);
+  fresh->session = session_.load(std::memory_order_acquire);
+  fresh->tid = next_tid_++;
+  fresh->capacity = events_per_thread_;
+  fresh->events.reset(new Event[fresh->capacity]);
+  buffers_.push_back(fresh);
+  buffer = std::move(fresh);
+  return buffer.get();
+}
+
+bool TraceRecorder::WriteChromeTrace(const std::string& path,
+                                     TraceStats* stats,
+                                     std::string* error) const {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers = buffers_;
+  }
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    *error = "Cannot open '" + path + "': " + std::strerror(errno);
+    return false;
+  }
+
+  TraceStats totals;
+  totals.threads = buffers.size();
+  const int pid = ProcessId();
+  bool first = true;
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+  for (const auto& buffer : buffers) {
+    if (!buffer->thread_name.empty()) {
+      std::fprintf(file,
+                   "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+                   "\"tid\":%" PRIu32 ",\"args\":{\"name\":",
+                   first ? "" : ",", pid, buffer->tid);
+      WriteJsonString(file, buffer->thread_name.c_str());
+      std::fputs("}}", file);
+      first = false;
+    }
+    const size_t count = buffer->count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+      const Event& event = buffer->events[i];
+      std::fprintf(file, "%s\n{\"name\":", first ? "" : ",");
+      WriteJsonString(file, event.name);
+      // Chrome traces count in microseconds.
+      std::fprintf(file,
+                   ",\"cat\":\"kataglyphis\",\"pid\":%d,\"tid\":%" PRIu32
+                   ",\"ts\":%.3f",
+                   pid, buffer->tid, static_cast<double>(event.start_ns) / 1e3);
+      if (event.duration_ns >= 0) {
+        std::fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f",
+                     static_cast<double>(event.duration_ns) / 1e3);
+      } else {
+        std::fputs(",\"ph\":\"i\",\"s\":\"t\"", file);
+      }
+      if (event.arg_name) {
+        std::fputs(",\"args\":{", file);
+        WriteJsonString(file, event.arg_name);
+        std::fprintf(file, ":%" PRId64 "}", event.arg);
+      }
+      std::fputc('}', file);
+      first = false;
+    }
+    totals.events += count;
+    totals.dropped += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  std::fputs("\n]}\n", file);
+  if (std::fclose(file) != 0) {
+    *error = "Writing '" + path + "' failed";
+    return false;
+  }
+  if (stats) *stats = totals;
+  return true;
+}
+
+}  // namespace core
+}  // namespace kataglyphis_native_inference
@@ -10,8 +10,10 @@
 
 #include <memory>
 #include <sstream>
+#include <string>
 
 #include "kataglyphis_c_api.h"
+#include "kataglyphis_native_core/trace_recorder.h"
 #include "kataglyphis_texture.h"
 
 namespace kataglyphis_native_inference {
@@ -133,6 +135,60 @@ bool TextureMethodCall(const flutter::MethodCall<flutter::EncodableValue>& call,
   return false;
 }
 
+// startTrace {eventsPerThread?} / stopTrace {path?}; see the Linux plugin.
+bool TraceMethodCall(const flutter::MethodCall<flutter::EncodableValue>& call,
+                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>& result) {
+  const std::string& method = call.method_name();
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  auto lookup = [args](const char* key) -> const flutter::EncodableValue* {
+    if (!args) return nullptr;
+    auto it = args->find(flutter::EncodableValue(key));
+    return it == args->end() ? nullptr : &it->second;
+  };
+
+  if (method == "startTrace") {
+    size_t events = core::TraceRecorder::kDefaultEventsPerThread;
+    if (const auto* value = lookup("eventsPerThread")) {
+      if (const int* count = std::get_if<int>(value)) {
+        events = static_cast<size_t>(*count > 0 ? *count : 1);
+      }
+    }
+    core::TraceRecorder::Get().Start(events);
+    result->Success(flutter::EncodableValue());
+    return true;
+  }
+  if (method == "stopTrace") {
+    std::string path;
+    if (const auto* value = lookup("path")) {
+      if (const auto* given = std::get_if<std::string>(value)) path = *given;
+    }
+    if (path.empty()) {
+      char temp_dir[MAX_PATH + 1] = {};
+      GetTempPathA(MAX_PATH + 1, temp_dir);
+      path = std::string(temp_dir) + "kataglyphis_trace_" +
+             std::to_string(GetCurrentProcessId()) + ".json";
+    }
+    core::TraceRecorder::Get().Stop();
+    core::TraceStats stats;
+    std::string error;
+    if (!core::TraceRecorder::Get().WriteChromeTrace(path, &stats, &error)) {
+      result->Error("trace_error", error);
+      return true;
+    }
+    flutter::EncodableMap summary;
+    summary[flutter::EncodableValue("path")] = flutter::EncodableValue(path);
+    summary[flutter::EncodableValue("events")] =
+        flutter::EncodableValue(static_cast<int64_t>(stats.events));
+    summary[flutter::EncodableValue("dropped")] =
+        flutter::EncodableValue(static_cast<int64_t>(stats.dropped));
+    summary[flutter::EncodableValue("threads")] =
+        flutter::EncodableValue(static_cast<int64_t>(stats.threads));
+    result->Success(flutter::EncodableValue(summary));
+    return true;
+  }
+  return false;
+}
+
 }  // namespace
 
 void KataglyphisNativeInferencePlugin::HandleMethodCall(
@@ -211,6 +267,7 @@ void KataglyphisNativeInferencePlugin::HandleMethodCall(
     OutputDebugStringA("[kataglyphis] Texture registered successfully\n");
 
     result->Success(flutter::EncodableValue(texture_id));
+  } else if (TraceMethodCall(method_call, result)) {
   } else if (TextureMethodCall(method_call, texture_, std::move(result))) {
   } else {
     result->NotImplemented();
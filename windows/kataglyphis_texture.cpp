@@ -2,9 +2,12 @@
 
 #include <windows.h>
 
-#include <algorithm>
-#include <cstring>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
+
+#include "kataglyphis_native_core/trace_recorder.h"
 
 namespace kataglyphis_native_inference {
 
@@ -13,22 +16,17 @@ KataglyphisTexture::KataglyphisTexture(uint32_t width, uint32_t height, uint8_t
     : texture_id_(-1),
       width_(width),
       height_(height),
-      buffer_(new uint8_t[width * height * kBytesPerPixel]),
       texture_registrar_(nullptr) {
   OutputDebugStringA("[kataglyphis_texture] Constructor called\n");
-  const uint32_t pixels = width * height;
-  for (uint32_t i = 0; i < pixels; ++i) {
-    uint8_t* p = buffer_.get() + i * kBytesPerPixel;
-    p[0] = r;
-    p[1] = g;
-    p[2] = b;
-    p[3] = 255;
-  }
+  exchange_.PublishFill(width, height, r, g, b);
 }
 
 KataglyphisTexture::~KataglyphisTexture() {
   OutputDebugStringA("[kataglyphis_texture] Destructor called\n");
-  buffer_.reset();
+  // The texture is unregistered by now, so dropping the last references
+  // hands any lent buffer back to its producer.
+  in_flight_.reset();
+  exchange_.Reset();
 }
 
 void KataglyphisTexture::SetTextureRegistrar(
@@ -37,19 +35,24 @@ void KataglyphisTexture::SetTextureRegistrar(
 }
 
 bool KataglyphisTexture::PushFrame(const uint8_t* rgba, uint32_t width,
-                                   uint32_t height) {
-  if (!rgba || width == 0 || height == 0) {
+                                   uint32_t height, bool* previous_consumed) {
+  core::ScopedTrace trace("KataglyphisTexture::PushFrame");
+  if (!exchange_.PushCopy(rgba, width, height, previous_consumed)) {
     return false;
   }
-  {
-    std::lock_guard<std::mutex> lock(frame_mutex_);
-    const size_t size = static_cast<size_t>(width) * height * kBytesPerPixel;
-    if (width != width_ || height != height_) {
-      buffer_.reset(new uint8_t[size]);
-      width_ = width;
-      height_ = height;
-    }
-    std::memcpy(buffer_.get(), rgba, size);
+  if (texture_registrar_ && texture_id_ >= 0) {
+    texture_registrar_->MarkTextureFrameAvailable(texture_id_);
+  }
+  return true;
+}
+
+bool KataglyphisTexture::LendFrame(const uint8_t* rgba, uint32_t width,
+                                   uint32_t height, KntReleaseCallback release,
+                                   void* release_context,
+                                   bool* previous_consumed) {
+  if (!exchange_.PushLent(rgba, width, height, release, release_context,
+                          previous_consumed)) {
+    return false;
   }
   if (texture_registrar_ && texture_id_ >= 0) {
     texture_registrar_->MarkTextureFrameAvailable(texture_id_);
@@ -57,26 +60,58 @@ bool KataglyphisTexture::PushFrame(const uint8_t* rgba, uint32_t width,
   return true;
 }
 
+bool KataglyphisTexture::HasPendingFrame() {
+  return exchange_.HasPendingFrame();
+}
+
+KntFrameFeedback KataglyphisTexture::GetFrameFeedback() {
+  const core::FrameStats stats = exchange_.GetStats();
+  KntFrameFeedback feedback = {};
+  feedback.frames_pushed = stats.frames_pushed;
+  feedback.frames_presented = stats.frames_presented;
+  feedback.frames_dropped = stats.frames_dropped;
+  feedback.last_frame_consumed = stats.frame_pending ? 0U : 1U;
+  feedback.consumer_fps = static_cast<float>(stats.consumer_fps);
+  return feedback;
+}
+
+void KataglyphisTexture::SetSlotFreeCallback(KntSlotFreeCallback callback,
+                                             void* user_data) {
+  if (!callback) {
+    exchange_.SetSlotFreeCallback(nullptr);
+    return;
+  }
+  exchange_.SetSlotFreeCallback([this, callback, user_data] {
+    callback(texture_id_, user_data);
+  });
+}
+
 const FlutterDesktopPixelBuffer* KataglyphisTexture::CopyPixelBufferCallback(
     size_t /*width*/, size_t /*height*/) {
-  std::lock_guard<std::mutex> lock(frame_mutex_);
-  const size_t size = static_cast<size_t>(width_) * height_ * kBytesPerPixel;
-  if (present_width_ != width_ || present_height_ != height_) {
-    present_buffer_.reset(new uint8_t[size]);
-    present_width_ = width_;
-    present_height_ = height_;
-  }
-  // Copy so the returned pointer stays stable after the lock is released,
-  // even if PushFrame overwrites (or resizes) the write buffer meanwhile.
-  std::memcpy(present_buffer_.get(), buffer_.get(), size);
-  pixel_buffer_.buffer = present_buffer_.get();
-  pixel_buffer_.width = present_width_;
-  pixel_buffer_.height = present_height_;
-  pixel_buffer_.release_callback = nullptr;
-  pixel_buffer_.release_context = nullptr;
+  core::ScopedTrace trace("KataglyphisTexture::CopyPixelBufferCallback",
+                          "generation");
+  core::FrameRef frame = exchange_.AcquireLatest();
+  if (!frame) {
+    return nullptr;
+  }
+  trace.set_arg(static_cast<int64_t>(frame->generation()));
+  // Flutter copies the pixels into its GPU texture and then calls
+  // OnPixelBufferReleased, so the frame (pooled copy or lent producer
+  // buffer) is presented in place and only kept alive until then.
+  in_flight_ = std::move(frame);
+  pixel_buffer_.buffer = in_flight_->data();
+  pixel_buffer_.width = in_flight_->width();
+  pixel_buffer_.height = in_flight_->height();
+  pixel_buffer_.release_callback = &KataglyphisTexture::OnPixelBufferReleased;
+  pixel_buffer_.release_context = this;
   return &pixel_buffer_;
 }
 
+// static
+void KataglyphisTexture::OnPixelBufferReleased(void* context) {
+  static_cast<KataglyphisTexture*>(context)->in_flight_.reset();
+}
+
 flutter::TextureVariant KataglyphisTexture::GetTextureVariant() {
   return flutter::TextureVariant(flutter::PixelBufferTexture(
       [this](size_t width, size_t height) -> const FlutterDesktopPixelBuffer* {
@@ -104,17 +139,14 @@ void KataglyphisTexture::Stop() {
 
 void KataglyphisTexture::SetColor(uint8_t r, uint8_t g, uint8_t b) {
   OutputDebugStringA("[kataglyphis_texture] SetColor called\n");
-  {
-    std::lock_guard<std::mutex> lock(frame_mutex_);
-    const uint32_t pixels = width_ * height_;
-    for (uint32_t i = 0; i < pixels; ++i) {
-      uint8_t* p = buffer_.get() + i * kBytesPerPixel;
-      p[0] = r;
-      p[1] = g;
-      p[2] = b;
-      p[3] = 255;
-    }
+  // Keep the size of whatever the producer pushed last.
+  uint32_t width = width_;
+  uint32_t height = height_;
+  if (core::FrameRef latest = exchange_.PeekLatest()) {
+    width = latest->width();
+    height = latest->height();
   }
+  exchange_.PublishFill(width, height, r, g, b);
   if (texture_registrar_ && texture_id_ >= 0) {
     texture_registrar_->MarkTextureFrameAvailable(texture_id_);
   }
@@ -122,40 +154,158 @@ void KataglyphisTexture::SetColor(uint8_t r, uint8_t g, uint8_t b) {
 
 namespace {
 
+struct PushTarget {
+  // Null once unregistering; lookups then treat the id as unknown.
+  KataglyphisTexture* texture = nullptr;
+  // Calls running on the texture outside the registry lock.
+  int pins = 0;
+};
+
 std::mutex g_push_targets_mutex;
-std::unordered_map<int64_t, KataglyphisTexture*>& PushTargets() {
-  static std::unordered_map<int64_t, KataglyphisTexture*> targets;
+std::condition_variable g_push_target_unpinned;
+std::unordered_map<int64_t, PushTarget>& PushTargets() {
+  static std::unordered_map<int64_t, PushTarget> targets;
   return targets;
 }
 
 }  // namespace
 
 void RegisterPushTarget(int64_t texture_id, KataglyphisTexture* texture) {
+  core::RegisterFfiTexture(texture_id, texture->ffi_texture());
   std::lock_guard<std::mutex> lock(g_push_targets_mutex);
-  PushTargets()[texture_id] = texture;
+  PushTargets()[texture_id].texture = texture;
 }
 
 void UnregisterPushTarget(int64_t texture_id) {
-  std::lock_guard<std::mutex> lock(g_push_targets_mutex);
+  core::UnregisterFfiTexture(texture_id);
+  std::unique_lock<std::mutex> lock(g_push_targets_mutex);
+  auto it = PushTargets().find(texture_id);
+  if (it == PushTargets().end()) {
+    return;
+  }
+  // The caller deletes the texture next; let pinned calls finish first.
+  it->second.texture = nullptr;
+  // Looked up again: registering another id may rehash while waiting.
+  g_push_target_unpinned.wait(
+      lock, [texture_id] { return PushTargets()[texture_id].pins == 0; });
   PushTargets().erase(texture_id);
 }
 
 }  // namespace kataglyphis_native_inference
 
-int32_t knt_push_frame(int64_t texture_id, const uint8_t* rgba, uint32_t width,
-                       uint32_t height) {
+namespace {
+
+// Resolves the push target and runs `fn` on it while the registry lock keeps
+// the texture alive. Returns -2 for unknown ids, otherwise `fn`'s result.
+template <typename Fn>
+int32_t WithPushTarget(int64_t texture_id, Fn&& fn) {
   using namespace kataglyphis_native_inference;
-  if (!rgba || width == 0 || height == 0) {
-    return -1;
-  }
-  // Held across PushFrame so the texture cannot be destroyed mid-copy;
+  // Held across the call so the texture cannot be destroyed mid-copy;
   // contention is only with create/destroy, never frame-vs-frame.
   std::lock_guard<std::mutex> lock(g_push_targets_mutex);
   auto it = PushTargets().find(texture_id);
-  if (it == PushTargets().end()) {
+  if (it == PushTargets().end() || !it->second.texture) {
     return -2;
   }
-  return it->second->PushFrame(rgba, width, height) ? 0 : -3;
+  return fn(it->second.texture);
+}
+
+// Like WithPushTarget, but runs `fn` without the registry lock, for calls
+// that may wait on a thread that pushes frames itself. A pin keeps
+// UnregisterPushTarget, and so the texture's deletion, waiting instead.
+template <typename Fn>
+int32_t WithPinnedPushTarget(int64_t texture_id, Fn&& fn) {
+  using namespace kataglyphis_native_inference;
+  KataglyphisTexture* texture = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_push_targets_mutex);
+    auto it = PushTargets().find(texture_id);
+    if (it == PushTargets().end() || !it->second.texture) {
+      return -2;
+    }
+    texture = it->second.texture;
+    ++it->second.pins;
+  }
+  const int32_t result = fn(texture);
+  std::lock_guard<std::mutex> lock(g_push_targets_mutex);
+  // Pinned entries are only erased once unpinned.
+  if (--PushTargets()[texture_id].pins == 0) {
+    g_push_target_unpinned.notify_all();
+  }
+  return result;
+}
+
+}  // namespace
+
+int32_t knt_push_frame(int64_t texture_id, const uint8_t* rgba, uint32_t width,
+                       uint32_t height) {
+  if (!rgba || width == 0 || height == 0) {
+    return -1;
+  }
+  return WithPushTarget(texture_id, [&](auto* texture) {
+    return texture->PushFrame(rgba, width, height) ? 0 : -3;
+  });
+}
+
+int32_t knt_push_frame_ex(int64_t texture_id, const uint8_t* rgba,
+                          uint32_t width, uint32_t height,
+                          KntFrameFeedback* feedback) {
+  if (!rgba || width == 0 || height == 0) {
+    return -1;
+  }
+  return WithPushTarget(texture_id, [&](auto* texture) {
+    bool previous_consumed = true;
+    if (!texture->PushFrame(rgba, width, height, &previous_consumed)) {
+      return -3;
+    }
+    if (feedback) {
+      *feedback = texture->GetFrameFeedback();
+    }
+    return previous_consumed ? 0 : 1;
+  });
+}
+
+int32_t knt_lend_frame(int64_t texture_id, const uint8_t* rgba,
+                       uint32_t width, uint32_t height,
+                       KntReleaseCallback release, void* release_context) {
+  if (!rgba || width == 0 || height == 0 || !release) {
+    return -1;
+  }
+  return WithPushTarget(texture_id, [&](auto* texture) {
+    bool previous_consumed = true;
+    if (!texture->LendFrame(rgba, width, height, release, release_context,
+                            &previous_consumed)) {
+      return -3;
+    }
+    return previous_consumed ? 0 : 1;
+  });
+}
+
+int32_t knt_frame_pending(int64_t texture_id) {
+  return WithPushTarget(texture_id, [](auto* texture) {
+    return texture->HasPendingFrame() ? 1 : 0;
+  });
+}
+
+int32_t knt_get_frame_feedback(int64_t texture_id, KntFrameFeedback* feedback) {
+  if (!feedback) {
+    return -1;
+  }
+  return WithPushTarget(texture_id, [&](auto* texture) {
+    *feedback = texture->GetFrameFeedback();
+    return 0;
+  });
+}
+
+int32_t knt_set_slot_free_callback(int64_t texture_id,
+                                   KntSlotFreeCallback callback,
+                                   void* user_data) {
+  // Replacing the callback waits for a running one, which may push frames
+  // and so take the registry lock.
+  return WithPinnedPushTarget(texture_id, [&](auto* texture) {
+    texture->SetSlotFreeCallback(callback, user_data);
+    return 0;
+  });
 }
 
-int32_t knt_api_version() { return 1; }
+int32_t knt_api_version() { return 3; }
@@ -9,9 +9,37 @@
 
 #include <cstdint>
 #include <memory>
-#include <mutex>
 #include <string>
 
+#include "kataglyphis_native_core/ffi_api.h"
+#include "kataglyphis_native_core/frame_exchange.h"
+#include "kataglyphis_native_core/result_slot.h"
+
+extern "C" {
+
+// Producer-visible presentation counters (see `knt_get_frame_feedback`).
+// Layout is part of the C ABI; only append fields and bump knt_api_version.
+typedef struct KntFrameFeedback {
+  uint64_t frames_pushed;
+  uint64_t frames_presented;
+  // Frames overwritten by a newer push before Flutter ever presented them.
+  uint64_t frames_dropped;
+  // 1 if the most recently pushed frame has been presented, 0 otherwise.
+  uint32_t last_frame_consumed;
+  // Smoothed rate at which the raster thread consumes new frames.
+  float consumer_fps;
+} KntFrameFeedback;
+
+// Fired on the raster thread right after a pending frame was presented and
+// the slot can take a new one. Must be cheap and must not block.
+typedef void (*KntSlotFreeCallback)(int64_t texture_id, void* user_data);
+
+// Returns a lent frame to its producer (see `knt_lend_frame`). Called exactly
+// once per accepted lend, from the raster thread or the lending thread.
+typedef void (*KntReleaseCallback)(void* release_context);
+
+}  // extern "C"
+
 namespace kataglyphis_native_inference {
 
 // A CPU pixel-buffer texture fed from outside (Rust pushes RGBA frames via the
@@ -31,7 +59,33 @@ class KataglyphisTexture {
 
   // Copies one tightly packed RGBA frame into the texture and marks it
   // available. Thread-safe; callable from any thread (Rust worker).
-  bool PushFrame(const uint8_t* rgba, uint32_t width, uint32_t height);
+  // `previous_consumed` (optional) reports whether the frame this push
+  // replaced had been presented; false means it was dropped unseen.
+  bool PushFrame(const uint8_t* rgba, uint32_t width, uint32_t height,
+                 bool* previous_consumed = nullptr);
+
+  // Presents `rgba` directly without copying. The producer must keep the
+  // buffer untouched until `release` fires, which happens once the frame
+  // was superseded and Flutter no longer reads from it.
+  bool LendFrame(const uint8_t* rgba, uint32_t width, uint32_t height,
+                 KntReleaseCallback release, void* release_context,
+                 bool* previous_consumed = nullptr);
+
+  // True while a pushed frame is still waiting for the raster thread.
+  // Producers can skip conversion/inference for frames that would be
+  // dropped anyway.
+  bool HasPendingFrame();
+
+  KntFrameFeedback GetFrameFeedback();
+
+  // Pass nullptr to clear. The callback runs on the raster thread; clearing
+  // or replacing it waits until a call in progress has returned.
+  void SetSlotFreeCallback(KntSlotFreeCallback callback, void* user_data);
+
+  // What the Dart FFI fast path reads (see kataglyphis_native_core/ffi_api.h).
+  core::FfiTexture ffi_texture() {
+    return core::FfiTexture{&exchange_, &results_};
+  }
 
   int64_t texture_id() const { return texture_id_; }
   void set_texture_id(int64_t id) { texture_id_ = id; }
@@ -40,22 +94,24 @@ class KataglyphisTexture {
   flutter::TextureVariant GetTextureVariant();
 
  private:
-  static constexpr size_t kBytesPerPixel = 4;
+  static void OnPixelBufferReleased(void* context);
 
   int64_t texture_id_;
+  // Size requested at creation; pushed frames may use any other size.
   uint32_t width_;
   uint32_t height_;
-  std::unique_ptr<uint8_t[]> buffer_;
 
-  // Raster-thread copy handed to Flutter; must outlive the callback return.
-  uint32_t present_width_ = 0;
-  uint32_t present_height_ = 0;
-  std::unique_ptr<uint8_t[]> present_buffer_;
-  FlutterDesktopPixelBuffer pixel_buffer_ = {};
+  // Frame handoff between PushFrame/LendFrame (any thread) and the raster
+  // thread; see kataglyphis_native_core for the locking and pooling rules.
+  core::FrameExchange exchange_;
+  // Latest inference result, read through the FFI fast path.
+  core::ResultSlot results_;
 
-  // Guards buffer_/width_/height_ between PushFrame (any thread) and the
-  // raster-thread pixel-buffer callback.
-  std::mutex frame_mutex_;
+  // Frame Flutter is reading from, held until its release callback fires so
+  // the pointer in pixel_buffer_ stays valid without a present copy. Only
+  // touched on the raster thread.
+  core::FrameRef in_flight_;
+  FlutterDesktopPixelBuffer pixel_buffer_ = {};
 
   flutter::TextureRegistrar* texture_registrar_;
 
@@ -65,7 +121,7 @@ class KataglyphisTexture {
 
 // Global id → texture registry backing the C ABI. The plugin registers a
 // texture after RegisterTexture assigns its id and unregisters it before
-// destruction.
+// destruction. Also (un)registers it for the Dart FFI fast path.
 void RegisterPushTarget(int64_t texture_id, KataglyphisTexture* texture);
 void UnregisterPushTarget(int64_t texture_id);
 
@@ -80,6 +136,39 @@ __declspec(dllexport) int32_t knt_push_frame(int64_t texture_id,
                                              const uint8_t* rgba,
                                              uint32_t width, uint32_t height);
 
+// Like knt_push_frame, but reports what happened to the replaced frame:
+// 0 = it had been presented, 1 = it was dropped unseen, negative on error.
+// `feedback` may be null; when set it is filled after the push.
+__declspec(dllexport) int32_t knt_push_frame_ex(int64_t texture_id,
+                                                const uint8_t* rgba,
+                                                uint32_t width, uint32_t height,
+                                                KntFrameFeedback* feedback);
+
+// Zero-copy variant of knt_push_frame_ex: the texture presents `rgba` in
+// place and calls `release(release_context)` once the buffer may be reused.
+// Same return values as knt_push_frame_ex; on a negative return the buffer
+// was not accepted and `release` will not be called.
+__declspec(dllexport) int32_t knt_lend_frame(int64_t texture_id,
+                                             const uint8_t* rgba,
+                                             uint32_t width, uint32_t height,
+                                             KntReleaseCallback release,
+                                             void* release_context);
+
+// 1 while the last pushed frame is still unpresented, 0 when the slot is
+// free, negative on error. Cheap enough to call before every conversion.
+__declspec(dllexport) int32_t knt_frame_pending(int64_t texture_id);
+
+// Returns 0 and fills `feedback`, negative on error.
+__declspec(dllexport) int32_t knt_get_frame_feedback(
+    int64_t texture_id, KntFrameFeedback* feedback);
+
+// Installs (or clears, with a null callback) the slot-free notification.
+// Once this returns, the previous callback is not running and will not be
+// called again, so its `user_data` may be freed. Returns 0 on success,
+// negative on error.
+__declspec(dllexport) int32_t knt_set_slot_free_callback(
+    int64_t texture_id, KntSlotFreeCallback callback, void* user_data);
+
 // ABI version for sanity checks from the Rust side.
 __declspec(dllexport) int32_t knt_api_version();
 
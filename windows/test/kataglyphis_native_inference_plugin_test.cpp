@@ -7,8 +7,10 @@
 #include <memory>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "kataglyphis_native_inference_plugin.h"
+#include "kataglyphis_texture.h"
 
 namespace kataglyphis_native_inference {
 namespace test {
@@ -39,5 +41,39 @@ TEST(KataglyphisNativeInferencePlugin, GetPlatformVersion) {
   EXPECT_TRUE(result_string.rfind("Windows ", 0) == 0);
 }
 
+TEST(KataglyphisTexture, PushFrameReportsDroppedFrames) {
+  KataglyphisTexture texture(2, 2, 0, 0, 0);
+  const std::vector<uint8_t> frame(2 * 2 * 4, 0x7f);
+
+  bool previous_consumed = false;
+  ASSERT_TRUE(texture.PushFrame(frame.data(), 2, 2, &previous_consumed));
+  EXPECT_TRUE(previous_consumed);
+  EXPECT_TRUE(texture.HasPendingFrame());
+
+  // Second push before any present replaces an unseen frame.
+  ASSERT_TRUE(texture.PushFrame(frame.data(), 2, 2, &previous_consumed));
+  EXPECT_FALSE(previous_consumed);
+
+  const KntFrameFeedback feedback = texture.GetFrameFeedback();
+  EXPECT_EQ(feedback.frames_pushed, 2u);
+  EXPECT_EQ(feedback.frames_presented, 0u);
+  EXPECT_EQ(feedback.frames_dropped, 1u);
+  EXPECT_EQ(feedback.last_frame_consumed, 0u);
+}
+
+TEST(KataglyphisTexture, LentFrameIsReleasedWhenSuperseded) {
+  KataglyphisTexture texture(2, 2, 0, 0, 0);
+  const std::vector<uint8_t> frame(2 * 2 * 4, 0x7f);
+  int releases = 0;
+  const auto release = [](void* context) { ++*static_cast<int*>(context); };
+
+  ASSERT_TRUE(texture.LendFrame(frame.data(), 2, 2, release, &releases));
+  EXPECT_EQ(releases, 0);
+
+  // Never presented, so a regular push hands the lent buffer straight back.
+  ASSERT_TRUE(texture.PushFrame(frame.data(), 2, 2));
+  EXPECT_EQ(releases, 1);
+}
+
 }  // namespace test
 }  // namespace kataglyphis_native_inference